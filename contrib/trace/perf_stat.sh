@@ -0,0 +1,27 @@
+#!/bin/sh
+#
+# Count every libfabric tracepoint hit while running a command, using perf.
+#
+# Usage: perf_stat.sh <path to the library with the probes> <command> [args]
+#
+# perf records the probes of a library once it is in the build-id cache.
+# Creating the probe events needs root, or a kernel.perf_event_paranoid
+# setting that allows uprobes.
+
+if [ $# -lt 2 ]; then
+	echo "usage: $0 <library> <command> [args]" >&2
+	exit 1
+fi
+
+lib=$1
+shift
+
+perf buildid-cache --add "$lib" || exit 1
+perf probe -q -d 'sdt_libfabric:*' 2> /dev/null
+perf probe -q -x "$lib" -a '%sdt_libfabric:*' || exit 1
+
+perf stat -e 'sdt_libfabric:*' -- "$@"
+ret=$?
+
+perf probe -q -d 'sdt_libfabric:*'
+exit $ret
@@ -33,6 +33,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 
 #include <rdma/fi_errno.h>
 
@@ -47,6 +49,9 @@
  */
 static int inject_size_set;
 
+static int bench_reps = 1;
+static enum ft_bench_format bench_format = FT_BENCH_TEXT;
+
 void ft_parse_benchmark_opts(int op, char *optarg)
 {
 	switch (op) {
@@ -63,6 +68,21 @@ void ft_parse_benchmark_opts(int op, char *optarg)
 	case 'W':
 		opts.window_size = atoi(optarg);
 		break;
+	case LONG_OPT_REPEAT:
+		bench_reps = atoi(optarg);
+		if (bench_reps < 1)
+			bench_reps = 1;
+		else if (bench_reps > FT_BENCH_MAX_REPS)
+			bench_reps = FT_BENCH_MAX_REPS;
+		break;
+	case LONG_OPT_OUTPUT:
+		if (!strcasecmp(optarg, "json"))
+			bench_format = FT_BENCH_JSON;
+		else if (!strcasecmp(optarg, "csv"))
+			bench_format = FT_BENCH_CSV;
+		else
+			bench_format = FT_BENCH_TEXT;
+		break;
 	default:
 		break;
 	}
@@ -77,22 +97,354 @@ void ft_benchmark_usage(void)
 			"* The following condition is required to have at least "
 			"one window\nsize # of messsages to be sent: "
 			"# of iterations > window size");
+	FT_PRINT_OPTS_USAGE("--repeat <count>",
+			"repeat each measurement and report the mean with a\n"
+			"95% confidence interval (default: 1)");
+	FT_PRINT_OPTS_USAGE("--output <text|json|csv>",
+			"print results as text, JSON lines or CSV; JSON and\n"
+			"CSV add latency percentiles and warmup detection");
 }
 
-int pingpong(void)
+static int bench_msb(uint64_t val)
 {
-	int ret, i, inject_size;
+	int msb = 0;
 
-	inject_size = inject_size_set ?
-			hints->tx_attr->inject_size : fi->tx_attr->inject_size;
+	if (val >> 32) {
+		val >>= 32;
+		msb += 32;
+	}
+	if (val >> 16) {
+		val >>= 16;
+		msb += 16;
+	}
+	if (val >> 8) {
+		val >>= 8;
+		msb += 8;
+	}
+	if (val >> 4) {
+		val >>= 4;
+		msb += 4;
+	}
+	if (val >> 2) {
+		val >>= 2;
+		msb += 2;
+	}
+	if (val >> 1)
+		msb += 1;
+	return msb;
+}
 
-	if (opts.options & FT_OPT_ENABLE_HMEM)
-		inject_size = 0;
+void ft_bench_hist_add(struct ft_bench_hist *hist, uint64_t val)
+{
+	int msb, idx;
+
+	if (val < FT_BENCH_HIST_SUB) {
+		idx = (int) val;
+	} else {
+		msb = bench_msb(val);
+		idx = (msb - 3) * FT_BENCH_HIST_SUB +
+		      (int) ((val >> (msb - 4)) & (FT_BENCH_HIST_SUB - 1));
+	}
+
+	hist->bucket[idx]++;
+	hist->count++;
+	if (val > hist->max)
+		hist->max = val;
+}
+
+void ft_bench_hist_merge(struct ft_bench_hist *dst,
+			 const struct ft_bench_hist *src)
+{
+	int i;
+
+	for (i = 0; i < FT_BENCH_HIST_BUCKETS; i++)
+		dst->bucket[i] += src->bucket[i];
+	dst->count += src->count;
+	if (src->max > dst->max)
+		dst->max = src->max;
+}
+
+/* Returns the upper bound of the bucket holding the given percentile. */
+uint64_t ft_bench_hist_pct(const struct ft_bench_hist *hist, double pct)
+{
+	uint64_t target, sum = 0, val;
+	int i, shift;
+
+	if (!hist->count)
+		return 0;
+
+	target = (uint64_t) ceil(hist->count * pct / 100);
+	if (!target)
+		target = 1;
+
+	for (i = 0; i < FT_BENCH_HIST_BUCKETS; i++) {
+		sum += hist->bucket[i];
+		if (sum >= target)
+			break;
+	}
+
+	if (i < FT_BENCH_HIST_SUB) {
+		val = i;
+	} else {
+		shift = i / FT_BENCH_HIST_SUB - 1;
+		val = ((uint64_t) (FT_BENCH_HIST_SUB + i % FT_BENCH_HIST_SUB)
+		       << shift) + ((1ULL << shift) - 1);
+	}
+	return MIN(val, hist->max);
+}
+
+int ft_bench_reps(void)
+{
+	return bench_reps;
+}
+
+/* Per-transfer samples are only taken when they will be reported. */
+int ft_bench_sampling(void)
+{
+	return bench_format != FT_BENCH_TEXT;
+}
+
+int ft_bench_stats_init(struct ft_bench_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	stats->settled = opts.warmup_iterations;
+	if (!ft_bench_sampling())
+		return 0;
+
+	/* One sample per iteration, or per window plus a final partial one */
+	stats->sample_max = opts.iterations + opts.warmup_iterations + 1;
+	stats->samples = calloc(stats->sample_max, sizeof(*stats->samples));
+	if (!stats->samples)
+		return -FI_ENOMEM;
+	return 0;
+}
+
+void ft_bench_stats_free(struct ft_bench_stats *stats)
+{
+	free(stats->samples);
+	stats->samples = NULL;
+}
+
+/* Record that the transfers of iteration iter and any before it that were
+ * not sampled yet took ns nanoseconds.
+ */
+void ft_bench_sample(struct ft_bench_stats *stats, int iter, uint64_t ns,
+		     int xfers)
+{
+	struct ft_bench_sample *sample;
+
+	if (!stats->samples || stats->sample_cnt == stats->sample_max)
+		return;
+
+	sample = &stats->samples[stats->sample_cnt++];
+	sample->iter = iter;
+	sample->xfers = xfers;
+	sample->ns = ns;
+}
+
+static uint64_t bench_sample_ns(const struct ft_bench_sample *sample)
+{
+	return sample->ns / sample->xfers;
+}
+
+/* The warm-up ends with the first run of steady samples, none taking more
+ * than twice the median of the timed iterations.  Later outliers do not
+ * move it, but it is only searched for in the first half of the samples.
+ * Returns the index of the first steady sample, or -1 if there is none.
+ */
+static int bench_warmup_end(struct ft_bench_stats *stats)
+{
+	struct ft_bench_hist *hist;
+	uint64_t limit;
+	int i, run, steady;
+
+	hist = calloc(1, sizeof(*hist));
+	if (!hist)
+		return -1;
+
+	for (i = 0; i < stats->sample_cnt; i++) {
+		if (stats->samples[i].iter >= opts.warmup_iterations)
+			ft_bench_hist_add(hist,
+					  bench_sample_ns(&stats->samples[i]));
+	}
+	limit = 2 * ft_bench_hist_pct(hist, 50);
+	free(hist);
+
+	steady = MIN(MAX(4, stats->sample_cnt / 50), stats->sample_cnt);
+	for (i = run = 0; i < stats->sample_cnt && run < steady; i++)
+		run = bench_sample_ns(&stats->samples[i]) > limit ? 0 : run + 1;
+
+	i -= run;
+	return (run == steady && i <= stats->sample_cnt / 2) ? i : -1;
+}
+
+/* Record the repetition timed by ft_start() and ft_stop().  When samples
+ * were taken, the repetition is instead timed from the end of the detected
+ * warm-up, or of the -w iterations if that is later.
+ */
+void ft_bench_rep_done(struct ft_bench_stats *stats, int xfers_per_iter)
+{
+	int64_t elapsed = get_elapsed(&start, &end, MICRO);
+	uint64_t ns = 0, xfers = 0;
+	double usec;
+	int i, first;
+
+	usec = (double) elapsed / opts.iterations / xfers_per_iter;
+	if (stats->sample_cnt) {
+		first = bench_warmup_end(stats);
+		if (first < 0) {
+			FT_WARN("warmup did not settle (see -w)");
+			first = 0;
+		}
+		while (first < stats->sample_cnt &&
+		       stats->samples[first].iter < opts.warmup_iterations)
+			first++;
+
+		for (i = first; i < stats->sample_cnt; i++) {
+			ft_bench_hist_add(&stats->hist,
+					  bench_sample_ns(&stats->samples[i]));
+			ns += stats->samples[i].ns;
+			xfers += stats->samples[i].xfers;
+		}
+		if (xfers) {
+			usec = (double) ns / xfers / 1000;
+			elapsed = ns / 1000;
+		}
+		if (first < stats->sample_cnt)
+			stats->settled = MAX(stats->settled,
+					     stats->samples[first].iter);
+		stats->sample_cnt = 0;
+	}
+
+	if (stats->reps < FT_BENCH_MAX_REPS)
+		stats->usec[stats->reps++] = usec;
+	stats->elapsed += elapsed;
+}
+
+/* Two-sided 95% Student's t values, indexed by degrees of freedom. */
+static const double bench_t95[] = {
+	0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+	2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+	2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045,
+	2.042,
+};
+
+static void bench_mean_ci(const double *val, int cnt, double *mean,
+			  double *ci)
+{
+	double sum = 0, var = 0;
+	int i;
+
+	for (i = 0; i < cnt; i++)
+		sum += val[i];
+	*mean = sum / cnt;
+
+	if (cnt < 2) {
+		*ci = 0;
+		return;
+	}
+
+	for (i = 0; i < cnt; i++)
+		var += (val[i] - *mean) * (val[i] - *mean);
+	var /= cnt - 1;
+	*ci = ((size_t) cnt - 1 < ARRAY_SIZE(bench_t95) ?
+	       bench_t95[cnt - 1] : 1.960) *
+	      sqrt(var / cnt);
+}
+
+static const char *bench_name(void)
+{
+	const char *name;
+
+	if (!opts.argv || !opts.argv[0])
+		return "";
+
+	name = strrchr(opts.argv[0], '/');
+	return name ? name + 1 : opts.argv[0];
+}
+
+void ft_bench_show(struct ft_bench_stats *stats, int xfers_per_iter,
+		   int nthreads)
+{
+	static int csv_header = 1;
+	struct timespec t0, t1;
+	double mbps[FT_BENCH_MAX_REPS];
+	double usec, usec_ci, rate, rate_ci;
+	int i;
+
+	if (bench_format == FT_BENCH_TEXT) {
+		t0.tv_sec = t0.tv_nsec = 0;
+		t1.tv_sec = stats->elapsed / 1000000;
+		t1.tv_nsec = (stats->elapsed % 1000000) * 1000;
+		if (opts.machr)
+			show_perf_mr(opts.transfer_size,
+				     opts.iterations * stats->reps, &t0, &t1,
+				     xfers_per_iter,
+				     opts.argc, opts.argv);
+		else
+			show_perf(NULL, opts.transfer_size,
+				  opts.iterations * stats->reps, &t0, &t1,
+				  xfers_per_iter);
+		return;
+	}
+
+	for (i = 0; i < stats->reps; i++)
+		mbps[i] = opts.transfer_size / stats->usec[i];
+	bench_mean_ci(stats->usec, stats->reps, &usec, &usec_ci);
+	bench_mean_ci(mbps, stats->reps, &rate, &rate_ci);
+
+	if (bench_format == FT_BENCH_JSON) {
+		printf("{\"benchmark\": \"%s\", \"bytes\": %zu, "
+		       "\"iterations\": %d, \"repetitions\": %d, "
+		       "\"threads\": %d, "
+		       "\"usec_per_xfer\": {\"mean\": %.3f, \"ci95\": %.3f}, "
+		       "\"mbytes_per_sec\": {\"mean\": %.2f, \"ci95\": %.2f}, "
+		       "\"latency_ns\": {\"p50\": %" PRIu64 ", "
+		       "\"p90\": %" PRIu64 ", \"p99\": %" PRIu64 ", "
+		       "\"p99.9\": %" PRIu64 ", \"max\": %" PRIu64 "}, "
+		       "\"warmup\": {\"iterations\": %d, \"settled\": %d}}\n",
+		       bench_name(), opts.transfer_size, opts.iterations,
+		       stats->reps, nthreads, usec, usec_ci, rate, rate_ci,
+		       ft_bench_hist_pct(&stats->hist, 50),
+		       ft_bench_hist_pct(&stats->hist, 90),
+		       ft_bench_hist_pct(&stats->hist, 99),
+		       ft_bench_hist_pct(&stats->hist, 99.9),
+		       stats->hist.max, opts.warmup_iterations, stats->settled);
+	} else {
+		if (csv_header) {
+			printf("benchmark,bytes,iterations,repetitions,"
+			       "threads,usec_per_xfer,usec_per_xfer_ci95,"
+			       "mbytes_per_sec,mbytes_per_sec_ci95,p50_ns,"
+			       "p90_ns,p99_ns,p99.9_ns,max_ns,"
+			       "warmup_iterations,warmup_settled\n");
+			csv_header = 0;
+		}
+		printf("%s,%zu,%d,%d,%d,%.3f,%.3f,%.2f,%.2f,%" PRIu64 ","
+		       "%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%d,%d\n",
+		       bench_name(), opts.transfer_size, opts.iterations,
+		       stats->reps, nthreads, usec, usec_ci, rate, rate_ci,
+		       ft_bench_hist_pct(&stats->hist, 50),
+		       ft_bench_hist_pct(&stats->hist, 90),
+		       ft_bench_hist_pct(&stats->hist, 99),
+		       ft_bench_hist_pct(&stats->hist, 99.9),
+		       stats->hist.max, opts.warmup_iterations, stats->settled);
+	}
+	fflush(stdout);
+}
+
+static int pingpong_rep(int inject_size, struct ft_bench_stats *stats)
+{
+	uint64_t prev = 0, now;
+	int ret, i, sampling;
 
 	ret = ft_sync();
 	if (ret)
 		return ret;
 
+	sampling = ft_bench_sampling();
+	if (sampling)
+		prev = ft_gettime_ns();
+
 	if (opts.dst_addr) {
 		for (i = 0; i < opts.iterations + opts.warmup_iterations; i++) {
 			if (i == opts.warmup_iterations)
@@ -108,6 +460,12 @@ int pingpong(void)
 			ret = ft_rx(ep, opts.transfer_size);
 			if (ret)
 				return ret;
+
+			if (sampling) {
+				now = ft_gettime_ns();
+				ft_bench_sample(stats, i, now - prev, 2);
+				prev = now;
+			}
 		}
 	} else {
 		for (i = 0; i < opts.iterations + opts.warmup_iterations; i++) {
@@ -124,19 +482,46 @@ int pingpong(void)
 				ret = ft_tx(ep, remote_fi_addr, opts.transfer_size, &tx_ctx);
 			if (ret)
 				return ret;
+
+			if (sampling) {
+				now = ft_gettime_ns();
+				ft_bench_sample(stats, i, now - prev, 2);
+				prev = now;
+			}
 		}
 	}
 	ft_stop();
 
-	if (opts.machr)
-		show_perf_mr(opts.transfer_size, opts.iterations, &start, &end, 2,
-				opts.argc, opts.argv);
-	else
-		show_perf(NULL, opts.transfer_size, opts.iterations, &start, &end, 2);
-
 	return 0;
 }
 
+int pingpong(void)
+{
+	struct ft_bench_stats stats;
+	int ret, rep, inject_size;
+
+	inject_size = inject_size_set ?
+			hints->tx_attr->inject_size : fi->tx_attr->inject_size;
+
+	if (opts.options & FT_OPT_ENABLE_HMEM)
+		inject_size = 0;
+
+	ret = ft_bench_stats_init(&stats);
+	if (ret)
+		return ret;
+
+	for (rep = 0; rep < bench_reps; rep++) {
+		ret = pingpong_rep(inject_size, &stats);
+		if (ret)
+			goto out;
+		ft_bench_rep_done(&stats, 2);
+	}
+	ft_bench_show(&stats, 2, 1);
+out:
+	ft_bench_stats_free(&stats);
+	return ret;
+}
+
 static int bw_tx_comp()
 {
 	int ret;
@@ -158,20 +543,33 @@ static int bw_rx_comp()
 	return ft_tx(ep, remote_fi_addr, 4, &tx_ctx);
 }
 
-int bandwidth(void)
+/* Sample the window of cnt transfers ending at iteration i. */
+static void bw_sample(struct ft_bench_stats *stats, int i, int cnt,
+		      uint64_t *prev)
 {
-	int ret, i, j, inject_size;
+	uint64_t now;
 
-	inject_size = inject_size_set ?
-			hints->tx_attr->inject_size : fi->tx_attr->inject_size;
+	if (!cnt)
+		return;
 
-	if (opts.options & FT_OPT_ENABLE_HMEM)
-		inject_size = 0;
+	now = ft_gettime_ns();
+	ft_bench_sample(stats, i, now - *prev, cnt);
+	*prev = now;
+}
+
+static int bandwidth_rep(int inject_size, struct ft_bench_stats *stats)
+{
+	uint64_t prev = 0;
+	int ret, i, j, sampling;
 
 	ret = ft_sync();
 	if (ret)
 		return ret;
 
+	sampling = ft_bench_sampling();
+	if (sampling)
+		prev = ft_gettime_ns();
+
 	/* The loop structured allows for the possibility that the sender
 	 * immediately overruns the receiving side on the first transfer (or
 	 * the entire window). This could result in exercising parts of the
@@ -196,6 +594,8 @@ int bandwidth(void)
 				ret = bw_tx_comp();
 				if (ret)
 					return ret;
+				if (sampling)
+					bw_sample(stats, i, j, &prev);
 				j = 0;
 			}
 		}
@@ -215,6 +615,8 @@ int bandwidth(void)
 				ret = bw_rx_comp();
 				if (ret)
 					return ret;
+				if (sampling)
+					bw_sample(stats, i, j, &prev);
 				j = 0;
 			}
 		}
@@ -222,17 +624,40 @@ int bandwidth(void)
 		if (ret)
 			return ret;
 	}
+	if (sampling)
+		bw_sample(stats, i - 1, j, &prev);
 	ft_stop();
 
-	if (opts.machr)
-		show_perf_mr(opts.transfer_size, opts.iterations, &start, &end, 1,
-				opts.argc, opts.argv);
-	else
-		show_perf(NULL, opts.transfer_size, opts.iterations, &start, &end, 1);
-
 	return 0;
 }
 
+int bandwidth(void)
+{
+	struct ft_bench_stats stats;
+	int ret, rep, inject_size;
+
+	inject_size = inject_size_set ?
+			hints->tx_attr->inject_size : fi->tx_attr->inject_size;
+
+	if (opts.options & FT_OPT_ENABLE_HMEM)
+		inject_size = 0;
+
+	ret = ft_bench_stats_init(&stats);
+	if (ret)
+		return ret;
+
+	for (rep = 0; rep < bench_reps; rep++) {
+		ret = bandwidth_rep(inject_size, &stats);
+		if (ret)
+			goto out;
+		ft_bench_rep_done(&stats, 1);
+	}
+	ft_bench_show(&stats, 1, 1);
+out:
+	ft_bench_stats_free(&stats);
+	return ret;
+}
+
 static int bw_rma_comp(enum ft_rma_opcodes rma_op)
 {
 	int ret;
@@ -252,20 +677,21 @@ static int bw_rma_comp(enum ft_rma_opcodes rma_op)
 	return 0;
 }
 
-int bandwidth_rma(enum ft_rma_opcodes rma_op, struct fi_rma_iov *remote)
+static int bandwidth_rma_rep(enum ft_rma_opcodes rma_op,
+			     struct fi_rma_iov *remote, int inject_size,
+			     struct ft_bench_stats *stats)
 {
-	int ret, i, j, inject_size;
-
-	inject_size = inject_size_set ?
-			hints->tx_attr->inject_size: fi->tx_attr->inject_size;
-
-	if (opts.options & FT_OPT_ENABLE_HMEM)
-		inject_size = 0;
+	uint64_t prev = 0;
+	int ret, i, j, sampling;
 
 	ret = ft_sync();
 	if (ret)
 		return ret;
 
+	sampling = ft_bench_sampling();
+	if (sampling)
+		prev = ft_gettime_ns();
+
 	for (i = j = 0; i < opts.iterations + opts.warmup_iterations; i++) {
 		if (i == opts.warmup_iterations)
 			ft_start();
@@ -320,18 +746,44 @@ int bandwidth_rma(enum ft_rma_opcodes rma_op, struct fi_rma_iov *remote)
 			ret = bw_rma_comp(rma_op);
 			if (ret)
 				return ret;
+			if (sampling)
+				bw_sample(stats, i, j, &prev);
 			j = 0;
 		}
 	}
 	ret = bw_rma_comp(rma_op);
 	if (ret)
 		return ret;
+	if (sampling)
+		bw_sample(stats, i - 1, j, &prev);
 	ft_stop();
 
-	if (opts.machr)
-		show_perf_mr(opts.transfer_size, opts.iterations, &start, &end,	1,
-				opts.argc, opts.argv);
-	else
-		show_perf(NULL, opts.transfer_size, opts.iterations, &start, &end, 1);
 	return 0;
 }
+
+int bandwidth_rma(enum ft_rma_opcodes rma_op, struct fi_rma_iov *remote)
+{
+	struct ft_bench_stats stats;
+	int ret, rep, inject_size;
+
+	inject_size = inject_size_set ?
+			hints->tx_attr->inject_size: fi->tx_attr->inject_size;
+
+	if (opts.options & FT_OPT_ENABLE_HMEM)
+		inject_size = 0;
+
+	ret = ft_bench_stats_init(&stats);
+	if (ret)
+		return ret;
+
+	for (rep = 0; rep < bench_reps; rep++) {
+		ret = bandwidth_rma_rep(rma_op, remote, inject_size, &stats);
+		if (ret)
+			goto out;
+		ft_bench_rep_done(&stats, 1);
+	}
+	ft_bench_show(&stats, 1, 1);
+out:
+	ft_bench_stats_free(&stats);
+	return ret;
+}
@@ -43,8 +43,72 @@ extern "C" {
 #define BENCHMARK_OPTS "vkj:W:"
 #define FT_BENCHMARK_MAX_MSG_SIZE (test_size[TEST_CNT - 1].size)
 
+enum ft_bench_format {
+	FT_BENCH_TEXT,
+	FT_BENCH_JSON,
+	FT_BENCH_CSV,
+};
+
+/* Log-linear histogram of nanosecond samples: values below 16 have their
+ * own bucket, larger values are split into 16 buckets per power of two,
+ * which bounds the error of a reported percentile to 1/16.
+ */
+#define FT_BENCH_HIST_SUB	16
+#define FT_BENCH_HIST_BUCKETS	(61 * FT_BENCH_HIST_SUB)
+#define FT_BENCH_MAX_REPS	64
+
+struct ft_bench_hist {
+	uint64_t count;
+	uint64_t max;
+	uint64_t bucket[FT_BENCH_HIST_BUCKETS];
+};
+
+/* A pingpong iteration is one sample of two transfers, a bandwidth window
+ * one sample of as many transfers as the window holds.
+ */
+struct ft_bench_sample {
+	int iter;
+	int xfers;
+	uint64_t ns;
+};
+
+/* Results for one message size, accumulated over --repeat repetitions.
+ * Histogram entries are per transfer: half a pingpong round trip, or the
+ * duration of a bandwidth window divided by the window size.  The samples
+ * of a repetition are kept until it is done, so that those taken before
+ * the warm-up settled can be left out.  The shared pingpong and bandwidth
+ * loops run in a single thread; multi-threaded tests merge the histograms
+ * of their threads instead.
+ */
+struct ft_bench_stats {
+	struct ft_bench_hist hist;
+	struct ft_bench_sample *samples;
+	int sample_cnt;
+	int sample_max;
+	int settled;
+	int reps;
+	int64_t elapsed;
+	double usec[FT_BENCH_MAX_REPS];
+};
+
 void ft_parse_benchmark_opts(int op, char *optarg);
 void ft_benchmark_usage(void);
+
+void ft_bench_hist_add(struct ft_bench_hist *hist, uint64_t val);
+void ft_bench_hist_merge(struct ft_bench_hist *dst,
+			 const struct ft_bench_hist *src);
+uint64_t ft_bench_hist_pct(const struct ft_bench_hist *hist, double pct);
+
+int ft_bench_reps(void);
+int ft_bench_sampling(void);
+int ft_bench_stats_init(struct ft_bench_stats *stats);
+void ft_bench_stats_free(struct ft_bench_stats *stats);
+void ft_bench_sample(struct ft_bench_stats *stats, int iter, uint64_t ns,
+		     int xfers);
+void ft_bench_rep_done(struct ft_bench_stats *stats, int xfers_per_iter);
+void ft_bench_show(struct ft_bench_stats *stats, int xfers_per_iter,
+		   int nthreads);
+
 int pingpong(void);
 int bandwidth(void);
 int bandwidth_rma(enum ft_rma_opcodes op, struct fi_rma_iov *remote);
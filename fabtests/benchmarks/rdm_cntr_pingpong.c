@@ -30,12 +30,207 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <getopt.h>
+#include <pthread.h>
 
 #include <rdma/fi_errno.h>
 
 #include <shared.h>
 #include "benchmark_shared.h"
 
+/* With -T, each thread issues RMA writes through its own endpoint.  The
+ * endpoints of all threads share one write counter at the client and one
+ * remote write counter at the server, so every completion updates the
+ * same counter from several threads.
+ */
+struct cntr_thread {
+	pthread_t		thread;
+	struct fid_ep		*ep;
+	struct fid_cq		*txcq;
+	struct fid_cq		*rxcq;
+	fi_addr_t		addr;
+	int			ret;
+};
+
+static int num_threads = 1;
+static struct cntr_thread *threads;
+static struct fid_cntr *write_cntr;
+static uint64_t write_base;
+static volatile int threads_stop;
+
+/* Threads wait for the writes of all threads to complete after each
+ * window, which keeps them in step and several threads blocked in
+ * fi_cntr_wait on the shared counter.
+ */
+static void *write_thread_run(void *arg)
+{
+	struct cntr_thread *t = arg;
+	uint64_t threshold;
+	int i, ret = 0;
+
+	for (i = 0; i < opts.iterations && !ret; ) {
+		do {
+			ret = fi_write(t->ep, tx_buf, opts.transfer_size,
+				       mr_desc, t->addr, remote.addr,
+				       remote.key, NULL);
+			if (ret == -FI_EAGAIN)
+				(void) fi_cntr_read(write_cntr);
+		} while (ret == -FI_EAGAIN);
+		if (ret) {
+			FT_PRINTERR("fi_write", ret);
+			break;
+		}
+
+		if (++i % opts.window_size && i < opts.iterations)
+			continue;
+
+		threshold = write_base + (uint64_t) i * num_threads;
+		ret = fi_cntr_wait(write_cntr, threshold, timeout);
+		if (ret)
+			FT_PRINTERR("fi_cntr_wait", ret);
+	}
+	t->ret = ret;
+	return NULL;
+}
+
+/* The server only progresses its endpoints until the client is done. */
+static void *progress_thread_run(void *arg)
+{
+	while (!threads_stop)
+		(void) fi_cntr_read(write_cntr);
+	return NULL;
+}
+
+static int run_threads(void)
+{
+	int i, ret;
+
+	ret = ft_sync();
+	if (ret)
+		return ret;
+
+	write_base = fi_cntr_read(write_cntr);
+	threads_stop = 0;
+	ft_start();
+	for (i = 0; i < num_threads; i++) {
+		ret = pthread_create(&threads[i].thread, NULL,
+				     opts.dst_addr ? write_thread_run :
+				     progress_thread_run, &threads[i]);
+		if (ret) {
+			FT_PRINTERR("pthread_create", -ret);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (!opts.dst_addr)
+		ret = ft_sync();
+
+	threads_stop = 1;
+	for (i = 0; i < num_threads; i++) {
+		pthread_join(threads[i].thread, NULL);
+		if (threads[i].ret && !ret)
+			ret = threads[i].ret;
+	}
+	ft_stop();
+	if (ret)
+		return ret;
+
+	if (opts.dst_addr) {
+		ret = ft_sync();
+		if (ret)
+			return ret;
+		show_perf(NULL, opts.transfer_size,
+			  opts.iterations * num_threads, &start, &end, 1);
+	}
+	return 0;
+}
+
+static int alloc_thread_res(void)
+{
+	struct fi_info *thread_hints, *thread_info;
+	int i, ret;
+
+	threads = calloc(num_threads, sizeof(*threads));
+	if (!threads)
+		return -FI_ENOMEM;
+
+	/* The thread endpoints take any free address */
+	thread_hints = fi_dupinfo(fi);
+	if (!thread_hints)
+		return -FI_ENOMEM;
+	free(thread_hints->src_addr);
+	thread_hints->src_addr = NULL;
+	thread_hints->src_addrlen = 0;
+	ret = fi_getinfo(FT_FIVERSION, opts.src_addr, NULL, 0, thread_hints,
+			 &thread_info);
+	fi_freeinfo(thread_hints);
+	if (ret) {
+		FT_PRINTERR("fi_getinfo", ret);
+		return ret;
+	}
+
+	ret = ft_cntr_open(&write_cntr);
+	if (ret) {
+		FT_PRINTERR("fi_cntr_open", ret);
+		return ret;
+	}
+
+	for (i = 0; i < num_threads; i++) {
+		ret = fi_endpoint(domain, thread_info, &threads[i].ep, NULL);
+		if (ret) {
+			FT_PRINTERR("fi_endpoint", ret);
+			goto out;
+		}
+
+		ret = fi_cq_open(domain, &cq_attr, &threads[i].txcq, NULL);
+		if (!ret)
+			ret = fi_cq_open(domain, &cq_attr, &threads[i].rxcq,
+					 NULL);
+		if (ret) {
+			FT_PRINTERR("fi_cq_open", ret);
+			goto out;
+		}
+
+		ret = ft_enable_ep(threads[i].ep, eq, av, threads[i].txcq,
+				   threads[i].rxcq,
+				   opts.dst_addr ? write_cntr : NULL,
+				   opts.dst_addr ? NULL : write_cntr);
+		if (ret)
+			goto out;
+
+		ret = ft_init_av_addr(av, threads[i].ep, &threads[i].addr);
+		if (ret)
+			goto out;
+	}
+
+	/* ft_rx has already reposted rx_buf, so keep the peer from sending
+	 * its keys before the last address has been read from it.
+	 */
+	ret = ft_sync();
+	if (!ret)
+		ret = ft_exchange_keys(&remote);
+out:
+	fi_freeinfo(thread_info);
+	return ret;
+}
+
+static void free_thread_res(void)
+{
+	int i;
+
+	for (i = 0; threads && i < num_threads; i++) {
+		FT_CLOSE_FID(threads[i].ep);
+		FT_CLOSE_FID(threads[i].txcq);
+		FT_CLOSE_FID(threads[i].rxcq);
+	}
+	FT_CLOSE_FID(write_cntr);
+	free(threads);
+}
+
+static int test(void)
+{
+	return num_threads > 1 ? run_threads() : pingpong();
+}
+
 static int run(void)
 {
 	int i, ret = 0;
@@ -44,25 +239,32 @@ static int run(void)
 	if (ret)
 		return ret;
 
+	if (num_threads > 1) {
+		ret = alloc_thread_res();
+		if (ret)
+			goto out;
+	}
+
 	if (!(opts.options & FT_OPT_SIZE)) {
 		for (i = 0; i < TEST_CNT; i++) {
 			if (!ft_use_size(i, opts.sizes_enabled))
 				continue;
 			opts.transfer_size = test_size[i].size;
 			init_test(&opts, test_name, sizeof(test_name));
-			ret = pingpong();
+			ret = test();
 			if (ret)
 				goto out;
 		}
 	} else {
 		init_test(&opts, test_name, sizeof(test_name));
-		ret = pingpong();
+		ret = test();
 		if (ret)
 			goto out;
 	}
 
 	ft_finalize();
 out:
+	free_thread_res();
 	return ret;
 }
 
@@ -78,8 +280,8 @@ int main(int argc, char **argv)
 	if (!hints)
 		return EXIT_FAILURE;
 
-	while ((op = getopt_long(argc, argv, "h" CS_OPTS INFO_OPTS BENCHMARK_OPTS,
-				 long_opts, &lopt_idx)) != -1) {
+	while ((op = getopt_long(argc, argv, "T:h" CS_OPTS INFO_OPTS
+				 BENCHMARK_OPTS, long_opts, &lopt_idx)) != -1) {
 		switch (op) {
 		default:
 			if (!ft_parse_long_opts(op, optarg))
@@ -88,9 +290,16 @@ int main(int argc, char **argv)
 			ft_parseinfo(op, optarg, hints, &opts);
 			ft_parsecsopts(op, optarg, &opts);
 			break;
+		case 'T':
+			num_threads = atoi(optarg);
+			break;
 		case '?':
 		case 'h':
 			ft_csusage(argv[0], "Ping pong client and server using counters.");
+			FT_PRINT_OPTS_USAGE("-T <threads>",
+					    "instead of ping pong, measure RMA "
+					    "writes from this many threads "
+					    "sharing a counter (default: 1)");
 			ft_benchmark_usage();
 			ft_longopts_usage();
 			return EXIT_FAILURE;
@@ -100,10 +309,19 @@ int main(int argc, char **argv)
 	if (optind < argc)
 		opts.dst_addr = argv[optind];
 
+	if (num_threads < 1) {
+		FT_PRINTERR("invalid thread count", -FI_EINVAL);
+		return EXIT_FAILURE;
+	}
+
 	hints->ep_attr->type = FI_EP_RDM;
 	hints->caps = FI_MSG;
 	hints->domain_attr->mr_mode = opts.mr_mode;
 	hints->domain_attr->threading = FI_THREAD_DOMAIN;
+	if (num_threads > 1) {
+		hints->caps |= FI_RMA;
+		hints->domain_attr->threading = FI_THREAD_SAFE;
+	}
 	hints->tx_attr->tclass = FI_TC_LOW_LATENCY;
 	hints->addr_format = opts.address_format;
 
@@ -0,0 +1,676 @@
+/*
+ * Copyright (c) 2026 libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <pthread.h>
+
+#include <rdma/fi_errno.h>
+#include <rdma/fi_tagged.h>
+
+#include <shared.h>
+#include "benchmark_shared.h"
+
+#define RATE_ACK_SIZE	4
+
+/* How the transmit and receive contexts of the threads are provided. */
+enum rate_ctx_mode {
+	RATE_CTX_EP,		/* an endpoint per thread */
+	RATE_CTX_SEP,		/* a context of one scalable endpoint per thread */
+	RATE_CTX_STX,		/* endpoints share a transmit context */
+	RATE_CTX_SRX,		/* endpoints share a receive context */
+	RATE_CTX_SHARED,	/* endpoints share both contexts */
+};
+
+static const char *rate_ctx_names[] = {
+	[RATE_CTX_EP] = "ep",
+	[RATE_CTX_SEP] = "sep",
+	[RATE_CTX_STX] = "stx",
+	[RATE_CTX_SRX] = "srx",
+	[RATE_CTX_SHARED] = "shared",
+};
+
+/* Each thread drives its own transmit and receive context and CQs, paired
+ * with the contexts of the same index in the peer.  The client sends
+ * windows of messages and the server acknowledges each window, as in the
+ * bandwidth tests.
+ */
+struct rate_thread {
+	pthread_t		thread;
+	struct fid_ep		*ep;
+	struct fid_ep		*tx_ctx;
+	struct fid_ep		*rx_ctx;
+	struct fid_ep		*tx;
+	struct fid_ep		*rx;
+	struct fid_cq		*txcq;
+	struct fid_cq		*rxcq;
+	fi_addr_t		addr;
+	uint64_t		tag;
+	char			*buf;
+	char			*ack_buf;
+	struct fi_context	*ctx;
+	struct fi_context	ack_ctx;
+	uint64_t		tx_cnt;
+	uint64_t		rx_cnt;
+	struct ft_bench_hist	hist;
+	int			ret;
+};
+
+static enum rate_ctx_mode ctx_mode = RATE_CTX_EP;
+static int num_threads = 1;
+static int run_threads;
+static struct rate_thread *threads;
+static char *rate_bufs;
+static size_t rate_buf_size;
+static struct fid_mr *rate_mr;
+static void *rate_desc;
+static struct fid_ep *rate_sep;
+static struct fid_stx *rate_stx;
+static struct fid_ep *rate_srx;
+static pthread_barrier_t rate_barrier;
+
+static int rate_post(struct rate_thread *t, int tx, void *buf, size_t len,
+		     void *ctx)
+{
+	int ret;
+
+	do {
+		if (hints->caps & FI_TAGGED)
+			ret = tx ? fi_tsend(t->tx, buf, len, rate_desc, t->addr,
+					    t->tag, ctx) :
+				   fi_trecv(t->rx, buf, len, rate_desc, t->addr,
+					    t->tag, 0, ctx);
+		else
+			ret = tx ? fi_send(t->tx, buf, len, rate_desc, t->addr,
+					   ctx) :
+				   fi_recv(t->rx, buf, len, rate_desc, t->addr,
+					   ctx);
+		if (ret == -FI_EAGAIN) {
+			(void) fi_cq_read(t->txcq, NULL, 0);
+			(void) fi_cq_read(t->rxcq, NULL, 0);
+		}
+	} while (ret == -FI_EAGAIN);
+
+	if (ret)
+		FT_PRINTERR(tx ? "fi_send" : "fi_recv", ret);
+	return ret;
+}
+
+static int rate_window(struct rate_thread *t, int cnt)
+{
+	int ret, i;
+
+	if (opts.dst_addr) {
+		ret = rate_post(t, 0, t->ack_buf, RATE_ACK_SIZE, &t->ack_ctx);
+		if (ret)
+			return ret;
+
+		for (i = 0; i < cnt; i++) {
+			ret = rate_post(t, 1, t->buf, opts.transfer_size,
+					&t->ctx[i]);
+			if (ret)
+				return ret;
+		}
+
+		ret = ft_get_cq_comp(t->txcq, &t->tx_cnt, t->tx_cnt + cnt,
+				     timeout);
+		if (ret)
+			return ret;
+		return ft_get_cq_comp(t->rxcq, &t->rx_cnt, t->rx_cnt + 1,
+				      timeout);
+	}
+
+	for (i = 0; i < cnt; i++) {
+		ret = rate_post(t, 0, t->buf, opts.transfer_size, &t->ctx[i]);
+		if (ret)
+			return ret;
+	}
+
+	ret = ft_get_cq_comp(t->rxcq, &t->rx_cnt, t->rx_cnt + cnt, timeout);
+	if (ret)
+		return ret;
+
+	ret = rate_post(t, 1, t->ack_buf, RATE_ACK_SIZE, &t->ack_ctx);
+	if (ret)
+		return ret;
+	return ft_get_cq_comp(t->txcq, &t->tx_cnt, t->tx_cnt + 1, timeout);
+}
+
+static int rate_windows(struct rate_thread *t, int total, int sample)
+{
+	uint64_t prev;
+	int i, cnt, ret;
+
+	for (i = 0; i < total; i += cnt) {
+		cnt = MIN(opts.window_size, total - i);
+		prev = ft_gettime_ns();
+		ret = rate_window(t, cnt);
+		if (ret)
+			return ret;
+
+		if (sample)
+			ft_bench_hist_add(&t->hist,
+					  (ft_gettime_ns() - prev) / cnt);
+	}
+	return 0;
+}
+
+static void *rate_thread_run(void *arg)
+{
+	struct rate_thread *t = arg;
+
+	memset(&t->hist, 0, sizeof(t->hist));
+	t->ret = rate_windows(t, opts.warmup_iterations, 0);
+
+	/* The main thread times the run from the barrier. */
+	pthread_barrier_wait(&rate_barrier);
+	if (!t->ret)
+		t->ret = rate_windows(t, opts.iterations, 1);
+	return NULL;
+}
+
+static int rate_run_threads(struct ft_bench_stats *stats)
+{
+	int i, ret;
+
+	ret = pthread_barrier_init(&rate_barrier, NULL, run_threads + 1);
+	if (ret)
+		return -ret;
+
+	for (i = 0; i < run_threads; i++) {
+		ret = pthread_create(&threads[i].thread, NULL, rate_thread_run,
+				     &threads[i]);
+		if (ret) {
+			/* threads already started wait on the barrier */
+			FT_PRINTERR("pthread_create", -ret);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	pthread_barrier_wait(&rate_barrier);
+	ft_start();
+	for (i = 0; i < run_threads; i++) {
+		pthread_join(threads[i].thread, NULL);
+		if (threads[i].ret && !ret)
+			ret = threads[i].ret;
+		ft_bench_hist_merge(&stats->hist, &threads[i].hist);
+	}
+	ft_stop();
+
+	pthread_barrier_destroy(&rate_barrier);
+	return ret;
+}
+
+/* Aggregate messages per second, averaged over the repetitions. */
+static double rate_msgs_per_sec(struct ft_bench_stats *stats)
+{
+	double sum = 0;
+	int i;
+
+	for (i = 0; i < stats->reps; i++)
+		sum += 1000000.0 / stats->usec[i];
+	return sum / stats->reps;
+}
+
+/* Scaling efficiency is the aggregate rate relative to run_threads times
+ * the rate of a single thread.
+ */
+static void rate_show(struct ft_bench_stats *stats, double *base_rate)
+{
+	static int header = 1;
+	char str[FT_STR_LEN];
+	double rate;
+
+	rate = rate_msgs_per_sec(stats);
+	if (run_threads == 1)
+		*base_rate = rate;
+
+	if (header) {
+		printf("%-8s%-8s%-8s%-8s%14s%10s%12s\n", "bytes", "threads",
+		       "iters", "ctx", "msgs/sec", "MB/sec", "efficiency");
+		header = 0;
+	}
+
+	printf("%-8s%-8d", size_str(str, opts.transfer_size), run_threads);
+	printf("%-8s%-8s", cnt_str(str, opts.iterations * stats->reps),
+	       rate_ctx_names[ctx_mode]);
+	printf("%14.0f%10.2f%11.1f%%\n", rate,
+	       rate * opts.transfer_size / 1000000,
+	       rate / (*base_rate * run_threads) * 100);
+}
+
+static int rate_test(double *base_rate)
+{
+	struct ft_bench_stats stats;
+	int ret, rep;
+
+	ret = ft_bench_stats_init(&stats);
+	if (ret)
+		return ret;
+
+	for (rep = 0; rep < ft_bench_reps(); rep++) {
+		ret = ft_sync();
+		if (ret)
+			goto out;
+
+		ret = rate_run_threads(&stats);
+		if (ret)
+			goto out;
+		ft_bench_rep_done(&stats, run_threads);
+	}
+
+	if (ft_bench_sampling() || opts.machr)
+		ft_bench_show(&stats, run_threads, run_threads);
+	else
+		rate_show(&stats, base_rate);
+out:
+	ft_bench_stats_free(&stats);
+	return ret;
+}
+
+/* Run with 1, 2, 4, ... threads, up to and including num_threads, to give
+ * the scaling curve of the current message size.
+ */
+static int rate_scale(void)
+{
+	double base_rate = 0;
+	int ret;
+
+	for (run_threads = 1; ; run_threads = MIN(run_threads * 2,
+						  num_threads)) {
+		ret = rate_test(&base_rate);
+		if (ret || run_threads == num_threads)
+			return ret;
+	}
+}
+
+static void free_rate_res(void)
+{
+	int i;
+
+	for (i = 0; threads && i < num_threads; i++) {
+		FT_CLOSE_FID(threads[i].tx_ctx);
+		FT_CLOSE_FID(threads[i].rx_ctx);
+		FT_CLOSE_FID(threads[i].ep);
+	}
+	FT_CLOSE_FID(rate_sep);
+	FT_CLOSE_FID(rate_stx);
+	FT_CLOSE_FID(rate_srx);
+	for (i = 0; threads && i < num_threads; i++) {
+		FT_CLOSE_FID(threads[i].txcq);
+		FT_CLOSE_FID(threads[i].rxcq);
+		free(threads[i].ctx);
+	}
+	FT_CLOSE_FID(rate_mr);
+	free(threads);
+	free(rate_bufs);
+}
+
+static int alloc_rate_res(void)
+{
+	size_t size;
+	int i, ret;
+
+	size = (opts.options & FT_OPT_SIZE) ?
+	       opts.transfer_size : FT_BENCHMARK_MAX_MSG_SIZE;
+	rate_buf_size = size + RATE_ACK_SIZE;
+
+	threads = calloc(num_threads, sizeof(*threads));
+	rate_bufs = calloc(num_threads, rate_buf_size);
+	if (!threads || !rate_bufs)
+		return -FI_ENOMEM;
+
+	ret = ft_reg_mr(fi, rate_bufs, num_threads * rate_buf_size,
+			ft_info_to_mr_access(fi), FT_MR_KEY + 1, &rate_mr,
+			&rate_desc);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < num_threads; i++) {
+		threads[i].buf = rate_bufs + i * rate_buf_size;
+		threads[i].ack_buf = threads[i].buf + size;
+		threads[i].tag = i + 1;
+		threads[i].ctx = calloc(opts.window_size,
+					sizeof(*threads[i].ctx));
+		if (!threads[i].ctx)
+			return -FI_ENOMEM;
+	}
+	return 0;
+}
+
+static int setup_rate_ep(struct rate_thread *t)
+{
+	int ret;
+
+	fi_freeinfo(hints);
+	hints = fi_dupinfo(fi);
+	fi_freeinfo(fi);
+
+	hints->src_addr = NULL;
+	hints->src_addrlen = 0;
+	if (rate_stx)
+		hints->ep_attr->tx_ctx_cnt = FI_SHARED_CONTEXT;
+	if (rate_srx)
+		hints->ep_attr->rx_ctx_cnt = FI_SHARED_CONTEXT;
+
+	ret = fi_getinfo(FT_FIVERSION, opts.src_addr, NULL, 0, hints, &fi);
+	if (ret) {
+		FT_PRINTERR("fi_getinfo", ret);
+		return ret;
+	}
+
+	ret = fi_endpoint(domain, fi, &t->ep, NULL);
+	if (ret) {
+		FT_PRINTERR("fi_endpoint", ret);
+		return ret;
+	}
+
+	ret = ft_alloc_ep_res(fi, &t->txcq, &t->rxcq, NULL, NULL);
+	if (ret)
+		return ret;
+
+	FT_EP_BIND(t->ep, rate_stx, 0);
+	FT_EP_BIND(t->ep, rate_srx, 0);
+	ret = ft_enable_ep(t->ep, eq, av, t->txcq, t->rxcq, NULL, NULL);
+	if (ret)
+		return ret;
+
+	t->tx = t->ep;
+	t->rx = rate_srx ? rate_srx : t->ep;
+	return ft_init_av_addr(av, t->ep, &t->addr);
+}
+
+static int setup_shared_ctx(void)
+{
+	int ret;
+
+	if ((ctx_mode == RATE_CTX_STX || ctx_mode == RATE_CTX_SHARED) &&
+	    !fi->domain_attr->max_ep_stx_ctx)
+		return -FI_ENODATA;
+	if ((ctx_mode == RATE_CTX_SRX || ctx_mode == RATE_CTX_SHARED) &&
+	    !fi->domain_attr->max_ep_srx_ctx)
+		return -FI_ENODATA;
+
+	if (ctx_mode != RATE_CTX_SRX) {
+		ret = fi_stx_context(domain, fi->tx_attr, &rate_stx, NULL);
+		if (ret) {
+			FT_PRINTERR("fi_stx_context", ret);
+			return ret;
+		}
+	}
+
+	if (ctx_mode != RATE_CTX_STX) {
+		ret = fi_srx_context(domain, fi->rx_attr, &rate_srx, NULL);
+		if (ret) {
+			FT_PRINTERR("fi_srx_context", ret);
+			return ret;
+		}
+	}
+	return 0;
+}
+
+static int setup_rate_sep(void)
+{
+	struct fi_info *info;
+	fi_addr_t addr;
+	int i, ret;
+
+	if (fi->domain_attr->max_ep_tx_ctx < num_threads ||
+	    fi->domain_attr->max_ep_rx_ctx < num_threads)
+		return -FI_ENODATA;
+
+	info = fi_dupinfo(fi);
+	if (!info)
+		return -FI_ENOMEM;
+	free(info->src_addr);
+	info->src_addr = NULL;
+	info->src_addrlen = 0;
+	info->ep_attr->tx_ctx_cnt = num_threads;
+	info->ep_attr->rx_ctx_cnt = num_threads;
+
+	ret = fi_scalable_ep(domain, info, &rate_sep, NULL);
+	if (ret) {
+		FT_PRINTERR("fi_scalable_ep", ret);
+		goto out;
+	}
+
+	ret = fi_scalable_ep_bind(rate_sep, &av->fid, 0);
+	if (ret) {
+		FT_PRINTERR("fi_scalable_ep_bind", ret);
+		goto out;
+	}
+
+	for (i = 0; i < num_threads; i++) {
+		ret = ft_alloc_ep_res(info, &threads[i].txcq, &threads[i].rxcq,
+				      NULL, NULL);
+		if (ret)
+			goto out;
+
+		ret = fi_tx_context(rate_sep, i, NULL, &threads[i].tx_ctx, NULL);
+		if (ret) {
+			FT_PRINTERR("fi_tx_context", ret);
+			goto out;
+		}
+
+		ret = fi_rx_context(rate_sep, i, NULL, &threads[i].rx_ctx, NULL);
+		if (ret) {
+			FT_PRINTERR("fi_rx_context", ret);
+			goto out;
+		}
+
+		ret = ft_enable_ep(threads[i].tx_ctx, NULL, NULL,
+				   threads[i].txcq, NULL, NULL, NULL);
+		if (ret)
+			goto out;
+
+		ret = ft_enable_ep(threads[i].rx_ctx, NULL, NULL, NULL,
+				   threads[i].rxcq, NULL, NULL);
+		if (ret)
+			goto out;
+
+		threads[i].tx = threads[i].tx_ctx;
+		threads[i].rx = threads[i].rx_ctx;
+	}
+
+	ret = fi_enable(rate_sep);
+	if (ret) {
+		FT_PRINTERR("fi_enable", ret);
+		goto out;
+	}
+
+	ret = ft_init_av_addr(av, rate_sep, &addr);
+	if (ret)
+		goto out;
+
+	for (i = 0; i < num_threads; i++)
+		threads[i].addr = fi_rx_addr(addr, i, av_attr.rx_ctx_bits);
+out:
+	fi_freeinfo(info);
+	return ret;
+}
+
+static int run(void)
+{
+	int i, ret;
+
+	opts.av_size = num_threads + 1;
+	if (ctx_mode == RATE_CTX_SEP)
+		while (num_threads >> ++av_attr.rx_ctx_bits);
+
+	ret = ft_init_fabric();
+	if (ret)
+		return ret;
+
+	ret = alloc_rate_res();
+	if (ret)
+		goto out;
+
+	if (ctx_mode == RATE_CTX_SEP) {
+		ret = setup_rate_sep();
+		if (ret)
+			goto out;
+	} else {
+		if (ctx_mode != RATE_CTX_EP) {
+			ret = setup_shared_ctx();
+			if (ret)
+				goto out;
+		}
+
+		for (i = 0; i < num_threads; i++) {
+			ret = setup_rate_ep(&threads[i]);
+			if (ret)
+				goto out;
+		}
+	}
+
+	if (!(opts.options & FT_OPT_SIZE)) {
+		for (i = 0; i < TEST_CNT; i++) {
+			if (!ft_use_size(i, opts.sizes_enabled))
+				continue;
+			opts.transfer_size = test_size[i].size;
+			if (!(opts.options & FT_OPT_ITER))
+				opts.iterations = size_to_count(opts.transfer_size);
+			ret = rate_scale();
+			if (ret)
+				goto out;
+		}
+	} else {
+		ret = rate_scale();
+		if (ret)
+			goto out;
+	}
+
+	ret = ft_finalize();
+out:
+	free_rate_res();
+	return ret;
+}
+
+static int parse_ctx_mode(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(rate_ctx_names); i++) {
+		if (!strcasecmp(name, rate_ctx_names[i])) {
+			ctx_mode = i;
+			return 0;
+		}
+	}
+	return -FI_EINVAL;
+}
+
+int main(int argc, char **argv)
+{
+	int op, ret;
+
+	opts = INIT_OPTS;
+	opts.options |= FT_OPT_BW;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return EXIT_FAILURE;
+
+	while ((op = getopt_long(argc, argv, "T:x:gh" CS_OPTS INFO_OPTS
+				 BENCHMARK_OPTS, long_opts, &lopt_idx)) != -1) {
+		switch (op) {
+		default:
+			if (!ft_parse_long_opts(op, optarg))
+				continue;
+			ft_parse_benchmark_opts(op, optarg);
+			ft_parseinfo(op, optarg, hints, &opts);
+			ft_parsecsopts(op, optarg, &opts);
+			break;
+		case 'T':
+			num_threads = atoi(optarg);
+			break;
+		case 'x':
+			if (parse_ctx_mode(optarg)) {
+				FT_PRINTERR("invalid context mode",
+					    -FI_EINVAL);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'g':
+			hints->caps = FI_TAGGED;
+			break;
+		case '?':
+		case 'h':
+			ft_csusage(argv[0], "Message rate of several threads, "
+				   "each using its own transmit and receive "
+				   "context.");
+			FT_PRINT_OPTS_USAGE("-T <threads>",
+					    "maximum number of threads; runs "
+					    "with 1, 2, 4, ... threads up to "
+					    "this count (default: 1)");
+			FT_PRINT_OPTS_USAGE("-x <mode>",
+					    "thread contexts: ep (an endpoint "
+					    "per thread), sep (contexts of a "
+					    "scalable endpoint), stx, srx or "
+					    "shared (endpoints sharing transmit, "
+					    "receive or both contexts) "
+					    "(default: ep)");
+			FT_PRINT_OPTS_USAGE("-g", "use tagged messages");
+			ft_benchmark_usage();
+			ft_longopts_usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind < argc)
+		opts.dst_addr = argv[optind];
+
+	if (num_threads < 1) {
+		FT_PRINTERR("invalid thread count", -FI_EINVAL);
+		return EXIT_FAILURE;
+	}
+
+	hints->ep_attr->type = FI_EP_RDM;
+	hints->domain_attr->resource_mgmt = FI_RM_ENABLED;
+	if (!(hints->caps & FI_TAGGED))
+		hints->caps = FI_MSG;
+	/* Receives posted to a shared receive context must only match the
+	 * peer of the posting thread, which keeps each thread's receive
+	 * contexts (struct fi_context) private to that thread.
+	 */
+	if (ctx_mode == RATE_CTX_SRX || ctx_mode == RATE_CTX_SHARED)
+		hints->caps |= FI_DIRECTED_RECV;
+	hints->mode |= FI_CONTEXT;
+	hints->domain_attr->mr_mode = opts.mr_mode;
+	hints->domain_attr->threading = FI_THREAD_SAFE;
+	hints->addr_format = opts.address_format;
+
+	ret = run();
+
+	ft_free_res();
+	return ft_exit_code(ret);
+}
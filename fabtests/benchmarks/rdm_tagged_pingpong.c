@@ -32,10 +32,181 @@
 #include <getopt.h>
 
 #include <rdma/fi_errno.h>
+#include <rdma/fi_ext.h>
 
 #include <shared.h>
 #include "benchmark_shared.h"
 
+/* Outside the range of the sequence numbers used as tags by ft_tx/ft_rx */
+#define PERSIST_TAG (1ULL << 48)
+
+static int persist;
+static struct fi_ops_persist *persist_ops;
+static struct fi_persist_req *tx_req, *rx_req;
+static struct fi_context2 persist_tx_ctx, persist_rx_ctx;
+
+static int persist_start(struct fi_persist_req *req)
+{
+	ssize_t ret;
+
+	do {
+		ret = persist_ops->start(req);
+		if (ret == -FI_EAGAIN) {
+			fi_cq_read(txcq, NULL, 0);
+			fi_cq_read(rxcq, NULL, 0);
+		}
+	} while (ret == -FI_EAGAIN);
+
+	if (ret)
+		FT_PRINTERR("start", ret);
+	return (int) ret;
+}
+
+/* Completions are read with the method selected by -c.  ft_tag is set to
+ * PERSIST_TAG while requests run, which is the tag receives check against.
+ */
+static int persist_wait(struct fid_cq *cq)
+{
+	uint64_t cur = 0;
+
+	return ft_get_cq_comp(cq, &cur, 1, cq == rxcq ? timeout : -1);
+}
+
+static int persist_send(void)
+{
+	int ret;
+
+	if (ft_check_opts(FT_OPT_VERIFY_DATA | FT_OPT_ACTIVE)) {
+		ret = ft_fill_buf(tx_buf, opts.transfer_size);
+		if (ret)
+			return ret;
+	}
+
+	ret = persist_start(tx_req);
+	if (ret)
+		return ret;
+	return persist_wait(txcq);
+}
+
+static int persist_recv(int last)
+{
+	int ret;
+
+	ret = persist_wait(rxcq);
+	if (ret)
+		return ret;
+
+	if (ft_check_opts(FT_OPT_VERIFY_DATA | FT_OPT_ACTIVE)) {
+		ret = ft_check_buf(rx_buf, opts.transfer_size);
+		if (ret)
+			return ret;
+	}
+	return last ? 0 : persist_start(rx_req);
+}
+
+static int persist_iter(int last)
+{
+	int ret;
+
+	if (opts.dst_addr) {
+		ret = persist_send();
+		return ret ? ret : persist_recv(last);
+	}
+
+	ret = persist_recv(last);
+	return ret ? ret : persist_send();
+}
+
+/* Like pingpong_rep, but each message is a start of a request created once
+ * per message size.  Receives are started again before the peer can send,
+ * except after the last message, so that none is left posted.
+ */
+static int persist_rep(struct ft_bench_stats *stats)
+{
+	uint64_t prev = 0, now, tag;
+	int ret, i, cnt, sampling;
+
+	ret = persist_start(rx_req);
+	if (ret)
+		return ret;
+
+	ret = ft_sync();
+	if (ret)
+		return ret;
+
+	sampling = ft_bench_sampling();
+	if (sampling)
+		prev = ft_gettime_ns();
+
+	tag = ft_tag;
+	ft_tag = PERSIST_TAG;
+	cnt = opts.iterations + opts.warmup_iterations;
+	for (i = 0; i < cnt; i++) {
+		if (i == opts.warmup_iterations)
+			ft_start();
+
+		ret = persist_iter(i + 1 == cnt);
+		if (ret)
+			break;
+
+		if (sampling) {
+			now = ft_gettime_ns();
+			ft_bench_sample(stats, i, now - prev, 2);
+			prev = now;
+		}
+	}
+	ft_stop();
+	ft_tag = tag;
+
+	return ret;
+}
+
+static int persist_pingpong(void)
+{
+	struct ft_bench_stats stats;
+	int ret, rep;
+
+	ret = persist_ops->tsend_init(ep, tx_buf, opts.transfer_size, mr_desc,
+				      remote_fi_addr, PERSIST_TAG,
+				      &persist_tx_ctx, &tx_req);
+	if (ret) {
+		FT_PRINTERR("tsend_init", ret);
+		return ret;
+	}
+
+	ret = persist_ops->trecv_init(ep, rx_buf, opts.transfer_size, mr_desc,
+				      remote_fi_addr, PERSIST_TAG, 0,
+				      &persist_rx_ctx, &rx_req);
+	if (ret) {
+		FT_PRINTERR("trecv_init", ret);
+		goto free_tx;
+	}
+
+	ret = ft_bench_stats_init(&stats);
+	if (ret)
+		goto free_rx;
+
+	for (rep = 0; rep < ft_bench_reps(); rep++) {
+		ret = persist_rep(&stats);
+		if (ret)
+			goto out;
+		ft_bench_rep_done(&stats, 2);
+	}
+	ft_bench_show(&stats, 2, 1);
+out:
+	ft_bench_stats_free(&stats);
+free_rx:
+	persist_ops->free(rx_req);
+free_tx:
+	persist_ops->free(tx_req);
+	return ret;
+}
+
+static int test(void)
+{
+	return persist ? persist_pingpong() : pingpong();
+}
+
 static int run(void)
 {
 	int i, ret = 0;
@@ -44,19 +215,28 @@ static int run(void)
 	if (ret)
 		return ret;
 
+	if (persist) {
+		ret = fi_open_ops(&ep->fid, FI_PERSIST_OPS, 0,
+				  (void **) &persist_ops, NULL);
+		if (ret) {
+			FT_PRINTERR("fi_open_ops", ret);
+			return ret;
+		}
+	}
+
 	if (!(opts.options & FT_OPT_SIZE)) {
 		for (i = 0; i < TEST_CNT; i++) {
 			if (!ft_use_size(i, opts.sizes_enabled))
 				continue;
 			opts.transfer_size = test_size[i].size;
 			init_test(&opts, test_name, sizeof(test_name));
-			ret = pingpong();
+			ret = test();
 			if (ret)
 				goto out;
 		}
 	} else {
 		init_test(&opts, test_name, sizeof(test_name));
-		ret = pingpong();
+		ret = test();
 		if (ret)
 			goto out;
 	}
@@ -76,7 +256,7 @@ int main(int argc, char **argv)
 	if (!hints)
 		return EXIT_FAILURE;
 
-	while ((op = getopt_long(argc, argv, "Uh" CS_OPTS INFO_OPTS BENCHMARK_OPTS,
+	while ((op = getopt_long(argc, argv, "URh" CS_OPTS INFO_OPTS BENCHMARK_OPTS,
 				 long_opts, &lopt_idx)) != -1) {
 		switch (op) {
 		default:
@@ -89,10 +269,15 @@ int main(int argc, char **argv)
 		case 'U':
 			hints->tx_attr->op_flags |= FI_DELIVERY_COMPLETE;
 			break;
+		case 'R':
+			persist = 1;
+			break;
 		case '?':
 		case 'h':
 			ft_csusage(argv[0], "Ping pong client and server using tagged messages.");
 			ft_benchmark_usage();
+			FT_PRINT_OPTS_USAGE("-R", "start persistent requests "
+					    "instead of calling fi_tsend/fi_trecv");
 			ft_longopts_usage();
 			return EXIT_FAILURE;
 		}
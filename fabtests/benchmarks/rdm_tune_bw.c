@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2026 libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include <rdma/fi_errno.h>
+#include <rdma/fi_ext.h>
+
+#include <shared.h>
+#include "benchmark_shared.h"
+
+/* Sizes around the default rxm eager, SAR and rendezvous limits */
+#define TUNE_MIN_SIZE	(1 << 12)
+#define TUNE_MAX_SIZE	(1 << 20)
+
+static int rounds = 4;
+
+static void print_limits(int round)
+{
+	struct fi_rxm_proto_limits limits;
+	size_t len = sizeof(limits);
+	int ret;
+
+	ret = fi_getopt(&ep->fid, FI_OPT_ENDPOINT, FI_OPT_RXM_PROTO_LIMITS,
+			&limits, &len);
+	if (ret) {
+		printf("round %d: protocol limits not reported (%s)\n",
+		       round, fi_strerror(-ret));
+		return;
+	}
+
+	printf("round %d: eager_limit %zu, sar_limit %zu, adjustments %" PRIu64
+	       "\n", round, limits.eager_limit, limits.sar_limit,
+	       limits.adjustments);
+}
+
+static int run(void)
+{
+	int i, round, ret;
+
+	ret = ft_init_fabric();
+	if (ret)
+		return ret;
+
+	for (round = 0; round < rounds; round++) {
+		if (opts.dst_addr)
+			print_limits(round);
+
+		for (i = 0; i < TEST_CNT; i++) {
+			if (test_size[i].size < TUNE_MIN_SIZE ||
+			    test_size[i].size > TUNE_MAX_SIZE)
+				continue;
+			opts.transfer_size = test_size[i].size;
+			init_test(&opts, test_name, sizeof(test_name));
+			ret = bandwidth();
+			if (ret)
+				return ret;
+		}
+	}
+
+	if (opts.dst_addr)
+		print_limits(round);
+
+	return ft_finalize();
+}
+
+int main(int argc, char **argv)
+{
+	int op, ret;
+
+	opts = INIT_OPTS;
+	opts.options |= FT_OPT_BW;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return EXIT_FAILURE;
+
+	while ((op = getopt_long(argc, argv, "R:h" CS_OPTS INFO_OPTS BENCHMARK_OPTS,
+				 long_opts, &lopt_idx)) != -1) {
+		switch (op) {
+		default:
+			if (!ft_parse_long_opts(op, optarg))
+				continue;
+			ft_parse_benchmark_opts(op, optarg);
+			ft_parseinfo(op, optarg, hints, &opts);
+			ft_parsecsopts(op, optarg, &opts);
+			break;
+		case 'R':
+			rounds = atoi(optarg);
+			break;
+		case '?':
+		case 'h':
+			ft_csusage(argv[0], "Bandwidth around the rxm protocol "
+				   "limits, repeated while they are tuned.");
+			FT_PRINT_OPTS_USAGE("-R <rounds>",
+					    "number of size sweeps (default: 4)");
+			ft_benchmark_usage();
+			ft_longopts_usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind < argc)
+		opts.dst_addr = argv[optind];
+
+	hints->ep_attr->type = FI_EP_RDM;
+	hints->domain_attr->resource_mgmt = FI_RM_ENABLED;
+	hints->caps = FI_TAGGED;
+	hints->mode |= FI_CONTEXT;
+	hints->domain_attr->mr_mode = opts.mr_mode;
+	hints->domain_attr->threading = FI_THREAD_DOMAIN;
+	hints->tx_attr->tclass = FI_TC_BULK_DATA;
+	hints->addr_format = opts.address_format;
+
+	ret = run();
+
+	ft_free_res();
+	return ft_exit_code(ret);
+}
@@ -3740,6 +3740,9 @@ struct option long_opts[] = {
 	{"pin-core", required_argument, NULL, LONG_OPT_PIN_CORE},
 	{"timeout", required_argument, NULL, LONG_OPT_TIMEOUT},
 	{"debug-assert", no_argument, &debug_assert, LONG_OPT_DEBUG_ASSERT},
+	/* benchmark options, see ft_parse_benchmark_opts() */
+	{"repeat", required_argument, NULL, LONG_OPT_REPEAT},
+	{"output", required_argument, NULL, LONG_OPT_OUTPUT},
 	{NULL, 0, NULL, 0},
 };
 
@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) 2026 libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include <rdma/fabric.h>
+#include <rdma/fi_errno.h>
+#include <rdma/fi_endpoint.h>
+#include <rdma/fi_cm.h>
+#include <rdma/fi_ext.h>
+
+#include "shared.h"
+
+/* Every endpoint on each side sends to every endpoint on the other side,
+ * in a rotating order, so that a connection limit below the number of
+ * endpoints forces connections to be evicted and reopened all the time.
+ */
+static struct fid_ep **eps;
+static struct fid_cq **txcqs, **rxcqs;
+static fi_addr_t *remote_addr;
+static char *data_bufs;
+static struct fi_context *send_ctx;
+static struct fi_context *recv_ctx;
+static struct fid_mr *data_mr;
+static void *data_desc;
+static int num_eps = 8;
+static char *max_conns;
+
+static char *send_buf(int idx)
+{
+	return data_bufs + opts.transfer_size * idx;
+}
+
+static char *recv_buf(int idx, int peer)
+{
+	return data_bufs + opts.transfer_size *
+	       (num_eps + idx * num_eps + peer);
+}
+
+static void free_ep_res(void)
+{
+	int i;
+
+	FT_CLOSE_FID(data_mr);
+	for (i = 0; i < num_eps; i++) {
+		FT_CLOSE_FID(eps[i]);
+		FT_CLOSE_FID(txcqs[i]);
+		FT_CLOSE_FID(rxcqs[i]);
+	}
+
+	free(txcqs);
+	free(rxcqs);
+	free(data_bufs);
+	free(send_ctx);
+	free(recv_ctx);
+	free(remote_addr);
+	free(eps);
+}
+
+static int alloc_ep_res(void)
+{
+	size_t size;
+	int ret;
+
+	eps = calloc(num_eps, sizeof(*eps));
+	txcqs = calloc(num_eps, sizeof(*txcqs));
+	rxcqs = calloc(num_eps, sizeof(*rxcqs));
+	remote_addr = calloc(num_eps, sizeof(*remote_addr));
+	send_ctx = calloc(num_eps * num_eps, sizeof(*send_ctx));
+	recv_ctx = calloc(num_eps * num_eps, sizeof(*recv_ctx));
+	size = opts.transfer_size * (num_eps + num_eps * num_eps);
+	data_bufs = calloc(1, size);
+	if (!eps || !txcqs || !rxcqs || !remote_addr || !send_ctx ||
+	    !recv_ctx || !data_bufs)
+		return -FI_ENOMEM;
+
+	ret = ft_reg_mr(fi, data_bufs, size, ft_info_to_mr_access(fi),
+			FT_MR_KEY + 1, &data_mr, &data_desc);
+	if (ret)
+		return ret;
+
+	return 0;
+}
+
+/* The additional endpoints bind to ephemeral ports. */
+static int get_ep_info(void)
+{
+	int ret;
+
+	fi_freeinfo(hints);
+	hints = fi_dupinfo(fi);
+	if (!hints)
+		return -FI_ENOMEM;
+
+	fi_freeinfo(fi);
+	free(hints->src_addr);
+	hints->src_addr = NULL;
+	hints->src_addrlen = 0;
+
+	ret = fi_getinfo(FT_FIVERSION, opts.src_addr, NULL, 0, hints, &fi);
+	if (ret)
+		FT_PRINTERR("fi_getinfo", ret);
+	return ret;
+}
+
+static int setup_ep(int idx)
+{
+	int ret;
+
+	ret = fi_endpoint(domain, fi, &eps[idx], NULL);
+	if (ret) {
+		FT_PRINTERR("fi_endpoint", ret);
+		return ret;
+	}
+
+	ret = ft_alloc_ep_res(fi, &txcqs[idx], &rxcqs[idx], NULL, NULL);
+	if (ret)
+		return ret;
+
+	ret = ft_enable_ep(eps[idx], eq, av, txcqs[idx], rxcqs[idx],
+			   NULL, NULL);
+	if (ret)
+		return ret;
+
+	return ft_init_av_addr(av, eps[idx], &remote_addr[idx]);
+}
+
+static int poll_cq(struct fid_cq *cq, uint64_t *cnt)
+{
+	struct fi_cq_entry comp;
+	ssize_t ret;
+
+	ret = fi_cq_read(cq, &comp, 1);
+	if (ret > 0) {
+		(*cnt)++;
+		return 0;
+	}
+
+	if (ret == -FI_EAGAIN)
+		return 0;
+
+	if (ret == -FI_EAVAIL)
+		return ft_cq_readerr(cq);
+
+	FT_PRINTERR("fi_cq_read", ret);
+	return (int) ret;
+}
+
+/* Data transfers to some peers may only progress while another
+ * endpoint's CQ is read, so always drive all of them.
+ */
+static int poll_all(uint64_t *tx_cnt, uint64_t *rx_cnt)
+{
+	int i, ret;
+
+	for (i = 0; i < num_eps; i++) {
+		ret = poll_cq(txcqs[i], tx_cnt);
+		if (ret)
+			return ret;
+
+		ret = poll_cq(rxcqs[i], rx_cnt);
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+static int run_iteration(int iter)
+{
+	uint64_t tx_cnt = 0, rx_cnt = 0, total;
+	int i, j, peer, ret;
+
+	total = (uint64_t) num_eps * num_eps;
+	for (i = 0; i < num_eps; i++) {
+		for (j = 0; j < num_eps; j++) {
+			while ((ret = fi_recv(eps[i], recv_buf(i, j),
+					      opts.transfer_size, data_desc,
+					      FI_ADDR_UNSPEC,
+					      &recv_ctx[i * num_eps + j])) ==
+			       -FI_EAGAIN) {
+				ret = poll_all(&tx_cnt, &rx_cnt);
+				if (ret)
+					return ret;
+			}
+			if (ret) {
+				FT_PRINTERR("fi_recv", ret);
+				return ret;
+			}
+		}
+	}
+
+	for (j = 0; j < num_eps; j++) {
+		for (i = 0; i < num_eps; i++) {
+			peer = (i + j + iter) % num_eps;
+			while ((ret = fi_send(eps[i], send_buf(i),
+					      opts.transfer_size, data_desc,
+					      remote_addr[peer],
+					      &send_ctx[i * num_eps + j])) ==
+			       -FI_EAGAIN) {
+				ret = poll_all(&tx_cnt, &rx_cnt);
+				if (ret)
+					return ret;
+			}
+			if (ret) {
+				FT_PRINTERR("fi_send", ret);
+				return ret;
+			}
+		}
+	}
+
+	while (tx_cnt < total || rx_cnt < total) {
+		ret = poll_all(&tx_cnt, &rx_cnt);
+		if (ret)
+			return ret;
+	}
+
+	if (ft_check_opts(FT_OPT_VERIFY_DATA)) {
+		for (i = 0; i < num_eps; i++) {
+			for (j = 0; j < num_eps; j++) {
+				ret = ft_check_buf(recv_buf(i, j),
+						   opts.transfer_size);
+				if (ret)
+					return ret;
+			}
+		}
+	}
+	return 0;
+}
+
+static void show_stats(void)
+{
+	struct fi_tcp_conn_stats stats, total = {0};
+	size_t len;
+	int i, ret;
+
+	for (i = 0; i < num_eps; i++) {
+		len = sizeof(stats);
+		ret = fi_getopt(&eps[i]->fid, FI_OPT_ENDPOINT,
+				FI_OPT_TCP_CONN_STATS, &stats, &len);
+		if (ret) {
+			printf("Connection cache stats not available: %s\n",
+			       fi_strerror(-ret));
+			return;
+		}
+		total.open += stats.open;
+		total.evictions += stats.evictions;
+		total.reconnects += stats.reconnects;
+	}
+
+	printf("Open connections: %zu, evictions: %" PRIu64
+	       ", reconnects: %" PRIu64 "\n",
+	       total.open, total.evictions, total.reconnects);
+}
+
+static int run_test(void)
+{
+	int i, ret;
+
+	opts.av_size = num_eps + 1;
+	ret = ft_init_fabric();
+	if (ret)
+		return ret;
+
+	ret = alloc_ep_res();
+	if (ret)
+		goto out;
+
+	ret = get_ep_info();
+	if (ret)
+		goto out;
+
+	printf("Creating %d EPs\n", num_eps);
+	for (i = 0; i < num_eps; i++) {
+		ret = setup_ep(i);
+		if (ret)
+			goto out;
+	}
+
+	if (ft_check_opts(FT_OPT_VERIFY_DATA)) {
+		for (i = 0; i < num_eps; i++)
+			ft_fill_buf(send_buf(i), opts.transfer_size);
+	}
+
+	printf("Sending from all %d EPs to all remote EPs, %d iterations\n",
+	       num_eps, opts.iterations);
+	for (i = 0; i < opts.iterations; i++) {
+		ret = run_iteration(i);
+		if (ret)
+			goto out;
+	}
+	show_stats();
+
+	ret = ft_finalize_ep(ep);
+	if (ret)
+		goto out;
+
+	printf("PASSED conn cache\n");
+out:
+	free_ep_res();
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	int op, ret;
+
+	opts = INIT_OPTS;
+	opts.transfer_size = 256;
+	opts.iterations = 20;
+	opts.options |= FT_OPT_OOB_ADDR_EXCH;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return EXIT_FAILURE;
+
+	while ((op = getopt(argc, argv, "c:n:I:S:vh" ADDR_OPTS INFO_OPTS)) != -1) {
+		switch (op) {
+		default:
+			ft_parse_addr_opts(op, optarg, &opts);
+			ft_parseinfo(op, optarg, hints, &opts);
+			break;
+		case 'c':
+			num_eps = atoi(optarg);
+			break;
+		case 'n':
+			max_conns = optarg;
+			break;
+		case 'I':
+			opts.iterations = atoi(optarg);
+			break;
+		case 'S':
+			opts.transfer_size = strtoul(optarg, NULL, 0);
+			break;
+		case 'v':
+			opts.options |= FT_OPT_VERIFY_DATA;
+			break;
+		case '?':
+		case 'h':
+			ft_usage(argv[0], "RDM connection cache stress test");
+			FT_PRINT_OPTS_USAGE("-c <int>",
+				"number of endpoints per side (def 8)");
+			FT_PRINT_OPTS_USAGE("-n <int>",
+				"limit the number of open connections per "
+				"endpoint, unless set in the environment");
+			FT_PRINT_OPTS_USAGE("-I <int>",
+				"number of iterations (def 20)");
+			FT_PRINT_OPTS_USAGE("-S <int>",
+				"message size (def 256)");
+			FT_PRINT_OPTS_USAGE("-v", "Enable data verification");
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind < argc)
+		opts.dst_addr = argv[optind];
+
+	/* Provider parameters are read when the provider is loaded. */
+	if (max_conns) {
+		setenv("FI_OFI_RXM_MAX_CONNS", max_conns, 0);
+		setenv("FI_NET_MAX_CONNS", max_conns, 0);
+	}
+
+	hints->ep_attr->type = FI_EP_RDM;
+	hints->caps = FI_MSG;
+	hints->mode = FI_CONTEXT;
+	hints->domain_attr->mr_mode = opts.mr_mode;
+
+	ret = run_test();
+
+	ft_free_res();
+	return ft_exit_code(ret);
+}
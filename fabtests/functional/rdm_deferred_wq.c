@@ -94,8 +94,8 @@ static void format_simple_msg_rma(struct fi_msg_rma *msg, struct iovec *iov,
 	iov->iov_len = size;
 	msg->msg_iov = iov;
 
-	rma_iov->addr = 0;
-	rma_iov->key = FT_MR_KEY;
+	rma_iov->addr = remote.addr;
+	rma_iov->key = remote.key;
 	rma_iov->len = size;
 	msg->rma_iov = rma_iov;
 }
@@ -119,9 +119,9 @@ static void format_simple_msg_atomic(struct fi_msg_atomic *msg, struct fi_ioc *i
 	iov->count = size;
 	msg->msg_iov = iov;
 
-	rma_iov->addr = 0;
+	rma_iov->addr = remote.addr;
 	rma_iov->count = size;
-	rma_iov->key = FT_MR_KEY;
+	rma_iov->key = remote.key;
 	msg->rma_iov = rma_iov;
 }
 
@@ -198,7 +198,7 @@ static int send_wait_check()
 
 	if (opts.dst_addr) {
 		ret = fi_write(ep, tx_buf, strlen(welcome_text), mr_desc,
-				remote_fi_addr, 0, FT_MR_KEY, &tx_ctx);
+				remote_fi_addr, remote.addr, remote.key, &tx_ctx);
  		if (ret) {
  			FT_PRINTERR("fi_write", ret);
  			return ret;
@@ -412,18 +412,21 @@ static int trigger()
 {
 	int ret;
 
-	//both sides start with both counters at 2, client will initiate triggering write
-	//which will trigger txcntr on client and rxcntr on server
+	//client will initiate triggering write which will trigger txcntr on
+	//client and rxcntr on server
 	//rx_exp = number of rx completions we should expect on that side
 	//n_trig = total number of triggers on work queue to expect completed
+	//all prior transfers have completed, so the counters match the
+	//sequence numbers
+	rx_exp = rx_seq;
 	if (opts.dst_addr) {
 		work.triggering_cntr = txcntr;
-		rx_exp = 2;
+		work.threshold = tx_seq + 1;
 	} else {
 		work.triggering_cntr = rxcntr;
-		rx_exp = 3;
+		work.threshold = rx_seq + 1;
+		rx_exp++;
 	}
-	work.threshold = 3;
 
 	if (tested_op != FI_OP_CNTR_ADD && tested_op != FI_OP_CNTR_SET)
 		work.completion_cntr = test_cntr;
@@ -511,12 +514,21 @@ static int run_test()
 	init_buf_vals();
 
 	//eat up first receive to make sure the triggered op doesn't go there instead
-	ret = ft_tx(ep, remote_fi_addr, strlen(welcome_text), &tx_ctx);
-	if (ret)
-		return ret;
+	//the server receives first, so neither side's rx_buf is written after
+	//the peer has started the triggered transfers
+	if (opts.dst_addr) {
+		ret = ft_tx(ep, remote_fi_addr, strlen(welcome_text), &tx_ctx);
+		if (ret)
+			return ret;
+	}
 	ret = ft_get_rx_comp(rx_seq);
 	if (ret)
 		return ret;
+	if (!opts.dst_addr) {
+		ret = ft_tx(ep, remote_fi_addr, strlen(welcome_text), &tx_ctx);
+		if (ret)
+			return ret;
+	}
 
 	ret = trigger();
 	if (ret) {
@@ -581,6 +593,8 @@ int main(int argc, char **argv)
 	opts.options = FT_OPT_SIZE | FT_OPT_RX_CNTR | FT_OPT_TX_CNTR |
 		       FT_OPT_SKIP_REG_MR;
 	opts.mr_mode = FI_MR_LOCAL | FI_MR_VIRT_ADDR | FI_MR_ALLOCATED;
+	/* counters are waited on with fi_cntr_wait() */
+	opts.comp_method = FT_COMP_SREAD;
 
 	hints = fi_allocinfo();
 	if (!hints)
@@ -657,6 +671,10 @@ int main(int argc, char **argv)
 	if (ret)
 		return ret;
 
+	ret = ft_exchange_keys(&remote);
+	if (ret)
+		return ret;
+
 	ret = run_test();
 	if (ret)
 		return ret;
@@ -45,13 +45,35 @@ static char *welcome_text2 = "Hello2 from Client!";
 static int rma_write_trigger(void *src, size_t size,
 			     struct fid_cntr *cntr, size_t threshold)
 {
+	struct fi_msg_rma msg;
+	struct fi_rma_iov rma_iov;
+	struct iovec iov;
 	int ret;
+
 	triggered_ctx.event_type = FI_TRIGGER_THRESHOLD;
 	triggered_ctx.trigger.threshold.cntr = cntr;
 	triggered_ctx.trigger.threshold.threshold = threshold;
-	ret = fi_write(alias_ep, src, size, mr_desc,
-		       remote_fi_addr, remote.addr, remote.key,
-		       &triggered_ctx);
+	if (alias_ep) {
+		ret = fi_write(alias_ep, src, size, mr_desc,
+			       remote_fi_addr, remote.addr, remote.key,
+			       &triggered_ctx);
+	} else {
+		iov.iov_base = src;
+		iov.iov_len = size;
+		rma_iov.addr = remote.addr;
+		rma_iov.len = size;
+		rma_iov.key = remote.key;
+
+		msg.msg_iov = &iov;
+		msg.desc = &mr_desc;
+		msg.iov_count = 1;
+		msg.addr = remote_fi_addr;
+		msg.rma_iov = &rma_iov;
+		msg.rma_iov_count = 1;
+		msg.context = &triggered_ctx;
+		msg.data = 0;
+		ret = fi_writemsg(ep, &msg, FI_TRIGGER);
+	}
  	if (ret){
  		FT_PRINTERR("fi_write", ret);
  		return ret;
@@ -68,9 +90,12 @@ static int run_test(void)
 	if (ret)
 		return ret;
 
-	ret = ft_init_alias_ep(FI_TRANSMIT | FI_TRIGGER);
-	if (ret)
+	/* Without alias support, pass FI_TRIGGER to fi_writemsg instead */
+	ret = fi_ep_alias(ep, &alias_ep, FI_TRANSMIT | FI_TRIGGER);
+	if (ret && ret != -FI_ENOSYS) {
+		FT_PRINTERR("fi_ep_alias", ret);
 		return ret;
+	}
 
 	ret = ft_exchange_keys(&remote);
 	if (ret)
@@ -130,6 +155,8 @@ int main(int argc, char **argv)
 	opts = INIT_OPTS;
 	opts.options = FT_OPT_SIZE | FT_OPT_RX_CNTR | FT_OPT_TX_CNTR;
 	opts.transfer_size = strlen(welcome_text1) + strlen(welcome_text2);
+	/* counters are waited on with fi_cntr_wait() */
+	opts.comp_method = FT_COMP_SREAD;
 
 	hints = fi_allocinfo();
 	if (!hints)
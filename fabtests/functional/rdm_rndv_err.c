@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2026 libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <unistd.h>
+
+#include <rdma/fi_errno.h>
+
+#include "shared.h"
+
+/* The client sends large messages to the server.  Every receive must
+ * complete exactly once, with its data or with an error, and every send
+ * must complete successfully.
+ *
+ * With -f, the client then posts one more large message and exits
+ * without waiting for it.  The reads of the server for that message fail
+ * with the connection, and its receive must complete with an error.
+ */
+#define FINAL_SIZE 4
+
+static int fail_peer;
+
+static int get_recv_comp(struct fi_cq_msg_entry *comp, int *err)
+{
+	struct fi_cq_err_entry cq_err;
+	ssize_t ret;
+
+	while ((ret = fi_cq_read(rxcq, comp, 1)) == -FI_EAGAIN)
+		;
+
+	*err = 0;
+	if (ret == -FI_EAVAIL) {
+		memset(&cq_err, 0, sizeof(cq_err));
+		ret = fi_cq_readerr(rxcq, &cq_err, 0);
+		if (ret < 0) {
+			FT_PRINTERR("fi_cq_readerr", ret);
+			return (int) ret;
+		}
+		comp->op_context = cq_err.op_context;
+		comp->len = cq_err.len;
+		*err = cq_err.err ? cq_err.err : FI_EOTHER;
+	} else if (ret < 0) {
+		FT_PRINTERR("fi_cq_read", ret);
+		return (int) ret;
+	}
+
+	rx_cq_cntr++;
+	if (comp->op_context != &rx_ctx) {
+		FT_ERR("completion for unknown context %p", comp->op_context);
+		return -FI_EOTHER;
+	}
+	return 0;
+}
+
+static int run_receiver(void)
+{
+	struct fi_cq_msg_entry comp;
+	int i, err, ret, failed = 0;
+
+	for (i = 0; i < opts.iterations; i++) {
+		ret = get_recv_comp(&comp, &err);
+		if (ret)
+			return ret;
+
+		if (err) {
+			failed++;
+		} else if (comp.len != opts.transfer_size) {
+			FT_ERR("received %zu bytes, expected %zu",
+			       comp.len, opts.transfer_size);
+			return -FI_EOTHER;
+		} else if (ft_check_opts(FT_OPT_VERIFY_DATA)) {
+			ret = ft_check_buf(rx_buf, opts.transfer_size);
+			if (ret)
+				return ret;
+		}
+
+		memset(rx_buf, 0, opts.transfer_size);
+		ret = ft_post_rx(ep, rx_size, &rx_ctx);
+		if (ret)
+			return ret;
+	}
+
+	/* A failed receive must not complete a second time */
+	ret = get_recv_comp(&comp, &err);
+	if (ret)
+		return ret;
+	if (err || comp.len != FINAL_SIZE) {
+		FT_ERR("unexpected completion after the last transfer");
+		return -FI_EOTHER;
+	}
+
+	ret = ft_post_rx(ep, rx_size, &rx_ctx);
+	if (ret)
+		return ret;
+
+	printf("%d of %d receives failed\n", failed, opts.iterations);
+	if (failed) {
+		FT_ERR("receives failed with a live peer");
+		return -FI_EOTHER;
+	}
+
+	if (fail_peer) {
+		ret = get_recv_comp(&comp, &err);
+		if (ret)
+			return ret;
+		if (!err) {
+			FT_ERR("receive from an exited peer did not fail");
+			return -FI_EOTHER;
+		}
+		printf("receive from the exited peer failed: %s\n",
+		       fi_strerror(err));
+	}
+	return 0;
+}
+
+static int run_sender(void)
+{
+	int i, ret;
+
+	if (ft_check_opts(FT_OPT_VERIFY_DATA)) {
+		ret = ft_fill_buf(tx_buf, opts.transfer_size);
+		if (ret)
+			return ret;
+	}
+
+	for (i = 0; i < opts.iterations; i++) {
+		ret = ft_post_tx(ep, remote_fi_addr, opts.transfer_size,
+				 NO_CQ_DATA, &tx_ctx);
+		if (ret)
+			return ret;
+
+		ret = ft_get_tx_comp(tx_seq);
+		if (ret)
+			return ret;
+	}
+
+	ret = (int) ft_tx(ep, remote_fi_addr, FINAL_SIZE, &tx_ctx);
+	if (ret || !fail_peer)
+		return ret;
+
+	/* Leave without closing anything, as a crashed process would. */
+	ret = (int) ft_post_tx(ep, remote_fi_addr, opts.transfer_size,
+			       NO_CQ_DATA, &tx_ctx);
+	if (ret)
+		return ret;
+
+	printf("Exiting with a send in flight\n");
+	fflush(stdout);
+	_exit(EXIT_SUCCESS);
+}
+
+static int run(void)
+{
+	int ret;
+
+	cq_attr.format = FI_CQ_FORMAT_MSG;
+	ret = ft_init_fabric();
+	if (ret)
+		return ret;
+
+	printf("Sending %d messages of %zu bytes\n", opts.iterations,
+	       opts.transfer_size);
+	ret = opts.dst_addr ? run_sender() : run_receiver();
+	if (ret)
+		return ret;
+
+	/* There is no peer left to finalize with */
+	ret = fail_peer ? 0 : ft_finalize();
+	if (!ret)
+		printf("PASSED rndv err\n");
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	int op, ret;
+
+	opts = INIT_OPTS;
+	opts.transfer_size = 1 << 20;
+	opts.iterations = 10;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return EXIT_FAILURE;
+
+	while ((op = getopt(argc, argv, "fI:S:vh" ADDR_OPTS INFO_OPTS)) != -1) {
+		switch (op) {
+		default:
+			ft_parse_addr_opts(op, optarg, &opts);
+			ft_parseinfo(op, optarg, hints, &opts);
+			break;
+		case 'f':
+			fail_peer = 1;
+			break;
+		case 'I':
+			opts.iterations = atoi(optarg);
+			break;
+		case 'S':
+			opts.transfer_size = strtoul(optarg, NULL, 0);
+			break;
+		case 'v':
+			opts.options |= FT_OPT_VERIFY_DATA;
+			break;
+		case '?':
+		case 'h':
+			ft_usage(argv[0], "RDM large message error handling test");
+			FT_PRINT_OPTS_USAGE("-f",
+				"client exits with a large send in flight");
+			FT_PRINT_OPTS_USAGE("-I <int>",
+				"number of iterations (def 10)");
+			FT_PRINT_OPTS_USAGE("-S <int>",
+				"message size (def 1M)");
+			FT_PRINT_OPTS_USAGE("-v", "Enable data verification");
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind < argc)
+		opts.dst_addr = argv[optind];
+
+	/* Provider parameters are read when the provider is loaded.  Small
+	 * chunks keep several reads in flight when one of them fails.
+	 */
+	if (fail_peer)
+		setenv("FI_OFI_RXM_RNDV_CHUNK_SIZE", "65536", 0);
+
+	hints->ep_attr->type = FI_EP_RDM;
+	hints->caps = FI_MSG;
+	hints->mode = FI_CONTEXT;
+	hints->domain_attr->mr_mode = opts.mr_mode;
+
+	ret = run();
+
+	ft_free_res();
+	return ft_exit_code(ret);
+}
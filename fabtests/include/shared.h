@@ -567,6 +567,8 @@ enum {
 	LONG_OPT_PIN_CORE = 1,
 	LONG_OPT_TIMEOUT,
 	LONG_OPT_DEBUG_ASSERT,
+	LONG_OPT_REPEAT,
+	LONG_OPT_OUTPUT,
 };
 
 extern int debug_assert;
@@ -126,7 +126,7 @@ static int wait_for_comp(void *ctx)
 		if (comp.op_context && comp.op_context == ctx)
 			return FI_SUCCESS;
 
-	} while (err == -FI_EAGAIN);
+	} while (err == -FI_EAGAIN || err > 0);
 
 	return err;
 }
@@ -518,6 +518,332 @@ struct coll_test tests[] = {
 
 const int NUM_TESTS = ARRAY_SIZE(tests);
 
+/* Collective benchmarks: each collective is timed over the enabled message
+ * sizes, and reductions over each of the datatype and op pairs below that
+ * the provider supports.  Each rank times every iteration; rank 0 reports
+ * the slowest rank's statistics, as the collective is only as fast as
+ * its last member.
+ */
+struct coll_bench_type {
+	enum fi_datatype datatype;
+	enum fi_op op;
+};
+
+static const struct coll_bench_type coll_bench_data[] = {
+	{ FI_UINT64, FI_NOOP },
+};
+
+static const struct coll_bench_type coll_bench_reduce[] = {
+	{ FI_UINT64, FI_SUM },
+	{ FI_INT32, FI_SUM },
+	{ FI_FLOAT, FI_SUM },
+	{ FI_DOUBLE, FI_SUM },
+	{ FI_INT64, FI_MIN },
+	{ FI_DOUBLE, FI_MAX },
+	{ FI_UINT64, FI_BOR },
+};
+
+struct coll_bench {
+	char *name;
+	enum fi_collective_op coll;
+	const struct coll_bench_type *types;
+	size_t type_cnt;
+	ssize_t (*post)(size_t count, const struct coll_bench_type *type,
+			void *ctx);
+};
+
+struct coll_bench_stats {
+	double avg;
+	double p50;
+	double p99;
+	double max;
+};
+
+static void *bench_buf;
+static void *bench_result;
+static uint64_t *bench_samples;
+
+static ssize_t bench_barrier(size_t count, const struct coll_bench_type *type,
+			     void *ctx)
+{
+	return fi_barrier(ep, coll_addr, ctx);
+}
+
+static ssize_t bench_broadcast(size_t count, const struct coll_bench_type *type,
+			       void *ctx)
+{
+	return fi_broadcast(ep, bench_buf, count, NULL, coll_addr, 0,
+			    type->datatype, 0, ctx);
+}
+
+static ssize_t bench_allreduce(size_t count, const struct coll_bench_type *type,
+			       void *ctx)
+{
+	return fi_allreduce(ep, bench_buf, count, NULL, bench_result, NULL,
+			    coll_addr, type->datatype, type->op, 0, ctx);
+}
+
+static ssize_t bench_allgather(size_t count, const struct coll_bench_type *type,
+			       void *ctx)
+{
+	return fi_allgather(ep, bench_buf, count, NULL, bench_result, NULL,
+			    coll_addr, type->datatype, 0, ctx);
+}
+
+static ssize_t bench_scatter(size_t count, const struct coll_bench_type *type,
+			     void *ctx)
+{
+	return fi_scatter(ep, bench_buf, count, NULL, bench_result, NULL,
+			  coll_addr, 0, type->datatype, 0, ctx);
+}
+
+static ssize_t bench_gather(size_t count, const struct coll_bench_type *type,
+			    void *ctx)
+{
+	return fi_gather(ep, bench_buf, count, NULL, bench_result, NULL,
+			 coll_addr, 0, type->datatype, 0, ctx);
+}
+
+static ssize_t bench_alltoall(size_t count, const struct coll_bench_type *type,
+			      void *ctx)
+{
+	return fi_alltoall(ep, bench_buf, count, NULL, bench_result, NULL,
+			   coll_addr, type->datatype, 0, ctx);
+}
+
+static ssize_t bench_reduce(size_t count, const struct coll_bench_type *type,
+			    void *ctx)
+{
+	return fi_reduce(ep, bench_buf, count, NULL, bench_result, NULL,
+			 coll_addr, 0, type->datatype, type->op, 0, ctx);
+}
+
+static ssize_t bench_reduce_scatter(size_t count,
+				    const struct coll_bench_type *type,
+				    void *ctx)
+{
+	return fi_reduce_scatter(ep, bench_buf, count, NULL, bench_result,
+				 NULL, coll_addr, type->datatype, type->op, 0,
+				 ctx);
+}
+
+/* Collectives the provider does not support are reported and skipped. */
+static struct coll_bench benches[] = {
+	{ "barrier", FI_BARRIER, NULL, 0, bench_barrier },
+	{ "broadcast", FI_BROADCAST, coll_bench_data,
+	  ARRAY_SIZE(coll_bench_data), bench_broadcast },
+	{ "allreduce", FI_ALLREDUCE, coll_bench_reduce,
+	  ARRAY_SIZE(coll_bench_reduce), bench_allreduce },
+	{ "allgather", FI_ALLGATHER, coll_bench_data,
+	  ARRAY_SIZE(coll_bench_data), bench_allgather },
+	{ "scatter", FI_SCATTER, coll_bench_data,
+	  ARRAY_SIZE(coll_bench_data), bench_scatter },
+	{ "gather", FI_GATHER, coll_bench_data,
+	  ARRAY_SIZE(coll_bench_data), bench_gather },
+	{ "alltoall", FI_ALLTOALL, coll_bench_data,
+	  ARRAY_SIZE(coll_bench_data), bench_alltoall },
+	{ "reduce", FI_REDUCE, coll_bench_reduce,
+	  ARRAY_SIZE(coll_bench_reduce), bench_reduce },
+	{ "reduce_scatter", FI_REDUCE_SCATTER, coll_bench_reduce,
+	  ARRAY_SIZE(coll_bench_reduce), bench_reduce_scatter },
+};
+
+static int bench_sample_cmp(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+	return (x > y) - (x < y);
+}
+
+static void bench_show(struct coll_bench *bench,
+		       const struct coll_bench_type *type, size_t bytes,
+		       int iters, struct coll_bench_stats *all)
+{
+	static int header = 1;
+	struct coll_bench_stats max = { 0 };
+	char dt[32] = "-", op[32] = "-";
+	int i;
+
+	for (i = 0; i < pm_job.num_ranks && iters; i++) {
+		max.avg = MAX(max.avg, all[i].avg);
+		max.p50 = MAX(max.p50, all[i].p50);
+		max.p99 = MAX(max.p99, all[i].p99);
+		max.max = MAX(max.max, all[i].max);
+	}
+
+	if (header) {
+		printf("%-16s%-10s%-8s%10s%8s%11s%11s%11s%11s%13s\n",
+		       "collective", "datatype", "op", "bytes", "iters",
+		       "avg_us", "p50_us", "p99_us", "max_us", "algbw_MB/s");
+		header = 0;
+	}
+
+	if (type) {
+		/* fi_tostr() returns a static buffer */
+		snprintf(dt, sizeof dt, "%s",
+			 fi_tostr(&type->datatype, FI_TYPE_ATOMIC_TYPE) + 3);
+		if (type->op != FI_NOOP)
+			snprintf(op, sizeof op, "%s",
+				 fi_tostr(&type->op, FI_TYPE_ATOMIC_OP) + 3);
+	}
+
+	if (!iters) {
+		printf("%-16s%-10s%-8s%10s\n", bench->name, dt, op,
+		       "not supported");
+		return;
+	}
+	printf("%-16s%-10s%-8s%10zu%8d", bench->name, dt, op, bytes, iters);
+	printf("%11.2f%11.2f%11.2f%11.2f%13.2f\n", max.avg, max.p50, max.p99,
+	       max.max, max.avg > 0 ? bytes / max.avg : 0);
+}
+
+static int bench_run_size(struct coll_bench *bench,
+			  const struct coll_bench_type *type, size_t count,
+			  int iters)
+{
+	struct coll_bench_stats local, *all;
+	uint64_t done_flag, start, sum = 0;
+	int i, ret;
+
+	all = calloc(pm_job.num_ranks, sizeof(*all));
+	if (!all)
+		return -FI_ENOMEM;
+
+	pm_barrier();
+	for (i = 0; i < opts.warmup_iterations + iters; i++) {
+		start = ft_gettime_ns();
+		ret = bench->post(count, type, &done_flag);
+		if (ret) {
+			FT_ERR("collective %s failed: %d (%s)\n", bench->name,
+			       ret, fi_strerror(-ret));
+			goto out;
+		}
+
+		ret = wait_for_comp(&done_flag);
+		if (ret) {
+			FT_PRINTERR("wait_for_comp", ret);
+			goto out;
+		}
+
+		if (i >= opts.warmup_iterations)
+			bench_samples[i - opts.warmup_iterations] =
+				ft_gettime_ns() - start;
+	}
+
+	qsort(bench_samples, iters, sizeof(*bench_samples), bench_sample_cmp);
+	for (i = 0; i < iters; i++)
+		sum += bench_samples[i];
+	local.avg = sum / 1000.0 / iters;
+	local.p50 = bench_samples[(iters - 1) / 2] / 1000.0;
+	local.p99 = bench_samples[(iters - 1) * 99 / 100] / 1000.0;
+	local.max = bench_samples[iters - 1] / 1000.0;
+
+	ret = pm_allgather(&local, all, sizeof(local));
+	if (ret)
+		goto out;
+
+	if (pm_job.my_rank == 0)
+		bench_show(bench, type,
+			   count * datatype_to_size(type ? type->datatype :
+						    FI_UINT64), iters, all);
+out:
+	free(all);
+	return ret;
+}
+
+static int bench_run_type(struct coll_bench *bench,
+			  const struct coll_bench_type *type)
+{
+	struct fi_collective_attr attr = { 0 };
+	size_t size, count;
+	int i, iters, ret;
+
+	attr.op = type ? type->op : FI_NOOP;
+	attr.datatype = type ? type->datatype : FI_VOID;
+	if (fi_query_collective(domain, bench->coll, &attr, 0)) {
+		if (pm_job.my_rank == 0)
+			bench_show(bench, type, 0, 0, NULL);
+		return 0;
+	}
+
+	if (!type) {
+		iters = (opts.options & FT_OPT_ITER) ?
+			opts.iterations : size_to_count(0);
+		return bench_run_size(bench, NULL, 0, iters);
+	}
+
+	for (i = 0; i < TEST_CNT; i++) {
+		if (opts.options & FT_OPT_SIZE) {
+			if (i)
+				break;
+			size = opts.transfer_size;
+		} else if (ft_use_size(i, opts.sizes_enabled)) {
+			size = test_size[i].size;
+		} else {
+			continue;
+		}
+
+		count = size / datatype_to_size(type->datatype);
+		if (!count)
+			continue;
+
+		iters = (opts.options & FT_OPT_ITER) ?
+			opts.iterations : size_to_count(size);
+		ret = bench_run_size(bench, type, count, iters);
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+static int multinode_run_benchmarks(void)
+{
+	size_t max_size = 0;
+	int i, j, ret;
+
+	if (opts.options & FT_OPT_SIZE) {
+		max_size = opts.transfer_size;
+	} else {
+		for (i = 0; i < TEST_CNT; i++) {
+			if (ft_use_size(i, opts.sizes_enabled))
+				max_size = MAX(max_size, test_size[i].size);
+		}
+	}
+
+	/* room for the contributions of all ranks, as for allgather */
+	bench_buf = calloc(pm_job.num_ranks, max_size);
+	bench_result = calloc(pm_job.num_ranks, max_size);
+	bench_samples = calloc(MAX(opts.iterations, size_to_count(0)),
+			       sizeof(*bench_samples));
+	if (!bench_buf || !bench_result || !bench_samples) {
+		ret = -FI_ENOMEM;
+		goto out;
+	}
+
+	ret = coll_setup();
+	if (ret)
+		goto out;
+
+	coll_addr = fi_mc_addr(coll_mc);
+	for (i = 0; i < ARRAY_SIZE(benches) && !ret; i++) {
+		if (!benches[i].types) {
+			ret = bench_run_type(&benches[i], NULL);
+			continue;
+		}
+
+		for (j = 0; j < benches[i].type_cnt && !ret; j++)
+			ret = bench_run_type(&benches[i], &benches[i].types[j]);
+	}
+
+	pm_barrier();
+	coll_teardown();
+out:
+	free(bench_samples);
+	free(bench_result);
+	free(bench_buf);
+	return ret;
+}
+
 static inline int setup_hints()
 {
 	hints->ep_attr->type = FI_EP_RDM;
@@ -525,7 +851,8 @@ static inline int setup_hints()
 	hints->mode = FI_CONTEXT;
 	hints->domain_attr->control_progress = FI_PROGRESS_MANUAL;
 	hints->domain_attr->data_progress = FI_PROGRESS_MANUAL;
-	hints->fabric_attr->prov_name = strdup("tcp");
+	if (!hints->fabric_attr->prov_name)
+		hints->fabric_attr->prov_name = strdup("tcp");
 	return FI_SUCCESS;
 }
 
@@ -614,6 +941,11 @@ int multinode_run_tests(int argc, char **argv)
 	if (ret)
 		return ret;
 
+	if (pm_job.benchmark) {
+		ret = multinode_run_benchmarks();
+		goto out;
+	}
+
 	for (i = 0; i < NUM_TESTS && !ret; i++) {
 		FT_DEBUG("Running Test: %s \n", tests[i].name);
 
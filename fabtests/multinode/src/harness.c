@@ -295,7 +295,6 @@ int main(int argc, char **argv)
 	int c, ret;
 
 	opts = INIT_OPTS;
-	opts.options |= FT_OPT_SIZE;
 
 	pm_job.clients = NULL;
 
@@ -303,7 +302,7 @@ int main(int argc, char **argv)
 	if (!hints)
 		return EXIT_FAILURE;
 
-	while ((c = getopt(argc, argv, "n:C:h" CS_OPTS INFO_OPTS)) != -1) {
+	while ((c = getopt(argc, argv, "n:C:xh" CS_OPTS INFO_OPTS)) != -1) {
 		switch (c) {
 		default:
 			ft_parse_addr_opts(c, optarg, &opts);
@@ -316,13 +315,22 @@ int main(int argc, char **argv)
 		case 'C':
 			pm_job.transfer_method = parse_caps(optarg);
 			break;
+		case 'x':
+			pm_job.benchmark = true;
+			break;
 		case '?':
 		case 'h':
 			ft_usage(argv[0], "A simple multinode test");
+			FT_PRINT_OPTS_USAGE("-x", "run collective benchmarks "
+					    "instead of tests (fi_multinode_coll)");
 			return EXIT_FAILURE;
 		}
 	}
 
+	/* Benchmarks sweep the message sizes unless -S selects one. */
+	if (!pm_job.benchmark)
+		opts.options |= FT_OPT_SIZE;
+
 	ret = ft_startup();
 	if (ret)
 		goto err1;
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+
+import sys
+import csv
+import json
+from argparse import ArgumentParser
+
+# Compare two sets of benchmark results written with --output=json or
+# --output=csv and flag regressions.  Results are matched on benchmark
+# name, message size and thread count.
+
+METRICS = [
+	# name, higher is better
+	('mbytes_per_sec', True),
+	('usec_per_xfer', False),
+	('p50_ns', False),
+	('p99_ns', False),
+]
+
+def _num(val):
+	try:
+		return float(val)
+	except (TypeError, ValueError):
+		return None
+
+def _flatten(rec):
+	"""Convert a JSON record to the flat CSV column names"""
+	flat = {}
+	for k, v in rec.items():
+		if k == 'latency_ns':
+			for p, n in v.items():
+				flat[p + '_ns'] = n
+		elif k == 'warmup':
+			flat['warmup_iterations'] = v.get('iterations')
+			flat['warmup_settled'] = v.get('settled')
+		elif isinstance(v, dict):
+			flat[k] = v.get('mean')
+			flat[k + '_ci95'] = v.get('ci95')
+		else:
+			flat[k] = v
+	return flat
+
+def load(path):
+	results = {}
+	with open(path, 'r') as fd:
+		data = fd.read()
+
+	if data.lstrip().startswith('{'):
+		records = []
+		for line in data.splitlines():
+			line = line.strip()
+			if line.startswith('{'):
+				records.append(_flatten(json.loads(line)))
+	else:
+		lines = [l for l in data.splitlines() if ',' in l]
+		records = list(csv.DictReader(lines))
+
+	for rec in records:
+		key = (rec.get('benchmark'), int(_num(rec.get('bytes'))),
+		       int(_num(rec.get('threads', 1)) or 1))
+		results[key] = rec
+	return results
+
+def compare(base, new, threshold):
+	"""Return a list of (key, metric, base, new, change %, regressed)"""
+	rows = []
+	for key in sorted(set(base) & set(new)):
+		for metric, higher_better in METRICS:
+			b = _num(base[key].get(metric))
+			n = _num(new[key].get(metric))
+			if b is None or n is None or b == 0:
+				continue
+
+			change = (n - b) / b * 100
+			worse = -change if higher_better else change
+
+			# Differences within the combined confidence intervals
+			# are noise, whatever their size.
+			b_ci = _num(base[key].get(metric + '_ci95')) or 0
+			n_ci = _num(new[key].get(metric + '_ci95')) or 0
+			significant = abs(n - b) > b_ci + n_ci
+
+			rows.append((key, metric, b, n, change,
+				     worse > threshold and significant))
+	return rows
+
+def main(argv=None):
+	parser = ArgumentParser(description="Compare two fabtests benchmark "
+				"result files and flag regressions.")
+	parser.add_argument('base', help="baseline results (json or csv)")
+	parser.add_argument('new', help="new results (json or csv)")
+	parser.add_argument('-t', '--threshold', type=float, default=5.0,
+			    help="percent change counted as a regression "
+			    "(default: 5)")
+	parser.add_argument('-a', '--all', action='store_true',
+			    help="print all compared values, not only "
+			    "regressions")
+	args = parser.parse_args(argv)
+
+	base = load(args.base)
+	new = load(args.new)
+	rows = compare(base, new, args.threshold)
+
+	regressions = 0
+	print("%-28s %10s %4s %-16s %14s %14s %9s" % ("benchmark", "bytes",
+	      "thr", "metric", "base", "new", "change"))
+	for key, metric, b, n, change, regressed in rows:
+		if regressed:
+			regressions += 1
+		elif not args.all:
+			continue
+		print("%-28s %10d %4d %-16s %14.3f %14.3f %+8.2f%%%s" %
+		      (key[0], key[1], key[2], metric, b, n, change,
+		       "  REGRESSION" if regressed else ""))
+
+	missing = set(base) ^ set(new)
+	if missing:
+		print("%d results present in only one file" % len(missing))
+	print("%d regressions in %d compared values" % (regressions, len(rows)))
+	return 1 if regressions else 0
+
+if __name__ == "__main__":
+	sys.exit(main())
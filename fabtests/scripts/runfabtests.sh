@@ -130,6 +130,9 @@ functional_tests=(
 	"fi_multi_mr -e rdm -V"
 	"fi_multi_ep -e msg -v"
 	"fi_multi_ep -e rdm -v"
+	"fi_rdm_conn_cache -c 6 -n 2 -v"
+	"fi_rdm_rndv_err -v"
+	"fi_rdm_rndv_err -f"
 	"fi_recv_cancel -e rdm -V"
 	"fi_unexpected_msg -e msg -I 10"
 	"fi_unexpected_msg -e rdm -I 10"
@@ -175,6 +178,11 @@ short_tests=(
 	"fi_rdm_tagged_bw -I 5 -U"
 	"fi_rdm_tagged_bw -I 5 -v"
 	"fi_rdm_tagged_bw -I 5 -v -U"
+	"fi_rdm_tune_bw -I 5 -R 2"
+	"fi_rdm_msg_rate -I 5 -T 2"
+	"fi_rdm_msg_rate -I 5 -T 2 -g"
+	"fi_rdm_msg_rate -I 5 -T 2 -x sep"
+	"fi_rdm_msg_rate -I 5 -T 2 -x shared"
 	"fi_dgram_pingpong -I 5"
 )
 
@@ -3,17 +3,18 @@
 
 echo "@=$@"
 
-Options=$(getopt --options h:,n:,p:,I:,C: \
-		  		--longoptions hosts:,processes-per-node:,provider:,capability:\
-				  ,iterations:,cleanup,help \
-				--"$@")
+Options=$(getopt --options h:,n:,p:,I:,C:,x \
+		--longoptions hosts:,processes-per-node:,provider:,capability:,iterations:,coll,coll-benchmark,cleanup,help \
+		-- "$@")
 
 eval set -- "$Options"
 
 hosts=[]
 ppn=1
-iterations=1
+iterations=""
 pattern=""
+binary=fi_multinode
+bench=""
 cleanup=false
 help=false
 
@@ -29,6 +30,10 @@ while true; do
 			iterations=$2; shift 2 ;;
 		-C|--capability)
 			capability="$2"; shift 2 ;;
+		--coll)
+			binary=fi_multinode_coll; shift ;;
+		-x|--coll-benchmark)
+			binary=fi_multinode_coll; bench="-x"; shift ;;
 		--cleanup)
 			cleanup=true; shift ;;
 		--help) 
@@ -48,6 +53,11 @@ if $help ; then
 	echo "\t -C,--cabability multinode cabability to use (rma or default: msg)"
 	echo "\t -I,-- iterations number of iterations for the multinode test \
 				to run each pattern on"
+	echo "\t --coll run the collective tests (fi_multinode_coll)"
+	echo "\t -x,--coll-benchmark run the collective benchmarks over a range \
+				of message sizes.  The results are written by rank 0"
+	echo "\t Hosts named localhost are run without ssh, so all processes \
+				can run on one host with -h localhost -n <ranks>"
 	echo "\t --cleanup end straggling processes. Does not rerun tests"
 	echo "\t --help show this message"
 	exit 1
@@ -59,21 +69,37 @@ server=${hosts[0]}
 start_server=0
 output="multinode_server_$ranks.out"
 
-cmd="fi_multinode -n $ranks -s $server -p '$provider' -C $capability -I $iterations"
+if [ -z "$iterations" -a -z "$bench" ]; then
+	iterations=1
+fi
+
+cmd="$binary -n $ranks -s $server -p '$provider'"
+[ -n "$capability" ] && cmd+=" -C $capability"
+[ -n "$iterations" ] && cmd+=" -I $iterations"
+[ -n "$bench" ] && cmd+=" $bench"
 echo $cmd
 
+run_on() {
+	local node="$1"; shift
+	if [ "$node" = "localhost" ]; then
+		bash -c "$*"
+	else
+		ssh $node "$@"
+	fi
+}
+
 if ! $cleanup ; then
   
 	for node in "${hosts[@]}"; do
 		for i in $(seq 1 $ppn); do
 			if [ $start_server -eq 0 ]; then
 				echo STARTING SERVER
-				ssh $node $cmd &> $output &
+				run_on $node $cmd &> $output &
 				server_pid=$!
 				start_server=1
 				sleep .5
 			else
-				ssh $node $cmd &> /dev/null &
+				run_on $node $cmd &> /dev/null &
 			fi
 		done
 	done
@@ -85,5 +111,5 @@ fi
 echo Cleaning up
   
 for node in "${hosts[@]}"; do
-	ssh $node "ps -eo comm,pid | grep '^fi_multinode' | awk '{print \$2}' | xargs kill -9" >& /dev/null
+	run_on $node "ps -eo comm,pid | grep '^fi_multinode' | awk '{print \$2}' | xargs kill -9" >& /dev/null
 done;
@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2026 libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "unit_common.h"
+#include "shared.h"
+
+#define MAX_STARTUP_PROCS 1024
+#define STARTUP_NAME_FMT "fi_av_startup_%08zu"
+
+static size_t addr_cnt = 100000;
+static int proc_cnt = 64;
+
+static char *addrs;
+static size_t addr_stride;
+static char av_name[64];
+
+/* fi_addr_t values returned to the creator of the shared AV */
+static fi_addr_t *shared_table;
+
+struct startup_result {
+	int64_t		usec;
+	int64_t		lookup_nsec;
+	long		priv_kb;
+	int		ret;
+};
+
+/* Placed in memory shared by all processes */
+struct startup_sync {
+	pthread_barrier_t	start;
+	pthread_barrier_t	ready;
+	pthread_barrier_t	done;
+	struct startup_result	result[];
+};
+
+static struct startup_sync *sync_buf;
+
+/* Generate addr_cnt distinct addresses in the format of the provider */
+static int alloc_addrs(void)
+{
+	struct sockaddr_in *sin;
+	struct sockaddr_in6 *sin6;
+	size_t i;
+
+	switch (fi->addr_format) {
+	case FI_SOCKADDR:
+	case FI_SOCKADDR_IN:
+		addr_stride = sizeof(*sin);
+		break;
+	case FI_SOCKADDR_IN6:
+		addr_stride = sizeof(*sin6);
+		break;
+	case FI_ADDR_STR:
+		addr_stride = snprintf(NULL, 0, STARTUP_NAME_FMT, addr_cnt) + 1;
+		break;
+	default:
+		fprintf(stderr, "Unsupported address format\n");
+		return -FI_ENODATA;
+	}
+
+	addrs = calloc(addr_cnt, addr_stride);
+	if (!addrs)
+		return -FI_ENOMEM;
+
+	for (i = 0; i < addr_cnt; i++) {
+		switch (fi->addr_format) {
+		case FI_SOCKADDR_IN6:
+			sin6 = (struct sockaddr_in6 *) (addrs + i * addr_stride);
+			sin6->sin6_family = AF_INET6;
+			sin6->sin6_addr.s6_addr[0] = 0xfd;
+			sin6->sin6_addr.s6_addr[13] = (uint8_t) (i >> 16);
+			sin6->sin6_addr.s6_addr[14] = (uint8_t) (i >> 8);
+			sin6->sin6_addr.s6_addr[15] = (uint8_t) i;
+			sin6->sin6_port = htons(1024 + (i & 0x3f));
+			break;
+		case FI_ADDR_STR:
+			snprintf(addrs + i * addr_stride, addr_stride,
+				 STARTUP_NAME_FMT, i);
+			break;
+		default:
+			sin = (struct sockaddr_in *) (addrs + i * addr_stride);
+			sin->sin_family = AF_INET;
+			sin->sin_addr.s_addr = htonl(0x0a000001 + (i >> 6));
+			sin->sin_port = htons(1024 + (i & 0x3f));
+			break;
+		}
+	}
+	return 0;
+}
+
+/* Resident memory that is not shared with other processes */
+static long private_kb(void)
+{
+	long size, resident, shared;
+	FILE *f;
+	int n;
+
+	f = fopen("/proc/self/statm", "r");
+	if (!f)
+		return 0;
+
+	n = fscanf(f, "%ld %ld %ld", &size, &resident, &shared);
+	fclose(f);
+	if (n != 3)
+		return 0;
+
+	return (resident - shared) * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static int insert_addrs(struct fid_av *startup_av, fi_addr_t *table)
+{
+	int ret;
+
+	ret = fi_av_insert(startup_av, addrs, addr_cnt, table, 0, NULL);
+	if (ret < 0) {
+		FT_PRINTERR("fi_av_insert", ret);
+		return ret;
+	}
+	if ((size_t) ret != addr_cnt) {
+		fprintf(stderr, "fi_av_insert: inserted %d of %zu addresses\n",
+			ret, addr_cnt);
+		return -FI_EOTHER;
+	}
+	return 0;
+}
+
+/* Spot check that every process sees the same fi_addr_t values */
+static int check_addrs(struct fid_av *startup_av, fi_addr_t *table)
+{
+	char buf[256];
+	size_t i, len;
+	int ret;
+
+	for (i = 0; i < addr_cnt; i += addr_cnt / 8 + 1) {
+		len = sizeof(buf);
+		ret = fi_av_lookup(startup_av, table[i], buf, &len);
+		if (ret) {
+			FT_PRINTERR("fi_av_lookup", ret);
+			return ret;
+		}
+
+		if (len < addr_stride ||
+		    memcmp(buf, addrs + i * addr_stride, addr_stride)) {
+			fprintf(stderr, "fi_addr %zu maps to the wrong address\n",
+				i);
+			return -FI_EOTHER;
+		}
+	}
+	return 0;
+}
+
+/* With a shared AV, process 0 creates the AV and inserts the addresses,
+ * then the other processes open it read-only.  Otherwise every process
+ * inserts all addresses into its own AV.
+ */
+static int run_proc(int rank, int shared)
+{
+	struct startup_result *res = &sync_buf->result[rank];
+	struct fi_av_attr attr = {
+		.type = FI_AV_TABLE,
+		.count = addr_cnt,
+	};
+	struct fid_av *startup_av = NULL;
+	fi_addr_t *table;
+	long kb;
+	int ret;
+
+	ret = ft_open_fabric_res();
+	table = malloc(addr_cnt * sizeof(*table));
+	if (table)
+		memset(table, 0, addr_cnt * sizeof(*table));
+	else if (!ret)
+		ret = -FI_ENOMEM;
+	kb = private_kb();
+
+	pthread_barrier_wait(&sync_buf->start);
+	ft_start();
+	if (!ret && (!shared || !rank)) {
+		attr.name = shared ? av_name : NULL;
+		ret = fi_av_open(domain, &attr, &startup_av, NULL);
+		if (ret)
+			FT_PRINTERR("fi_av_open", ret);
+		else
+			ret = insert_addrs(startup_av, table);
+		if (!ret && shared)
+			memcpy(shared_table, table, addr_cnt * sizeof(*table));
+	}
+
+	pthread_barrier_wait(&sync_buf->ready);
+	if (!ret && shared && rank) {
+		attr.name = av_name;
+		attr.flags = FI_READ;
+		ret = fi_av_open(domain, &attr, &startup_av, NULL);
+		if (ret)
+			FT_PRINTERR("fi_av_open", ret);
+	}
+	ft_stop();
+
+	res->usec = get_elapsed(&start, &end, MICRO);
+	res->priv_kb = private_kb() - kb;
+	if (!ret)
+		ret = check_addrs(startup_av, shared ? shared_table : table);
+
+	/* Inserting addresses already in the AV only resolves them */
+	if (!ret) {
+		ft_start();
+		ret = insert_addrs(startup_av, table);
+		ft_stop();
+		res->lookup_nsec = get_elapsed(&start, &end, NANO);
+	}
+	res->ret = ret;
+
+	/* the creator keeps the AV until everyone has opened it */
+	pthread_barrier_wait(&sync_buf->done);
+	if (startup_av)
+		fi_close(&startup_av->fid);
+	free(table);
+	ft_free_res();
+	return ret;
+}
+
+static int init_sync(void)
+{
+	pthread_barrierattr_t attr;
+	int ret;
+
+	pthread_barrierattr_init(&attr);
+	pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+	ret = pthread_barrier_init(&sync_buf->start, &attr, proc_cnt);
+	if (!ret)
+		ret = pthread_barrier_init(&sync_buf->ready, &attr, proc_cnt);
+	if (!ret)
+		ret = pthread_barrier_init(&sync_buf->done, &attr, proc_cnt);
+	pthread_barrierattr_destroy(&attr);
+	return -ret;
+}
+
+static void fini_sync(void)
+{
+	pthread_barrier_destroy(&sync_buf->start);
+	pthread_barrier_destroy(&sync_buf->ready);
+	pthread_barrier_destroy(&sync_buf->done);
+}
+
+static int run_startup(int shared)
+{
+	int64_t max_usec = 0, total_usec = 0, lookup_nsec = 0;
+	long total_kb = 0;
+	int i, status, ret;
+	pid_t pid;
+
+	ret = init_sync();
+	if (ret) {
+		FT_PRINTERR("pthread_barrier_init", ret);
+		return ret;
+	}
+
+	for (i = 0; i < proc_cnt; i++) {
+		pid = fork();
+		if (!pid)
+			_exit(ft_exit_code(run_proc(i, shared)));
+		if (pid < 0) {
+			/* processes already started wait for the others */
+			ret = -errno;
+			FT_PRINTERR("fork", ret);
+			fprintf(stderr, "unable to start all processes\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	for (i = 0; i < proc_cnt; i++) {
+		if (wait(&status) < 0 || !WIFEXITED(status) ||
+		    WEXITSTATUS(status))
+			ret = -FI_EOTHER;
+	}
+	fini_sync();
+
+	for (i = 0; i < proc_cnt; i++) {
+		if (sync_buf->result[i].ret && !ret)
+			ret = sync_buf->result[i].ret;
+		max_usec = MAX(max_usec, sync_buf->result[i].usec);
+		total_usec += sync_buf->result[i].usec;
+		total_kb += sync_buf->result[i].priv_kb;
+		lookup_nsec += sync_buf->result[i].lookup_nsec;
+	}
+	if (ret)
+		return ret;
+
+	printf("%-10s %-14" PRId64 " %-14" PRId64 " %-14ld %-14.1f\n",
+	       shared ? "shared" : "private", max_usec,
+	       total_usec / proc_cnt, total_kb / proc_cnt,
+	       (double) lookup_nsec / proc_cnt / addr_cnt);
+	return 0;
+}
+
+static void usage(char *name)
+{
+	ft_unit_usage(name,
+		"Measure the time for a group of local processes to set up\n"
+		"an AV holding the same addresses, and the memory it uses.\n"
+		"Each process inserts the addresses into its own AV, then\n"
+		"one process fills a named AV that the others open with\n"
+		"FI_READ, if the provider supports shared AVs.  The time to\n"
+		"resolve an address already in the AV is also reported.");
+	FT_PRINT_OPTS_USAGE("-n <count>", "Number of addresses.");
+	FT_PRINT_OPTS_USAGE("-c <procs>", "Number of processes.");
+}
+
+int main(int argc, char **argv)
+{
+	int ret, op;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return EXIT_FAILURE;
+
+	while ((op = getopt(argc, argv, FAB_OPTS "h" "n:c:")) != -1) {
+		switch (op) {
+		default:
+			ft_parseinfo(op, optarg, hints, &opts);
+			break;
+		case 'n':
+			addr_cnt = strtoul(optarg, NULL, 10);
+			break;
+		case 'c':
+			proc_cnt = atoi(optarg);
+			break;
+		case '?':
+		case 'h':
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!addr_cnt || proc_cnt <= 0 || proc_cnt > MAX_STARTUP_PROCS) {
+		ret = -FI_EINVAL;
+		FT_PRINTERR("Invalid option", ret);
+		goto out;
+	}
+
+	hints->mode = ~0;
+	hints->domain_attr->mode = ~0;
+	hints->domain_attr->mr_mode = ~(FI_MR_BASIC | FI_MR_SCALABLE);
+
+	/* Prefer datagram endpoints, which use the AV of the core provider
+	 * rather than that of a utility provider layered over it.
+	 */
+	ret = -FI_ENODATA;
+	if (!hints->ep_attr->type) {
+		hints->ep_attr->type = FI_EP_DGRAM;
+		ret = fi_getinfo(FT_FIVERSION, NULL, 0, 0, hints, &fi);
+		hints->ep_attr->type = FI_EP_UNSPEC;
+	}
+	if (ret)
+		ret = fi_getinfo(FT_FIVERSION, NULL, 0, 0, hints, &fi);
+	if (ret) {
+		FT_PRINTERR("fi_getinfo", ret);
+		goto out;
+	}
+
+	ret = alloc_addrs();
+	if (ret)
+		goto out;
+
+	sync_buf = mmap(NULL, sizeof(*sync_buf) +
+			proc_cnt * sizeof(sync_buf->result[0]),
+			PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+			-1, 0);
+	if (sync_buf == MAP_FAILED) {
+		ret = -errno;
+		FT_PRINTERR("mmap", ret);
+		sync_buf = NULL;
+		goto out;
+	}
+
+	shared_table = mmap(NULL, addr_cnt * sizeof(*shared_table),
+			    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+			    -1, 0);
+	if (shared_table == MAP_FAILED) {
+		ret = -errno;
+		FT_PRINTERR("mmap", ret);
+		shared_table = NULL;
+		goto out;
+	}
+	snprintf(av_name, sizeof(av_name), "fi_av_startup_%d", getpid());
+
+	printf("Testing AV startup on fabric %s domain %s\n",
+	       fi->fabric_attr->name, fi->domain_attr->name);
+	printf("%d processes, %zu addresses\n", proc_cnt, addr_cnt);
+	printf("%-10s %-14s %-14s %-14s %-14s\n", "av", "max_usec",
+	       "mean_usec", "priv_kb/proc", "lookup_ns");
+
+	ret = run_startup(0);
+	if (ret)
+		goto out;
+
+	if (fi->domain_attr->caps & FI_SHARED_AV)
+		ret = run_startup(1);
+	else
+		printf("%-10s not supported\n", "shared");
+
+out:
+	if (shared_table)
+		munmap(shared_table, addr_cnt * sizeof(*shared_table));
+	if (sync_buf)
+		munmap(sync_buf, sizeof(*sync_buf) +
+		       proc_cnt * sizeof(sync_buf->result[0]));
+	free(addrs);
+	ft_free_res();
+	return ft_exit_code(ret);
+}
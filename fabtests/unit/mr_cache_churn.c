@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2026 libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include "unit_common.h"
+#include "shared.h"
+
+#define MAX_CHURN_THREADS 64
+
+static size_t mr_buf_size = 65536;
+static size_t churn_pages = 64;
+static int churn_threads = 4;
+static int lookups = 100000;
+
+struct churn_ctx {
+	pthread_t	thread;
+	uint64_t	key;
+	long		unmaps;
+	int		ret;
+};
+
+static volatile int churn_stop;
+
+static int mr_lookup(void *buf, size_t size, uint64_t key)
+{
+	struct fid_mr *mr;
+	const struct iovec iov = {
+		.iov_base = buf,
+		.iov_len = size,
+	};
+	struct fi_mr_attr attr = {
+		.mr_iov = &iov,
+		.iov_count = 1,
+		.access = ft_info_to_mr_access(fi),
+		.requested_key = key,
+		.iface = FI_HMEM_SYSTEM,
+	};
+	int ret;
+
+	ret = fi_mr_regattr(domain, &attr, 0, &mr);
+	if (ret)
+		return ret;
+
+	return fi_close(&mr->fid);
+}
+
+/* Map a region, register it so that the MR cache monitors it, then tear it
+ * down one page at a time.  Odd pages are released with madvise before the
+ * region is unmapped, which generates both remove and unmap events.
+ */
+static void *churn_thread(void *arg)
+{
+	struct churn_ctx *ctx = arg;
+	size_t page_size, len, i;
+	char *buf;
+
+	page_size = sysconf(_SC_PAGESIZE);
+	len = page_size * churn_pages;
+
+	while (!churn_stop) {
+		buf = mmap(NULL, len, PROT_READ | PROT_WRITE,
+			   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (buf == MAP_FAILED) {
+			ctx->ret = -errno;
+			FT_PRINTERR("mmap", ctx->ret);
+			break;
+		}
+		memset(buf, 0, len);
+
+		ctx->ret = mr_lookup(buf, len, ctx->key);
+		if (ctx->ret) {
+			FT_PRINTERR("fi_mr_regattr", ctx->ret);
+			munmap(buf, len);
+			break;
+		}
+
+		for (i = 1; i < churn_pages; i += 2)
+			madvise(buf + i * page_size, page_size, MADV_DONTNEED);
+		for (i = 0; i < churn_pages; i++)
+			munmap(buf + i * page_size, page_size);
+		ctx->unmaps += churn_pages;
+	}
+	return NULL;
+}
+
+/* Register and release the same buffer repeatedly while nthreads threads
+ * churn mappings.  With an MR cache, each registration is a cache lookup
+ * that competes with the invalidations generated by the churn.
+ */
+static int run_churn(void *buf, int nthreads)
+{
+	struct churn_ctx ctx[MAX_CHURN_THREADS];
+	int64_t elapsed;
+	long unmaps = 0;
+	int i, ret, tret;
+
+	churn_stop = 0;
+	for (i = 0; i < nthreads; i++) {
+		ctx[i].key = FT_MR_KEY + 1 + i;
+		ctx[i].unmaps = 0;
+		ctx[i].ret = 0;
+		ret = pthread_create(&ctx[i].thread, NULL, churn_thread,
+				     &ctx[i]);
+		if (ret) {
+			FT_PRINTERR("pthread_create", -ret);
+			nthreads = i;
+			goto join;
+		}
+	}
+
+	ft_start();
+	for (i = 0; i < lookups; i++) {
+		ret = mr_lookup(buf, mr_buf_size, FT_MR_KEY);
+		if (ret) {
+			FT_PRINTERR("fi_mr_regattr", ret);
+			break;
+		}
+	}
+	ft_stop();
+
+join:
+	churn_stop = 1;
+	for (i = 0; i < nthreads; i++) {
+		tret = pthread_join(ctx[i].thread, NULL);
+		if (tret)
+			FT_PRINTERR("pthread_join", -tret);
+		if (!ret)
+			ret = ctx[i].ret;
+		unmaps += ctx[i].unmaps;
+	}
+	if (ret)
+		return ret;
+
+	elapsed = get_elapsed(&start, &end, MICRO);
+	printf("%-10d %-14.0f %-14.0f\n", nthreads,
+	       (double) lookups * 1000000 / elapsed,
+	       (double) unmaps * 1000000 / elapsed);
+	return 0;
+}
+
+static void usage(char *name)
+{
+	ft_unit_usage(name,
+		"Measure memory registration lookups while other threads\n"
+		"map, register and unmap memory a page at a time.  Providers\n"
+		"with an MR cache must apply the resulting invalidations\n"
+		"while the lookups are in progress.");
+	FT_PRINT_OPTS_USAGE("-s <bytes>", "Looked up memory region size.");
+	FT_PRINT_OPTS_USAGE("-n <pages>", "Pages mapped per churn iteration.");
+	FT_PRINT_OPTS_USAGE("-t <threads>", "Number of churn threads.");
+	FT_PRINT_OPTS_USAGE("-I <count>", "Lookups per measurement.");
+}
+
+int main(int argc, char **argv)
+{
+	void *buf = NULL;
+	int ret, op;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return EXIT_FAILURE;
+
+	while ((op = getopt(argc, argv, FAB_OPTS "h" "s:n:t:I:")) != -1) {
+		switch (op) {
+		default:
+			ft_parseinfo(op, optarg, hints, &opts);
+			break;
+		case 's':
+			mr_buf_size = strtoul(optarg, NULL, 10);
+			break;
+		case 'n':
+			churn_pages = strtoul(optarg, NULL, 10);
+			break;
+		case 't':
+			churn_threads = atoi(optarg);
+			break;
+		case 'I':
+			lookups = atoi(optarg);
+			break;
+		case '?':
+		case 'h':
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!mr_buf_size || !churn_pages || lookups <= 0 ||
+	    churn_threads < 0 || churn_threads > MAX_CHURN_THREADS) {
+		ret = -FI_EINVAL;
+		FT_PRINTERR("Invalid option", ret);
+		goto out;
+	}
+
+	hints->mode = ~0;
+	hints->domain_attr->mode = ~0;
+	hints->domain_attr->mr_mode = ~(FI_MR_BASIC | FI_MR_SCALABLE);
+	hints->caps |= FI_MSG | FI_RMA;
+
+	ret = fi_getinfo(FT_FIVERSION, NULL, 0, 0, hints, &fi);
+	if (ret) {
+		hints->caps &= ~FI_RMA;
+		ret = fi_getinfo(FT_FIVERSION, NULL, 0, 0, hints, &fi);
+		if (ret) {
+			FT_PRINTERR("fi_getinfo", ret);
+			goto out;
+		}
+	}
+
+	ret = ft_open_fabric_res();
+	if (ret)
+		goto out;
+
+	buf = malloc(mr_buf_size);
+	if (!buf) {
+		ret = -FI_ENOMEM;
+		goto out;
+	}
+	memset(buf, 0, mr_buf_size);
+
+	printf("Testing MR lookups on fabric %s domain %s\n",
+	       fi->fabric_attr->name, fi->domain_attr->name);
+	printf("%-10s %-14s %-14s\n", "threads", "lookups/sec", "unmaps/sec");
+
+	ret = run_churn(buf, 0);
+	if (!ret && churn_threads)
+		ret = run_churn(buf, churn_threads);
+
+out:
+	free(buf);
+	ft_free_res();
+	return ft_exit_code(ret);
+}
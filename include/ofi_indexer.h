@@ -37,9 +37,68 @@
 
 #include "config.h"
 
+#include <assert.h>
+#include <stdint.h>
 #include <sys/types.h>
 #include <stdbool.h>
 
+#include <ofi_osd.h>
+
+/*
+ * Index tree:
+ * Both the indexer and the index map store their entries in the leaves of
+ * a radix tree.  Each level resolves OFI_IDX_OFFSET_BITS of the index.
+ * The tree starts with a single leaf and gains levels as larger indices
+ * are stored, up to OFI_IDX_MAX_DEPTH levels.
+ *
+ * The root pointer carries the tree height in its low bits, so readers
+ * see the root and height change together.  Nodes are published with
+ * release semantics and are not freed until the structure is reset.
+ * Lookups therefore never block and need no lock, even while a writer
+ * is adding nodes.
+ */
+#ifndef OFI_IDX_MAX_DEPTH
+#define OFI_IDX_MAX_DEPTH 3
+#endif
+
+#define OFI_IDX_OFFSET_BITS 10
+#define OFI_IDX_CHUNK_SIZE (1 << OFI_IDX_OFFSET_BITS)
+#define OFI_IDX_HEIGHT_MASK ((uintptr_t) 0x7)
+
+#if (OFI_IDX_MAX_DEPTH * OFI_IDX_OFFSET_BITS) > 30
+#error "OFI_IDX_MAX_DEPTH exceeds the range of an int index"
+#endif
+
+#define OFI_IDX_MAX_INDEX (1 << (OFI_IDX_MAX_DEPTH * OFI_IDX_OFFSET_BITS))
+
+#define ofi_idx_offset(index) ((index) & (OFI_IDX_CHUNK_SIZE - 1))
+
+void *ofi_idx_tree_leaf(void **root, int index, size_t leaf_size);
+void ofi_idx_tree_free(void **root, void (*callback)(void *leaf, void *arg),
+		       void *arg);
+
+static inline void *ofi_idx_tree_lookup(void **root, int index)
+{
+	uintptr_t tagged;
+	void **node;
+	int level;
+
+	tagged = (uintptr_t) ofi_atomic_load_ptr(root);
+	if (!tagged)
+		return NULL;
+
+	level = (int) (tagged & OFI_IDX_HEIGHT_MASK) - 1;
+	if ((unsigned int) index >> ((level + 1) * OFI_IDX_OFFSET_BITS))
+		return NULL;
+
+	node = (void **) (tagged & ~OFI_IDX_HEIGHT_MASK);
+	for (; level > 0 && node; level--) {
+		node = ofi_atomic_load_ptr(&node[ofi_idx_offset(index >>
+				(level * OFI_IDX_OFFSET_BITS))]);
+	}
+	return node;
+}
+
 /*
  * Indexer:
  * The indexer is used to associate a pointer with an integer value.
@@ -48,12 +107,13 @@
  * indexer to retrieve the stored pointer.  The integer value is selected
  * by the indexer by selecting the first available unused value.
  *
- * The pointers are stored using a double-lookup array, which grows
- * dynamically.  This helps conserve memory when only a few objects are
- * stored in the indexer.
+ * The pointers are stored in an index tree, which grows dynamically.
+ * This helps conserve memory when only a few objects are stored in the
+ * indexer.
  *
- * Synchronization must be provided by the caller.  Caller must
- * initialize the indexer by setting free_list and size to 0.
+ * Insert and remove must be serialized by the caller; lookups may run
+ * concurrently with them.  Caller must initialize the indexer by setting
+ * it to 0.
  */
 
 struct ofi_idx_entry {
@@ -61,26 +121,14 @@ struct ofi_idx_entry {
 	int   next;
 };
 
-/* User's index is a bit field of format: [chunk_id:offset] */
-#define OFI_IDX_CHUNK_BITS 10
-#define OFI_IDX_OFFSET_BITS 10
-
-#define OFI_IDX_CHUNK_SIZE (1 << OFI_IDX_OFFSET_BITS)
-#define OFI_IDX_MAX_CHUNKS (1 << OFI_IDX_CHUNK_BITS)
-
-#define OFI_IDX_MAX_INDEX  (OFI_IDX_MAX_CHUNKS * OFI_IDX_CHUNK_SIZE)
-
 struct indexer
 {
-	struct ofi_idx_entry 	*chunk[OFI_IDX_MAX_CHUNKS];
+	void			*root;
 	int		 	free_list;
-	/* Array size (used): [0, OFI_IDX_MAX_CHUNKS) */
+	/* Number of leaf chunks in use */
 	int		 	size;
 };
 
-#define ofi_idx_chunk_id(index) (index >> OFI_IDX_OFFSET_BITS)
-#define ofi_idx_offset(index) (index & (OFI_IDX_CHUNK_SIZE - 1))
-
 int ofi_idx_insert(struct indexer *idx, void *item);
 void *ofi_idx_remove(struct indexer *idx, int index);
 void *ofi_idx_remove_ordered(struct indexer *idx, int index);
@@ -96,7 +144,7 @@ static inline struct ofi_idx_entry *
 ofi_idx_chunk(struct indexer *idx, int index)
 {
 	assert(ofi_idx_is_valid(idx, index));
-	return idx->chunk[ofi_idx_chunk_id(index)];
+	return ofi_idx_tree_lookup(&idx->root, index);
 }
 
 static inline void *ofi_idx_at(struct indexer *idx, int index)
@@ -120,18 +168,22 @@ static inline bool ofi_idx_free_list_empty(struct indexer *idx)
  * map and indexer, is that the user of the index map selects the index.  This
  * results in the index map behaving the same as a standard array.
  *
- * The index map stores pointers using a double-lookup table.  This minimizes
- * the memory footprint relative to using a standard array when the selected
- * integer values are sparse.
+ * The index map stores pointers in an index tree.  This minimizes the memory
+ * footprint relative to using a standard array when the selected integer
+ * values are sparse.  Clearing an index leaves its leaf in place for the
+ * lookups that may still be reading it, and setting an index in the same
+ * range reuses it, so the map holds the leaves of every index range that
+ * was set until it is reset.
  *
- * Synchronization must be provided by the caller.  Caller must initialize
- * the index map by setting it to 0.
+ * Set and clear are lock-free and may race with each other and with
+ * lookups, provided that concurrent callers use distinct indices.  Reset
+ * must be serialized by the caller.  Caller must initialize the index map
+ * by setting it to 0.
  */
 
 struct index_map
 {
-	void **chunk[OFI_IDX_MAX_CHUNKS];
-	int count[OFI_IDX_MAX_CHUNKS];
+	void *root;
 };
 
 int ofi_idm_set(struct index_map *idm, int index, void *item);
@@ -140,22 +192,24 @@ void ofi_idm_reset(struct index_map *idm, void (*callback)(void *item));
 
 static inline void **ofi_idm_chunk(struct index_map *idm, int index)
 {
-	assert(idm->chunk);
-	return idm->chunk[ofi_idx_chunk_id(index)];
+	return ofi_idx_tree_lookup(&idm->root, index);
 }
 
 static inline void *ofi_idm_at(struct index_map *idm, int index)
 {
 	void **chunk;
 	chunk = ofi_idm_chunk(idm, index);
-	assert(chunk && idm->count[ofi_idx_chunk_id(index)]);
-	return chunk[ofi_idx_offset(index)];
+	assert(chunk);
+	return ofi_atomic_load_ptr(&chunk[ofi_idx_offset(index)]);
 }
 
 static inline void *ofi_idm_lookup(struct index_map *idm, int index)
 {
-	return ((index <= OFI_IDX_MAX_INDEX) && ofi_idm_chunk(idm, index)) ?
-		ofi_idm_at(idm, index) : NULL;
+	void **chunk;
+
+	chunk = ofi_idm_chunk(idm, index);
+	return chunk ? ofi_atomic_load_ptr(&chunk[ofi_idx_offset(index)]) :
+		       NULL;
 }
 
 #endif /* _OFI_INDEXER_H_ */
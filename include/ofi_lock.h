@@ -357,9 +357,6 @@ enum ofi_lock_type {
 	OFI_LOCK_NONE,
 };
 
-typedef int  (*ofi_genlock_lockheld_t)(void *baselock);
-typedef void (*ofi_genlock_lockop_t)(void *baselock);
-
 struct ofi_genlock {
 	enum ofi_lock_type	lock_type;
 	union {
@@ -367,29 +364,54 @@ struct ofi_genlock {
 		ofi_spin_t	spinlock;
 		void		*nolock;
 	} base;
-
-	ofi_genlock_lockheld_t	held;
-	ofi_genlock_lockop_t	lock;
-	ofi_genlock_lockop_t	unlock;
 };
 
 int ofi_genlock_init(struct ofi_genlock *lock,
 		     enum ofi_lock_type lock_type);
 void ofi_genlock_destroy(struct ofi_genlock *lock);
 
+/*
+ * The lock type is fixed at init time, so dispatch inline on it rather than
+ * through function pointers.  Callers pick OFI_LOCK_NOOP or OFI_LOCK_NONE
+ * from the threading model when they need no locking.
+ */
 static inline int ofi_genlock_held(struct ofi_genlock *lock)
 {
-	return lock->held(&lock->base);
+	switch (lock->lock_type) {
+	case OFI_LOCK_NONE:
+		return ofi_nolock_held_op(lock->base.nolock);
+	case OFI_LOCK_NOOP:
+	case OFI_LOCK_MUTEX:
+		return ofi_mutex_held(&lock->base.mutex);
+	default:
+		return ofi_spin_held(&lock->base.spinlock);
+	}
 }
 
 static inline void ofi_genlock_lock(struct ofi_genlock *lock)
 {
-	lock->lock(&lock->base);
+	if (lock->lock_type == OFI_LOCK_NONE)
+		return;
+
+	if (lock->lock_type == OFI_LOCK_NOOP)
+		ofi_mutex_lock_noop(&lock->base.mutex);
+	else if (lock->lock_type == OFI_LOCK_MUTEX)
+		ofi_mutex_lock(&lock->base.mutex);
+	else
+		ofi_spin_lock(&lock->base.spinlock);
 }
 
 static inline void ofi_genlock_unlock(struct ofi_genlock *lock)
 {
-	lock->unlock(&lock->base);
+	if (lock->lock_type == OFI_LOCK_NONE)
+		return;
+
+	if (lock->lock_type == OFI_LOCK_NOOP)
+		ofi_mutex_unlock_noop(&lock->base.mutex);
+	else if (lock->lock_type == OFI_LOCK_MUTEX)
+		ofi_mutex_unlock(&lock->base.mutex);
+	else
+		ofi_spin_unlock(&lock->base.spinlock);
 }
 
 #ifdef __cplusplus
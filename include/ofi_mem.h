@@ -290,6 +290,7 @@ enum {
 	OFI_BUFPOOL_NO_TRACK		= 1 << 2,
 	OFI_BUFPOOL_HUGEPAGES		= 1 << 3,
 	OFI_BUFPOOL_NONSHARED		= 1 << 4,
+	OFI_BUFPOOL_EXTERNAL_MEM	= 1 << 5,
 };
 
 struct ofi_bufpool_region;
@@ -301,6 +302,12 @@ struct ofi_bufpool_attr {
 	size_t 		chunk_cnt;
 	int		(*alloc_fn)(struct ofi_bufpool_region *region);
 	void		(*free_fn)(struct ofi_bufpool_region *region);
+	/* Optional source of region memory.  mem_alloc_fn sets
+	 * region->alloc_region to pool->alloc_size bytes, or fails to have
+	 * the pool allocate the region itself.
+	 */
+	int		(*mem_alloc_fn)(struct ofi_bufpool_region *region);
+	void		(*mem_free_fn)(struct ofi_bufpool_region *region);
 	void		(*init_fn)(struct ofi_bufpool_region *region, void *buf);
 	void 		*context;
 	int		flags;
@@ -371,6 +378,7 @@ ofi_bufpool_create(struct ofi_bufpool **buf_pool,
 void ofi_bufpool_destroy(struct ofi_bufpool *pool);
 
 int ofi_bufpool_grow(struct ofi_bufpool *pool);
+size_t ofi_bufpool_trim(struct ofi_bufpool *pool);
 
 static inline struct ofi_bufpool_hdr *ofi_buf_hdr(void *buf)
 {
@@ -49,6 +49,7 @@
 #include <ofi_list.h>
 #include <ofi_tree.h>
 #include <ofi_hmem.h>
+#include <ofi_signal.h>
 
 
 int ofi_open_mr_cache(uint32_t version, void *attr, size_t attr_len,
@@ -189,10 +190,18 @@ extern struct ofi_mem_monitor *default_ze_monitor;
 /*
  * Userfault fd memory monitor
  */
+#define OFI_UFFD_BATCH 64
+
+struct ofi_uffd_range {
+	uintptr_t			start;
+	uintptr_t			end;
+};
+
 struct ofi_uffd {
 	struct ofi_mem_monitor		monitor;
 	pthread_t			thread;
 	int				fd;
+	struct fd_signal		stop;
 };
 
 extern struct ofi_mem_monitor *uffd_monitor;
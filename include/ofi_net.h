@@ -198,12 +198,15 @@ ofi_byteq_write(struct ofi_byteq *byteq, const void *buf, size_t len)
 void ofi_byteq_writev(struct ofi_byteq *byteq, const struct iovec *iov,
 		      size_t cnt);
 
-static inline ssize_t ofi_byteq_recv(struct ofi_byteq *byteq, SOCKET sock)
+static inline ssize_t
+ofi_byteq_recv(struct ofi_byteq *byteq, SOCKET sock, size_t max)
 {
 	size_t avail;
 	ssize_t ret;
 
 	avail = ofi_byteq_writeable(byteq);
+	if (avail > max)
+		avail = max;
 	assert(avail);
 	ret = ofi_recv_socket(sock, &byteq->data[byteq->tail], avail,
 			      MSG_NOSIGNAL);
@@ -236,12 +239,21 @@ static inline ssize_t ofi_byteq_send(struct ofi_byteq *byteq, SOCKET sock)
 
 /*
  * Buffered socket - socket with send/receive staging buffers.
+ *
+ * Small receives fill rq with up to rx_prefetch bytes, so that several
+ * messages are read per system call.  Receives of at least rx_prefetch
+ * (or half of rq) bytes bypass rq and land in the caller's buffer.
+ * Callers that expect large transfers lower rx_prefetch to avoid pulling
+ * payload into rq that would need to be copied out again.
  */
 struct ofi_bsock {
 	SOCKET sock;
 	struct ofi_byteq sq;
 	struct ofi_byteq rq;
 	size_t zerocopy_size;
+	size_t rx_prefetch;
+	uint64_t rx_bounce_bytes;
+	uint64_t rx_direct_bytes;
 	uint32_t async_index;
 	uint32_t done_index;
 };
@@ -253,6 +265,9 @@ ofi_bsock_init(struct ofi_bsock *bsock, ssize_t sbuf_size, ssize_t rbuf_size)
 	ofi_byteq_init(&bsock->sq, sbuf_size);
 	ofi_byteq_init(&bsock->rq, rbuf_size);
 	bsock->zerocopy_size = SIZE_MAX;
+	bsock->rx_prefetch = bsock->rq.size;
+	bsock->rx_bounce_bytes = 0;
+	bsock->rx_direct_bytes = 0;
 
 	/* first async op will wrap back to 0 as the starting index */
 	bsock->async_index = UINT32_MAX;
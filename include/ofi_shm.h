@@ -361,6 +361,8 @@ void	smr_unmap_from_endpoint(struct smr_region *region, int64_t id);
 void	smr_exchange_all_peers(struct smr_region *region);
 int	smr_map_add(const struct fi_provider *prov,
 		    struct smr_map *map, const char *name, int64_t *id);
+int	smr_map_add_id(const struct fi_provider *prov,
+		       struct smr_map *map, const char *name, int64_t id);
 void	smr_map_del(struct smr_map *map, int64_t id);
 void	smr_map_free(struct smr_map *map);
 
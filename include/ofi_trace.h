@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2026 libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _OFI_TRACE_H_
+#define _OFI_TRACE_H_
+
+#include "config.h"
+
+/*
+ * Statically defined tracepoints (USDT).  A probe compiles to a nop and an
+ * ELF note that bpftrace, perf and systemtap use to attach to it, so the
+ * probes are left enabled in release builds.  Arguments must be integers or
+ * pointers.  They are computed even when no tracer is attached, so pass
+ * values that the surrounding code has at hand.  See contrib/trace for the
+ * list of probes and scripts that use them.
+ */
+#if HAVE_SDT
+#include <sys/sdt.h>
+
+#define OFI_TRACE(name, ...) STAP_PROBEV(libfabric, name, __VA_ARGS__)
+#else
+#define OFI_TRACE(name, ...) do { } while (0)
+#endif
+
+#endif /* _OFI_TRACE_H_ */
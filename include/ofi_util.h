@@ -66,6 +66,7 @@
 #include <ofi_epoll.h>
 #include <ofi_proto.h>
 #include <ofi_bitmask.h>
+#include <ofi_trace.h>
 
 #include "rbtree.h"
 #include "uthash.h"
@@ -193,6 +194,8 @@ int ofi_trywait(struct fid_fabric *fabric, struct fid **fids, int count);
 /*
  * Domain
  */
+#define OFI_TRIGGER_HASH_SIZE	64
+
 struct util_domain {
 	struct fid_domain	domain_fid;
 	struct dlist_entry	list_entry;
@@ -212,6 +215,13 @@ struct util_domain {
 	struct ofi_mr_map	mr_map;
 	enum fi_threading	threading;
 	enum fi_progress	data_progress;
+
+	/* deferred work and triggered operations, see util_trigger.c */
+	ofi_mutex_t		trigger_lock;
+	struct dlist_entry	trigger_list;
+	ofi_atomic32_t		trigger_cnt;
+	struct dlist_entry	trigger_issued[OFI_TRIGGER_HASH_SIZE];
+	ofi_atomic32_t		trigger_issued_cnt[OFI_TRIGGER_HASH_SIZE];
 };
 
 int ofi_domain_init(struct fid_fabric *fabric_fid, const struct fi_info *info,
@@ -301,8 +311,7 @@ struct util_ep {
 	uint64_t		flags;
 	ofi_ep_progress_func	progress;
 	ofi_mutex_t		lock;
-	ofi_mutex_lock_t	lock_acquire;
-	ofi_mutex_unlock_t	lock_release;
+	enum ofi_lock_type	lock_type;
 
 	struct bitmask		*coll_cid_mask;
 	struct slist		coll_ready_queue;
@@ -328,17 +337,23 @@ ofi_ep_fid_bind(struct fid *ep_fid, struct fid *bfid, uint64_t flags)
 
 static inline void ofi_ep_lock_acquire(struct util_ep *ep)
 {
-	ep->lock_acquire(&ep->lock);
+	if (ep->lock_type == OFI_LOCK_NOOP)
+		ofi_mutex_lock_noop(&ep->lock);
+	else
+		ofi_mutex_lock(&ep->lock);
 }
 
 static inline void ofi_ep_lock_release(struct util_ep *ep)
 {
-	ep->lock_release(&ep->lock);
+	if (ep->lock_type == OFI_LOCK_NOOP)
+		ofi_mutex_unlock_noop(&ep->lock);
+	else
+		ofi_mutex_unlock(&ep->lock);
 }
 
 static inline bool ofi_ep_lock_held(struct util_ep *ep)
 {
-	return (ep->lock_acquire == ofi_mutex_lock_noop) ||
+	return (ep->lock_type == OFI_LOCK_NOOP) ||
 		ofi_mutex_held(&ep->lock);
 }
 
@@ -481,6 +496,59 @@ struct util_wait_yield {
 int ofi_wait_yield_open(struct fid_fabric *fabric, struct fi_wait_attr *attr,
 			struct fid_wait **waitset);
 
+/*
+ * Triggered operations and deferred work
+ *
+ * Work is queued on the triggering counter in threshold order.  Counter
+ * updates only mark work as ready; ready work is issued from the CQ and
+ * counter progress functions, where no provider locks are held.  Issued
+ * operations complete through the util CQ, where ofi_trigger_complete()
+ * restores the application context and bumps the completion counter.
+ */
+#define OFI_TRIGGER_IOV_LIMIT	4
+#define OFI_TRIGGER_WAIT_MS	1
+
+int ofi_trigger_queue_work(struct util_domain *domain,
+			   struct fi_deferred_work *work);
+ssize_t ofi_trigger_msg(struct fid_ep *ep, const struct fi_msg *msg,
+			uint64_t flags, enum fi_op_type op_type);
+ssize_t ofi_trigger_tagged(struct fid_ep *ep, const struct fi_msg_tagged *msg,
+			   uint64_t flags, enum fi_op_type op_type);
+ssize_t ofi_trigger_rma(struct fid_ep *ep, const struct fi_msg_rma *msg,
+			uint64_t flags, enum fi_op_type op_type);
+ssize_t ofi_trigger_atomic(struct fid_ep *ep, const struct fi_msg_atomic *msg,
+			   struct fi_ioc *resultv, void **result_desc,
+			   size_t result_count, const struct fi_ioc *comparev,
+			   void **compare_desc, size_t compare_count,
+			   uint64_t flags, enum fi_op_type op_type);
+void ofi_trigger_check(struct util_cntr *cntr);
+void ofi_trigger_progress(struct util_domain *domain);
+bool ofi_trigger_complete(struct util_domain *domain, void **context,
+			  uint64_t err);
+void ofi_trigger_cleanup_cntr(struct util_cntr *cntr);
+void ofi_trigger_cleanup_ep(struct util_ep *ep);
+void ofi_trigger_cleanup_domain(struct util_domain *domain);
+
+static inline bool ofi_trigger_pending(struct util_domain *domain)
+{
+	return ofi_atomic_get32(&domain->trigger_cnt) != 0;
+}
+
+static inline size_t ofi_trigger_hash(const void *context)
+{
+	uintptr_t val = (uintptr_t) context;
+
+	return ((val >> 4) ^ (val >> 10)) & (OFI_TRIGGER_HASH_SIZE - 1);
+}
+
+/* Lock-free check that a completion context may be an issued trigger */
+static inline bool ofi_trigger_issued(struct util_domain *domain,
+				      const void *context)
+{
+	return ofi_atomic_get32(
+		&domain->trigger_issued_cnt[ofi_trigger_hash(context)]) != 0;
+}
+
 /*
  * Completion queue
  *
@@ -554,7 +622,13 @@ static inline void
 ofi_cq_write_entry(struct util_cq *cq, void *context, uint64_t flags,
 		   size_t len, void *buf, uint64_t data, uint64_t tag)
 {
-	struct fi_cq_tagged_entry *comp = ofi_cirque_next(cq->cirq);
+	struct fi_cq_tagged_entry *comp;
+
+	if (OFI_UNLIKELY(ofi_trigger_issued(cq->domain, context)) &&
+	    ofi_trigger_complete(cq->domain, &context, 0))
+		return;
+
+	comp = ofi_cirque_next(cq->cirq);
 	comp->op_context = context;
 	comp->flags = flags;
 	comp->len = len;
@@ -579,6 +653,7 @@ ofi_cq_write(struct util_cq *cq, void *context, uint64_t flags, size_t len,
 {
 	int ret;
 
+	OFI_TRACE(cq_write, cq, context, flags, len);
 	ofi_genlock_lock(&cq->cq_lock);
 	if (ofi_cirque_freecnt(cq->cirq) > 1) {
 		ofi_cq_write_entry(cq, context, flags, len, buf, data, tag);
@@ -597,6 +672,7 @@ ofi_cq_write_src(struct util_cq *cq, void *context, uint64_t flags, size_t len,
 {
 	int ret;
 
+	OFI_TRACE(cq_write, cq, context, flags, len);
 	ofi_genlock_lock(&cq->cq_lock);
 	if (ofi_cirque_freecnt(cq->cirq) > 1) {
 		ofi_cq_write_src_entry(cq, context, flags, len, buf, data,
@@ -644,6 +720,15 @@ static inline uint64_t ofi_tx_cq_flags(uint32_t op)
  */
 typedef void (*ofi_cntr_progress_func)(struct util_cntr *cntr);
 
+#define OFI_CNTR_SHARD_SIZE	64
+#define OFI_CNTR_MAX_SHARDS	64
+
+/* Each shard sits on its own cache line */
+struct util_cntr_shard {
+	ofi_atomic64_t		cnt;
+	uint8_t			pad[OFI_CNTR_SHARD_SIZE - sizeof(ofi_atomic64_t)];
+};
+
 struct util_cntr {
 	struct fid_cntr		cntr_fid;
 	struct util_domain	*domain;
@@ -659,8 +744,21 @@ struct util_cntr {
 	struct dlist_entry	ep_list;
 	ofi_mutex_t		ep_list_lock;
 
+	/* threshold ordered, protected by domain->trigger_lock */
+	struct dlist_entry	trigger_list;
+
 	int			internal_wait;
 	ofi_cntr_progress_func	progress;
+
+	/*
+	 * Sharded mode (FI_CNTR_SHARDS): increments go to a shard picked
+	 * by the calling thread and are folded into cnt when read.  An
+	 * internal wait object is only signaled once the lowest threshold
+	 * passed to fi_cntr_wait may have been reached.
+	 */
+	struct util_cntr_shard	*shards;
+	size_t			shard_mask;
+	ofi_atomic64_t		wait_threshold;
 };
 
 #define OFI_TIMEOUT_QUANTUM_MS 50
@@ -677,6 +775,39 @@ static inline void util_cntr_signal(struct util_cntr *cntr)
 	cntr->wait->signal(cntr->wait);
 }
 
+static inline uint64_t ofi_cntr_value(struct util_cntr *cntr)
+{
+	uint64_t value;
+	size_t i;
+
+	value = ofi_atomic_get64(&cntr->cnt);
+	if (cntr->shards) {
+		for (i = 0; i <= cntr->shard_mask; i++)
+			value += ofi_atomic_get64(&cntr->shards[i].cnt);
+	}
+	return value;
+}
+
+/*
+ * Called by fi_cntr_wait implementations before blocking on the wait
+ * object.  Lowers the value at which a sharded counter signals it.
+ */
+static inline void ofi_cntr_wait_threshold(struct util_cntr *cntr,
+					   uint64_t threshold)
+{
+	int64_t cur;
+
+	if (!cntr->shards)
+		return;
+
+	do {
+		cur = ofi_atomic_get64(&cntr->wait_threshold);
+		if ((uint64_t) cur <= threshold)
+			return;
+	} while (!ofi_atomic_cas_bool64(&cntr->wait_threshold, cur,
+					 (int64_t) threshold));
+}
+
 static inline void ofi_cntr_inc_noop(struct util_cntr *cntr)
 {
 	OFI_UNUSED(cntr);
@@ -717,7 +848,7 @@ struct util_av_set {
 
 struct util_av_entry {
 	ofi_atomic32_t	use_cnt;
-	UT_hash_handle	hh;
+	uint64_t	hash;
 	/*
 	 * data includes 'addr' and any other additional fields
 	 * associated with av_entry. 'addr' must be the first
@@ -727,6 +858,47 @@ struct util_av_entry {
 	char		data[];
 };
 
+/* Open addressing hash of the entries of a private AV.  Each slot has a
+ * control byte holding a fingerprint of the hash of its address, or
+ * marking the slot empty or deleted.  Updated under the AV lock.  A table
+ * replaced when the AV grows is kept on the retired list, for lock-free
+ * lookups, until AV close.
+ */
+struct util_av_index {
+	struct util_av_index	*retired;
+	size_t			size;
+	size_t			cnt;
+	size_t			deleted;
+	uint8_t			*ctrl;
+	struct util_av_entry	**slots;
+};
+
+/* Named AVs are kept in a shm segment, created by the first process to
+ * open the AV and mapped by others opening it with FI_READ.  The segment
+ * holds a header, the fi_addr map returned through fi_av_attr::map_addr,
+ * an open addressing hash of the entries, and the entries themselves.
+ */
+struct util_av_shm_hdr {
+	uint64_t		magic;
+	uint64_t		count;
+	uint64_t		addrlen;
+	uint64_t		entry_size;
+	uint64_t		hash_size;
+	uint64_t		used;
+};
+
+struct util_av_shared {
+	struct util_shm		shm;
+	struct util_av_shm_hdr	*hdr;
+	/* map[i] is i if entry i is valid, FI_ADDR_NOTAVAIL otherwise */
+	fi_addr_t		*map;
+	/* fi_addr + 1 of each entry, 0 if empty, UINT64_MAX if removed */
+	uint64_t		*hash;
+	char			*entries;
+	/* reference counts of the entries, only kept by the creator */
+	uint32_t		*use_cnt;
+};
+
 struct util_av {
 	struct fid_av		av_fid;
 	struct util_domain	*domain;
@@ -735,8 +907,11 @@ struct util_av {
 	ofi_mutex_t		lock;
 	const struct fi_provider *prov;
 
-	struct util_av_entry	*hash;
+	struct util_av_index	*index;
+	/* Odd while an update of the index or of an entry is in progress */
+	uint64_t		index_seq;
 	struct ofi_bufpool	*av_entry_pool;
+	struct util_av_shared	*shared;
 
 	struct util_av_set	*av_set;
 	void			*context;
@@ -752,6 +927,9 @@ struct util_av {
 };
 
 #define OFI_AV_DYN_ADDRLEN (1 << 0)
+/* Provider supports named AVs.  Addresses and context must not
+ * reference process local memory. */
+#define OFI_AV_SHARED (1 << 1)
 
 struct util_av_attr {
 	/* Must be a multiple of 8 bytes */
@@ -824,11 +1002,15 @@ int ofi_av_close(struct util_av *av);
 int ofi_av_close_lightweight(struct util_av *av);
 
 size_t ofi_av_size(struct util_av *av);
+size_t ofi_av_count(struct util_av *av);
+int ofi_av_reserve(struct util_av *av, size_t count);
 int ofi_av_insert_addr(struct util_av *av, const void *addr, fi_addr_t *fi_addr);
 int ofi_av_remove_addr(struct util_av *av, fi_addr_t fi_addr);
 fi_addr_t ofi_av_lookup_fi_addr_unsafe(struct util_av *av, const void *addr);
 fi_addr_t ofi_av_lookup_fi_addr(struct util_av *av, const void *addr);
 int ofi_av_bind(struct fid *av_fid, struct fid *eq_fid, uint64_t flags);
+int ofi_av_elements_iter(struct util_av *av, ofi_av_apply_func apply,
+			 void *arg);
 void ofi_av_write_event(struct util_av *av, uint64_t data,
 			int err, void *context);
 
@@ -1037,6 +1219,8 @@ int ofi_exclude_prov_name(char **prov_name, const char *util_prov_name);
 
 int ofi_shm_map(struct util_shm *shm, const char *name, size_t size,
 		int readonly, void **mapped);
+int ofi_shm_map_flags(struct util_shm *shm, const char *name, size_t size,
+		      int flags, void **mapped);
 int ofi_shm_unmap(struct util_shm *shm);
 
 /*
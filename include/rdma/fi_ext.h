@@ -64,6 +64,7 @@ extern "C" {
 
 #define FI_PROV_SPECIFIC_EFA   (0xefa << 16)
 #define FI_PROV_SPECIFIC_TCP   (0x7cb << 16)
+#define FI_PROV_SPECIFIC_RXM   (0x12a << 16)
 
 
 /* negative options are provider specific */
@@ -71,6 +72,86 @@ enum {
        FI_OPT_EFA_RNR_RETRY = -FI_PROV_SPECIFIC_EFA,
 };
 
+/* -FI_PROV_SPECIFIC_TCP is reserved for internal use */
+enum {
+       FI_OPT_TCP_CONN_STATS = -FI_PROV_SPECIFIC_TCP + 1,
+       FI_OPT_TCP_RX_STATS,
+};
+
+/* Connection cache counters of RDM endpoints emulated over connections,
+ * read with FI_OPT_TCP_CONN_STATS.
+ */
+struct fi_tcp_conn_stats {
+	size_t		open;
+	uint64_t	evictions;
+	uint64_t	reconnects;
+};
+
+/* Received bytes copied out of the socket staging buffer versus placed
+ * directly into posted buffers, read with FI_OPT_TCP_RX_STATS.
+ */
+struct fi_tcp_rx_stats {
+	uint64_t	bounce_bytes;
+	uint64_t	direct_bytes;
+};
+
+enum {
+       FI_OPT_RXM_PROTO_LIMITS = -FI_PROV_SPECIFIC_RXM,
+};
+
+/* Message sizes up to which rxm uses the eager and SAR protocols, larger
+ * sends use rendezvous.  adjustments counts the changes made by
+ * FI_OFI_RXM_AUTO_TUNE.  Read with FI_OPT_RXM_PROTO_LIMITS.
+ */
+struct fi_rxm_proto_limits {
+	size_t		eager_limit;
+	size_t		sar_limit;
+	uint64_t	adjustments;
+};
+
+/* Zero-copy receive on rstream endpoints, opened with fi_open_ops on the
+ * endpoint fid using FI_RSTREAM_OPS.  recv_borrow returns the number of
+ * contiguous bytes readable in place at *buf, or -FI_EAGAIN if none have
+ * arrived.  The bytes stay valid until handed back with recv_release,
+ * which may return fewer bytes than were borrowed.
+ */
+#define FI_RSTREAM_OPS "rstream ops"
+
+struct fi_ops_rstream {
+	size_t	size;
+	ssize_t	(*recv_borrow)(struct fid_ep *ep, void **buf);
+	int	(*recv_release)(struct fid_ep *ep, size_t len);
+};
+
+/* Persistent tagged transfers, opened with fi_open_ops on an RDM endpoint
+ * fid using FI_PERSIST_OPS.  tsend_init and trecv_init take the arguments
+ * of fi_tsend and fi_trecv and return a request that is posted each time
+ * it is passed to start.  Every start generates the completion fi_tsend or
+ * fi_trecv would, with the request context, and a request may be started
+ * again once that completion has been read.  Requests are released with
+ * free before the endpoint is closed.  Freeing a request does not cancel
+ * an operation it already started.
+ */
+#define FI_PERSIST_OPS "persist ops"
+
+struct fi_persist_req {
+	struct fid_ep	*ep;
+	void		*context;
+};
+
+struct fi_ops_persist {
+	size_t	size;
+	int	(*tsend_init)(struct fid_ep *ep, const void *buf, size_t len,
+			      void *desc, fi_addr_t dest_addr, uint64_t tag,
+			      void *context, struct fi_persist_req **req);
+	int	(*trecv_init)(struct fid_ep *ep, void *buf, size_t len,
+			      void *desc, fi_addr_t src_addr, uint64_t tag,
+			      uint64_t ignore, void *context,
+			      struct fi_persist_req **req);
+	ssize_t	(*start)(struct fi_persist_req *req);
+	int	(*free)(struct fi_persist_req *req);
+};
+
 struct fi_fid_export {
 	struct fid **fid;
 	uint64_t flags;
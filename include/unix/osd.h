@@ -90,6 +90,11 @@ struct util_shm
 	size_t		size;
 };
 
+/* ofi_shm_map_flags() flags */
+#define OFI_SHM_CREATE	(1 << 0)	/* create if it does not exist */
+#define OFI_SHM_EXCL	(1 << 1)	/* with CREATE, fail if it exists */
+#define OFI_SHM_RDONLY	(1 << 2)	/* map read-only */
+
 int ofi_mmap_anon_pages(void **memptr, size_t size, int flags);
 int ofi_unmap_anon_pages(void *memptr, size_t size);
 
@@ -253,6 +258,22 @@ OFI_DEF_COMPLEX_OPS(long_double)
 	__sync_bool_compare_and_swap((ptr), (expected), (desired))
 #endif /* HAVE_BUILTIN_ATOMICS */
 
+/* pointer publication */
+#define ofi_atomic_load_ptr(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define ofi_atomic_store_ptr(ptr, val) \
+	__atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define ofi_atomic_cas_ptr(ptr, expected, desired) \
+	__sync_bool_compare_and_swap((ptr), (expected), (desired))
+
+/* 64-bit value publication */
+#define ofi_atomic_load_u64(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define ofi_atomic_store_u64(ptr, val) \
+	__atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+
+/* Ordering for data read or written outside of an atomic */
+#define ofi_atomic_fence_acquire() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define ofi_atomic_fence_release() __atomic_thread_fence(__ATOMIC_RELEASE)
+
 int ofi_set_thread_affinity(const char *s);
 
 
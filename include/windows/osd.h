@@ -243,6 +243,11 @@ struct util_shm
 	size_t		size;
 };
 
+/* ofi_shm_map_flags() flags */
+#define OFI_SHM_CREATE	(1 << 0)	/* create if it does not exist */
+#define OFI_SHM_EXCL	(1 << 1)	/* with CREATE, fail if it exists */
+#define OFI_SHM_RDONLY	(1 << 2)	/* map read-only */
+
 #define FI_FFSL(val)	 			\
 do						\
 {						\
@@ -842,6 +847,8 @@ static inline int ofi_wait_cond(pthread_cond_t *cond, pthread_mutex_t *mut, int
 
 int ofi_shm_map(struct util_shm *shm, const char *name, size_t size,
 				int readonly, void **mapped);
+int ofi_shm_map_flags(struct util_shm *shm, const char *name, size_t size,
+		      int flags, void **mapped);
 
 static inline int ofi_shm_remap(struct util_shm *shm, size_t newsize, void **mapped)
 {
@@ -1028,6 +1035,25 @@ typedef LONGLONG ofi_atomic_int_64_t;
 
 #endif /* HAVE_BUILTIN_ATOMICS */
 
+/* pointer publication */
+#define ofi_atomic_load_ptr(ptr) \
+	InterlockedCompareExchangePointer((PVOID volatile *)(ptr), NULL, NULL)
+#define ofi_atomic_store_ptr(ptr, val) \
+	InterlockedExchangePointer((PVOID volatile *)(ptr), (PVOID)(val))
+#define ofi_atomic_cas_ptr(ptr, expected, desired)			\
+	(InterlockedCompareExchangePointer((PVOID volatile *)(ptr),	\
+		(PVOID)(desired), (PVOID)(expected)) == (PVOID)(expected))
+
+/* 64-bit value publication */
+#define ofi_atomic_load_u64(ptr) \
+	((uint64_t) InterlockedCompareExchange64((LONG64 volatile *)(ptr), 0, 0))
+#define ofi_atomic_store_u64(ptr, val) \
+	InterlockedExchange64((LONG64 volatile *)(ptr), (LONG64)(val))
+
+/* Ordering for data read or written outside of an atomic */
+#define ofi_atomic_fence_acquire() MemoryBarrier()
+#define ofi_atomic_fence_release() MemoryBarrier()
+
 static inline int ofi_set_thread_affinity(const char *s)
 {
 	OFI_UNUSED(s);
@@ -51,8 +51,9 @@ static int efa_cntr_wait(struct fid_cntr *cntr_fid, uint64_t threshold, int time
 	start = (timeout >= 0) ? ofi_gettime_ms() : 0;
 
 	for (tryid = 0; tryid < numtry; ++tryid) {
+		ofi_cntr_wait_threshold(cntr, threshold);
 		cntr->progress(cntr);
-		if (threshold <= ofi_atomic_get64(&cntr->cnt))
+		if (threshold <= ofi_cntr_value(cntr))
 			return FI_SUCCESS;
 
 		if (errcnt != ofi_atomic_get64(&cntr->err))
@@ -84,6 +84,8 @@ extern int xnet_prefetch_rbuf_size;
 extern size_t xnet_default_tx_size;
 extern size_t xnet_default_rx_size;
 extern size_t xnet_zerocopy_size;
+extern size_t xnet_rndv_size;
+extern size_t xnet_max_conns;
 
 struct xnet_xfer_entry;
 struct xnet_ep;
@@ -125,6 +127,7 @@ struct xnet_conn_handle {
 	struct xnet_pep		*pep;
 	SOCKET			sock;
 	bool			endian_match;
+	bool			rndv;
 };
 
 struct xnet_pep {
@@ -188,12 +191,20 @@ struct xnet_ep {
 	OFI_DBG_VAR(uint8_t, rx_id)
 
 	struct dlist_entry	active_entry; /* protected by progress->lock */
+	struct dlist_entry	rts_entry; /* on progress->rts_wait_list */
 	struct slist		rx_queue;
 	struct slist		tx_queue;
 	struct slist		priority_queue;
 	struct slist		need_ack_queue;
 	struct slist		async_queue;
 	struct slist		rma_read_queue;
+	/* rendezvous sends waiting for the peer to read the data */
+	struct slist		need_read_queue;
+	uint64_t		rndv_key;
+	/* unexpected rendezvous headers, in arrival order */
+	struct slist		rts_queue;
+	/* matched rendezvous receives waiting for their data */
+	struct slist		rndv_read_queue;
 	int			rx_avail;
 	struct xnet_srx		*srx;
 
@@ -206,6 +217,10 @@ struct xnet_ep {
 	void (*report_success)(struct xnet_ep *ep, struct util_cq *cq,
 			       struct xnet_xfer_entry *xfer_entry);
 	bool			pollout_set;
+	/* peer shut down its side, finish sending before disabling */
+	bool			rx_shutdown;
+	/* peer accepts rendezvous sends */
+	bool			rndv;
 };
 
 struct xnet_event {
@@ -217,6 +232,8 @@ struct xnet_event {
 
 enum {
 	XNET_CONN_INDEXED = BIT(0),
+	XNET_CONN_EVICTED = BIT(1),
+	XNET_CONN_DRAINING = BIT(2),
 };
 
 struct xnet_conn {
@@ -226,6 +243,8 @@ struct xnet_conn {
 	uint32_t		remote_pid;
 	int			flags;
 	struct dlist_entry	loopback_entry;
+	/* linked on conn_lru while open, drain_list once draining */
+	struct dlist_entry	lru_entry;
 };
 
 struct xnet_rdm {
@@ -237,13 +256,57 @@ struct xnet_rdm {
 	struct index_map	conn_idx_map;
 	struct dlist_entry	loopback_list;
 	union ofi_sock_ip	addr;
+
+	/* connection cache, most recently used first */
+	struct dlist_entry	conn_lru;
+	struct dlist_entry	drain_list;
+	size_t			conn_cnt;
+	uint64_t		evictions;
+	uint64_t		reconnects;
+	/* rx counters of closed connections */
+	struct fi_tcp_rx_stats	rx_stats;
 };
 
+/* A persistent tagged send or receive on an rdm ep.  Sends keep a
+ * reference to the peer, used to find its conn by index.  The tag header,
+ * completion flags and protocol are set when they are created, from the
+ * op flags that the rdm ep passes to all of its conns.
+ */
+struct xnet_persist_req {
+	struct fi_persist_req	persist;
+	struct xnet_rdm		*rdm;
+	struct iovec		iov;
+	void			*desc;
+	fi_addr_t		addr;
+	uint64_t		tag;
+	uint64_t		ignore;
+	bool			send;
+
+	struct util_peer_addr	*peer;
+	struct xnet_tag_hdr	hdr;
+	uint64_t		cq_flags;
+	uint32_t		ctrl_flags;
+	bool			rndv;
+};
+
+ssize_t xnet_persist_tsend(struct xnet_ep *ep, struct xnet_persist_req *req);
+
 int xnet_rdm_ep(struct fid_domain *domain, struct fi_info *info,
 		struct fid_ep **ep_fid, void *context);
 ssize_t xnet_get_conn(struct xnet_rdm *rdm, fi_addr_t dest_addr,
 		      struct xnet_conn **conn);
 void xnet_freeall_conns(struct xnet_rdm *rdm);
+void xnet_rdm_rx_stats(struct xnet_rdm *rdm, struct fi_tcp_rx_stats *stats);
+bool xnet_rdm_peer_closed(struct xnet_ep *ep);
+
+static inline void xnet_touch_conn(struct xnet_conn *conn)
+{
+	if (!dlist_empty(&conn->lru_entry) &&
+	    !(conn->flags & XNET_CONN_DRAINING)) {
+		dlist_remove(&conn->lru_entry);
+		dlist_insert_head(&conn->lru_entry, &conn->rdm->conn_lru);
+	}
+}
 
 struct xnet_progress {
 	struct fid		fid;
@@ -252,6 +315,8 @@ struct xnet_progress {
 	struct ofi_genlock	*active_lock;
 
 	struct dlist_entry	active_wait_list;
+	/* eps with unexpected rendezvous headers, retried on new receives */
+	struct dlist_entry	rts_wait_list;
 	struct fd_signal	signal;
 
 	struct slist		event_list;
@@ -324,6 +389,7 @@ static inline void xnet_signal_progress(struct xnet_progress *progress)
 #define XNET_NEED_DYN_RBUF 	BIT(4)
 #define XNET_ASYNC		BIT(5)
 #define XNET_INJECT_OP		BIT(6)
+#define XNET_NEED_READ		BIT(7)
 #define XNET_MULTI_RECV		FI_MULTI_RECV /* BIT(16) */
 
 struct xnet_xfer_entry {
@@ -458,6 +524,7 @@ void xnet_cntr_incerr(struct xnet_ep *ep, struct xnet_xfer_entry *xfer_entry);
 void xnet_reset_rx(struct xnet_ep *ep);
 
 void xnet_progress_rx(struct xnet_ep *ep);
+void xnet_progress_rts_wait(struct xnet_progress *progress);
 void xnet_progress_async(struct xnet_ep *ep);
 
 void xnet_hdr_none(struct xnet_base_hdr *hdr);
@@ -489,6 +556,13 @@ xnet_set_commit_flags(struct xnet_xfer_entry *xfer, uint64_t flags)
 	}
 }
 
+/* Transfers that wait for an ack are never sent with rendezvous. */
+static inline bool xnet_rndv_eligible(size_t data_len, uint32_t ctrl_flags)
+{
+	return xnet_rndv_size && data_len >= xnet_rndv_size &&
+	       data_len > XNET_MAX_INJECT && !(ctrl_flags & XNET_NEED_ACK);
+}
+
 static inline uint64_t
 xnet_tx_completion_flag(struct xnet_ep *ep, uint64_t op_flags)
 {
@@ -569,6 +643,19 @@ static inline bool xnet_active_wait(struct xnet_ep *ep)
 	       (ep->cur_rx.handler && !ep->cur_rx.entry);
 }
 
+/* A newly posted receive may match an unexpected rendezvous header */
+static inline void xnet_match_rts_wait(struct xnet_progress *progress)
+{
+	assert(xnet_progress_locked(progress));
+	if (!dlist_empty(&progress->rts_wait_list))
+		xnet_progress_rts_wait(progress);
+}
+
+static inline bool xnet_tx_pending(struct xnet_ep *ep)
+{
+	return ep->cur_tx.entry || ofi_bsock_tosend(&ep->bsock);
+}
+
 #define XNET_WARN_ERR(subsystem, log_str, err) \
 	FI_WARN(&xnet_prov, subsystem, log_str "%s (%d)\n", \
 		fi_strerror((int) -(err)), (int) err)
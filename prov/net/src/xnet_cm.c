@@ -155,6 +155,7 @@ void xnet_req_done(struct xnet_ep *ep)
 
 	ep->hdr_bswap = (ep->cm_msg->hdr.conn_data == 1) ?
 			xnet_hdr_none : xnet_hdr_bswap;
+	ep->rndv = !!(ntohl(ep->cm_msg->hdr.seg_no) & XNET_CM_RNDV);
 
 	len = ntohs(ep->cm_msg->hdr.seg_size);
 	cm_entry.fid = &ep->util_ep.ep_fid.fid;
@@ -229,6 +230,7 @@ void xnet_run_conn(struct xnet_conn_handle *conn, bool pin, bool pout, bool perr
 		goto freeinfo;
 
 	conn->endian_match = (msg.hdr.conn_data == 1);
+	conn->rndv = !!(ntohl(msg.hdr.seg_no) & XNET_CM_RNDV);
 	cm_entry.info->handle = &conn->fid;
 	datalen = ntohs(msg.hdr.seg_size);
 	if (datalen)
@@ -82,6 +82,7 @@ static void xnet_cq_progress(struct util_cq *util_cq)
 	struct xnet_cq *cq;
 	cq = container_of(util_cq, struct xnet_cq, util_cq);
 	xnet_run_progress(xnet_cq2_progress(cq), false);
+	ofi_trigger_progress(util_cq->domain);
 }
 
 static int xnet_cq_close(struct fid *fid)
@@ -129,6 +130,7 @@ void xnet_report_success(struct xnet_ep *ep, struct util_cq *cq,
 			 struct xnet_xfer_entry *xfer_entry)
 {
 	uint64_t flags, data, tag;
+	void *buf = NULL;
 	size_t len;
 
 	if (!(xfer_entry->cq_flags & FI_COMPLETION) ||
@@ -140,6 +142,14 @@ void xnet_report_success(struct xnet_ep *ep, struct util_cq *cq,
 		len = xfer_entry->hdr.base_hdr.size -
 		      xfer_entry->hdr.base_hdr.hdr_size;
 		xnet_get_cq_info(xfer_entry, &flags, &data, &tag);
+
+		/* The single iov was truncated to the message and only
+		 * advanced by partial reads, so its end marks the end of
+		 * the data placed in the multi-recv buffer.
+		 */
+		if (xfer_entry->ctrl_flags & XNET_MULTI_RECV)
+			buf = (char *) xfer_entry->iov[0].iov_base +
+			      xfer_entry->iov[0].iov_len - len;
 	} else if (flags & FI_REMOTE_CQ_DATA) {
 		assert(flags & FI_REMOTE_WRITE);
 		len = 0;
@@ -152,7 +162,7 @@ void xnet_report_success(struct xnet_ep *ep, struct util_cq *cq,
 	}
 
 	ofi_cq_write(cq, xfer_entry->context,
-		     flags, len, NULL, data, tag);
+		     flags, len, buf, data, tag);
 	if (cq->wait)
 		cq->wait->signal(cq->wait);
 }
@@ -287,6 +297,7 @@ free_cq:
 static void xnet_cntr_progress(struct util_cntr *cntr)
 {
 	xnet_progress(xnet_cntr2_progress(cntr), false);
+	ofi_trigger_progress(cntr->domain);
 }
 
 static struct util_cntr *
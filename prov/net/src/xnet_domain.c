@@ -150,11 +150,25 @@ static int xnet_domain_close(fid_t fid)
 	return FI_SUCCESS;
 }
 
+static int xnet_domain_ctrl(struct fid *fid, int command, void *arg)
+{
+	struct xnet_domain *domain;
+
+	domain = container_of(fid, struct xnet_domain,
+			      util_domain.domain_fid.fid);
+	switch (command) {
+	case FI_QUEUE_WORK:
+		return ofi_trigger_queue_work(&domain->util_domain, arg);
+	default:
+		return -FI_ENOSYS;
+	}
+}
+
 static struct fi_ops xnet_domain_fi_ops = {
 	.size = sizeof(struct fi_ops),
 	.close = xnet_domain_close,
 	.bind = ofi_domain_bind,
-	.control = fi_no_control,
+	.control = xnet_domain_ctrl,
 	.ops_open = fi_no_ops_open,
 	.tostr = fi_no_tostr,
 	.ops_set = fi_no_ops_set,
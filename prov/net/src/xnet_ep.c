@@ -164,6 +164,7 @@ static int xnet_ep_connect(struct fid_ep *ep_fid, const void *addr,
 	ep->cm_msg->hdr.version = XNET_CTRL_HDR_VERSION;
 	ep->cm_msg->hdr.type = ofi_ctrl_connreq;
 	ep->cm_msg->hdr.conn_data = 1; /* tests endianess mismatch at peer */
+	ep->cm_msg->hdr.seg_no = htonl(XNET_CM_RNDV);
 	if (paramlen) {
 		memcpy(ep->cm_msg->data, param, paramlen);
 		ep->cm_msg->hdr.seg_size = htons((uint16_t) paramlen);
@@ -221,6 +222,7 @@ xnet_ep_accept(struct fid_ep *ep_fid, const void *param, size_t paramlen)
 	ep->cm_msg->hdr.version = XNET_CTRL_HDR_VERSION;
 	ep->cm_msg->hdr.type = ofi_ctrl_connresp;
 	ep->cm_msg->hdr.conn_data = 1; /* tests endianess mismatch at peer */
+	ep->cm_msg->hdr.seg_no = htonl(XNET_CM_RNDV);
 	if (paramlen) {
 		memcpy(ep->cm_msg->data, param, paramlen);
 		ep->cm_msg->hdr.seg_size = htons((uint16_t) paramlen);
@@ -294,6 +296,7 @@ static void xnet_ep_flush_all_queues(struct xnet_ep *ep)
 	xnet_ep_flush_queue(ep, &ep->priority_queue, cq);
 	xnet_ep_flush_queue(ep, &ep->rma_read_queue, cq);
 	xnet_ep_flush_queue(ep, &ep->need_ack_queue, cq);
+	xnet_ep_flush_queue(ep, &ep->need_read_queue, cq);
 	xnet_ep_flush_queue(ep, &ep->async_queue, cq);
 
 	cq = container_of(ep->util_ep.rx_cq, struct xnet_cq, util_cq);
@@ -304,6 +307,9 @@ static void xnet_ep_flush_all_queues(struct xnet_ep *ep)
 	}
 	xnet_reset_rx(ep);
 	xnet_ep_flush_queue(ep, &ep->rx_queue, cq);
+	xnet_ep_flush_queue(ep, &ep->rndv_read_queue, cq);
+	dlist_remove_init(&ep->rts_entry);
+	xnet_ep_flush_queue(ep, &ep->rts_queue, cq);
 	ofi_bsock_discard(&ep->bsock);
 }
 
@@ -568,6 +574,10 @@ static struct fi_ops xnet_ep_fi_ops = {
 static int xnet_ep_getopt(fid_t fid, int level, int optname,
 			  void *optval, size_t *optlen)
 {
+	struct fi_tcp_rx_stats *stats;
+	struct xnet_progress *progress;
+	struct xnet_ep *ep;
+
 	if (level != FI_OPT_ENDPOINT)
 		return -ENOPROTOOPT;
 
@@ -580,6 +590,20 @@ static int xnet_ep_getopt(fid_t fid, int level, int optname,
 		*((size_t *) optval) = XNET_MAX_CM_DATA_SIZE;
 		*optlen = sizeof(size_t);
 		break;
+	case FI_OPT_TCP_RX_STATS:
+		if (*optlen < sizeof(struct fi_tcp_rx_stats)) {
+			*optlen = sizeof(struct fi_tcp_rx_stats);
+			return -FI_ETOOSMALL;
+		}
+		ep = container_of(fid, struct xnet_ep, util_ep.ep_fid.fid);
+		progress = xnet_ep2_progress(ep);
+		stats = optval;
+		ofi_genlock_lock(&progress->lock);
+		stats->bounce_bytes = ep->bsock.rx_bounce_bytes;
+		stats->direct_bytes = ep->bsock.rx_direct_bytes;
+		ofi_genlock_unlock(&progress->lock);
+		*optlen = sizeof(struct fi_tcp_rx_stats);
+		break;
 	default:
 		return -FI_ENOPROTOOPT;
 	}
@@ -638,6 +662,7 @@ int xnet_endpoint(struct fid_domain *domain, struct fi_info *info,
 			conn->sock = INVALID_SOCKET;
 			ep->hdr_bswap = conn->endian_match ?
 					xnet_hdr_none : xnet_hdr_bswap;
+			ep->rndv = conn->rndv;
 			/* Save handle, but we only free if user calls accept.
 			 * Otherwise, user will call reject, which will free it.
 			 */
@@ -684,10 +709,14 @@ int xnet_endpoint(struct fid_domain *domain, struct fi_info *info,
 	}
 
 	dlist_init(&ep->active_entry);
+	dlist_init(&ep->rts_entry);
 	slist_init(&ep->rx_queue);
 	slist_init(&ep->tx_queue);
 	slist_init(&ep->priority_queue);
 	slist_init(&ep->rma_read_queue);
+	slist_init(&ep->need_read_queue);
+	slist_init(&ep->rts_queue);
+	slist_init(&ep->rndv_read_queue);
 	slist_init(&ep->need_ack_queue);
 	slist_init(&ep->async_queue);
 
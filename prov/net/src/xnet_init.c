@@ -59,6 +59,8 @@ int xnet_prefetch_rbuf_size = 9000;
 size_t xnet_default_tx_size = 256;
 size_t xnet_default_rx_size = 256;
 size_t xnet_zerocopy_size = SIZE_MAX;
+size_t xnet_rndv_size;
+size_t xnet_max_conns;
 
 
 static void xnet_init_env(void)
@@ -121,6 +123,21 @@ static void xnet_init_env(void)
 	fi_param_get_int(&xnet_prov, "prefetch_rbuf_size",
 			 &xnet_prefetch_rbuf_size);
 	fi_param_get_size_t(&xnet_prov, "zerocopy_size", &xnet_zerocopy_size);
+
+	fi_param_define(&xnet_prov, "rndv_size", FI_PARAM_SIZE_T,
+			"messages at or above this size are sent using a "
+			"rendezvous protocol, where the receiver pulls the "
+			"data once a matching receive is posted.  Only used "
+			"with peers that support it, 0 disables (default: "
+			"%zu)", xnet_rndv_size);
+	fi_param_get_size_t(&xnet_prov, "rndv_size", &xnet_rndv_size);
+
+	fi_param_define(&xnet_prov, "max_conns", FI_PARAM_SIZE_T,
+			"maximum number of connections kept open by an rdm "
+			"endpoint.  Once reached, idle connections are closed "
+			"least recently used first and reopened on demand, "
+			"set to 0 for no limit (default: %zu)", xnet_max_conns);
+	fi_param_get_size_t(&xnet_prov, "max_conns", &xnet_max_conns);
 }
 
 static void xnet_fini(void)
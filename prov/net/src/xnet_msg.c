@@ -139,6 +139,42 @@ xnet_init_tx_iov(struct xnet_xfer_entry *tx_entry, size_t hdr_len,
 	}
 }
 
+/* Large messages send a header describing the payload and wait for the
+ * peer to read the data once it has a matching receive posted.  The data
+ * iov's are left in place behind the header iov for the read response.
+ * The payload is sent from the buffer in place, so nothing is registered.
+ */
+static inline void xnet_set_tx_rndv(struct xnet_xfer_entry *tx_entry)
+{
+	struct ofi_rma_iov *rma_iov;
+	size_t hdr_len, data_len;
+
+	hdr_len = tx_entry->hdr.base_hdr.hdr_size;
+	data_len = tx_entry->hdr.base_hdr.size - hdr_len;
+	rma_iov = (struct ofi_rma_iov *) ((uint8_t *) &tx_entry->hdr + hdr_len);
+	rma_iov->addr = 0;
+	rma_iov->len = data_len;
+	rma_iov->key = tx_entry->ep->rndv_key++;
+
+	hdr_len += sizeof(*rma_iov);
+	xnet_init_tx_sizes(tx_entry, hdr_len, 0);
+	tx_entry->hdr.base_hdr.flags |= XNET_RNDV;
+	tx_entry->iov[0].iov_len = hdr_len;
+	tx_entry->iov_cnt = 1;
+	tx_entry->ctrl_flags |= XNET_NEED_READ;
+}
+
+static inline void xnet_init_tx_rndv(struct xnet_xfer_entry *tx_entry)
+{
+	size_t data_len;
+
+	data_len = tx_entry->hdr.base_hdr.size -
+		   tx_entry->hdr.base_hdr.hdr_size;
+	if (tx_entry->ep->rndv &&
+	    xnet_rndv_eligible(data_len, tx_entry->ctrl_flags))
+		xnet_set_tx_rndv(tx_entry);
+}
+
 static inline bool
 xnet_queue_recv(struct xnet_ep *ep, struct xnet_xfer_entry *recv_entry)
 {
@@ -149,6 +185,7 @@ xnet_queue_recv(struct xnet_ep *ep, struct xnet_xfer_entry *recv_entry)
 	if (ret) {
 		slist_insert_tail(&recv_entry->entry, &ep->rx_queue);
 		ep->rx_avail--;
+		xnet_match_rts_wait(xnet_ep2_progress(ep));
 	}
 	return ret;
 }
@@ -285,6 +322,7 @@ xnet_sendmsg(struct fid_ep *ep_fid, const struct fi_msg *msg, uint64_t flags)
 	tx_entry->cq_flags = xnet_tx_completion_flag(ep, flags) |
 			     FI_MSG | FI_SEND;
 	xnet_set_ack_flags(tx_entry, flags);
+	xnet_init_tx_rndv(tx_entry);
 	tx_entry->context = msg->context;
 
 	xnet_tx_queue_insert(ep, tx_entry);
@@ -315,6 +353,7 @@ xnet_send(struct fid_ep *ep_fid, const void *buf, size_t len,
 	tx_entry->cq_flags = xnet_tx_completion_flag(ep, 0) |
 			     FI_MSG | FI_SEND;
 	xnet_set_ack_flags(tx_entry, ep->util_ep.tx_op_flags);
+	xnet_init_tx_rndv(tx_entry);
 
 	xnet_tx_queue_insert(ep, tx_entry);
 unlock:
@@ -344,6 +383,7 @@ xnet_sendv(struct fid_ep *ep_fid, const struct iovec *iov,
 	tx_entry->cq_flags = xnet_tx_completion_flag(ep, 0) |
 			     FI_MSG | FI_SEND;
 	xnet_set_ack_flags(tx_entry, ep->util_ep.tx_op_flags);
+	xnet_init_tx_rndv(tx_entry);
 
 	xnet_tx_queue_insert(ep, tx_entry);
 unlock:
@@ -407,6 +447,7 @@ xnet_senddata(struct fid_ep *ep_fid, const void *buf, size_t len,
 	tx_entry->cq_flags = xnet_tx_completion_flag(ep, 0) |
 			     FI_MSG | FI_SEND;
 	xnet_set_ack_flags(tx_entry, ep->util_ep.tx_op_flags);
+	xnet_init_tx_rndv(tx_entry);
 
 	xnet_tx_queue_insert(ep, tx_entry);
 unlock:
@@ -490,6 +531,7 @@ xnet_tsendmsg(struct fid_ep *fid_ep, const struct fi_msg_tagged *msg,
 	tx_entry->cq_flags = xnet_tx_completion_flag(ep, flags) |
 			     FI_TAGGED | FI_SEND;
 	xnet_set_ack_flags(tx_entry, flags);
+	xnet_init_tx_rndv(tx_entry);
 	tx_entry->context = msg->context;
 
 	xnet_tx_queue_insert(ep, tx_entry);
@@ -522,6 +564,40 @@ xnet_tsend(struct fid_ep *fid_ep, const void *buf, size_t len,
 	tx_entry->cq_flags = xnet_tx_completion_flag(ep, 0) |
 			     FI_TAGGED | FI_SEND;
 	xnet_set_ack_flags(tx_entry, ep->util_ep.tx_op_flags);
+	xnet_init_tx_rndv(tx_entry);
+
+	xnet_tx_queue_insert(ep, tx_entry);
+unlock:
+	ofi_genlock_unlock(&xnet_ep2_progress(ep)->lock);
+	return ret;
+}
+
+/* The tag header, the completion flags and whether the message may use
+ * rendezvous were set when the persistent request was created.  Only
+ * whether the peer supports rendezvous is checked here, as it depends on
+ * the conn.
+ */
+ssize_t xnet_persist_tsend(struct xnet_ep *ep, struct xnet_persist_req *req)
+{
+	struct xnet_xfer_entry *tx_entry;
+	ssize_t ret = 0;
+
+	ofi_genlock_lock(&xnet_ep2_progress(ep)->lock);
+	tx_entry = xnet_alloc_tx(ep);
+	if (!tx_entry) {
+		ret = -FI_EAGAIN;
+		goto unlock;
+	}
+
+	assert(ep->srx);
+	memcpy(&tx_entry->hdr.tag_hdr, &req->hdr, sizeof(req->hdr));
+	xnet_init_tx_buf(tx_entry, sizeof(req->hdr), req->iov.iov_base,
+			 req->iov.iov_len);
+	tx_entry->context = req->persist.context;
+	tx_entry->cq_flags = req->cq_flags;
+	tx_entry->ctrl_flags = req->ctrl_flags;
+	if (req->rndv && ep->rndv)
+		xnet_set_tx_rndv(tx_entry);
 
 	xnet_tx_queue_insert(ep, tx_entry);
 unlock:
@@ -553,6 +629,7 @@ xnet_tsendv(struct fid_ep *fid_ep, const struct iovec *iov, void **desc,
 	tx_entry->cq_flags = xnet_tx_completion_flag(ep, 0) |
 			     FI_TAGGED | FI_SEND;
 	xnet_set_ack_flags(tx_entry, ep->util_ep.tx_op_flags);
+	xnet_init_tx_rndv(tx_entry);
 
 	xnet_tx_queue_insert(ep, tx_entry);
 unlock:
@@ -617,6 +694,7 @@ xnet_tsenddata(struct fid_ep *fid_ep, const void *buf, size_t len, void *desc,
 	tx_entry->cq_flags = xnet_tx_completion_flag(ep, 0) |
 			     FI_TAGGED | FI_SEND;
 	xnet_set_ack_flags(tx_entry, ep->util_ep.tx_op_flags);
+	xnet_init_tx_rndv(tx_entry);
 
 	xnet_tx_queue_insert(ep, tx_entry);
 unlock:
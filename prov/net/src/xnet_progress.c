@@ -118,12 +118,19 @@ static void xnet_progress_tx(struct xnet_ep *ep)
 
 		tx_entry = ep->cur_tx.entry;
 		cq = container_of(ep->util_ep.tx_cq, struct xnet_cq, util_cq);
+		OFI_TRACE(xnet_tx_done, ep, tx_entry, ret);
 
 		if (ret) {
 			FI_WARN(&xnet_prov, FI_LOG_DOMAIN, "msg send failed\n");
 			xnet_cntr_incerr(ep, tx_entry);
 			xnet_cq_report_error(&cq->util_cq, tx_entry, (int) -ret);
 			xnet_free_xfer(ep, tx_entry);
+		} else if (tx_entry->ctrl_flags & XNET_NEED_READ) {
+			/* Rendezvous header sent, the peer pulls the data.
+			 * Later transfers do not wait for it.
+			 */
+			slist_insert_tail(&tx_entry->entry,
+					  &ep->need_read_queue);
 		} else if (tx_entry->ctrl_flags & XNET_NEED_ACK) {
 			/* A SW ack guarantees the peer received the data, so
 			 * we can skip the async completion.
@@ -149,7 +156,8 @@ static void xnet_progress_tx(struct xnet_ep *ep)
 			ep->cur_tx.entry = container_of(slist_remove_head(
 							&ep->priority_queue),
 					     struct xnet_xfer_entry, entry);
-			assert(ep->cur_tx.entry->ctrl_flags & XNET_INTERNAL_XFER);
+			assert((ep->cur_tx.entry->ctrl_flags & XNET_INTERNAL_XFER) ||
+			       (ep->cur_tx.entry->hdr.base_hdr.flags & XNET_RNDV));
 		} else if (!slist_empty(&ep->tx_queue)) {
 			ep->cur_tx.entry = container_of(slist_remove_head(
 							&ep->tx_queue),
@@ -170,7 +178,10 @@ static void xnet_progress_tx(struct xnet_ep *ep)
 	 */
 	(void) ofi_bsock_flush(&ep->bsock);
 update:
-	xnet_update_poll(ep);
+	if (ep->rx_shutdown && !xnet_tx_pending(ep))
+		xnet_ep_disable(ep, 0, NULL, 0);
+	else
+		xnet_update_poll(ep);
 }
 
 static int xnet_queue_ack(struct xnet_xfer_entry *rx_entry)
@@ -411,6 +422,171 @@ static int xnet_handle_ack(struct xnet_ep *ep)
 	return FI_SUCCESS;
 }
 
+/* Match the oldest unexpected rendezvous header against the posted
+ * receives.  On a match, the header entry is reused to send a read
+ * request for the payload, and the receive waits on rndv_read_queue.
+ */
+static ssize_t xnet_match_rts(struct xnet_ep *ep, struct xnet_xfer_entry *rts)
+{
+	struct xnet_xfer_entry *rx_entry;
+	struct ofi_rma_iov *rma_iov;
+	size_t hdr_size, msg_len;
+	uint64_t tag, key;
+	ssize_t ret;
+
+	assert(xnet_progress_locked(xnet_ep2_progress(ep)));
+	hdr_size = rts->hdr.base_hdr.hdr_size;
+	rma_iov = (struct ofi_rma_iov *) ((uint8_t *) &rts->hdr + hdr_size -
+					  sizeof(*rma_iov));
+	msg_len = rma_iov->len;
+	key = rma_iov->key;
+
+	if (rts->hdr.base_hdr.op == ofi_op_tagged) {
+		assert(ep->srx);
+		tag = (rts->hdr.base_hdr.flags & XNET_REMOTE_CQ_DATA) ?
+		      rts->hdr.tag_data_hdr.tag : rts->hdr.tag_hdr.tag;
+
+		rx_entry = ep->srx->match_tag_rx(ep->srx, ep, tag);
+		if (!rx_entry)
+			return -FI_EAGAIN;
+
+		rx_entry->cq_flags |= xnet_rx_completion_flag(ep, 0);
+	} else {
+		rx_entry = xnet_get_rx_entry(ep);
+		if (!rx_entry)
+			return -FI_EAGAIN;
+	}
+
+	memcpy(&rx_entry->hdr, &rts->hdr, hdr_size);
+	rx_entry->hdr.base_hdr.size = hdr_size + msg_len;
+	rx_entry->ep = ep;
+
+	if (rx_entry->ctrl_flags & XNET_MULTI_RECV) {
+		ret = xnet_alter_mrecv(ep, rx_entry, msg_len);
+		if (ret)
+			goto truncate_err;
+	}
+
+	ret = ofi_truncate_iov(rx_entry->iov, &rx_entry->iov_cnt, msg_len);
+	if (ret)
+		goto truncate_err;
+
+	slist_remove_head(&ep->rts_queue);
+	slist_insert_tail(&rx_entry->entry, &ep->rndv_read_queue);
+
+	rma_iov = (struct ofi_rma_iov *) ((uint8_t *) &rts->hdr +
+					  sizeof(rts->hdr.base_hdr));
+	rma_iov->addr = 0;
+	rma_iov->len = msg_len;
+	rma_iov->key = key;
+
+	rts->hdr.base_hdr.version = XNET_HDR_VERSION;
+	rts->hdr.base_hdr.op = ofi_op_read_req;
+	rts->hdr.base_hdr.flags = XNET_RNDV;
+	rts->hdr.base_hdr.op_data = 0;
+	rts->hdr.base_hdr.rma_iov_cnt = 1;
+	rts->hdr.base_hdr.hdr_size = (uint8_t) (sizeof(rts->hdr.base_hdr) +
+						sizeof(*rma_iov));
+	rts->hdr.base_hdr.size = rts->hdr.base_hdr.hdr_size;
+
+	rts->iov[0].iov_base = (void *) &rts->hdr;
+	rts->iov[0].iov_len = rts->hdr.base_hdr.hdr_size;
+	rts->iov_cnt = 1;
+
+	xnet_tx_queue_insert(ep, rts);
+	return FI_SUCCESS;
+
+truncate_err:
+	FI_WARN(&xnet_prov, FI_LOG_EP_DATA,
+		"posted rx buffer size is not big enough\n");
+	xnet_cntr_incerr(ep, rx_entry);
+	xnet_cq_report_error(rx_entry->ep->util_ep.rx_cq, rx_entry, (int) -ret);
+	xnet_free_xfer(ep, rx_entry);
+	return ret;
+}
+
+static ssize_t xnet_progress_rts(struct xnet_ep *ep)
+{
+	struct xnet_progress *progress;
+	struct xnet_xfer_entry *rts;
+	ssize_t ret;
+
+	progress = xnet_ep2_progress(ep);
+	assert(xnet_progress_locked(progress));
+	while (!slist_empty(&ep->rts_queue)) {
+		rts = container_of(ep->rts_queue.head, struct xnet_xfer_entry,
+				   entry);
+		ret = xnet_match_rts(ep, rts);
+		if (ret == -FI_EAGAIN) {
+			if (dlist_empty(&ep->rts_entry))
+				dlist_insert_tail(&ep->rts_entry,
+						  &progress->rts_wait_list);
+			return FI_SUCCESS;
+		} else if (ret) {
+			return ret;
+		}
+	}
+	dlist_remove_init(&ep->rts_entry);
+	return FI_SUCCESS;
+}
+
+void xnet_progress_rts_wait(struct xnet_progress *progress)
+{
+	struct dlist_entry *item, *tmp;
+	struct xnet_ep *ep;
+
+	assert(xnet_progress_locked(progress));
+	dlist_foreach_safe(&progress->rts_wait_list, item, tmp) {
+		ep = container_of(item, struct xnet_ep, rts_entry);
+		if (xnet_progress_rts(ep))
+			xnet_ep_disable(ep, 0, NULL, 0);
+	}
+}
+
+/* Unexpected rendezvous headers are queued so that the stream keeps
+ * moving: read requests and responses, acks and RMA get past them.  A
+ * later message waits for the header to be matched, see
+ * xnet_rts_pending().  The ep is retried when a receive is posted,
+ * rather than polled.
+ */
+static ssize_t xnet_queue_rts(struct xnet_ep *ep)
+{
+	struct xnet_xfer_entry *rts;
+	size_t hdr_size;
+
+	assert(xnet_progress_locked(xnet_ep2_progress(ep)));
+	hdr_size = ep->cur_rx.hdr.base_hdr.hdr_size;
+	if (ep->cur_rx.data_left ||
+	    hdr_size < sizeof(ep->cur_rx.hdr.base_hdr) +
+		       sizeof(struct ofi_rma_iov)) {
+		FI_WARN(&xnet_prov, FI_LOG_EP_DATA,
+			"invalid rendezvous header received\n");
+		return -FI_EIO;
+	}
+
+	rts = xnet_alloc_xfer(xnet_ep2_progress(ep));
+	if (!rts)
+		return -FI_ENOMEM;
+
+	memcpy(&rts->hdr, &ep->cur_rx.hdr, hdr_size);
+	rts->ep = ep;
+	rts->ctrl_flags = XNET_INTERNAL_XFER;
+	rts->context = NULL;
+	slist_insert_tail(&rts->entry, &ep->rts_queue);
+	xnet_reset_rx(ep);
+
+	return xnet_progress_rts(ep);
+}
+
+/* Messages are matched in the order they were sent.  One that follows an
+ * unmatched rendezvous header waits for a receive for the header, as it
+ * would if it were the unexpected message itself.
+ */
+static inline bool xnet_rts_pending(struct xnet_ep *ep)
+{
+	return !slist_empty(&ep->rts_queue);
+}
+
 static ssize_t xnet_op_msg(struct xnet_ep *ep)
 {
 	struct xnet_xfer_entry *rx_entry;
@@ -422,6 +598,12 @@ static ssize_t xnet_op_msg(struct xnet_ep *ep)
 	if (msg->hdr.base_hdr.op_data == XNET_OP_ACK)
 		return xnet_handle_ack(ep);
 
+	if (msg->hdr.base_hdr.flags & XNET_RNDV)
+		return xnet_queue_rts(ep);
+
+	if (xnet_rts_pending(ep))
+		return -FI_EAGAIN;
+
 	msg_len = (msg->hdr.base_hdr.size - msg->hdr.base_hdr.hdr_size);
 
 	rx_entry = xnet_get_rx_entry(ep);
@@ -466,6 +648,12 @@ static ssize_t xnet_op_tagged(struct xnet_ep *ep)
 
 	assert(xnet_progress_locked(xnet_ep2_progress(ep)));
 	assert(ep->srx);
+	if (msg->hdr.base_hdr.flags & XNET_RNDV)
+		return xnet_queue_rts(ep);
+
+	if (xnet_rts_pending(ep))
+		return -FI_EAGAIN;
+
 	msg_len = (msg->hdr.base_hdr.size - msg->hdr.base_hdr.hdr_size);
 
 	tag = (msg->hdr.base_hdr.flags & XNET_REMOTE_CQ_DATA) ?
@@ -497,6 +685,76 @@ truncate_err:
 	return ret;
 }
 
+static int xnet_match_read_key(struct slist_entry *item, const void *arg)
+{
+	struct xnet_xfer_entry *tx_entry;
+	struct ofi_rma_iov *rma_iov;
+
+	tx_entry = container_of(item, struct xnet_xfer_entry, entry);
+	rma_iov = (struct ofi_rma_iov *) ((uint8_t *) &tx_entry->hdr +
+					  tx_entry->hdr.base_hdr.hdr_size -
+					  sizeof(*rma_iov));
+	return rma_iov->key == *(const uint64_t *) arg;
+}
+
+/* The peer matched one of our rendezvous sends.  Reply with the data
+ * iov's that were left in place behind the header.
+ */
+static ssize_t xnet_op_rndv_read_req(struct xnet_ep *ep)
+{
+	struct xnet_xfer_entry *tx_entry;
+	struct slist_entry *item;
+	struct ofi_rma_iov *rma_iov;
+	size_t len, i;
+
+	assert(xnet_progress_locked(xnet_ep2_progress(ep)));
+	rma_iov = (struct ofi_rma_iov *) ((uint8_t *) &ep->cur_rx.hdr +
+					  sizeof(ep->cur_rx.hdr.base_hdr));
+	item = slist_remove_first_match(&ep->need_read_queue,
+					xnet_match_read_key, &rma_iov->key);
+	if (!item) {
+		FI_WARN(&xnet_prov, FI_LOG_EP_DATA,
+			"unknown rendezvous read request\n");
+		return -FI_EIO;
+	}
+
+	tx_entry = container_of(item, struct xnet_xfer_entry, entry);
+	for (i = 1, len = 0; len < rma_iov->len && i <= XNET_IOV_LIMIT; i++)
+		len += tx_entry->iov[i].iov_len;
+
+	if (len != rma_iov->len) {
+		FI_WARN(&xnet_prov, FI_LOG_EP_DATA,
+			"invalid rendezvous read length\n");
+		xnet_cntr_incerr(ep, tx_entry);
+		xnet_cq_report_error(ep->util_ep.tx_cq, tx_entry, FI_EIO);
+		xnet_free_xfer(ep, tx_entry);
+		return -FI_EIO;
+	}
+
+	tx_entry->hdr.base_hdr.op = ofi_op_read_rsp;
+	tx_entry->hdr.base_hdr.flags = XNET_RNDV;
+	tx_entry->hdr.base_hdr.op_data = 0;
+	tx_entry->hdr.base_hdr.rma_iov_cnt = 0;
+	tx_entry->hdr.base_hdr.hdr_size = (uint8_t)
+					  sizeof(tx_entry->hdr.base_hdr);
+	tx_entry->hdr.base_hdr.size = sizeof(tx_entry->hdr.base_hdr) + len;
+
+	tx_entry->iov[0].iov_base = (void *) &tx_entry->hdr;
+	tx_entry->iov[0].iov_len = sizeof(tx_entry->hdr.base_hdr);
+	tx_entry->iov_cnt = i;
+	tx_entry->ctrl_flags &= ~(XNET_NEED_READ | XNET_ASYNC);
+
+	/* The receive is waiting on the data, so send it ahead of queued
+	 * sends.  The peer expects the data in the order it asked for it.
+	 */
+	if (ep->cur_tx.entry)
+		slist_insert_tail(&tx_entry->entry, &ep->priority_queue);
+	else
+		xnet_tx_queue_insert(ep, tx_entry);
+	xnet_reset_rx(ep);
+	return FI_SUCCESS;
+}
+
 static ssize_t xnet_op_read_req(struct xnet_ep *ep)
 {
 	struct xnet_xfer_entry *resp;
@@ -504,6 +762,9 @@ static ssize_t xnet_op_read_req(struct xnet_ep *ep)
 	ssize_t i, ret;
 
 	assert(xnet_progress_locked(xnet_ep2_progress(ep)));
+	if (ep->cur_rx.hdr.base_hdr.flags & XNET_RNDV)
+		return xnet_op_rndv_read_req(ep);
+
 	resp = xnet_alloc_xfer(xnet_ep2_progress(ep));
 	if (!resp)
 		return -FI_ENOMEM;
@@ -597,12 +858,32 @@ static ssize_t xnet_op_write(struct xnet_ep *ep)
 	return xnet_process_remote_write(ep);
 }
 
+/* Rendezvous data arrives in the order the read requests were sent */
+static ssize_t xnet_op_rndv_read_rsp(struct xnet_ep *ep)
+{
+	struct xnet_xfer_entry *rx_entry;
+
+	assert(xnet_progress_locked(xnet_ep2_progress(ep)));
+	if (slist_empty(&ep->rndv_read_queue))
+		return -FI_EINVAL;
+
+	rx_entry = container_of(slist_remove_head(&ep->rndv_read_queue),
+				struct xnet_xfer_entry, entry);
+
+	ep->cur_rx.entry = rx_entry;
+	ep->cur_rx.handler = xnet_process_recv;
+	return xnet_process_recv(ep);
+}
+
 static ssize_t xnet_op_read_rsp(struct xnet_ep *ep)
 {
 	struct xnet_xfer_entry *rx_entry;
 	struct slist_entry *entry;
 
 	assert(xnet_progress_locked(xnet_ep2_progress(ep)));
+	if (ep->cur_rx.hdr.base_hdr.flags & XNET_RNDV)
+		return xnet_op_rndv_read_rsp(ep);
+
 	if (slist_empty(&ep->rma_read_queue))
 		return -FI_EINVAL;
 
@@ -662,15 +943,51 @@ next_hdr:
 	ep->cur_rx.data_left = ep->cur_rx.hdr.base_hdr.size -
 			       ep->cur_rx.hdr.base_hdr.hdr_size;
 	ep->cur_rx.handler = xnet_start_op[ep->cur_rx.hdr.base_hdr.op];
+	OFI_TRACE(xnet_recv_hdr, ep, ep->cur_rx.hdr.base_hdr.op,
+		  ep->cur_rx.hdr.base_hdr.size);
+
+	/* While large payloads arrive, only prefetch the next header, so
+	 * that the payload following it is read straight into the posted
+	 * buffers instead of being copied out of the staging buffer.
+	 */
+	if (ep->cur_rx.data_left >= (ep->bsock.rq.size >> 1))
+		ep->bsock.rx_prefetch = XNET_MAX_HDR;
+	else
+		ep->bsock.rx_prefetch = ep->bsock.rq.size;
 
 	return ep->cur_rx.handler(ep);
 }
 
+/* An RDM peer shuts down its side of an idle connection to evict it from
+ * its connection cache, but keeps reading until we close ours.  Finish
+ * sending anything we have queued before disabling the ep.
+ */
+static bool xnet_drain_tx(struct xnet_ep *ep)
+{
+	struct xnet_progress *progress;
+
+	if (!ep->peer || ep->cur_rx.hdr_done || !xnet_tx_pending(ep) ||
+	    !xnet_rdm_peer_closed(ep))
+		return false;
+
+	FI_DBG(&xnet_prov, FI_LOG_EP_DATA, "draining tx of ep %p\n", ep);
+	progress = xnet_ep2_progress(ep);
+	dlist_remove_init(&ep->active_entry);
+	ep->rx_shutdown = true;
+	ep->pollout_set = true;
+	progress->poll_mod(progress, ep->bsock.sock, POLLOUT,
+			   &ep->util_ep.ep_fid.fid);
+	return true;
+}
+
 void xnet_progress_rx(struct xnet_ep *ep)
 {
 	ssize_t ret;
 
 	assert(xnet_progress_locked(xnet_ep2_progress(ep)));
+	if (xnet_max_conns && ep->peer)
+		xnet_touch_conn(ep->util_ep.ep_fid.fid.context);
+
 	do {
 		if (ep->cur_rx.hdr_done < ep->cur_rx.hdr_len) {
 			ret = xnet_recv_hdr(ep);
@@ -681,7 +998,8 @@ void xnet_progress_rx(struct xnet_ep *ep)
 	} while (!ret && ofi_bsock_readable(&ep->bsock));
 
 	if (ret && !OFI_SOCK_TRY_SND_RCV_AGAIN(-ret)) {
-		xnet_ep_disable(ep, 0, NULL, 0);
+		if (ret != -FI_ENOTCONN || !xnet_drain_tx(ep))
+			xnet_ep_disable(ep, 0, NULL, 0);
 	} else if (xnet_active_wait(ep) && dlist_empty(&ep->active_entry)) {
 		dlist_insert_tail(&ep->active_entry,
 				  &xnet_ep2_progress(ep)->active_wait_list);
@@ -708,15 +1026,12 @@ void xnet_progress_async(struct xnet_ep *ep)
 	}
 }
 
-static bool xnet_tx_pending(struct xnet_ep *ep)
-{
-	return ep->cur_tx.entry || ofi_bsock_tosend(&ep->bsock);
-}
-
 void xnet_tx_queue_insert(struct xnet_ep *ep,
 			  struct xnet_xfer_entry *tx_entry)
 {
 	assert(xnet_progress_locked(xnet_ep2_progress(ep)));
+	OFI_TRACE(xnet_tx_queue, ep, tx_entry, tx_entry->hdr.base_hdr.op,
+		  tx_entry->hdr.base_hdr.size);
 
 	if (!ep->cur_tx.entry) {
 		ep->cur_tx.entry = tx_entry;
@@ -943,6 +1258,9 @@ void xnet_update_poll(struct xnet_ep *ep)
 
 	progress = xnet_ep2_progress(ep);
 	assert(xnet_progress_locked(progress));
+	if (ep->rx_shutdown)
+		return;
+
 	tx_pending = xnet_tx_pending(ep);
 	if ((tx_pending && ep->pollout_set) ||
 	    (!tx_pending && !ep->pollout_set))
@@ -1124,6 +1442,7 @@ int xnet_init_progress(struct xnet_progress *progress, struct fi_info *info)
 	progress->fid.fclass = XNET_CLASS_PROGRESS;
 	progress->auto_progress = false;
 	dlist_init(&progress->active_wait_list);
+	dlist_init(&progress->rts_wait_list);
 	slist_init(&progress->event_list);
 
 	ret = fd_signal_init(&progress->signal);
@@ -1166,6 +1485,7 @@ err1:
 void xnet_close_progress(struct xnet_progress *progress)
 {
 	assert(dlist_empty(&progress->active_wait_list));
+	assert(dlist_empty(&progress->rts_wait_list));
 	assert(slist_empty(&progress->event_list));
 	xnet_stop_progress(progress);
 	progress->poll_close(progress);
@@ -59,6 +59,11 @@ struct xnet_cm_msg {
 	char data[XNET_MAX_CM_DATA_SIZE];
 };
 
+/* Capabilities exchanged in ofi_ctrl_hdr::seg_no of the connect request
+ * and response, in network byte order.  Older peers leave the field zero.
+ */
+#define XNET_CM_RNDV		(1 << 0)
+
 #define XNET_HDR_VERSION	3
 
 enum {
@@ -76,6 +81,12 @@ enum {
 /* not used XNET_TRANSMIT_COMPLETE	(1 << 1) */
 #define XNET_DELIVERY_COMPLETE	(1 << 2)
 #define XNET_COMMIT_COMPLETE	(1 << 3)
+/* Rendezvous: message carries an ofi_rma_iov describing the payload
+ * instead of the payload itself.  The receiver pulls the data with a
+ * read request once a matching receive is posted.  Only sent to peers
+ * that advertised XNET_CM_RNDV.
+ */
+#define XNET_RNDV		(1 << 4)
 #define XNET_TAGGED		(1 << 7)
 
 struct xnet_base_hdr {
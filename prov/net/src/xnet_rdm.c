@@ -373,6 +373,142 @@ static struct fi_ops_tagged xnet_rdm_tagged_ops = {
 	.injectdata = xnet_rdm_tinjectdata,
 };
 
+static struct xnet_persist_req *
+xnet_persist_alloc(struct fid_ep *ep_fid, void *buf, size_t len, void *desc,
+		   fi_addr_t addr, uint64_t tag, void *context)
+{
+	struct xnet_persist_req *req;
+
+	req = calloc(1, sizeof(*req));
+	if (!req)
+		return NULL;
+
+	req->rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	req->persist.ep = ep_fid;
+	req->persist.context = context;
+	req->iov.iov_base = buf;
+	req->iov.iov_len = len;
+	req->desc = desc;
+	req->addr = addr;
+	req->tag = tag;
+	return req;
+}
+
+static int
+xnet_persist_tsend_init(struct fid_ep *ep_fid, const void *buf, size_t len,
+			void *desc, fi_addr_t dest_addr, uint64_t tag,
+			void *context, struct fi_persist_req **persist)
+{
+	struct xnet_persist_req *req;
+	struct util_peer_addr **peer;
+	struct xnet_rdm *rdm;
+	uint64_t flags;
+
+	req = xnet_persist_alloc(ep_fid, (void *) buf, len, desc, dest_addr,
+				 tag, context);
+	if (!req)
+		return -FI_ENOMEM;
+
+	rdm = req->rdm;
+	ofi_genlock_lock(&xnet_rdm2_progress(rdm)->rdm_lock);
+	peer = ofi_av_addr_context(rdm->util_ep.av, dest_addr);
+	if (!peer || !*peer) {
+		ofi_genlock_unlock(&xnet_rdm2_progress(rdm)->rdm_lock);
+		free(req);
+		return -FI_EINVAL;
+	}
+	req->peer = *peer;
+	rxm_ref_peer(req->peer);
+	ofi_genlock_unlock(&xnet_rdm2_progress(rdm)->rdm_lock);
+
+	req->send = true;
+	req->hdr.base_hdr.version = XNET_HDR_VERSION;
+	req->hdr.base_hdr.op = ofi_op_tagged;
+	req->hdr.tag = tag;
+
+	flags = rdm->util_ep.tx_op_flags;
+	req->cq_flags = (flags & FI_COMPLETION) | FI_TAGGED | FI_SEND;
+	if (flags & (FI_TRANSMIT_COMPLETE | FI_DELIVERY_COMPLETE)) {
+		req->hdr.base_hdr.flags |= XNET_DELIVERY_COMPLETE;
+		req->ctrl_flags |= XNET_NEED_ACK;
+	}
+	req->rndv = xnet_rndv_eligible(len, req->ctrl_flags);
+	*persist = &req->persist;
+	return 0;
+}
+
+static int
+xnet_persist_trecv_init(struct fid_ep *ep_fid, void *buf, size_t len,
+			void *desc, fi_addr_t src_addr, uint64_t tag,
+			uint64_t ignore, void *context,
+			struct fi_persist_req **persist)
+{
+	struct xnet_persist_req *req;
+
+	req = xnet_persist_alloc(ep_fid, buf, len, desc, src_addr, tag,
+				 context);
+	if (!req)
+		return -FI_ENOMEM;
+
+	req->ignore = ignore;
+	*persist = &req->persist;
+	return 0;
+}
+
+/* The conn is found by peer index, skipping the AV lookup.  Until it is
+ * connected, the start goes through xnet_get_conn to set it up.
+ */
+static ssize_t xnet_persist_start(struct fi_persist_req *persist)
+{
+	struct xnet_persist_req *req;
+	struct xnet_rdm *rdm;
+	struct xnet_conn *conn;
+	ssize_t ret;
+
+	req = container_of(persist, struct xnet_persist_req, persist);
+	rdm = req->rdm;
+	if (!req->send) {
+		return fi_trecv(&rdm->srx->rx_fid, req->iov.iov_base,
+				req->iov.iov_len, req->desc, req->addr,
+				req->tag, req->ignore, persist->context);
+	}
+
+	ofi_genlock_lock(&xnet_rdm2_progress(rdm)->rdm_lock);
+	conn = ofi_idm_lookup(&rdm->conn_idx_map, req->peer->index);
+	if (conn && conn->ep && conn->ep->state == XNET_CONNECTED) {
+		if (xnet_max_conns)
+			xnet_touch_conn(conn);
+	} else {
+		ret = xnet_get_conn(rdm, req->addr, &conn);
+		if (ret)
+			goto unlock;
+	}
+
+	ret = xnet_persist_tsend(conn->ep, req);
+unlock:
+	ofi_genlock_unlock(&xnet_rdm2_progress(rdm)->rdm_lock);
+	return ret;
+}
+
+static int xnet_persist_free(struct fi_persist_req *persist)
+{
+	struct xnet_persist_req *req;
+
+	req = container_of(persist, struct xnet_persist_req, persist);
+	if (req->peer)
+		util_put_peer(req->peer);
+	free(req);
+	return 0;
+}
+
+static struct fi_ops_persist xnet_rdm_persist_ops = {
+	.size = sizeof(struct fi_ops_persist),
+	.tsend_init = xnet_persist_tsend_init,
+	.trecv_init = xnet_persist_trecv_init,
+	.start = xnet_persist_start,
+	.free = xnet_persist_free,
+};
+
 static ssize_t
 xnet_rdm_read(struct fid_ep *ep_fid, void *buf, size_t len,
 	      void *desc, fi_addr_t src_addr, uint64_t addr,
@@ -638,6 +774,7 @@ static ssize_t xnet_rdm_cancel(struct fid *fid, void *context)
 static int xnet_rdm_getopt(struct fid *fid, int level, int optname,
 			   void *optval, size_t *optlen)
 {
+	struct fi_tcp_conn_stats *stats;
 	struct xnet_rdm *rdm;
 
 	rdm = container_of(fid, struct xnet_rdm, util_ep.ep_fid.fid);
@@ -653,6 +790,29 @@ static int xnet_rdm_getopt(struct fid *fid, int level, int optname,
 		*((size_t *) optval) = rdm->srx->min_multi_recv_size;
 		*optlen = sizeof(size_t);
 		break;
+	case FI_OPT_TCP_CONN_STATS:
+		if (*optlen < sizeof(struct fi_tcp_conn_stats)) {
+			*optlen = sizeof(struct fi_tcp_conn_stats);
+			return -FI_ETOOSMALL;
+		}
+		stats = optval;
+		ofi_genlock_lock(&xnet_rdm2_progress(rdm)->rdm_lock);
+		stats->open = rdm->conn_cnt;
+		stats->evictions = rdm->evictions;
+		stats->reconnects = rdm->reconnects;
+		ofi_genlock_unlock(&xnet_rdm2_progress(rdm)->rdm_lock);
+		*optlen = sizeof(struct fi_tcp_conn_stats);
+		break;
+	case FI_OPT_TCP_RX_STATS:
+		if (*optlen < sizeof(struct fi_tcp_rx_stats)) {
+			*optlen = sizeof(struct fi_tcp_rx_stats);
+			return -FI_ETOOSMALL;
+		}
+		ofi_genlock_lock(&xnet_rdm2_progress(rdm)->rdm_lock);
+		xnet_rdm_rx_stats(rdm, optval);
+		ofi_genlock_unlock(&xnet_rdm2_progress(rdm)->rdm_lock);
+		*optlen = sizeof(struct fi_tcp_rx_stats);
+		break;
 	default:
 		return -FI_ENOPROTOOPT;
 	}
@@ -776,7 +936,16 @@ static int xnet_rdm_close(struct fid *fid)
 		return ret;
 	}
 
+	if (rdm->evictions) {
+		FI_INFO(&xnet_prov, FI_LOG_EP_CTRL,
+			"conn cache: %" PRIu64 " evictions, %" PRIu64
+			" reconnects\n", rdm->evictions, rdm->reconnects);
+	}
 	xnet_freeall_conns(rdm);
+	FI_INFO(&xnet_prov, FI_LOG_EP_DATA,
+		"rx: %" PRIu64 " bytes copied from staging buffer, %" PRIu64
+		" bytes received directly\n", rdm->rx_stats.bounce_bytes,
+		rdm->rx_stats.direct_bytes);
 	ofi_genlock_unlock(&xnet_rdm2_progress(rdm)->rdm_lock);
 
 	ret = fi_close(&rdm->srx->rx_fid.fid);
@@ -791,12 +960,23 @@ static int xnet_rdm_close(struct fid *fid)
 	return 0;
 }
 
+static int xnet_rdm_ops_open(struct fid *fid, const char *name,
+			     uint64_t flags, void **ops, void *context)
+{
+	if (!strcasecmp(name, FI_PERSIST_OPS)) {
+		*ops = &xnet_rdm_persist_ops;
+		return 0;
+	}
+
+	return -FI_ENOSYS;
+}
+
 static struct fi_ops xnet_rdm_fid_ops = {
 	.size = sizeof(struct fi_ops),
 	.close = xnet_rdm_close,
 	.bind = ofi_ep_fid_bind,
 	.control = xnet_rdm_ctrl,
-	.ops_open = fi_no_ops_open,
+	.ops_open = xnet_rdm_ops_open,
 };
 
 static int xnet_init_rdm(struct xnet_rdm *rdm, struct fi_info *info)
@@ -845,6 +1025,8 @@ static int xnet_init_rdm(struct xnet_rdm *rdm, struct fi_info *info)
 	}
 
 	dlist_init(&rdm->loopback_list);
+	dlist_init(&rdm->conn_lru);
+	dlist_init(&rdm->drain_list);
 	rdm->srx = container_of(srx, struct xnet_srx, rx_fid);
 	rdm->pep = container_of(pep, struct xnet_pep, util_pep);
 	return 0;
@@ -46,11 +46,16 @@
  */
 struct xnet_rdm_cm {
 	uint8_t version;
-	uint8_t resv;
+	uint8_t flags;
 	uint16_t port;
 	uint32_t pid;
 };
 
+/* The sender evicted its previous connection to the peer, which may not
+ * have seen the close yet.
+ */
+#define XNET_RDM_CM_RECONNECT	BIT(0)
+
 static int xnet_match_rdm(struct slist_entry *item, const void *arg)
 {
 	struct xnet_event *event;
@@ -58,29 +63,66 @@ static int xnet_match_rdm(struct slist_entry *item, const void *arg)
 	return event->rdm == arg;
 }
 
-static void xnet_close_conn(struct xnet_conn *conn)
+static int xnet_match_fid(struct slist_entry *item, const void *arg)
+{
+	struct xnet_event *event;
+	event = container_of(item, struct xnet_event, list_entry);
+	return event->cm_entry.fid == arg;
+}
+
+static void xnet_purge_events(struct xnet_progress *progress,
+			      int (*match)(struct slist_entry *, const void *),
+			      const void *arg)
 {
 	struct xnet_event *event;
 	struct slist_entry *item;
 
+	while ((item = slist_remove_first_match(&progress->event_list,
+						 match, arg))) {
+		event = container_of(item, struct xnet_event, list_entry);
+		free(event);
+	}
+}
+
+static void xnet_conn_lru_add(struct xnet_conn *conn)
+{
+	assert(dlist_empty(&conn->lru_entry));
+	dlist_insert_head(&conn->lru_entry, &conn->rdm->conn_lru);
+	conn->rdm->conn_cnt++;
+}
+
+static void xnet_conn_lru_del(struct xnet_conn *conn)
+{
+	if (dlist_empty(&conn->lru_entry))
+		return;
+
+	dlist_remove_init(&conn->lru_entry);
+	if (!(conn->flags & XNET_CONN_DRAINING))
+		conn->rdm->conn_cnt--;
+}
+
+static void xnet_close_conn(struct xnet_conn *conn)
+{
+	struct util_peer_addr *peer;
+
 	FI_DBG(&xnet_prov, FI_LOG_EP_CTRL, "closing conn %p\n", conn);
 	assert(xnet_progress_locked(xnet_rdm2_progress(conn->rdm)));
 	dlist_remove_init(&conn->loopback_entry);
+	xnet_conn_lru_del(conn);
 
 	if (conn->ep) {
+		conn->rdm->rx_stats.bounce_bytes +=
+			conn->ep->bsock.rx_bounce_bytes;
+		conn->rdm->rx_stats.direct_bytes +=
+			conn->ep->bsock.rx_direct_bytes;
+
+		/* the ep is freed by close */
+		peer = conn->ep->peer;
+		xnet_purge_events(xnet_rdm2_progress(conn->rdm),
+				  xnet_match_fid, &conn->ep->util_ep.ep_fid.fid);
 		fi_close(&conn->ep->util_ep.ep_fid.fid);
-		do {
-			item = slist_remove_first_match(
-				&xnet_rdm2_progress(conn->rdm)->event_list,
-				xnet_match_rdm, conn->rdm);
-			if (!item)
-				break;
-
-			event = container_of(item, struct xnet_event, list_entry);
-			free(event);
-		} while (item);
-		if (conn->ep->peer)
-			util_put_peer(conn->ep->peer);
+		if (peer)
+			util_put_peer(peer);
 	}
 
 	conn->ep = NULL;
@@ -154,12 +196,115 @@ static int xnet_bind_conn(struct xnet_rdm *rdm, struct xnet_ep *ep)
 	return 0;
 }
 
+static struct xnet_conn *
+xnet_alloc_conn(struct xnet_rdm *rdm, struct util_peer_addr *peer);
+
+/* Hand the conn's ep over to a draining conn.  The next transfer to the
+ * peer opens a new connection, while the old one winds down.
+ */
+static struct xnet_conn *xnet_drain_conn(struct xnet_conn *conn)
+{
+	struct xnet_conn *drain;
+
+	assert(conn->ep);
+	if (!(conn->flags & XNET_CONN_INDEXED)) {
+		conn->flags |= XNET_CONN_DRAINING;
+		return conn;
+	}
+
+	drain = xnet_alloc_conn(conn->rdm, conn->peer);
+	if (!drain)
+		return NULL;
+
+	xnet_conn_lru_del(conn);
+	drain->flags |= XNET_CONN_DRAINING;
+	drain->remote_pid = conn->remote_pid;
+	dlist_insert_tail(&drain->lru_entry, &conn->rdm->drain_list);
+
+	drain->ep = conn->ep;
+	drain->ep->util_ep.ep_fid.fid.context = drain;
+	conn->ep = NULL;
+	return drain;
+}
+
+/* Nothing is in flight in either direction, as far as we can tell. */
+static bool xnet_conn_idle(struct xnet_conn *conn)
+{
+	struct xnet_ep *ep = conn->ep;
+
+	return ep && ep->state == XNET_CONNECTED && !xnet_tx_pending(ep) &&
+	       !ep->cur_rx.handler && !ep->cur_rx.hdr_done &&
+	       !ofi_bsock_readable(&ep->bsock) &&
+	       slist_empty(&ep->tx_queue) &&
+	       slist_empty(&ep->priority_queue) &&
+	       slist_empty(&ep->need_ack_queue) &&
+	       slist_empty(&ep->async_queue) &&
+	       slist_empty(&ep->rma_read_queue) &&
+	       slist_empty(&ep->need_read_queue) &&
+	       slist_empty(&ep->rts_queue) &&
+	       slist_empty(&ep->rndv_read_queue);
+}
+
+/* Shutting down our side tells the peer to finish sending whatever it
+ * has queued and close its side.  We keep receiving until then.
+ */
+static void xnet_evict_conn(struct xnet_conn *conn)
+{
+	struct xnet_conn *drain;
+
+	FI_DBG(&xnet_prov, FI_LOG_EP_CTRL, "evicting conn %p\n", conn);
+	drain = xnet_drain_conn(conn);
+	if (!drain)
+		return;
+
+	conn->flags |= XNET_CONN_EVICTED;
+	conn->rdm->evictions++;
+	if (ofi_shutdown(drain->ep->bsock.sock, SHUT_WR)) {
+		FI_WARN(&xnet_prov, FI_LOG_EP_CTRL, "shutdown failed\n");
+		xnet_ep_disable(drain->ep, 0, NULL, 0);
+	}
+}
+
+static void xnet_make_room(struct xnet_rdm *rdm)
+{
+	struct xnet_conn *conn;
+
+	if (!xnet_max_conns || rdm->conn_cnt < xnet_max_conns)
+		return;
+
+	dlist_foreach_container_reverse(&rdm->conn_lru, struct xnet_conn,
+					conn, lru_entry) {
+		if (xnet_conn_idle(conn)) {
+			xnet_evict_conn(conn);
+			return;
+		}
+	}
+
+	FI_DBG(&xnet_prov, FI_LOG_EP_CTRL,
+	       "no idle conn to evict, exceeding max_conns\n");
+}
+
+bool xnet_rdm_peer_closed(struct xnet_ep *ep)
+{
+	struct xnet_conn *conn;
+
+	conn = ep->util_ep.ep_fid.fid.context;
+	assert(xnet_progress_locked(xnet_rdm2_progress(conn->rdm)));
+	if (conn->flags & XNET_CONN_DRAINING)
+		return false;
+
+	return xnet_drain_conn(conn) != NULL;
+}
+
 static int xnet_open_conn(struct xnet_conn *conn, struct fi_info *info)
 {
 	struct fid_ep *ep_fid;
 	int ret;
 
 	assert(xnet_progress_locked(xnet_rdm2_progress(conn->rdm)));
+	if (conn->flags & XNET_CONN_INDEXED)
+		xnet_make_room(conn->rdm);
+
 	ret = fi_endpoint(&conn->rdm->util_ep.domain->domain_fid, info,
 			  &ep_fid, conn);
 	if (ret) {
@@ -180,6 +325,13 @@ static int xnet_open_conn(struct xnet_conn *conn, struct fi_info *info)
 		goto err;
 	}
 
+	if (conn->flags & XNET_CONN_INDEXED) {
+		xnet_conn_lru_add(conn);
+		if (conn->flags & XNET_CONN_EVICTED) {
+			conn->flags &= ~XNET_CONN_EVICTED;
+			conn->rdm->reconnects++;
+		}
+	}
 	return 0;
 
 err:
@@ -195,6 +347,9 @@ static int xnet_rdm_connect(struct xnet_conn *conn)
 	int ret;
 
 	FI_DBG(&xnet_prov, FI_LOG_EP_CTRL, "connecting %p\n", conn);
+	msg.flags = (conn->flags & XNET_CONN_EVICTED) ?
+		    XNET_RDM_CM_RECONNECT : 0;
+	conn->remote_pid = 0;
 	assert(xnet_progress_locked(xnet_rdm2_progress(conn->rdm)));
 
 	info = conn->rdm->pep->info;
@@ -211,7 +366,6 @@ static int xnet_rdm_connect(struct xnet_conn *conn)
 
 	msg.version = XNET_RDM_VERSION;
 	msg.pid = htonl((uint32_t) getpid());
-	msg.resv = 0;
 	msg.port = htons(ofi_addr_get_port(&conn->rdm->addr.sa));
 
 	ret = fi_connect(&conn->ep->util_ep.ep_fid, info->dest_addr,
@@ -270,6 +424,51 @@ void xnet_freeall_conns(struct xnet_rdm *rdm)
 		xnet_close_conn(conn);
 		xnet_free_conn(conn);
 	}
+
+	dlist_foreach_container_safe(&rdm->drain_list, struct xnet_conn,
+				     conn, lru_entry, tmp) {
+		xnet_close_conn(conn);
+		xnet_free_conn(conn);
+	}
+
+	ofi_idm_reset(&rdm->conn_idx_map, NULL);
+	xnet_purge_events(xnet_rdm2_progress(rdm), xnet_match_rdm, rdm);
+}
+
+static void xnet_add_rx_stats(struct xnet_conn *conn,
+			      struct fi_tcp_rx_stats *stats)
+{
+	if (!conn->ep)
+		return;
+
+	stats->bounce_bytes += conn->ep->bsock.rx_bounce_bytes;
+	stats->direct_bytes += conn->ep->bsock.rx_direct_bytes;
+}
+
+void xnet_rdm_rx_stats(struct xnet_rdm *rdm, struct fi_tcp_rx_stats *stats)
+{
+	struct xnet_conn *conn;
+	struct rxm_av *av;
+	int i, cnt;
+
+	assert(xnet_progress_locked(xnet_rdm2_progress(rdm)));
+	*stats = rdm->rx_stats;
+
+	av = container_of(rdm->util_ep.av, struct rxm_av, util_av);
+	cnt = (int) rxm_av_max_peers(av);
+	for (i = 0; i < cnt; i++) {
+		conn = ofi_idm_lookup(&rdm->conn_idx_map, i);
+		if (conn)
+			xnet_add_rx_stats(conn, stats);
+	}
+
+	dlist_foreach_container(&rdm->loopback_list, struct xnet_conn,
+				conn, loopback_entry)
+		xnet_add_rx_stats(conn, stats);
+
+	dlist_foreach_container(&rdm->drain_list, struct xnet_conn,
+				conn, lru_entry)
+		xnet_add_rx_stats(conn, stats);
 }
 
 static struct xnet_conn *
@@ -289,6 +488,7 @@ xnet_alloc_conn(struct xnet_rdm *rdm, struct util_peer_addr *peer)
 	conn->rdm = rdm;
 	conn->flags = 0;
 	dlist_init(&conn->loopback_entry);
+	dlist_init(&conn->lru_entry);
 
 	conn->peer = peer;
 	rxm_ref_peer(peer);
@@ -346,6 +546,8 @@ ssize_t xnet_get_conn(struct xnet_rdm *rdm, fi_addr_t addr,
 	if ((*conn)->ep->state != XNET_CONNECTED)
 		return -FI_EAGAIN;
 
+	if (xnet_max_conns)
+		xnet_touch_conn(*conn);
 	return 0;
 }
 
@@ -425,15 +627,35 @@ static void xnet_process_connreq(struct fi_eq_cm_entry *cm_entry)
 		break;
 	case XNET_ACCEPTING:
 	case XNET_CONNECTED:
-		if (conn->remote_pid == ntohl(msg->pid)) {
-			FI_INFO(&xnet_prov, FI_LOG_EP_CTRL,
-				"simultaneous, reject peer\n");
-			goto put;
-		} else {
+		/* The pid is unknown until our connect event is handled. */
+		if (conn->remote_pid && conn->remote_pid != ntohl(msg->pid)) {
 			FI_INFO(&xnet_prov, FI_LOG_EP_CTRL,
 				"old connection exists, replacing %p\n", conn);
 			xnet_close_conn(conn);
+			break;
 		}
+
+		/* If the peer had accepted our request while sending its
+		 * own, it expects us to reject the latter.  That can only
+		 * happen if our request wins.
+		 */
+		cmp = ofi_addr_cmp(&xnet_prov, &peer_addr.sa, &rdm->addr.sa);
+		if (cmp > 0 && (msg->flags & XNET_RDM_CM_RECONNECT)) {
+			FI_INFO(&xnet_prov, FI_LOG_EP_CTRL,
+				"peer reconnecting, draining %p\n", conn);
+			if (!xnet_drain_conn(conn))
+				goto put;
+		} else {
+			FI_INFO(&xnet_prov, FI_LOG_EP_CTRL,
+				"simultaneous, reject peer\n");
+			goto put;
+		}
+		break;
+	case XNET_DISCONNECTED:
+		/* shutdown event is still queued */
+		FI_INFO(&xnet_prov, FI_LOG_EP_CTRL,
+			"old connection closed, replacing %p\n", conn);
+		xnet_close_conn(conn);
 		break;
 	default:
 		assert(0);
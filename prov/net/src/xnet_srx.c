@@ -70,6 +70,7 @@ xnet_srx_recvmsg(struct fid_ep *ep_fid, const struct fi_msg *msg,
 	       msg->iov_count * sizeof(*msg->msg_iov));
 
 	slist_insert_tail(&recv_entry->entry, &srx->rx_queue);
+	xnet_match_rts_wait(xnet_srx2_progress(srx));
 unlock:
 	ofi_genlock_unlock(xnet_srx2_progress(srx)->active_lock);
 	return ret;
@@ -99,6 +100,7 @@ xnet_srx_recv(struct fid_ep *ep_fid, void *buf, size_t len, void *desc,
 	recv_entry->iov[0].iov_len = len;
 
 	slist_insert_tail(&recv_entry->entry, &srx->rx_queue);
+	xnet_match_rts_wait(xnet_srx2_progress(srx));
 unlock:
 	ofi_genlock_unlock(xnet_srx2_progress(srx)->active_lock);
 	return ret;
@@ -128,6 +130,7 @@ xnet_srx_recvv(struct fid_ep *ep_fid, const struct iovec *iov, void **desc,
 	memcpy(&recv_entry->iov[0], iov, count * sizeof(*iov));
 
 	slist_insert_tail(&recv_entry->entry, &srx->rx_queue);
+	xnet_match_rts_wait(xnet_srx2_progress(srx));
 unlock:
 	ofi_genlock_unlock(xnet_srx2_progress(srx)->active_lock);
 	return ret;
@@ -194,6 +197,7 @@ xnet_srx_trecvmsg(struct fid_ep *ep_fid, const struct fi_msg_tagged *msg,
 	       msg->iov_count * sizeof(*msg->msg_iov));
 
 	slist_insert_tail(&recv_entry->entry, &srx->tag_queue);
+	xnet_match_rts_wait(xnet_srx2_progress(srx));
 unlock:
 	ofi_genlock_unlock(xnet_srx2_progress(srx)->active_lock);
 	return ret;
@@ -226,6 +230,7 @@ xnet_srx_trecv(struct fid_ep *ep_fid, void *buf, size_t len, void *desc,
 	recv_entry->iov[0].iov_len = len;
 
 	slist_insert_tail(&recv_entry->entry, &srx->tag_queue);
+	xnet_match_rts_wait(xnet_srx2_progress(srx));
 unlock:
 	ofi_genlock_unlock(xnet_srx2_progress(srx)->active_lock);
 	return ret;
@@ -259,6 +264,7 @@ xnet_srx_trecvv(struct fid_ep *ep_fid, const struct iovec *iov, void **desc,
 	memcpy(&recv_entry->iov[0], iov, count * sizeof(*iov));
 
 	slist_insert_tail(&recv_entry->entry, &srx->tag_queue);
+	xnet_match_rts_wait(xnet_srx2_progress(srx));
 unlock:
 	ofi_genlock_unlock(xnet_srx2_progress(srx)->active_lock);
 	return ret;
@@ -349,11 +355,60 @@ static ssize_t xnet_srx_cancel(fid_t fid, void *context)
 	return 0;
 }
 
+static int xnet_srx_getopt(struct fid *fid, int level, int optname,
+			   void *optval, size_t *optlen)
+{
+	struct xnet_srx *srx;
+
+	srx = container_of(fid, struct xnet_srx, rx_fid.fid);
+	if (level != FI_OPT_ENDPOINT)
+		return -FI_ENOPROTOOPT;
+
+	switch (optname) {
+	case FI_OPT_MIN_MULTI_RECV:
+		if (*optlen < sizeof(size_t)) {
+			*optlen = sizeof(size_t);
+			return -FI_ETOOSMALL;
+		}
+		*((size_t *) optval) = srx->min_multi_recv_size;
+		*optlen = sizeof(size_t);
+		break;
+	default:
+		return -FI_ENOPROTOOPT;
+	}
+	return FI_SUCCESS;
+}
+
+static int xnet_srx_setopt(struct fid *fid, int level, int optname,
+			   const void *optval, size_t optlen)
+{
+	struct xnet_srx *srx;
+
+	srx = container_of(fid, struct xnet_srx, rx_fid.fid);
+	if (level != FI_OPT_ENDPOINT)
+		return -FI_ENOPROTOOPT;
+
+	switch (optname) {
+	case FI_OPT_MIN_MULTI_RECV:
+		if (optlen != sizeof(size_t))
+			return -FI_EINVAL;
+
+		srx->min_multi_recv_size = *(size_t *) optval;
+		FI_INFO(&xnet_prov, FI_LOG_EP_CTRL,
+			"FI_OPT_MIN_MULTI_RECV set to %zu\n",
+			srx->min_multi_recv_size);
+		break;
+	default:
+		return -FI_ENOPROTOOPT;
+	}
+	return FI_SUCCESS;
+}
+
 static struct fi_ops_ep xnet_srx_ops = {
 	.size = sizeof(struct fi_ops_ep),
 	.cancel = xnet_srx_cancel,
-	.getopt = fi_no_getopt,
-	.setopt = fi_no_setopt,
+	.getopt = xnet_srx_getopt,
+	.setopt = xnet_srx_setopt,
 	.tx_ctx = fi_no_tx_ctx,
 	.rx_ctx = fi_no_rx_ctx,
 	.rx_size_left = fi_no_rx_size_left,
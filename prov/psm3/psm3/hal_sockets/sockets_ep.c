@@ -104,7 +104,7 @@ psm3_ep_open_udp_internal(psm2_ep_t ep, int unit, int port,
 	struct sockaddr_in6 loc_addr;
 	socklen_t addr_len;
 	union psmi_envvar_val env_bdev;
-	union psmi_envvar_val env_gso, env_gro;
+	union psmi_envvar_val env_gso, env_gro, env_batch;
 	union psmi_envvar_val env_zerocopy;
 	union psmi_envvar_val env_prate;
 	union psmi_envvar_val env_rbuf, env_sbuf;
@@ -194,10 +194,21 @@ psm3_ep_open_udp_internal(psm2_ep_t ep, int unit, int port,
 				PSMI_ENVVAR_LEVEL_HIDDEN, PSMI_ENVVAR_TYPE_INT,
 				(union psmi_envvar_val) 0, &env_gro);
 		ep->sockets_ep.udp_gro = env_gro.e_int;
+
+		psm3_getenv("PSM3_UDP_RECV_BATCH",
+				"Max UDP datagrams received per system call (0 receives one at a time and disables GRO)",
+				PSMI_ENVVAR_LEVEL_USER, PSMI_ENVVAR_TYPE_UINT,
+				(union psmi_envvar_val) UDP_RECV_BATCH, &env_batch);
+		ep->sockets_ep.rbatch_size = min(env_batch.e_uint, UDP_MAX_RECV_BATCH);
+		if (! ep->sockets_ep.rbatch_size && ep->sockets_ep.udp_gro) {
+			// only the batched receive splits coalesced datagrams
+			_HFI_PRDBG("UDP GRO requires PSM3_UDP_RECV_BATCH, GRO disabled\n");
+			ep->sockets_ep.udp_gro = 0;
+		}
 		if (ep->sockets_ep.udp_gro) {
 			int gro;
 			socklen_t optlen = sizeof(gro);
-			if (!getsockopt(ep->sockets_ep.udp_tx_fd, SOL_UDP, UDP_GRO, &gro, &optlen)) {
+			if (!getsockopt(ep->sockets_ep.udp_rx_fd, SOL_UDP, UDP_GRO, &gro, &optlen)) {
 				_HFI_PRDBG("UDP GRO supported and enabled\n");
 			} else {
 				ep->sockets_ep.udp_gro = 0;
@@ -217,7 +228,7 @@ psm3_ep_open_udp_internal(psm2_ep_t ep, int unit, int port,
 		// additional stuff related to gro
 		if (ep->sockets_ep.udp_gro) {
 			int val = 1;
-			if (-1 == setsockopt(ep->sockets_ep.udp_tx_fd, SOL_IP, UDP_GRO, &val, sizeof(val))) {
+			if (-1 == setsockopt(ep->sockets_ep.udp_rx_fd, SOL_UDP, UDP_GRO, &val, sizeof(val))) {
 				_HFI_ERROR("Failed setsockopt GRO for %s: %s\n", ep->dev_name, strerror(errno));
 				goto fail;
 			}
@@ -884,6 +895,53 @@ psm3_ep_open_sockets(psm2_ep_t ep, int unit, int port, int addr_index, psm2_uuid
 }
 
 
+// allocate the buffers and message headers for recvmmsg() and point each
+// message header at its buffer, address and control buffer
+static psm2_error_t psm3_sockets_udp_alloc_rbatch(psm2_ep_t ep)
+{
+	struct psm3_sockets_ep *sep = &ep->sockets_ep;
+	uint32_t i;
+
+	// a GRO coalesced datagram is larger than the MTU
+	sep->rbatch_buf_size = sep->udp_gro ? UDP_GRO_MAX_SIZE : sep->buf_size;
+	sep->rbatch_bufs = (uint8_t *)psmi_calloc(ep, NETWORK_BUFFERS,
+					sep->rbatch_size, sep->rbatch_buf_size);
+	sep->rbatch_msgs = (struct mmsghdr *)psmi_calloc(ep, NETWORK_BUFFERS,
+					sep->rbatch_size, sizeof(struct mmsghdr));
+	sep->rbatch_iovs = (struct iovec *)psmi_calloc(ep, NETWORK_BUFFERS,
+					sep->rbatch_size, sizeof(struct iovec));
+	sep->rbatch_addrs = (struct sockaddr_storage *)psmi_calloc(ep,
+					NETWORK_BUFFERS, sep->rbatch_size,
+					sizeof(struct sockaddr_storage));
+	if (sep->udp_gro)
+		sep->rbatch_ctrl = (uint8_t *)psmi_calloc(ep, NETWORK_BUFFERS,
+					sep->rbatch_size, UDP_GRO_CTRL_SIZE);
+	if (! sep->rbatch_bufs || ! sep->rbatch_msgs || ! sep->rbatch_iovs
+		|| ! sep->rbatch_addrs || (sep->udp_gro && ! sep->rbatch_ctrl))
+		return PSM2_NO_MEMORY;
+
+	for (i = 0; i < sep->rbatch_size; i++) {
+		struct msghdr *hdr = &sep->rbatch_msgs[i].msg_hdr;
+
+		sep->rbatch_iovs[i].iov_base = sep->rbatch_bufs +
+						i * sep->rbatch_buf_size;
+		sep->rbatch_iovs[i].iov_len = sep->rbatch_buf_size;
+		hdr->msg_iov = &sep->rbatch_iovs[i];
+		hdr->msg_iovlen = 1;
+		hdr->msg_name = &sep->rbatch_addrs[i];
+		hdr->msg_namelen = sizeof(struct sockaddr_storage);
+		if (sep->udp_gro) {
+			hdr->msg_control = sep->rbatch_ctrl +
+						i * UDP_GRO_CTRL_SIZE;
+			hdr->msg_controllen = UDP_GRO_CTRL_SIZE;
+		}
+	}
+	sep->rbatch_cnt = 0;
+	sep->rbatch_next = 0;
+	sep->rbatch_seg_off = 0;
+	return PSM2_OK;
+}
+
 // ep->mtu is now max PSM payload, not including headers and perhaps decreased
 // via PSM3_MTU
 psm2_error_t
@@ -972,6 +1030,12 @@ psm3_sockets_ips_proto_init(struct ips_proto *proto, uint32_t cksum_sz)
 		goto fail;
 	}
 
+	if (ep->sockets_ep.rbatch_size &&
+		PSM2_OK != psm3_sockets_udp_alloc_rbatch(ep)) {
+		_HFI_ERROR( "Unable to allocate UDP receive batch buffers\n");
+		goto fail;
+	}
+
 #ifdef PSM_BYTE_FLOW_CREDITS
 	if (ep->sockets_ep.sockets_mode == PSM3_SOCKETS_TCP) {
 		// let flow_credits be the control
@@ -1197,6 +1261,30 @@ void psm3_ep_sockets_free_buffers(psm2_ep_t ep)
 		psmi_free(ep->sockets_ep.rbuf);
 		ep->sockets_ep.rbuf = NULL;
 	}
+
+	if (ep->sockets_ep.rbatch_bufs) {
+		psmi_free(ep->sockets_ep.rbatch_bufs);
+		ep->sockets_ep.rbatch_bufs = NULL;
+	}
+	if (ep->sockets_ep.rbatch_msgs) {
+		psmi_free(ep->sockets_ep.rbatch_msgs);
+		ep->sockets_ep.rbatch_msgs = NULL;
+	}
+	if (ep->sockets_ep.rbatch_iovs) {
+		psmi_free(ep->sockets_ep.rbatch_iovs);
+		ep->sockets_ep.rbatch_iovs = NULL;
+	}
+	if (ep->sockets_ep.rbatch_addrs) {
+		psmi_free(ep->sockets_ep.rbatch_addrs);
+		ep->sockets_ep.rbatch_addrs = NULL;
+	}
+	if (ep->sockets_ep.rbatch_ctrl) {
+		psmi_free(ep->sockets_ep.rbatch_ctrl);
+		ep->sockets_ep.rbatch_ctrl = NULL;
+	}
+	ep->sockets_ep.rbatch_cnt = 0;
+	ep->sockets_ep.rbatch_next = 0;
+	ep->sockets_ep.rbatch_seg_off = 0;
 }
 
 void
@@ -63,6 +63,7 @@
 #define PSM_HAL_SOCKETS_EP_H
 
 #include <netinet/in.h>
+#include <sys/socket.h>
 
 #ifdef RNDV_MOD
 #ifdef PSM_CUDA
@@ -131,6 +132,10 @@
 #define TCP_IOV_SIZE	1024
 #define TCP_INACT_SKIP_POLLS	20
 #define TCP_ACT_SKIP_POLLS	10
+#define UDP_RECV_BATCH	32		// default datagrams per recvmmsg
+#define UDP_MAX_RECV_BATCH	1024	// UIO_MAXIOV, kernel limit for recvmmsg
+#define UDP_GRO_MAX_SIZE	(64*1024)	// max size of a GRO coalesced datagram
+#define UDP_GRO_CTRL_SIZE	CMSG_SPACE(sizeof(int))	// cmsg with GRO segment size
 
 // this structure can be part of psm2_ep
 // one instance of this per local end point (NIC)
@@ -160,7 +165,21 @@ struct psm3_sockets_ep {
 	int udp_gso;	// is GSO enabled for UDP
 	uint8_t *sbuf_udp_gso;	// buffer to compose UDP GSO packet sequence
 	int udp_gso_zerocopy;	// is UDP GSO Zero copy option enabled
-	int udp_gro; // will be used later
+	int udp_gro;	// is GRO enabled for UDP, requires rbatch_size
+	// batched UDP receive, recvmmsg() fills rbatch_cnt of rbatch_size
+	// buffers and psm3_sockets_udp_recvhdrq_progress processes them in
+	// order, splitting GRO coalesced datagrams into their segments.
+	// When rbatch_size is 0 recvfrom() reads one datagram into rbuf
+	uint32_t rbatch_size;
+	uint32_t rbatch_buf_size;	// size of each rbatch buffer
+	uint32_t rbatch_cnt;	// datagrams returned by last recvmmsg()
+	uint32_t rbatch_next;	// next datagram to process
+	uint32_t rbatch_seg_off;	// offset of next GRO segment in it
+	uint8_t *rbatch_bufs;
+	struct mmsghdr *rbatch_msgs;
+	struct iovec *rbatch_iovs;
+	struct sockaddr_storage *rbatch_addrs;
+	uint8_t *rbatch_ctrl;	// UDP_GRO_CTRL_SIZE per datagram
 	/* fields used for both UDP and TCP */
 	uint8_t *sbuf;
 	uint8_t *rbuf;
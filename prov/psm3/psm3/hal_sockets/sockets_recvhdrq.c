@@ -787,6 +787,82 @@ psm3_sockets_udp_process_packet(struct ips_recvhdrq_event *rcv_ev,
 	return ret;
 }
 
+// size of the segments of a GRO coalesced datagram, all but the last
+// segment have this size
+static __inline__ uint32_t
+psm3_sockets_udp_gro_size(struct msghdr *hdr, uint32_t len)
+{
+	struct cmsghdr *cmsg;
+	int gso_size;
+
+	for (cmsg = CMSG_FIRSTHDR(hdr); cmsg; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+		if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+			memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+			if (gso_size > 0)
+				return (uint32_t)gso_size;
+		}
+	}
+	return len;
+}
+
+// Get the next packet of the receive batch, refilling the batch with
+// recvmmsg() once all its packets were returned.
+// Returns 1 when a packet is returned, -1 with errno set when recvmmsg()
+// fails, including EAGAIN when no packets are available.
+// As with recvfrom(MSG_TRUNC), recvlen exceeds the buffer size for
+// truncated datagrams.
+static __inline__ int
+psm3_sockets_udp_rbatch_next(psm2_ep_t ep, uint8_t **buf, int *recvlen,
+				struct sockaddr_storage **rem_addr,
+				socklen_t *len_addr)
+{
+	struct psm3_sockets_ep *sep = &ep->sockets_ep;
+	struct msghdr *hdr;
+	uint32_t len, seg_size, i;
+	int ret;
+
+	if (sep->rbatch_next == sep->rbatch_cnt) {
+		// the kernel updated these for the datagrams of the last batch
+		for (i = 0; i < sep->rbatch_cnt; i++) {
+			hdr = &sep->rbatch_msgs[i].msg_hdr;
+			hdr->msg_namelen = sizeof(struct sockaddr_storage);
+			hdr->msg_controllen = sep->udp_gro ? UDP_GRO_CTRL_SIZE : 0;
+		}
+		sep->rbatch_cnt = 0;
+		sep->rbatch_next = 0;
+		sep->rbatch_seg_off = 0;
+		// MSG_DONTWAIT is redundant since we set O_NONBLOCK
+		ret = recvmmsg(sep->udp_rx_fd, sep->rbatch_msgs, sep->rbatch_size,
+				MSG_DONTWAIT|MSG_TRUNC, NULL);
+		if (ret <= 0) {
+			if (ret == 0)
+				errno = EAGAIN;
+			return -1;
+		}
+		sep->rbatch_cnt = ret;
+	}
+
+	i = sep->rbatch_next;
+	hdr = &sep->rbatch_msgs[i].msg_hdr;
+	len = sep->rbatch_msgs[i].msg_len;
+	if (sep->udp_gro && len <= sep->rbatch_buf_size)
+		seg_size = psm3_sockets_udp_gro_size(hdr, len);
+	else
+		seg_size = len;
+
+	*buf = (uint8_t *)sep->rbatch_iovs[i].iov_base + sep->rbatch_seg_off;
+	*recvlen = min(seg_size, len - sep->rbatch_seg_off);
+	*rem_addr = &sep->rbatch_addrs[i];
+	*len_addr = hdr->msg_namelen;
+
+	sep->rbatch_seg_off += *recvlen;
+	if (sep->rbatch_seg_off >= len) {
+		sep->rbatch_next++;
+		sep->rbatch_seg_off = 0;
+	}
+	return 1;
+}
+
 psm2_error_t psm3_sockets_udp_recvhdrq_progress(struct ips_recvhdrq *recvq)
 {
 	GENERIC_PERF_BEGIN(PSM_RX_SPEEDPATH_CTR); /* perf stats */
@@ -794,8 +870,9 @@ psm2_error_t psm3_sockets_udp_recvhdrq_progress(struct ips_recvhdrq *recvq)
 	int ret = IPS_RECVHDRQ_CONTINUE;
 	int recvlen = 0;
 	psm2_ep_t ep = recvq->proto->ep;
-	struct sockaddr_storage rem_addr;
-	socklen_t len_addr = sizeof(rem_addr);
+	struct sockaddr_storage from_addr;
+	struct sockaddr_storage *rem_addr = &from_addr;
+	socklen_t len_addr = sizeof(from_addr);
 	PSMI_CACHEALIGN struct ips_recvhdrq_event rcv_ev = {
 		.proto = recvq->proto,
 		.recvq = recvq,
@@ -812,12 +889,21 @@ psm2_error_t psm3_sockets_udp_recvhdrq_progress(struct ips_recvhdrq *recvq)
 			rcv_ev.payload_size = ep->sockets_ep.revisit_payload_size;
 			ep->sockets_ep.revisit_payload_size = 0;
 		} else {
-			buf = ep->sockets_ep.rbuf;
-			// TBD - do we need rem_addr?  if not, can use recv
-			// MSG_DONTWAIT is redundant since we set O_NONBLOCK
-			recvlen = recvfrom(ep->sockets_ep.udp_rx_fd, buf, ep->sockets_ep.buf_size,
-								MSG_DONTWAIT|MSG_TRUNC,
-								(struct sockaddr *)&rem_addr, &len_addr);
+			if (ep->sockets_ep.rbatch_size) {
+				// packets not yet processed when we return stay
+				// in the batch for the next call
+				if (psm3_sockets_udp_rbatch_next(ep, &buf, &recvlen,
+							&rem_addr, &len_addr) < 0)
+					recvlen = -1;
+			} else {
+				buf = ep->sockets_ep.rbuf;
+				// TBD - do we need rem_addr?  if not, can use recv
+				// MSG_DONTWAIT is redundant since we set O_NONBLOCK
+				len_addr = sizeof(from_addr);
+				recvlen = recvfrom(ep->sockets_ep.udp_rx_fd, buf, ep->sockets_ep.buf_size,
+									MSG_DONTWAIT|MSG_TRUNC,
+									(struct sockaddr *)rem_addr, &len_addr);
+			}
 			if (recvlen < 0) {
 				if (errno == EAGAIN || errno == EWOULDBLOCK) {
 					break;
@@ -830,19 +916,19 @@ psm2_error_t psm3_sockets_udp_recvhdrq_progress(struct ips_recvhdrq *recvq)
 				}
 			}
 			// coverity[uninit_use] - rem_addr initialized in recvfrom() call above
-			if_pf (len_addr > sizeof(rem_addr)
-				|| rem_addr.ss_family != AF_INET6) {
+			if_pf (len_addr > sizeof(*rem_addr)
+				|| rem_addr->ss_family != AF_INET6) {
 				// TBD - how to best handle errors
 				// coverity[uninit_use_in_call] - rem_addr initialized in recvfrom() call above
 				_HFI_ERROR("unexpected rem_addr type (%u) on %s epid %s\n",
-					rem_addr.ss_family, ep->dev_name, psm3_epid_fmt_internal(ep->epid, 0));
+					rem_addr->ss_family, ep->dev_name, psm3_epid_fmt_internal(ep->epid, 0));
 				GENERIC_PERF_END(PSM_RX_SPEEDPATH_CTR); /* perf stats */
 				return PSM2_INTERNAL_ERR;
 			}
 			if_pf (_HFI_VDBG_ON) {
 				if (len_addr) {
 					_HFI_VDBG("got recv %u bytes from IP %s payload_size=%d opcode=%x\n", recvlen,
-						psm3_sockaddr_fmt((struct sockaddr *)&rem_addr, 0),
+						psm3_sockaddr_fmt((struct sockaddr *)rem_addr, 0),
 						rcv_ev.payload_size,
 						_get_proto_hfi_opcode((struct ips_message_header *)buf));
 				} else {
@@ -861,7 +947,7 @@ psm2_error_t psm3_sockets_udp_recvhdrq_progress(struct ips_recvhdrq *recvq)
 			rcv_ev.payload_size = recvlen - sizeof(struct ips_message_header);
 		}
 		ret = psm3_sockets_udp_process_packet(&rcv_ev, ep, buf,
-						(struct sockaddr_in6 *)&rem_addr, recvq);
+						(struct sockaddr_in6 *)rem_addr, recvq);
 		if_pf (ret == IPS_RECVHDRQ_REVISIT)
 		{
 			GENERIC_PERF_END(PSM_RX_SPEEDPATH_CTR); /* perf stats */
@@ -45,6 +45,7 @@
 #include <rdma/fi_domain.h>
 #include <rdma/fi_endpoint.h>
 #include <rdma/fi_eq.h>
+#include <rdma/fi_ext.h>
 #include <rdma/fi_rma.h>
 #include <rdma/fi_tagged.h>
 #include <rdma/providers/fi_log.h>
@@ -177,6 +178,8 @@ struct rstream_ep {
 	uint32_t rx_ctx_index;
 	struct rstream_tx_ctx_fs *tx_ctxs;
 	struct rstream_cq_data rx_cq_data;
+	/* bytes of the rx ring lent out through recv_borrow */
+	uint32_t rx_borrowed;
 	ofi_mutex_t send_lock;
 	ofi_mutex_t recv_lock;
 	/* must take send/recv lock before cq_lock */
@@ -214,6 +217,7 @@ extern void rstream_set_info(struct fi_info *info);
 extern struct fi_ops_cm rstream_ops_cm;
 extern struct fi_ops_cm rstream_ops_pep_cm;
 extern struct fi_ops_msg rstream_ops_msg;
+extern struct fi_ops_rstream rstream_ops_rstream;
 extern int rstream_passive_ep(struct fid_fabric *fabric, struct fi_info *info,
 	struct fid_pep **pep, void *context);
 extern void rstream_process_cm_event(struct rstream_ep *ep, void *cm_data);
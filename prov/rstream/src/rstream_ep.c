@@ -178,12 +178,23 @@ err1:
 	return ret;
 }
 
+static int rstream_ep_ops_open(struct fid *fid, const char *name,
+	uint64_t flags, void **ops, void *context)
+{
+	if (!strcasecmp(name, FI_RSTREAM_OPS)) {
+		*ops = &rstream_ops_rstream;
+		return 0;
+	}
+
+	return -FI_ENOSYS;
+}
+
 static struct fi_ops rstream_ep_fi_ops = {
 	.size = sizeof(struct fi_ops),
 	.close = rstream_ep_close,
 	.bind = rstream_ep_bind,
 	.control = rstream_ep_ctrl,
-	.ops_open = fi_no_ops_open,
+	.ops_open = rstream_ep_ops_open,
 };
 
 static int rstream_ep_setopt(fid_t fid, int level, int optname,
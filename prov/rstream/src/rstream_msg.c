@@ -650,6 +650,10 @@ static ssize_t rstream_recv(struct fid_ep *ep_fid, void *buf, size_t len,
 	ssize_t ret;
 
 	ofi_mutex_lock(&ep->recv_lock);
+	if (ep->rx_borrowed) {
+		ofi_mutex_unlock(&ep->recv_lock);
+		return -FI_EBUSY;
+	}
 
 	copy_out_len = rstream_copy_out_chunk(ep, buf, len);
 
@@ -679,6 +683,64 @@ static ssize_t rstream_recv(struct fid_ep *ep_fid, void *buf, size_t len,
 	return -FI_EAGAIN;
 }
 
+/* Lend out the contiguous received bytes at the read offset of the rx
+ * ring without copying them.  The read offset only moves, and the space is
+ * only returned to the sender, once the bytes are released.  Data that
+ * wraps around the end of the ring is returned by the next borrow.
+ */
+static ssize_t rstream_recv_borrow(struct fid_ep *ep_fid, void **buf)
+{
+	struct rstream_ep *ep = container_of(ep_fid, struct rstream_ep,
+		util_ep.ep_fid);
+	struct rstream_mr_seg *rx = &ep->local_mr.rx;
+	uint32_t len;
+	ssize_t ret;
+
+	ofi_mutex_lock(&ep->recv_lock);
+	len = rstream_calc_contig_len(rx);
+	if (!len) {
+		ret = rstream_process_cq(ep, RSTREAM_RX_MSG_COMP);
+		if (ret < 0 && ret != -FI_EAGAIN) {
+			ofi_mutex_unlock(&ep->recv_lock);
+			return ret;
+		}
+		len = rstream_calc_contig_len(rx);
+	}
+
+	if (len) {
+		*buf = (char *)rx->data_start + rx->start_offset;
+		ep->rx_borrowed = len;
+	}
+	ofi_mutex_unlock(&ep->recv_lock);
+
+	return len ? len : -FI_EAGAIN;
+}
+
+static int rstream_recv_release(struct fid_ep *ep_fid, size_t len)
+{
+	struct rstream_ep *ep = container_of(ep_fid, struct rstream_ep,
+		util_ep.ep_fid);
+	char *rx_data_ptr;
+	ssize_t ret;
+
+	ofi_mutex_lock(&ep->recv_lock);
+	if (len > ep->rx_borrowed) {
+		ofi_mutex_unlock(&ep->recv_lock);
+		return -FI_EINVAL;
+	}
+
+	rstream_alloc_contig_len_available(&ep->local_mr.rx, &rx_data_ptr,
+		len);
+	ep->rx_borrowed = 0;
+
+	ofi_mutex_lock(&ep->send_lock);
+	ret = rstream_update_target(ep, 0, len);
+	ofi_mutex_unlock(&ep->send_lock);
+	ofi_mutex_unlock(&ep->recv_lock);
+
+	return (ret < 0 && ret != -FI_EAGAIN) ? (int) ret : 0;
+}
+
 static ssize_t rstream_recvv(struct fid_ep *ep_fid, const struct iovec *iov,
 	void **desc, size_t count, fi_addr_t src_addr, void *context)
 {
@@ -740,3 +802,9 @@ struct fi_ops_msg rstream_ops_msg = {
 	.senddata = fi_no_msg_senddata,
 	.injectdata = fi_no_msg_injectdata,
 };
+
+struct fi_ops_rstream rstream_ops_rstream = {
+	.size = sizeof(struct fi_ops_rstream),
+	.recv_borrow = rstream_recv_borrow,
+	.recv_release = rstream_recv_release,
+};
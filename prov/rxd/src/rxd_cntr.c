@@ -49,8 +49,9 @@ static int rxd_cntr_wait(struct fid_cntr *cntr_fid, uint64_t threshold, int time
 	endtime = ofi_timeout_time(timeout);
 
 	do {
+		ofi_cntr_wait_threshold(cntr, threshold);
 		cntr->progress(cntr);
-		if (threshold <= (uint64_t) ofi_atomic_get64(&cntr->cnt))
+		if (threshold <= ofi_cntr_value(cntr))
 			return FI_SUCCESS;
 
 		if (errcnt != (uint64_t) ofi_atomic_get64(&cntr->err))
@@ -934,6 +934,8 @@ static void rxd_progress_pkt_list(struct rxd_ep *ep, struct rxd_peer *peer)
 						 (uint8_t) peer->retry_cnt))
 			break;
 		retry = 1;
+		OFI_TRACE(rxd_retransmit, ep, peer, pkt_entry,
+			  peer->retry_cnt);
 		ret = rxd_ep_send_pkt(ep, pkt_entry);
 		if (ret)
 			break;
@@ -121,6 +121,11 @@ static inline uint32_t rxm_peer_pid(uint64_t conn_id)
 
 extern size_t rxm_buffer_size;
 extern size_t rxm_packet_size;
+extern size_t rxm_rx_slab_size;
+extern size_t rxm_max_conns;
+extern size_t rxm_rndv_chunk_size;
+extern size_t rxm_buf_arena_size;
+extern int rxm_auto_tune;
 
 #define RXM_SAR_TX_ERROR	UINT64_MAX
 #define RXM_SAR_RX_INIT		UINT64_MAX
@@ -188,12 +193,14 @@ extern struct fi_ops_tagged rxm_tagged_thru_ops;
 extern struct fi_ops_rma rxm_rma_ops;
 extern struct fi_ops_rma rxm_rma_thru_ops;
 extern struct fi_ops_atomic rxm_ops_atomic;
+extern struct fi_ops_persist rxm_ops_persist;
 
 enum {
 	RXM_MSG_RXTX_SIZE = 128,
 	RXM_MSG_SRX_SIZE = 4096,
 	RXM_RX_SIZE = 65536,
 	RXM_TX_SIZE = 16384,
+	RXM_RX_SLAB_CNT = 4,
 };
 
 extern size_t rxm_msg_tx_size;
@@ -218,6 +225,26 @@ enum rxm_cm_state {
 
 enum {
 	RXM_CONN_INDEXED = BIT(0),
+	RXM_CONN_EVICTED = BIT(1),
+	RXM_CONN_CLOSE_REQ = BIT(2),	/* asked the peer to close */
+	RXM_CONN_CLOSE_ACK = BIT(3),	/* agreed to the peer's request */
+	RXM_CONN_CLOSE_FIN = BIT(4),	/* waiting for the peer to close */
+};
+
+#define RXM_CONN_CLOSING \
+	(RXM_CONN_CLOSE_REQ | RXM_CONN_CLOSE_ACK | RXM_CONN_CLOSE_FIN)
+
+/* Close handshake used by the connection cache, carried in ctrl_data of
+ * an rxm_ctrl_close message.  Either side may ask to close an idle conn.
+ * Once the peer agrees, the requester sends FIN, which is ordered after
+ * everything else it sent, and the peer shuts the connection down.
+ */
+enum {
+	RXM_CLOSE_REQ,
+	RXM_CLOSE_ACK,
+	RXM_CLOSE_NAK,
+	RXM_CLOSE_CANCEL,
+	RXM_CLOSE_FIN,
 };
 
 /* Each local rxm ep will have at most 1 connection to a single
@@ -245,7 +272,10 @@ struct rxm_conn {
 	struct dlist_entry deferred_tx_queue;
 	struct dlist_entry deferred_sar_msgs;
 	struct dlist_entry deferred_sar_segments;
+	/* rendezvous sends waiting on the peer keep the conn open */
+	struct dlist_entry rndv_tx_list;
 	struct dlist_entry loopback_entry;
+	struct dlist_entry lru_entry;
 };
 
 void rxm_freeall_conns(struct rxm_ep *ep);
@@ -341,13 +371,16 @@ struct rxm_atomic_resp_hdr {
 	FUNC(RXM_INJECT_TX),		\
 	FUNC(RXM_RMA),			\
 	FUNC(RXM_RX),			\
+	FUNC(RXM_RX_SLAB),		\
 	FUNC(RXM_SAR_TX),		\
 	FUNC(RXM_CREDIT_TX),		\
+	FUNC(RXM_CLOSE_TX),		\
 	FUNC(RXM_RNDV_TX),		\
 	FUNC(RXM_RNDV_READ_DONE_WAIT),	\
 	FUNC(RXM_RNDV_WRITE_DATA_WAIT),	\
 	FUNC(RXM_RNDV_WRITE_DONE_WAIT),	\
 	FUNC(RXM_RNDV_READ),		\
+	FUNC(RXM_RNDV_READ_CHUNK),	\
 	FUNC(RXM_RNDV_WRITE), /* not used */ \
 	FUNC(RXM_RNDV_READ_DONE_SENT),	\
 	FUNC(RXM_RNDV_READ_DONE_RECVD),	\
@@ -374,7 +407,8 @@ enum {
 	rxm_ctrl_atomic_resp,
 	rxm_ctrl_credit,
 	rxm_ctrl_rndv_wr_data,
-	rxm_ctrl_rndv_wr_done
+	rxm_ctrl_rndv_wr_done,
+	rxm_ctrl_close
 };
 
 struct rxm_pkt {
@@ -453,15 +487,63 @@ struct rxm_rx_buf {
 	/* Used for large messages */
 	struct dlist_entry rndv_wait_entry;
 	struct rxm_rndv_hdr *remote_rndv_hdr;
-	size_t rndv_rma_index;
 	struct fid_mr *mr[RXM_IOV_LIMIT];
-
+	/* read rendezvous position in the remote and local iovs */
+	size_t rndv_rma_index;
+	size_t rndv_rma_offset;
+	size_t rndv_iov_index;
+	size_t rndv_iov_offset;
+	size_t rndv_left;
+	size_t rndv_reads;
+	/* first chunk error, reported once the outstanding reads drain */
+	int rndv_err;
+
+	/* Set if data references a packet carved from a multi-recv slab */
+	struct rxm_rx_slab *slab;
 	/* Only differs from pkt.data for unexpected messages */
 	void *data;
 	/* Must stay at bottom */
 	struct rxm_pkt pkt;
 };
 
+/* Read rendezvous transfers are split into chunks of at most
+ * rxm_rndv_chunk_size bytes, with up to RXM_RNDV_READ_DEPTH reads
+ * outstanding.  Each chunk registers the part of the receive buffer it
+ * reads into, so registration of a large buffer overlaps the transfer.
+ */
+#define RXM_RNDV_READ_DEPTH	4
+
+struct rxm_rndv_chunk {
+	/* Must stay at top */
+	struct rxm_buf hdr;
+
+	struct rxm_rx_buf *rx_buf;
+	size_t count;
+	struct fid_mr *mr[RXM_IOV_LIMIT];
+};
+
+/* Multi-recv buffer posted to the msg provider when it supports
+ * FI_MULTI_RECV.  The provider packs incoming packets back to back into
+ * the slab.  Eager data is left in place and referenced by a header-only
+ * rx_buf; the slab is reposted once the provider has released it and
+ * the last reference is dropped.
+ */
+struct rxm_rx_slab {
+	/* Must stay at top */
+	struct rxm_buf hdr;
+
+	struct rxm_ep *ep;
+	struct fid_ep *rx_ep;
+	struct rxm_conn *conn;
+	size_t consumed;
+	size_t released;
+	int refcnt;
+	bool posted;
+	bool repost;
+
+	uint8_t data[];
+};
+
 struct rxm_tx_buf {
 	/* Must stay at top */
 	struct rxm_buf hdr;
@@ -488,6 +570,14 @@ struct rxm_tx_buf {
 		struct rxm_rndv_hdr remote_hdr;
 	} write_rndv;
 
+	/* entry in rndv_tx_list of the conn while the peer is pulling data */
+	struct dlist_entry rndv_entry;
+
+	/* set when the send is measured by the protocol tuner */
+	size_t tune_len;
+	uint32_t tune_epoch;
+	bool tune_trial;
+
 	/* Must stay at bottom */
 	struct rxm_pkt pkt;
 };
@@ -504,6 +594,7 @@ enum rxm_deferred_tx_entry_type {
 	RXM_DEFERRED_TX_SAR_SEG,
 	RXM_DEFERRED_TX_ATOMIC_RESP,
 	RXM_DEFERRED_TX_CREDIT_SEND,
+	RXM_DEFERRED_TX_CLOSE,
 };
 
 struct rxm_deferred_tx_entry {
@@ -522,6 +613,7 @@ struct rxm_deferred_tx_entry {
 		} rndv_done;
 		struct {
 			struct rxm_rx_buf *rx_buf;
+			struct rxm_rndv_chunk *chunk;
 			struct fi_rma_iov rma_iov;
 			struct rxm_iov rxm_iov;
 		} rndv_read;
@@ -557,6 +649,9 @@ struct rxm_deferred_tx_entry {
 		struct {
 			struct rxm_tx_buf *tx_buf;
 		} credit_msg;
+		struct {
+			struct rxm_tx_buf *tx_buf;
+		} close_msg;
 	};
 };
 
@@ -626,6 +721,82 @@ struct rxm_rndv_ops {
 			      void *buf);
 };
 
+enum rxm_proto {
+	RXM_PROTO_EAGER,
+	RXM_PROTO_SAR,
+	RXM_PROTO_RNDV,
+};
+
+#define RXM_TUNE_EPOCH		32
+#define RXM_TUNE_IDLE_SENDS	(RXM_TUNE_EPOCH * 6)
+#define RXM_TUNE_SAR_SCALE	4
+
+enum rxm_tune_phase {
+	RXM_TUNE_IDLE,
+	RXM_TUNE_BASE,
+	RXM_TUNE_TRIAL,
+	RXM_TUNE_SETTLE,
+	RXM_TUNE_WAIT,
+};
+
+/* Bytes completed while sends of one limit were outstanding */
+struct rxm_tune_stat {
+	uint64_t		start;
+	uint64_t		busy;
+	uint64_t		bytes;
+	uint32_t		pending;
+	uint32_t		cnt;
+};
+
+/* Hill climbs sar_limit, the size above which sends use rendezvous.
+ * Sends within a factor of 2 of the limit are counted in epochs.  Two
+ * epochs at the current limit are followed by one at a trial limit, 1.5
+ * times larger or smaller, and the trial limit is kept if data completed
+ * at a higher rate while sends were outstanding.  Eager and SAR sends
+ * complete before the peer has received them, so the epoch after the
+ * trial settles the backlog it left and is measured with it.  Idle
+ * periods keep trials to 1/10th of the sends near the limit.  When SAR
+ * is disabled, eager_limit moves along with sar_limit.
+ */
+struct rxm_tune {
+	bool			enabled;
+	bool			eager;
+	bool			up;
+	enum rxm_tune_phase	phase;
+	size_t			min;
+	size_t			max;
+	size_t			trial_limit;
+	uint32_t		epoch;
+	uint64_t		sends;
+	uint64_t		adjustments;
+	/* current limit, trial and settle epochs */
+	struct rxm_tune_stat	stat[2];
+};
+
+/* With rxm_buf_arena_size set, the regions of the bounce buffer pools
+ * are carved out of a single range per endpoint.  The range is backed by
+ * transparent huge pages where available and registered with the msg
+ * provider once, so growing a pool does not register memory.  Regions
+ * released by an idle pool return to the arena for reuse.
+ */
+#define RXM_ARENA_TRIM_INTERVAL	1000000	/* usec */
+
+struct rxm_arena_range {
+	struct dlist_entry	entry;
+	char			*addr;
+	size_t			len;
+};
+
+struct rxm_buf_arena {
+	char			*base;
+	size_t			size;
+	size_t			used;
+	struct dlist_entry	free_list;
+	struct fid_mr		*mr;
+	uint64_t		last_trim;
+	bool			reclaim;
+};
+
 struct rxm_ep {
 	struct util_ep 		util_ep;
 	struct fi_info 		*rxm_info;
@@ -636,6 +807,12 @@ struct rxm_ep {
 	struct dlist_entry	loopback_list;
 	union ofi_sock_ip	addr;
 
+	/* connection cache, most recently used first */
+	struct dlist_entry	conn_lru;
+	size_t			conn_cnt;
+	uint64_t		evictions;
+	uint64_t		reconnects;
+
 	pthread_t		cm_thread;
 	struct fid_pep 		*msg_pep;
 	struct fid_eq 		*msg_eq;
@@ -662,9 +839,14 @@ struct rxm_ep {
 	size_t			eager_limit;
 	size_t			sar_limit;
 	size_t			tx_credit;
+	struct rxm_tune		tune;
 
 	struct ofi_bufpool	*rx_pool;
 	struct ofi_bufpool	*tx_pool;
+	struct ofi_bufpool	*rx_slab_pool;
+	struct ofi_bufpool	*rx_ref_pool;
+	struct ofi_bufpool	*rndv_chunk_pool;
+	struct rxm_buf_arena	buf_arena;
 	struct rxm_pkt		*inject_pkt;
 
 	struct dlist_entry	deferred_queue;
@@ -681,6 +863,24 @@ struct rxm_ep {
 int rxm_start_listen(struct rxm_ep *ep);
 void rxm_stop_listen(struct rxm_ep *ep);
 void rxm_conn_progress(struct rxm_ep *ep);
+void rxm_ep_trim_pools(struct rxm_ep *ep);
+void rxm_process_close(struct rxm_conn *conn, uint64_t op);
+
+static inline void rxm_touch_conn(struct rxm_conn *conn)
+{
+	if (!dlist_empty(&conn->lru_entry)) {
+		dlist_remove(&conn->lru_entry);
+		dlist_insert_head(&conn->lru_entry, &conn->ep->conn_lru);
+	}
+}
+
+/* With a shared receive context, the conn is looked up on demand. */
+static inline struct rxm_conn *rxm_rx_buf_conn(struct rxm_rx_buf *rx_buf)
+{
+	return rx_buf->conn ? rx_buf->conn :
+	       ofi_idm_lookup(&rx_buf->ep->conn_idx_map,
+			      (int) rx_buf->pkt.ctrl_hdr.conn_id);
+}
 
 
 extern struct fi_provider rxm_prov;
@@ -731,6 +931,9 @@ int rxm_ep_query_atomic(struct fid_domain *domain, enum fi_datatype datatype,
 			enum fi_op op, struct fi_atomic_attr *attr,
 			uint64_t flags);
 ssize_t rxm_rndv_read(struct rxm_rx_buf *rx_buf);
+void rxm_rndv_read_chunk_error(struct rxm_rndv_chunk *chunk, int err);
+ssize_t rxm_rndv_read_chunk(struct rxm_rndv_chunk *chunk, struct iovec *iov,
+			    void **desc, uint64_t addr, uint64_t key);
 ssize_t rxm_rndv_send_wr_data(struct rxm_rx_buf *rx_buf);
 void rxm_rndv_hdr_init(struct rxm_ep *rxm_ep, void *buf,
 			      const struct iovec *iov, size_t count,
@@ -881,6 +1084,57 @@ rxm_send_common(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 		const struct iovec *iov, void **desc, size_t count,
 		void *context, uint64_t data, uint64_t flags, uint64_t tag,
 		uint8_t op);
+void rxm_tune_send(struct rxm_ep *ep, struct rxm_tx_buf *tx_buf, size_t len);
+void rxm_tune_sample(struct rxm_ep *ep, struct rxm_tx_buf *tx_buf);
+
+static inline bool rxm_tune_band(struct rxm_ep *ep, size_t len)
+{
+	return len > ep->tune.min && len > ep->sar_limit / 2 &&
+	       len <= ep->sar_limit * 2;
+}
+
+static inline void
+rxm_tune_stamp(struct rxm_ep *ep, struct rxm_tx_buf *tx_buf, size_t len)
+{
+	if (ep->tune.enabled && rxm_tune_band(ep, len))
+		rxm_tune_send(ep, tx_buf, len);
+}
+
+enum rxm_persist_path {
+	RXM_PERSIST_MSG_TSEND,
+	RXM_PERSIST_DIRECT,
+	RXM_PERSIST_COPY,
+};
+
+/* A persistent tagged send or receive.  Sends resolve the peer, protocol,
+ * eager transfer path and packet header once, when they are created.
+ */
+struct rxm_persist_req {
+	struct fi_persist_req	persist;
+	struct rxm_ep		*ep;
+	struct iovec		iov;
+	void			*desc;
+	fi_addr_t		addr;
+	uint64_t		tag;
+	uint64_t		ignore;
+	uint64_t		flags;
+	bool			send;
+	bool			thru;
+
+	struct util_peer_addr	*peer;
+	enum rxm_proto		proto;
+	enum rxm_persist_path	path;
+	enum fi_hmem_iface	iface;
+	uint64_t		device;
+	struct rxm_pkt		pkt;
+};
+
+enum rxm_proto
+rxm_select_proto(struct rxm_ep *ep, size_t data_len, size_t count, uint8_t op);
+void rxm_persist_send_init(struct rxm_ep *ep, struct rxm_persist_req *req);
+ssize_t rxm_persist_send(struct rxm_ep *ep, struct rxm_conn *conn,
+			 struct rxm_persist_req *req);
+
 ssize_t
 rxm_inject_send(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 		const void *buf, size_t len);
@@ -897,10 +1151,19 @@ ssize_t rxm_handle_unexp_sar(struct rxm_recv_queue *recv_queue,
 			     struct rxm_recv_entry *recv_entry,
 			     struct rxm_rx_buf *rx_buf);
 int rxm_post_recv(struct rxm_rx_buf *rx_buf);
+void rxm_release_rx_slab(struct rxm_rx_slab *slab);
 
 static inline void
 rxm_free_rx_buf(struct rxm_rx_buf *rx_buf)
 {
+	if (rx_buf->slab) {
+		rxm_release_rx_slab(rx_buf->slab);
+		rx_buf->slab = NULL;
+		rx_buf->data = &rx_buf->pkt.data;
+		ofi_buf_free(rx_buf);
+		return;
+	}
+
 	if (rx_buf->data != rx_buf->pkt.data) {
 		free(rx_buf->data);
 		rx_buf->data = &rx_buf->pkt.data;
@@ -55,6 +55,22 @@ struct rxm_eq_cm_entry {
 };
 
 
+static void rxm_conn_lru_add(struct rxm_conn *conn)
+{
+	assert(dlist_empty(&conn->lru_entry));
+	dlist_insert_head(&conn->lru_entry, &conn->ep->conn_lru);
+	conn->ep->conn_cnt++;
+}
+
+static void rxm_conn_lru_del(struct rxm_conn *conn)
+{
+	if (dlist_empty(&conn->lru_entry))
+		return;
+
+	dlist_remove_init(&conn->lru_entry);
+	conn->ep->conn_cnt--;
+}
+
 static void rxm_close_conn(struct rxm_conn *conn)
 {
 	struct rxm_deferred_tx_entry *tx_entry;
@@ -69,6 +85,8 @@ static void rxm_close_conn(struct rxm_conn *conn)
 		tx_entry = container_of(conn->deferred_tx_queue.next,
 				     struct rxm_deferred_tx_entry, entry);
 		rxm_dequeue_deferred_tx(tx_entry);
+		if (tx_entry->type == RXM_DEFERRED_TX_CLOSE)
+			ofi_buf_free(tx_entry->close_msg.tx_buf);
 		free(tx_entry);
 	}
 
@@ -87,7 +105,14 @@ static void rxm_close_conn(struct rxm_conn *conn)
 	}
 	fi_close(&conn->msg_ep->fid);
 	rxm_flush_msg_cq(conn->ep);
+
+	/* The peer will not finish the remaining rendezvous sends.  Unlink
+	 * them, so that a later completion does not touch this conn.
+	 */
+	while (!dlist_empty(&conn->rndv_tx_list))
+		dlist_remove_init(conn->rndv_tx_list.next);
 	dlist_remove_init(&conn->loopback_entry);
+	rxm_conn_lru_del(conn);
 	conn->msg_ep = NULL;
 
 	if (conn->state == RXM_CM_CONNECTING || conn->state == RXM_CM_ACCEPTING)
@@ -173,6 +198,180 @@ static int rxm_bind_comp(struct rxm_ep *ep, struct fid_ep *msg_ep)
 	return 0;
 }
 
+static bool rxm_conn_referenced(struct dlist_entry *list,
+				struct rxm_conn *conn)
+{
+	struct rxm_rx_buf *rx_buf;
+
+	dlist_foreach_container(list, struct rxm_rx_buf, rx_buf,
+				unexp_msg.entry) {
+		if (rxm_rx_buf_conn(rx_buf) == conn)
+			return true;
+	}
+	return false;
+}
+
+/* A conn may be closed once nothing that rxm tracks still needs it.
+ * Transfers queued inside the msg provider are ordered ahead of the
+ * close messages and complete before the connection is shut down.
+ */
+static bool rxm_conn_idle(struct rxm_conn *conn)
+{
+	struct rxm_rx_buf *rx_buf;
+
+	if (conn->state != RXM_CM_CONNECTED ||
+	    !dlist_empty(&conn->rndv_tx_list) ||
+	    !dlist_empty(&conn->deferred_tx_queue) ||
+	    !dlist_empty(&conn->deferred_sar_msgs) ||
+	    !dlist_empty(&conn->deferred_sar_segments) ||
+	    rxm_conn_referenced(&conn->ep->recv_queue.unexp_msg_list, conn) ||
+	    rxm_conn_referenced(&conn->ep->trecv_queue.unexp_msg_list, conn))
+		return false;
+
+	dlist_foreach_container(&conn->ep->rndv_wait_list, struct rxm_rx_buf,
+				rx_buf, rndv_wait_entry) {
+		if (rxm_rx_buf_conn(rx_buf) == conn)
+			return false;
+	}
+	return true;
+}
+
+static ssize_t rxm_send_close(struct rxm_conn *conn, uint64_t op)
+{
+	struct rxm_deferred_tx_entry *def_tx_entry;
+	struct rxm_tx_buf *tx_buf;
+	ssize_t ret;
+
+	tx_buf = ofi_buf_alloc(conn->ep->tx_pool);
+	if (!tx_buf)
+		return -FI_ENOMEM;
+
+	tx_buf->hdr.state = RXM_CLOSE_TX;
+	rxm_ep_format_tx_buf_pkt(conn, 0, 0, 0, 0, 0, &tx_buf->pkt);
+	tx_buf->pkt.ctrl_hdr.type = rxm_ctrl_close;
+	tx_buf->pkt.ctrl_hdr.msg_id = ofi_buf_index(tx_buf);
+	tx_buf->pkt.ctrl_hdr.ctrl_data = op;
+
+	/* must stay behind anything already deferred */
+	if (dlist_empty(&conn->deferred_tx_queue)) {
+		ret = fi_send(conn->msg_ep, &tx_buf->pkt, sizeof(tx_buf->pkt),
+			      tx_buf->hdr.desc, 0, tx_buf);
+		if (ret != -FI_EAGAIN) {
+			if (ret) {
+				RXM_WARN_ERR(FI_LOG_EP_CTRL, "fi_send", ret);
+				ofi_buf_free(tx_buf);
+			}
+			return ret;
+		}
+	}
+
+	def_tx_entry = rxm_ep_alloc_deferred_tx_entry(conn->ep, conn,
+						      RXM_DEFERRED_TX_CLOSE);
+	if (!def_tx_entry) {
+		ofi_buf_free(tx_buf);
+		return -FI_ENOMEM;
+	}
+
+	def_tx_entry->close_msg.tx_buf = tx_buf;
+	rxm_queue_deferred_tx(def_tx_entry, OFI_LIST_TAIL);
+	return 0;
+}
+
+/* Back to the cache after the peer declined, or we did. */
+static void rxm_conn_keep(struct rxm_conn *conn)
+{
+	if (!(conn->flags & RXM_CONN_CLOSING) && dlist_empty(&conn->lru_entry))
+		rxm_conn_lru_add(conn);
+}
+
+/* The conn object stays allocated and keeps its index, as received
+ * buffers may reference it.  The next transfer reopens it.
+ */
+static void rxm_close_evicted(struct rxm_conn *conn)
+{
+	FI_DBG(&rxm_prov, FI_LOG_EP_CTRL, "closed evicted conn %p\n", conn);
+	rxm_close_conn(conn);
+	conn->flags &= ~RXM_CONN_CLOSING;
+	conn->flags |= RXM_CONN_EVICTED;
+}
+
+void rxm_process_close(struct rxm_conn *conn, uint64_t op)
+{
+	assert(ofi_ep_lock_held(&conn->ep->util_ep));
+	FI_DBG(&rxm_prov, FI_LOG_EP_CTRL, "close op %" PRIu64 " for conn %p\n",
+	       op, conn);
+
+	if (conn->state != RXM_CM_CONNECTED)
+		return;
+
+	switch (op) {
+	case RXM_CLOSE_REQ:
+		if (!(conn->flags & RXM_CONN_CLOSE_FIN) && rxm_conn_idle(conn) &&
+		    !rxm_send_close(conn, RXM_CLOSE_ACK)) {
+			conn->flags |= RXM_CONN_CLOSE_ACK;
+			rxm_conn_lru_del(conn);
+		} else {
+			(void) rxm_send_close(conn, RXM_CLOSE_NAK);
+		}
+		break;
+	case RXM_CLOSE_ACK:
+		/* The peer will not start anything new, but we may have
+		 * received something from it that still needs the conn.
+		 */
+		conn->flags &= ~RXM_CONN_CLOSE_REQ;
+		if (rxm_conn_idle(conn) && !rxm_send_close(conn, RXM_CLOSE_FIN)) {
+			conn->flags |= RXM_CONN_CLOSE_FIN;
+			conn->ep->evictions++;
+		} else {
+			(void) rxm_send_close(conn, RXM_CLOSE_CANCEL);
+			rxm_conn_keep(conn);
+		}
+		break;
+	case RXM_CLOSE_NAK:
+		conn->flags &= ~RXM_CONN_CLOSE_REQ;
+		rxm_conn_keep(conn);
+		break;
+	case RXM_CLOSE_CANCEL:
+		conn->flags &= ~RXM_CONN_CLOSE_ACK;
+		rxm_conn_keep(conn);
+		break;
+	case RXM_CLOSE_FIN:
+		/* Everything the peer sent has arrived.  Both sides see the
+		 * shutdown event and close.
+		 */
+		fi_shutdown(conn->msg_ep, 0);
+		break;
+	default:
+		FI_WARN(&rxm_prov, FI_LOG_EP_CTRL, "unknown close op\n");
+		break;
+	}
+}
+
+static void rxm_make_room(struct rxm_ep *ep)
+{
+	struct rxm_conn *conn;
+
+	if (!rxm_max_conns || ep->conn_cnt < rxm_max_conns)
+		return;
+
+	dlist_foreach_container_reverse(&ep->conn_lru, struct rxm_conn,
+					conn, lru_entry) {
+		if (rxm_conn_idle(conn)) {
+			FI_DBG(&rxm_prov, FI_LOG_EP_CTRL,
+			       "evicting conn %p\n", conn);
+			if (rxm_send_close(conn, RXM_CLOSE_REQ))
+				return;
+
+			conn->flags |= RXM_CONN_CLOSE_REQ;
+			rxm_conn_lru_del(conn);
+			return;
+		}
+	}
+
+	FI_DBG(&rxm_prov, FI_LOG_EP_CTRL,
+	       "no idle conn to evict, exceeding max_conns\n");
+}
+
 static int rxm_open_conn(struct rxm_conn *conn, struct fi_info *msg_info)
 {
 	struct rxm_domain *domain;
@@ -185,6 +384,9 @@ static int rxm_open_conn(struct rxm_conn *conn, struct fi_info *msg_info)
 
 	assert(ofi_ep_lock_held(&conn->ep->util_ep));
 	ep = conn->ep;
+	if (conn->flags & RXM_CONN_INDEXED)
+		rxm_make_room(ep);
+
 	domain = container_of(ep->util_ep.domain, struct rxm_domain,
 			      util_domain);
 	ret = fi_endpoint(domain->msg_domain, msg_info, &msg_ep, conn);
@@ -233,6 +435,13 @@ static int rxm_open_conn(struct rxm_conn *conn, struct fi_info *msg_info)
 	}
 
 	conn->msg_ep = msg_ep;
+	if (conn->flags & RXM_CONN_INDEXED) {
+		rxm_conn_lru_add(conn);
+		if (conn->flags & RXM_CONN_EVICTED) {
+			conn->flags &= ~RXM_CONN_EVICTED;
+			ep->reconnects++;
+		}
+	}
 	return 0;
 err:
 	fi_close(&msg_ep->fid);
@@ -389,6 +598,7 @@ void rxm_freeall_conns(struct rxm_ep *ep)
 		rxm_free_conn(conn);
 	}
 
+	ofi_idm_reset(&ep->conn_idx_map, NULL);
 	ofi_ep_lock_release(&ep->util_ep);
 }
 
@@ -414,7 +624,9 @@ rxm_alloc_conn(struct rxm_ep *ep, struct util_peer_addr *peer)
 	dlist_init(&conn->deferred_tx_queue);
 	dlist_init(&conn->deferred_sar_msgs);
 	dlist_init(&conn->deferred_sar_segments);
+	dlist_init(&conn->rndv_tx_list);
 	dlist_init(&conn->loopback_entry);
+	dlist_init(&conn->lru_entry);
 
 	conn->peer = peer;
 	rxm_ref_peer(peer);
@@ -460,11 +672,18 @@ ssize_t rxm_get_conn(struct rxm_ep *ep, fi_addr_t addr, struct rxm_conn **conn)
 		return -FI_ENOMEM;
 
 	if ((*conn)->state == RXM_CM_CONNECTED) {
+		/* wait for the close handshake to finish */
+		if ((*conn)->flags & RXM_CONN_CLOSING) {
+			rxm_ep_do_progress(&ep->util_ep);
+			return -FI_EAGAIN;
+		}
 		if (!dlist_empty(&(*conn)->deferred_tx_queue)) {
 			rxm_ep_do_progress(&ep->util_ep);
 			if (!dlist_empty(&(*conn)->deferred_tx_queue))
 				return -FI_EAGAIN;
 		}
+		if (rxm_max_conns)
+			rxm_touch_conn(*conn);
 		return 0;
 	}
 
@@ -708,7 +927,12 @@ rxm_process_connreq(struct rxm_ep *ep, struct rxm_eq_cm_entry *cm_entry)
 		break;
 	case RXM_CM_ACCEPTING:
 	case RXM_CM_CONNECTED:
-		if (conn->remote_pid &&
+		if (conn->flags & RXM_CONN_CLOSING) {
+			/* the peer closed its side already */
+			FI_INFO(&rxm_prov, FI_LOG_EP_CTRL,
+				"closing conn %p, accept peer\n", conn);
+			rxm_close_evicted(conn);
+		} else if (conn->remote_pid &&
 		    (conn->remote_pid == rxm_peer_pid(cm_entry->data.connect.
 		    				      client_conn_id))) {
 			FI_INFO(&rxm_prov, FI_LOG_EP_CTRL,
@@ -770,6 +994,10 @@ void rxm_process_shutdown(struct rxm_conn *conn)
 	case RXM_CM_CONNECTING:
 	case RXM_CM_ACCEPTING:
 	case RXM_CM_CONNECTED:
+		if (conn->flags & RXM_CONN_CLOSING) {
+			rxm_close_evicted(conn);
+			break;
+		}
 		rxm_close_conn(conn);
 		rxm_free_conn(conn);
 		break;
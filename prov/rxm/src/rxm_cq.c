@@ -92,6 +92,10 @@ static void rxm_replace_rx_buf(struct rxm_rx_buf *rx_buf)
 	struct rxm_rx_buf *new_rx_buf;
 	int ret;
 
+	/* Buffers carved from a slab were never posted on their own */
+	if (!rx_buf->repost)
+		return;
+
 	new_rx_buf = rxm_rx_buf_alloc(rx_buf->ep, rx_buf->rx_ep);
 	if (!new_rx_buf)
 		return;
@@ -156,6 +160,21 @@ static void rxm_cq_write_error_trunc(struct rxm_rx_buf *rx_buf, size_t done_len)
 	}
 }
 
+/* Collective transfers are issued by util_coll and complete to it rather
+ * than to the application.  Eager transfers are routed by coll_eager_ops;
+ * this handles the ones sent using the SAR and rendezvous protocols.
+ */
+static bool rxm_coll_xfer_comp(struct rxm_ep *rxm_ep, uint64_t tag,
+			       void *context)
+{
+	if (!(rxm_ep->rxm_info->caps & FI_COLLECTIVE) ||
+	    !(tag & OFI_COLL_TAG_FLAG))
+		return false;
+
+	ofi_coll_handle_xfer_comp(tag, context);
+	return true;
+}
+
 static void rxm_finish_recv(struct rxm_rx_buf *rx_buf, size_t done_len)
 {
 	struct rxm_recv_entry *recv_entry = rx_buf->recv_entry;
@@ -165,6 +184,10 @@ static void rxm_finish_recv(struct rxm_rx_buf *rx_buf, size_t done_len)
 		goto release;
 	}
 
+	if (rxm_coll_xfer_comp(rx_buf->ep, rx_buf->pkt.hdr.tag,
+			       recv_entry->context))
+		goto release;
+
 	if (rx_buf->recv_entry->flags & FI_COMPLETION ||
 	    rx_buf->ep->rxm_info->mode & FI_BUFFERED_RECV) {
 		rxm_cq_write_recv_comp(rx_buf, rx_buf->recv_entry->context,
@@ -238,6 +261,8 @@ static bool rxm_complete_sar(struct rxm_ep *rxm_ep,
 	case RXM_SAR_SEG_LAST:
 		first_tx_buf = ofi_bufpool_get_ibuf(rxm_ep->tx_pool,
 						tx_buf->pkt.ctrl_hdr.msg_id);
+		if (first_tx_buf->tune_len)
+			rxm_tune_sample(rxm_ep, first_tx_buf);
 		rxm_free_tx_buf(rxm_ep, first_tx_buf);
 		rxm_free_tx_buf(rxm_ep, tx_buf);
 		return true;
@@ -250,21 +275,27 @@ static void rxm_handle_sar_comp(struct rxm_ep *rxm_ep,
 				struct rxm_tx_buf *tx_buf)
 {
 	void *app_context;
-	uint64_t comp_flags, tx_flags;
+	uint64_t comp_flags, tx_flags, tag;
 
 	app_context = tx_buf->app_context;
 	comp_flags = ofi_tx_cq_flags(tx_buf->pkt.hdr.op);
 	tx_flags = tx_buf->flags;
+	tag = tx_buf->pkt.hdr.tag;
 
 	if (!rxm_complete_sar(rxm_ep, tx_buf))
 		return;
 
+	if (rxm_coll_xfer_comp(rxm_ep, tag, app_context))
+		return;
+
 	rxm_cq_write_tx_comp(rxm_ep, comp_flags, app_context, tx_flags);
 	ofi_ep_tx_cntr_inc(&rxm_ep->util_ep);
 }
 
 static void rxm_rndv_rx_finish(struct rxm_rx_buf *rx_buf)
 {
+	int err;
+
 	RXM_UPDATE_STATE(FI_LOG_CQ, rx_buf, RXM_RNDV_FINISH);
 
 	if (rx_buf->recv_entry->rndv.tx_buf) {
@@ -276,7 +307,18 @@ static void rxm_rndv_rx_finish(struct rxm_rx_buf *rx_buf)
 		rxm_msg_mr_closev(rx_buf->mr,
 				  rx_buf->recv_entry->rxm_iov.count);
 
-	rxm_finish_recv(rx_buf, rx_buf->recv_entry->total_len);
+	err = rx_buf->rndv_err;
+	if (!err) {
+		rxm_finish_recv(rx_buf, rx_buf->recv_entry->total_len);
+		return;
+	}
+
+	rx_buf->rndv_err = 0;
+	rxm_cq_write_error(rx_buf->ep->util_ep.rx_cq,
+			   rx_buf->ep->util_ep.rx_cntr,
+			   rx_buf->recv_entry->context, err);
+	rxm_recv_entry_release(rx_buf->recv_entry);
+	rxm_free_rx_buf(rx_buf);
 }
 
 static void rxm_rndv_tx_finish(struct rxm_ep *rxm_ep,
@@ -285,18 +327,25 @@ static void rxm_rndv_tx_finish(struct rxm_ep *rxm_ep,
 	assert(ofi_tx_cq_flags(tx_buf->pkt.hdr.op) & FI_SEND);
 
 	RXM_UPDATE_STATE(FI_LOG_CQ, tx_buf, RXM_RNDV_FINISH);
+	dlist_remove(&tx_buf->rndv_entry);
+	if (tx_buf->tune_len)
+		rxm_tune_sample(rxm_ep, tx_buf);
 	if (!rxm_ep->rdm_mr_local)
 		rxm_msg_mr_closev(tx_buf->rma.mr, tx_buf->rma.count);
 
-	rxm_cq_write_tx_comp(rxm_ep, ofi_tx_cq_flags(tx_buf->pkt.hdr.op),
-			     tx_buf->app_context, tx_buf->flags);
-
 	if (rxm_ep->rndv_ops == &rxm_rndv_ops_write &&
 	    tx_buf->write_rndv.done_buf) {
 		ofi_buf_free(tx_buf->write_rndv.done_buf);
 		tx_buf->write_rndv.done_buf = NULL;
 	}
-	ofi_ep_tx_cntr_inc(&rxm_ep->util_ep);
+
+	if (!rxm_coll_xfer_comp(rxm_ep, tx_buf->pkt.hdr.tag,
+				tx_buf->app_context)) {
+		rxm_cq_write_tx_comp(rxm_ep,
+				     ofi_tx_cq_flags(tx_buf->pkt.hdr.op),
+				     tx_buf->app_context, tx_buf->flags);
+		ofi_ep_tx_cntr_inc(&rxm_ep->util_ep);
+	}
 	rxm_free_tx_buf(rxm_ep, tx_buf);
 }
 
@@ -503,27 +552,6 @@ static ssize_t rxm_rndv_xfer(struct rxm_ep *rxm_ep, struct fid_ep *msg_ep,
 	return ret;
 }
 
-ssize_t rxm_rndv_read(struct rxm_rx_buf *rx_buf)
-{
-	ssize_t ret;
-	size_t total_len;
-
-	total_len = MIN(rx_buf->recv_entry->total_len, rx_buf->pkt.hdr.size);
-	RXM_UPDATE_STATE(FI_LOG_CQ, rx_buf, RXM_RNDV_READ);
-
-	ret = rxm_rndv_xfer(rx_buf->ep, rx_buf->conn->msg_ep,
-			    rx_buf->remote_rndv_hdr,
-			    rx_buf->recv_entry->rxm_iov.iov,
-			    rx_buf->recv_entry->rxm_iov.desc,
-			    rx_buf->recv_entry->rxm_iov.count, total_len,
-			    rx_buf);
-	if (ret) {
-		rxm_cq_write_error(rx_buf->ep->util_ep.rx_cq,
-				   rx_buf->ep->util_ep.rx_cntr, rx_buf, (int) ret);
-	}
-	return ret;
-}
-
 static ssize_t rxm_rndv_handle_wr_data(struct rxm_rx_buf *rx_buf)
 {
 	int i;
@@ -589,9 +617,10 @@ static ssize_t rxm_handle_rndv(struct rxm_rx_buf *rx_buf)
 	       rx_buf->pkt.ctrl_hdr.msg_id);
 
 	rx_buf->remote_rndv_hdr = (struct rxm_rndv_hdr *) rx_buf->pkt.data;
-	rx_buf->rndv_rma_index = 0;
 
-	if (!rx_buf->ep->rdm_mr_local) {
+	/* read rendezvous registers each chunk as it is read */
+	if (!rx_buf->ep->rdm_mr_local &&
+	    rx_buf->ep->rndv_ops == &rxm_rndv_ops_write) {
 		total_recv_len = MIN(rx_buf->recv_entry->total_len,
 				     rx_buf->pkt.hdr.size);
 		ret = rxm_msg_mr_regv(rx_buf->ep, rx_buf->recv_entry->rxm_iov.iov,
@@ -607,7 +636,7 @@ static ssize_t rxm_handle_rndv(struct rxm_rx_buf *rx_buf)
 			rx_buf->recv_entry->rxm_iov.desc[i] =
 						fi_mr_desc(rx_buf->mr[i]);
 		}
-	} else {
+	} else if (rx_buf->ep->rdm_mr_local) {
 		struct rxm_mr *mr;
 
 		for (i = 0; i < rx_buf->recv_entry->rxm_iov.count; i++) {
@@ -876,12 +905,199 @@ free:
 err:
 	FI_WARN(&rxm_prov, FI_LOG_CQ,
 		"unable to allocate/send rd rndv ack: %s\n",
-		fi_strerror((int) ret));
-	assert(0);
+		fi_strerror((int) -ret));
 	/* TODO: Allocate all resources needed on receiving
 	 * original message receive request, to avoid allocation failures.
-	 * On other failures, we need to fail the receive.
 	 */
+	if (!rx_buf->rndv_err)
+		rx_buf->rndv_err = (int) ret;
+	rxm_rndv_rx_finish(rx_buf);
+}
+
+static void rxm_rndv_free_chunk(struct rxm_rndv_chunk *chunk)
+{
+	struct rxm_rx_buf *rx_buf = chunk->rx_buf;
+
+	if (!rx_buf->ep->rdm_mr_local)
+		rxm_msg_mr_closev(chunk->mr, chunk->count);
+	rx_buf->rndv_reads--;
+	ofi_buf_free(chunk);
+}
+
+ssize_t rxm_rndv_read_chunk(struct rxm_rndv_chunk *chunk, struct iovec *iov,
+			    void **desc, uint64_t addr, uint64_t key)
+{
+	return fi_readv(chunk->rx_buf->conn->msg_ep, iov, desc, chunk->count,
+			0, addr, key, chunk);
+}
+
+static ssize_t
+rxm_rndv_defer_chunk(struct rxm_rndv_chunk *chunk, struct iovec *iov,
+		     void **desc, size_t count, uint64_t addr, uint64_t key)
+{
+	struct rxm_deferred_tx_entry *def_tx_entry;
+	size_t i;
+
+	def_tx_entry = rxm_ep_alloc_deferred_tx_entry(chunk->rx_buf->ep,
+						      chunk->rx_buf->conn,
+						      RXM_DEFERRED_TX_RNDV_READ);
+	if (!def_tx_entry)
+		return -FI_ENOMEM;
+
+	def_tx_entry->rndv_read.rx_buf = chunk->rx_buf;
+	def_tx_entry->rndv_read.chunk = chunk;
+	def_tx_entry->rndv_read.rma_iov.addr = addr;
+	def_tx_entry->rndv_read.rma_iov.key = key;
+	for (i = 0; i < count; i++) {
+		def_tx_entry->rndv_read.rxm_iov.iov[i] = iov[i];
+		def_tx_entry->rndv_read.rxm_iov.desc[i] = desc[i];
+	}
+	def_tx_entry->rndv_read.rxm_iov.count = (uint8_t) count;
+
+	rxm_queue_deferred_tx(def_tx_entry, OFI_LIST_TAIL);
+	return 0;
+}
+
+/* Issue reads for the next chunks of the transfer, until
+ * RXM_RNDV_READ_DEPTH are outstanding.  A chunk does not cross a buffer
+ * of the sender.
+ */
+static ssize_t rxm_rndv_read_chunks(struct rxm_rx_buf *rx_buf)
+{
+	struct rxm_recv_entry *recv_entry = rx_buf->recv_entry;
+	struct ofi_rma_iov *rma_iov;
+	struct rxm_rndv_chunk *chunk;
+	struct iovec iov[RXM_IOV_LIMIT];
+	void *desc[RXM_IOV_LIMIT];
+	uint64_t addr;
+	size_t len, i;
+	ssize_t ret;
+
+	while (rx_buf->rndv_left && rx_buf->rndv_reads < RXM_RNDV_READ_DEPTH) {
+		assert(rx_buf->rndv_rma_index < rx_buf->remote_rndv_hdr->count);
+		rma_iov = &rx_buf->remote_rndv_hdr->iov[rx_buf->rndv_rma_index];
+		len = MIN(rx_buf->rndv_left,
+			  rma_iov->len - rx_buf->rndv_rma_offset);
+		if (rxm_rndv_chunk_size)
+			len = MIN(len, rxm_rndv_chunk_size);
+
+		chunk = ofi_buf_alloc(rx_buf->ep->rndv_chunk_pool);
+		if (!chunk)
+			return -FI_ENOMEM;
+
+		chunk->rx_buf = rx_buf;
+		ret = ofi_copy_iov_desc(iov, desc, &chunk->count,
+					recv_entry->rxm_iov.iov,
+					recv_entry->rxm_iov.desc,
+					recv_entry->rxm_iov.count,
+					&rx_buf->rndv_iov_index,
+					&rx_buf->rndv_iov_offset, len);
+		if (ret)
+			goto free;
+
+		if (!rx_buf->ep->rdm_mr_local) {
+			ret = rxm_msg_mr_regv(rx_buf->ep, iov, chunk->count,
+					      len, FI_READ, chunk->mr);
+			if (ret)
+				goto free;
+
+			for (i = 0; i < chunk->count; i++)
+				desc[i] = fi_mr_desc(chunk->mr[i]);
+		}
+
+		addr = rma_iov->addr + rx_buf->rndv_rma_offset;
+		rx_buf->rndv_rma_offset += len;
+		if (rx_buf->rndv_rma_offset == rma_iov->len) {
+			rx_buf->rndv_rma_index++;
+			rx_buf->rndv_rma_offset = 0;
+		}
+		rx_buf->rndv_left -= len;
+		rx_buf->rndv_reads++;
+
+		ret = rxm_rndv_read_chunk(chunk, iov, desc, addr,
+					  rma_iov->key);
+		if (ret == -FI_EAGAIN) {
+			/* resumed as the deferred read completes */
+			ret = rxm_rndv_defer_chunk(chunk, iov, desc,
+						   chunk->count, addr,
+						   rma_iov->key);
+			if (ret)
+				goto free_chunk;
+			break;
+		} else if (ret) {
+			goto free_chunk;
+		}
+	}
+	return 0;
+
+free:
+	ofi_buf_free(chunk);
+	return ret;
+free_chunk:
+	rxm_rndv_free_chunk(chunk);
+	return ret;
+}
+
+static void rxm_rndv_read_done(struct rxm_rx_buf *rx_buf);
+
+/* A failed read stops the transfer.  Reads already issued are left to
+ * complete, after which rd_done releases the sender and the receive
+ * completes with the first error.
+ */
+static void rxm_rndv_read_error(struct rxm_rx_buf *rx_buf, ssize_t ret)
+{
+	FI_WARN(&rxm_prov, FI_LOG_CQ, "rndv read failed: %s\n",
+		fi_strerror((int) -ret));
+	if (!rx_buf->rndv_err)
+		rx_buf->rndv_err = (int) ret;
+	rx_buf->rndv_left = 0;
+	rxm_rndv_read_done(rx_buf);
+}
+
+void rxm_rndv_read_chunk_error(struct rxm_rndv_chunk *chunk, int err)
+{
+	struct rxm_rx_buf *rx_buf = chunk->rx_buf;
+
+	rxm_rndv_free_chunk(chunk);
+	rxm_rndv_read_error(rx_buf, err);
+}
+
+static void rxm_rndv_read_done(struct rxm_rx_buf *rx_buf)
+{
+	ssize_t ret;
+
+	if (rx_buf->hdr.state != RXM_RNDV_READ)
+		return;
+
+	if (rx_buf->rndv_left) {
+		ret = rxm_rndv_read_chunks(rx_buf);
+		if (ret)
+			rxm_rndv_read_error(rx_buf, ret);
+	} else if (!rx_buf->rndv_reads) {
+		rxm_rndv_send_rd_done(rx_buf);
+	}
+}
+
+ssize_t rxm_rndv_read(struct rxm_rx_buf *rx_buf)
+{
+	ssize_t ret;
+
+	RXM_UPDATE_STATE(FI_LOG_CQ, rx_buf, RXM_RNDV_READ);
+	rx_buf->rndv_left = MIN(rx_buf->recv_entry->total_len,
+				rx_buf->pkt.hdr.size);
+	rx_buf->rndv_rma_index = 0;
+	rx_buf->rndv_rma_offset = 0;
+	rx_buf->rndv_iov_index = 0;
+	rx_buf->rndv_iov_offset = 0;
+	rx_buf->rndv_reads = 0;
+	rx_buf->rndv_err = 0;
+
+	ret = rxm_rndv_read_chunks(rx_buf);
+	if (ret)
+		rxm_rndv_read_error(rx_buf, ret);
+	else if (!rx_buf->rndv_left && !rx_buf->rndv_reads)
+		rxm_rndv_send_rd_done(rx_buf);
+	return 0;
 }
 
 static void
@@ -1327,6 +1543,19 @@ write_err:
 	goto free;
 }
 
+static ssize_t rxm_handle_close(struct rxm_rx_buf *rx_buf)
+{
+	struct rxm_conn *conn;
+	uint64_t op;
+
+	conn = rxm_rx_buf_conn(rx_buf);
+	op = rx_buf->pkt.ctrl_hdr.ctrl_data;
+	rxm_free_rx_buf(rx_buf);
+	if (conn)
+		rxm_process_close(conn, op);
+	return FI_SUCCESS;
+}
+
 static ssize_t rxm_handle_credit(struct rxm_ep *rxm_ep, struct rxm_rx_buf *rx_buf)
 {
 	struct rxm_domain *domain;
@@ -1351,8 +1580,206 @@ void rxm_finish_coll_eager_send(struct rxm_ep *rxm_ep,
 	}
 }
 
+static ssize_t rxm_handle_rx_comp(struct rxm_ep *rxm_ep,
+				  struct rxm_rx_buf *rx_buf)
+{
+	struct rxm_conn *conn;
+
+	assert((rx_buf->pkt.hdr.version == OFI_OP_VERSION) &&
+	       (rx_buf->pkt.ctrl_hdr.version == RXM_CTRL_VERSION));
+
+	if (rxm_max_conns) {
+		conn = rxm_rx_buf_conn(rx_buf);
+		if (conn)
+			rxm_touch_conn(conn);
+	}
+
+	switch (rx_buf->pkt.ctrl_hdr.type) {
+	case rxm_ctrl_eager:
+	case rxm_ctrl_rndv_req:
+		return rxm_handle_recv_comp(rx_buf);
+	case rxm_ctrl_rndv_rd_done:
+		rxm_rndv_handle_rd_done(rxm_ep, rx_buf);
+		return 0;
+	case rxm_ctrl_rndv_wr_done:
+		return rxm_rndv_handle_wr_done(rxm_ep, rx_buf);
+	case rxm_ctrl_rndv_wr_data:
+		return rxm_rndv_handle_wr_data(rx_buf);
+	case rxm_ctrl_seg:
+		return rxm_sar_handle_segment(rx_buf);
+	case rxm_ctrl_atomic:
+		return rxm_handle_atomic_req(rxm_ep, rx_buf);
+	case rxm_ctrl_atomic_resp:
+		return rxm_handle_atomic_resp(rxm_ep, rx_buf);
+	case rxm_ctrl_credit:
+		return rxm_handle_credit(rxm_ep, rx_buf);
+	case rxm_ctrl_close:
+		return rxm_handle_close(rx_buf);
+	default:
+		FI_WARN(&rxm_prov, FI_LOG_CQ, "Unknown message type\n");
+		assert(0);
+		return -FI_EINVAL;
+	}
+}
+
+static struct rxm_rx_slab *
+rxm_rx_slab_alloc(struct rxm_ep *ep, struct fid_ep *rx_ep)
+{
+	struct rxm_rx_slab *slab;
+
+	slab = ofi_buf_alloc(ep->rx_slab_pool);
+	if (!slab)
+		return NULL;
+
+	assert(slab->ep == ep);
+	slab->hdr.state = RXM_RX_SLAB;
+	slab->rx_ep = rx_ep;
+	slab->conn = ep->srx_ctx ? NULL : rx_ep->fid.context;
+	return slab;
+}
+
+static int rxm_post_rx_slab(struct rxm_rx_slab *slab)
+{
+	struct iovec iov;
+	struct fi_msg msg;
+	int ret;
+
+	slab->consumed = 0;
+	slab->released = 0;
+	slab->refcnt = 0;
+	slab->repost = true;
+
+	iov.iov_base = slab->data;
+	iov.iov_len = rxm_rx_slab_size;
+	msg.msg_iov = &iov;
+	msg.desc = &slab->hdr.desc;
+	msg.iov_count = 1;
+	msg.addr = FI_ADDR_UNSPEC;
+	msg.context = slab;
+	msg.data = 0;
+
+	ret = (int) fi_recvmsg(slab->rx_ep, &msg, FI_MULTI_RECV);
+	slab->posted = !ret;
+	if (ret && ret != -FI_EAGAIN) {
+		FI_DBG(&rxm_prov, FI_LOG_EP_CTRL,
+		       "unable to post rx slab: %d\n", ret);
+	}
+	return ret;
+}
+
+/* The slab may only be reused once the provider has released it, every
+ * packet carved from it has completed, and no rx_buf still points into it.
+ */
+void rxm_release_rx_slab(struct rxm_rx_slab *slab)
+{
+	assert(slab->refcnt > 0);
+	if (--slab->refcnt || slab->posted ||
+	    slab->consumed != slab->released)
+		return;
+
+	/* Discard the slab if its msg_ep was closed */
+	if (slab->repost && (slab->ep->srx_ctx || slab->conn->msg_ep) &&
+	    !rxm_post_rx_slab(slab))
+		return;
+
+	ofi_buf_free(slab);
+}
+
+/* A released slab that is still in use by unexpected messages would
+ * leave the msg ep without a buffer.  Post a fresh slab in its place and
+ * return the old one to the pool once it drains.
+ */
+static void rxm_replace_rx_slab(struct rxm_rx_slab *slab)
+{
+	struct rxm_rx_slab *new_slab;
+
+	if (!slab->ep->srx_ctx && !slab->conn->msg_ep)
+		return;
+
+	new_slab = rxm_rx_slab_alloc(slab->ep, slab->rx_ep);
+	if (!new_slab)
+		return;
+
+	if (rxm_post_rx_slab(new_slab)) {
+		ofi_buf_free(new_slab);
+		return;
+	}
+	slab->repost = false;
+}
+
+/* Eager data is referenced in place.  Everything else is copied into a
+ * regular rx_buf, since those handlers build on the full packet buffer.
+ */
+static struct rxm_rx_buf *
+rxm_rx_slab_get_buf(struct rxm_rx_slab *slab, struct fi_cq_data_entry *comp)
+{
+	struct rxm_pkt *pkt = comp->buf;
+	struct rxm_rx_buf *rx_buf;
+
+	assert(pkt && comp->len >= sizeof(*pkt) &&
+	       comp->len <= rxm_packet_size);
+
+	if (pkt->ctrl_hdr.type == rxm_ctrl_eager &&
+	    !(slab->ep->rxm_info->mode & FI_BUFFERED_RECV)) {
+		rx_buf = ofi_buf_alloc(slab->ep->rx_ref_pool);
+		if (!rx_buf)
+			return NULL;
+
+		memcpy(&rx_buf->pkt, pkt, sizeof(*pkt));
+		rx_buf->data = pkt->data;
+		rx_buf->slab = slab;
+		slab->refcnt++;
+	} else {
+		rx_buf = ofi_buf_alloc(slab->ep->rx_pool);
+		if (!rx_buf)
+			return NULL;
+
+		memcpy(&rx_buf->pkt, pkt, comp->len);
+	}
+
+	assert(rx_buf->ep == slab->ep);
+	rx_buf->hdr.state = RXM_RX;
+	rx_buf->rx_ep = slab->rx_ep;
+	rx_buf->conn = slab->conn;
+	rx_buf->recv_entry = NULL;
+	rx_buf->repost = false;
+	return rx_buf;
+}
+
+static ssize_t rxm_handle_rx_slab(struct rxm_ep *rxm_ep,
+				  struct fi_cq_data_entry *comp)
+{
+	struct rxm_rx_slab *slab = comp->op_context;
+	struct rxm_rx_buf *rx_buf;
+	ssize_t ret = 0;
+
+	/* Hold the slab until the packet has been handed off */
+	slab->refcnt++;
+	slab->consumed += comp->len;
+	if (comp->flags & FI_MULTI_RECV) {
+		slab->posted = false;
+		slab->released = comp->buf ?
+			(uint8_t *) comp->buf + comp->len - slab->data :
+			slab->consumed;
+	}
+
+	if (comp->len) {
+		rx_buf = rxm_rx_slab_get_buf(slab, comp);
+		ret = rx_buf ? rxm_handle_rx_comp(rxm_ep, rx_buf) :
+			       -FI_ENOMEM;
+	}
+
+	if ((comp->flags & FI_MULTI_RECV) &&
+	    (slab->refcnt > 1 || slab->consumed != slab->released))
+		rxm_replace_rx_slab(slab);
+
+	rxm_release_rx_slab(slab);
+	return ret;
+}
+
 ssize_t rxm_handle_comp(struct rxm_ep *rxm_ep, struct fi_cq_data_entry *comp)
 {
+	struct rxm_rndv_chunk *chunk;
 	struct rxm_rx_buf *rx_buf;
 	struct rxm_tx_buf *tx_buf;
 
@@ -1367,10 +1794,13 @@ ssize_t rxm_handle_comp(struct rxm_ep *rxm_ep, struct fi_cq_data_entry *comp)
 	case RXM_TX:
 	case RXM_INJECT_TX:
 		tx_buf = comp->op_context;
+		if (tx_buf->tune_len)
+			rxm_tune_sample(rxm_ep, tx_buf);
 		rxm_ep->eager_ops->comp_tx(rxm_ep, tx_buf);
 		rxm_free_tx_buf(rxm_ep, tx_buf);
 		return 0;
 	case RXM_CREDIT_TX:
+	case RXM_CLOSE_TX:
 		tx_buf = comp->op_context;
 		assert(comp->flags & FI_SEND);
 		ofi_buf_free(tx_buf);
@@ -1384,33 +1814,10 @@ ssize_t rxm_handle_comp(struct rxm_ep *rxm_ep, struct fi_cq_data_entry *comp)
 	case RXM_RX:
 		rx_buf = comp->op_context;
 		assert(!(comp->flags & FI_REMOTE_READ));
-		assert((rx_buf->pkt.hdr.version == OFI_OP_VERSION) &&
-		       (rx_buf->pkt.ctrl_hdr.version == RXM_CTRL_VERSION));
-
-		switch (rx_buf->pkt.ctrl_hdr.type) {
-		case rxm_ctrl_eager:
-		case rxm_ctrl_rndv_req:
-			return rxm_handle_recv_comp(rx_buf);
-		case rxm_ctrl_rndv_rd_done:
-			rxm_rndv_handle_rd_done(rxm_ep, rx_buf);
-			return 0;
-		case rxm_ctrl_rndv_wr_done:
-			return rxm_rndv_handle_wr_done(rxm_ep, rx_buf);
-		case rxm_ctrl_rndv_wr_data:
-			return rxm_rndv_handle_wr_data(rx_buf);
-		case rxm_ctrl_seg:
-			return rxm_sar_handle_segment(rx_buf);
-		case rxm_ctrl_atomic:
-			return rxm_handle_atomic_req(rxm_ep, rx_buf);
-		case rxm_ctrl_atomic_resp:
-			return rxm_handle_atomic_resp(rxm_ep, rx_buf);
-		case rxm_ctrl_credit:
-			return rxm_handle_credit(rxm_ep, rx_buf);
-		default:
-			FI_WARN(&rxm_prov, FI_LOG_CQ, "Unknown message type\n");
-			assert(0);
-			return -FI_EINVAL;
-		}
+		return rxm_handle_rx_comp(rxm_ep, rx_buf);
+	case RXM_RX_SLAB:
+		assert(!(comp->flags & FI_REMOTE_READ));
+		return rxm_handle_rx_slab(rxm_ep, comp);
 	case RXM_SAR_TX:
 		tx_buf = comp->op_context;
 		assert(comp->flags & FI_SEND);
@@ -1428,15 +1835,15 @@ ssize_t rxm_handle_comp(struct rxm_ep *rxm_ep, struct fi_cq_data_entry *comp)
 		return 0;
 	case RXM_RNDV_READ_DONE_WAIT:
 	case RXM_RNDV_WRITE_DATA_WAIT:
+	case RXM_RNDV_READ:
 		assert(0);
 		return 0;
-	case RXM_RNDV_READ:
-		rx_buf = comp->op_context;
+	case RXM_RNDV_READ_CHUNK:
+		chunk = comp->op_context;
 		assert(comp->flags & FI_READ);
-		if (++rx_buf->rndv_rma_index < rx_buf->remote_rndv_hdr->count)
-			return 0;
-
-		rxm_rndv_send_rd_done(rx_buf);
+		rx_buf = chunk->rx_buf;
+		rxm_rndv_free_chunk(chunk);
+		rxm_rndv_read_done(rx_buf);
 		return 0;
 	case RXM_RNDV_WRITE:
 		tx_buf = comp->op_context;
@@ -1634,6 +2041,7 @@ ssize_t rxm_get_dyn_rbuf(struct ofi_cq_rbuf_entry *entry, struct iovec *iov,
 	case rxm_ctrl_rndv_wr_done:
 	case rxm_ctrl_rndv_rd_done:
 	case rxm_ctrl_credit:
+	case rxm_ctrl_close:
 		*count = 1;
 		iov[0].iov_base = &rx_buf->pkt.data;
 		iov[0].iov_len = rxm_buffer_size;
@@ -1708,6 +2116,7 @@ void rxm_handle_comp_error(struct rxm_ep *rxm_ep)
 {
 	struct rxm_tx_buf *tx_buf;
 	struct rxm_rx_buf *rx_buf;
+	struct rxm_rx_slab *slab;
 	struct util_cq *cq;
 	struct util_cntr *cntr;
 	struct fi_cq_err_entry err_entry = {0};
@@ -1734,8 +2143,11 @@ void rxm_handle_comp_error(struct rxm_ep *rxm_ep)
 	cntr = rxm_ep->util_ep.tx_cntr;
 
 	switch (RXM_GET_PROTO_STATE(err_entry.op_context)) {
-	case RXM_TX:
 	case RXM_RNDV_TX:
+		tx_buf = err_entry.op_context;
+		dlist_remove(&tx_buf->rndv_entry);
+		/* fall through */
+	case RXM_TX:
 	case RXM_RNDV_WRITE_DONE_SENT:
 	case RXM_ATOMIC_RESP_WAIT:
 		tx_buf = err_entry.op_context;
@@ -1757,6 +2169,7 @@ void rxm_handle_comp_error(struct rxm_ep *rxm_ep)
 			rxm_cntr_incerr(cntr);
 		return;
 	case RXM_CREDIT_TX:
+	case RXM_CLOSE_TX:
 	case RXM_ATOMIC_RESP_SENT: /* BUG: should have consumed tx credit */
 		tx_buf = err_entry.op_context;
 		ofi_buf_free(tx_buf);
@@ -1784,6 +2197,25 @@ void rxm_handle_comp_error(struct rxm_ep *rxm_ep)
 		err_entry.flags = ofi_tx_cq_flags(tx_buf->pkt.hdr.op);
 		break;
 
+	/* Posted slabs are flushed when their msg ep or srx closes.  Any
+	 * packets already carved from the slab have completed, so it only
+	 * needs to drain before going back to the pool.
+	 */
+	case RXM_RX_SLAB:
+		slab = err_entry.op_context;
+		slab->posted = false;
+		slab->repost = false;
+		slab->released = slab->consumed;
+		slab->refcnt++;
+		rxm_release_rx_slab(slab);
+		return;
+
+	/* The receive fails once the outstanding chunks have drained */
+	case RXM_RNDV_READ_CHUNK:
+		rxm_rndv_read_chunk_error(err_entry.op_context,
+					  err_entry.err ? -err_entry.err : -FI_EIO);
+		return;
+
 	/* Incoming application data error */
 	case RXM_RX:
 		/* Silently drop MSG CQ error entries for internal receive
@@ -1800,7 +2232,6 @@ void rxm_handle_comp_error(struct rxm_ep *rxm_ep)
 		/* fall through */
 	case RXM_RNDV_READ_DONE_SENT:
 	case RXM_RNDV_WRITE_DATA_SENT: /* BUG: should fail initial send */
-	case RXM_RNDV_READ:
 		rx_buf = (struct rxm_rx_buf *) err_entry.op_context;
 		assert(rx_buf->recv_entry);
 		err_entry.op_context = rx_buf->recv_entry->context;
@@ -1895,12 +2326,44 @@ int rxm_post_recv(struct rxm_rx_buf *rx_buf)
 	return ret;
 }
 
+static int rxm_prepost_rx_slabs(struct rxm_ep *ep, struct fid_ep *rx_ep)
+{
+	struct rxm_rx_slab *slab;
+	int ret, i;
+
+	for (i = 0; i < RXM_RX_SLAB_CNT; i++) {
+		slab = rxm_rx_slab_alloc(ep, rx_ep);
+		if (!slab)
+			return -FI_ENOMEM;
+
+		ret = rxm_post_rx_slab(slab);
+		if (ret) {
+			ofi_buf_free(slab);
+			return ret;
+		}
+	}
+	return 0;
+}
+
 int rxm_prepost_recv(struct rxm_ep *ep, struct fid_ep *rx_ep)
 {
 	struct rxm_rx_buf *rx_buf;
 	int ret;
 	size_t i;
 
+	/* Release a slab only once a full packet no longer fits */
+	if (ep->rx_slab_pool) {
+		ret = fi_setopt(&rx_ep->fid, FI_OPT_ENDPOINT,
+				FI_OPT_MIN_MULTI_RECV, &rxm_packet_size,
+				sizeof(rxm_packet_size));
+		if (!ret)
+			return rxm_prepost_rx_slabs(ep, rx_ep);
+
+		FI_INFO(&rxm_prov, FI_LOG_EP_CTRL,
+			"unable to set FI_OPT_MIN_MULTI_RECV, "
+			"posting rx buffers instead of slabs\n");
+	}
+
 	for (i = 0; i < ep->msg_info->rx_attr->size; i++) {
 		rx_buf = rxm_rx_buf_alloc(ep, rx_ep);
 		if (!rx_buf)
@@ -1954,6 +2417,7 @@ void rxm_ep_do_progress(struct util_ep *util_ep)
 				    rxm_cm_progress_interval) {
 					rxm_ep->msg_cq_last_poll = timestamp;
 					rxm_conn_progress(rxm_ep);
+					rxm_ep_trim_pools(rxm_ep);
 				}
 			} else {
 					rxm_conn_progress(rxm_ep);
@@ -116,6 +116,171 @@ static int rxm_match_unexp_msg_tag_addr(struct dlist_entry *item, const void *ar
 		ofi_match_tag(attr->tag, attr->ignore, unexp_msg->tag);
 }
 
+static size_t rxm_arena_len(struct ofi_bufpool *pool)
+{
+	return ofi_get_aligned_size(pool->alloc_size, ofi_get_page_size());
+}
+
+static int rxm_arena_alloc(struct ofi_bufpool_region *region)
+{
+	struct rxm_ep *ep = region->pool->attr.context;
+	struct rxm_buf_arena *arena = &ep->buf_arena;
+	struct rxm_arena_range *range;
+	size_t len;
+
+	len = rxm_arena_len(region->pool);
+	dlist_foreach_container(&arena->free_list, struct rxm_arena_range,
+				range, entry) {
+		if (range->len == len) {
+			dlist_remove(&range->entry);
+			region->alloc_region = range->addr;
+			free(range);
+			return 0;
+		}
+	}
+
+	if (arena->size - arena->used < len)
+		return -FI_ENOMEM;
+
+	region->alloc_region = arena->base + arena->used;
+	arena->used += len;
+	return 0;
+}
+
+static void rxm_arena_free(struct ofi_bufpool_region *region)
+{
+	struct rxm_ep *ep = region->pool->attr.context;
+	struct rxm_buf_arena *arena = &ep->buf_arena;
+	struct rxm_arena_range *range;
+
+	range = malloc(sizeof(*range));
+	if (!range)
+		return;
+
+	range->addr = region->alloc_region;
+	range->len = rxm_arena_len(region->pool);
+#ifdef MADV_DONTNEED
+	if (arena->reclaim)
+		(void) madvise(range->addr, range->len, MADV_DONTNEED);
+#endif
+	dlist_insert_tail(&range->entry, &arena->free_list);
+}
+
+static void rxm_arena_close(struct rxm_ep *ep)
+{
+	struct rxm_buf_arena *arena = &ep->buf_arena;
+	struct rxm_arena_range *range;
+
+	if (!arena->base)
+		return;
+
+	while (!dlist_empty(&arena->free_list)) {
+		dlist_pop_front(&arena->free_list, struct rxm_arena_range,
+				range, entry);
+		free(range);
+	}
+
+	if (arena->mr) {
+		fi_close(&arena->mr->fid);
+		arena->mr = NULL;
+	}
+	if (ep->util_ep.caps & FI_HMEM)
+		ofi_hmem_host_unregister(arena->base);
+	(void) ofi_unmap_anon_pages(arena->base, arena->size);
+	arena->base = NULL;
+}
+
+static int rxm_arena_open(struct rxm_ep *ep)
+{
+	struct rxm_buf_arena *arena = &ep->buf_arena;
+	struct rxm_domain *domain;
+	ssize_t align;
+	char *buf;
+	size_t size;
+	int ret;
+
+	dlist_init(&arena->free_list);
+	align = ofi_get_hugepage_size();
+	if (align <= 0)
+		align = ofi_get_page_size();
+	size = ofi_get_aligned_size(rxm_buf_arena_size, align);
+
+	/* Reserve extra space to align the arena for huge pages. */
+	ret = ofi_mmap_anon_pages((void **) &buf, size + align, 0);
+	if (ret)
+		return ret;
+
+	arena->base = (char *) ofi_get_aligned_size((uintptr_t) buf, align);
+	if (arena->base != buf)
+		(void) ofi_unmap_anon_pages(buf, arena->base - buf);
+	if (arena->base + size != buf + size + align)
+		(void) ofi_unmap_anon_pages(arena->base + size,
+					    buf + align - arena->base);
+	arena->size = size;
+	arena->used = 0;
+	arena->last_trim = ofi_gettime_us();
+#ifdef MADV_HUGEPAGE
+	(void) madvise(arena->base, arena->size, MADV_HUGEPAGE);
+#endif
+
+	if (ep->util_ep.caps & FI_HMEM) {
+		ret = ofi_hmem_host_register(arena->base, arena->size);
+		if (ret)
+			goto unmap;
+	}
+
+	if (ep->msg_mr_local) {
+		domain = container_of(ep->util_ep.domain, struct rxm_domain,
+				      util_domain);
+		ret = rxm_msg_mr_reg_internal(domain, arena->base, arena->size,
+					      FI_SEND | FI_RECV | FI_READ |
+					      FI_WRITE, OFI_MR_NOCACHE,
+					      &arena->mr);
+		if (ret)
+			goto unreg;
+	}
+
+	/* Pages can only be handed back to the OS if they are not pinned
+	 * by a registration.
+	 */
+	arena->reclaim = !ep->msg_mr_local && !(ep->util_ep.caps & FI_HMEM);
+	FI_INFO(&rxm_prov, FI_LOG_EP_CTRL,
+		"buffer arena of %zu bytes at %p\n", arena->size, arena->base);
+	return 0;
+
+unreg:
+	if (ep->util_ep.caps & FI_HMEM)
+		ofi_hmem_host_unregister(arena->base);
+unmap:
+	(void) ofi_unmap_anon_pages(arena->base, arena->size);
+	arena->base = NULL;
+	return ret;
+}
+
+/* Called periodically from progress.  Bounce buffers of an idle tx pool
+ * are released to the arena, from which the pool can regrow without
+ * registering memory.  Receive buffers stay posted, so the rx pools are
+ * never idle.
+ */
+void rxm_ep_trim_pools(struct rxm_ep *ep)
+{
+	uint64_t now;
+
+	if (!ep->buf_arena.base || ep->tx_pool->region_cnt <= 1)
+		return;
+
+	now = ofi_gettime_us();
+	if (now - ep->buf_arena.last_trim < RXM_ARENA_TRIM_INTERVAL)
+		return;
+
+	ep->buf_arena.last_trim = now;
+	if (ofi_bufpool_trim(ep->tx_pool)) {
+		FI_DBG(&rxm_prov, FI_LOG_EP_DATA,
+		       "tx pool trimmed to %zu buffers\n",
+		       ep->tx_pool->entry_cnt);
+	}
+}
+
 static int rxm_buf_reg(struct ofi_bufpool_region *region)
 {
 	struct rxm_ep *rxm_ep = region->pool->attr.context;
@@ -123,6 +288,12 @@ static int rxm_buf_reg(struct ofi_bufpool_region *region)
 	int ret;
 	bool hmem_enabled = !!(rxm_ep->util_ep.caps & FI_HMEM);
 
+	/* Arena memory was registered up front. */
+	if (region->flags & OFI_BUFPOOL_EXTERNAL_MEM) {
+		region->context = rxm_ep->buf_arena.mr;
+		return 0;
+	}
+
 	if (hmem_enabled) {
 		ret = ofi_hmem_host_register(region->mem_region,
 					     region->pool->region_size);
@@ -158,9 +329,31 @@ static void rxm_init_rx_buf(struct ofi_bufpool_region *region, void *buf)
 	rx_buf->hdr.desc = ep->msg_mr_local ?
 			   fi_mr_desc((struct fid_mr *) region->context) : NULL;
 	rx_buf->ep = ep;
+	rx_buf->slab = NULL;
+	rx_buf->data = &rx_buf->pkt.data;
+}
+
+/* Header-only rx buffers whose data lives in an rx slab */
+static void rxm_init_rx_ref_buf(struct ofi_bufpool_region *region, void *buf)
+{
+	struct rxm_rx_buf *rx_buf = buf;
+
+	rx_buf->hdr.desc = NULL;
+	rx_buf->ep = region->pool->attr.context;
+	rx_buf->slab = NULL;
 	rx_buf->data = &rx_buf->pkt.data;
 }
 
+static void rxm_init_rx_slab(struct ofi_bufpool_region *region, void *buf)
+{
+	struct rxm_ep *ep = region->pool->attr.context;
+	struct rxm_rx_slab *slab = buf;
+
+	slab->hdr.desc = ep->msg_mr_local ?
+			 fi_mr_desc((struct fid_mr *) region->context) : NULL;
+	slab->ep = ep;
+}
+
 static void rxm_init_tx_buf(struct ofi_bufpool_region *region, void *buf)
 {
 	struct rxm_ep *ep = region->pool->attr.context;
@@ -173,10 +366,21 @@ static void rxm_init_tx_buf(struct ofi_bufpool_region *region, void *buf)
 	tx_buf->pkt.hdr.version = OFI_OP_VERSION;
 }
 
+static void rxm_init_rndv_chunk(struct ofi_bufpool_region *region, void *buf)
+{
+	struct rxm_rndv_chunk *chunk = buf;
+
+	memset(chunk, 0, sizeof(*chunk));
+	chunk->hdr.state = RXM_RNDV_READ_CHUNK;
+}
+
 static void rxm_buf_close(struct ofi_bufpool_region *region)
 {
 	struct rxm_ep *ep = region->pool->attr.context;
 
+	if (region->flags & OFI_BUFPOOL_EXTERNAL_MEM)
+		return;
+
 	if (ep->util_ep.caps & FI_HMEM)
 		ofi_hmem_host_unregister(region->mem_region);
 
@@ -250,11 +454,77 @@ static void rxm_recv_queue_close(struct rxm_recv_queue *recv_queue)
 	// TODO cleanup recv_list and unexp msg list
 }
 
+/* Slabs rely on the msg provider packing packets into a multi-recv
+ * buffer and reporting where each one landed.  Dynamic receive buffers
+ * place data directly and don't use posted bounce buffers at all.
+ */
+static bool rxm_use_rx_slabs(struct rxm_ep *ep)
+{
+	struct rxm_domain *domain;
+
+	domain = container_of(ep->util_ep.domain, struct rxm_domain,
+			      util_domain);
+	return rxm_rx_slab_size && !domain->dyn_rbuf &&
+	       (ep->msg_info->rx_attr->caps & FI_MULTI_RECV);
+}
+
+static int rxm_ep_create_slab_pools(struct rxm_ep *rxm_ep)
+{
+	struct ofi_bufpool_attr attr = {0};
+	int ret;
+
+	attr.size = sizeof(struct rxm_rx_slab) + rxm_rx_slab_size;
+	attr.alignment = 16;
+	attr.chunk_cnt = RXM_RX_SLAB_CNT;
+	attr.alloc_fn = rxm_buf_reg;
+	attr.free_fn = rxm_buf_close;
+	attr.init_fn = rxm_init_rx_slab;
+	attr.context = rxm_ep;
+	attr.flags = OFI_BUFPOOL_NO_TRACK;
+	if (rxm_ep->buf_arena.base) {
+		attr.mem_alloc_fn = rxm_arena_alloc;
+		attr.mem_free_fn = rxm_arena_free;
+	}
+
+	ret = ofi_bufpool_create_attr(&attr, &rxm_ep->rx_slab_pool);
+	if (ret) {
+		FI_WARN(&rxm_prov, FI_LOG_EP_CTRL,
+			"Unable to create rx slab pool\n");
+		return ret;
+	}
+
+	memset(&attr, 0, sizeof attr);
+	attr.size = sizeof(struct rxm_rx_buf);
+	attr.alignment = 16;
+	attr.chunk_cnt = 1024;
+	attr.init_fn = rxm_init_rx_ref_buf;
+	attr.context = rxm_ep;
+	attr.flags = OFI_BUFPOOL_NO_TRACK;
+
+	ret = ofi_bufpool_create_attr(&attr, &rxm_ep->rx_ref_pool);
+	if (ret) {
+		FI_WARN(&rxm_prov, FI_LOG_EP_CTRL,
+			"Unable to create rx slab reference pool\n");
+		ofi_bufpool_destroy(rxm_ep->rx_slab_pool);
+		rxm_ep->rx_slab_pool = NULL;
+	}
+	return ret;
+}
+
 static int rxm_ep_create_pools(struct rxm_ep *rxm_ep)
 {
 	struct ofi_bufpool_attr attr = {0};
 	int ret;
 
+	if (rxm_buf_arena_size) {
+		ret = rxm_arena_open(rxm_ep);
+		if (ret) {
+			RXM_WARN_ERR(FI_LOG_EP_CTRL,
+				     "buffer arena disabled, reserve failed: ",
+				     ret);
+		}
+	}
+
 	attr.size = rxm_buffer_size + sizeof(struct rxm_rx_buf);
 	attr.alignment = 16;
 	attr.chunk_cnt = 1024;
@@ -263,12 +533,16 @@ static int rxm_ep_create_pools(struct rxm_ep *rxm_ep)
 	attr.init_fn = rxm_init_rx_buf;
 	attr.context = rxm_ep;
 	attr.flags = OFI_BUFPOOL_NO_TRACK;
+	if (rxm_ep->buf_arena.base) {
+		attr.mem_alloc_fn = rxm_arena_alloc;
+		attr.mem_free_fn = rxm_arena_free;
+	}
 
 	ret = ofi_bufpool_create_attr(&attr, &rxm_ep->rx_pool);
 	if (ret) {
 		FI_WARN(&rxm_prov, FI_LOG_EP_CTRL,
 			"Unable to create rx buf pool\n");
-		return ret;
+		goto close_arena;
 	}
 
 	attr.size = rxm_buffer_size + sizeof(struct rxm_tx_buf);
@@ -280,11 +554,38 @@ static int rxm_ep_create_pools(struct rxm_ep *rxm_ep)
 		goto free_rx_pool;
 	}
 
+	memset(&attr, 0, sizeof attr);
+	attr.size = sizeof(struct rxm_rndv_chunk);
+	attr.alignment = 16;
+	attr.chunk_cnt = 64;
+	attr.init_fn = rxm_init_rndv_chunk;
+	attr.flags = OFI_BUFPOOL_NO_TRACK;
+	ret = ofi_bufpool_create_attr(&attr, &rxm_ep->rndv_chunk_pool);
+	if (ret) {
+		FI_WARN(&rxm_prov, FI_LOG_EP_CTRL,
+			"Unable to create rndv chunk pool\n");
+		goto free_tx_pool;
+	}
+
+	if (rxm_use_rx_slabs(rxm_ep)) {
+		ret = rxm_ep_create_slab_pools(rxm_ep);
+		if (ret)
+			goto free_chunk_pool;
+	}
+
 	return 0;
 
+free_chunk_pool:
+	ofi_bufpool_destroy(rxm_ep->rndv_chunk_pool);
+	rxm_ep->rndv_chunk_pool = NULL;
+free_tx_pool:
+	ofi_bufpool_destroy(rxm_ep->tx_pool);
+	rxm_ep->tx_pool = NULL;
 free_rx_pool:
 	ofi_bufpool_destroy(rxm_ep->rx_pool);
 	rxm_ep->rx_pool = NULL;
+close_arena:
+	rxm_arena_close(rxm_ep);
 	return ret;
 }
 
@@ -344,6 +645,18 @@ static void rxm_ep_txrx_res_close(struct rxm_ep *ep)
 		ofi_bufpool_destroy(ep->multi_recv_pool);
 		ep->multi_recv_pool = NULL;
 	}
+	if (ep->rx_ref_pool) {
+		ofi_bufpool_destroy(ep->rx_ref_pool);
+		ep->rx_ref_pool = NULL;
+	}
+	if (ep->rx_slab_pool) {
+		ofi_bufpool_destroy(ep->rx_slab_pool);
+		ep->rx_slab_pool = NULL;
+	}
+	if (ep->rndv_chunk_pool) {
+		ofi_bufpool_destroy(ep->rndv_chunk_pool);
+		ep->rndv_chunk_pool = NULL;
+	}
 	if (ep->rx_pool) {
 		ofi_bufpool_destroy(ep->rx_pool);
 		ep->rx_pool = NULL;
@@ -352,6 +665,7 @@ static void rxm_ep_txrx_res_close(struct rxm_ep *ep)
 		ofi_bufpool_destroy(ep->tx_pool);
 		ep->tx_pool = NULL;
 	}
+	rxm_arena_close(ep);
 }
 
 static int rxm_setname(fid_t fid, void *addr, size_t addrlen)
@@ -460,11 +774,39 @@ static int rxm_ep_getopt(fid_t fid, int level, int optname, void *optval,
 {
 	struct rxm_ep *rxm_ep =
 		container_of(fid, struct rxm_ep, util_ep.ep_fid);
+	struct fi_tcp_conn_stats *stats;
+	struct fi_rxm_proto_limits *limits;
 
 	if (level != FI_OPT_ENDPOINT)
 		return -FI_ENOPROTOOPT;
 
 	switch (optname) {
+	case FI_OPT_TCP_CONN_STATS:
+		if (*optlen < sizeof(*stats)) {
+			*optlen = sizeof(*stats);
+			return -FI_ETOOSMALL;
+		}
+		stats = optval;
+		ofi_ep_lock_acquire(&rxm_ep->util_ep);
+		stats->open = rxm_ep->conn_cnt;
+		stats->evictions = rxm_ep->evictions;
+		stats->reconnects = rxm_ep->reconnects;
+		ofi_ep_lock_release(&rxm_ep->util_ep);
+		*optlen = sizeof(*stats);
+		break;
+	case FI_OPT_RXM_PROTO_LIMITS:
+		if (*optlen < sizeof(*limits)) {
+			*optlen = sizeof(*limits);
+			return -FI_ETOOSMALL;
+		}
+		limits = optval;
+		ofi_ep_lock_acquire(&rxm_ep->util_ep);
+		limits->eager_limit = rxm_ep->eager_limit;
+		limits->sar_limit = rxm_ep->sar_limit;
+		limits->adjustments = rxm_ep->tune.adjustments;
+		ofi_ep_lock_release(&rxm_ep->util_ep);
+		*optlen = sizeof(*limits);
+		break;
 	case FI_OPT_MIN_MULTI_RECV:
 		assert(sizeof(rxm_ep->min_multi_recv_size) == sizeof(size_t));
 		*(size_t *)optval = rxm_ep->min_multi_recv_size;
@@ -661,6 +1003,7 @@ struct rxm_tx_buf *rxm_get_tx_buf(struct rxm_ep *ep)
 	buf = ofi_buf_alloc(ep->tx_pool);
 	if (buf) {
 		OFI_DBG_SET(buf->user_tx, true);
+		buf->tune_len = 0;
 		ep->tx_credit--;
 	}
 	return buf;
@@ -858,21 +1201,17 @@ void rxm_ep_progress_deferred_queue(struct rxm_ep *rxm_ep,
 					 RXM_RNDV_WRITE_DONE_SENT);
 			break;
 		case RXM_DEFERRED_TX_RNDV_READ:
-			ret = rxm_ep->rndv_ops->xfer(
-				def_tx_entry->rxm_conn->msg_ep,
+			ret = rxm_rndv_read_chunk(
+				def_tx_entry->rndv_read.chunk,
 				def_tx_entry->rndv_read.rxm_iov.iov,
 				def_tx_entry->rndv_read.rxm_iov.desc,
-				def_tx_entry->rndv_read.rxm_iov.count, 0,
 				def_tx_entry->rndv_read.rma_iov.addr,
-				def_tx_entry->rndv_read.rma_iov.key,
-				def_tx_entry->rndv_read.rx_buf);
+				def_tx_entry->rndv_read.rma_iov.key);
 			if (ret) {
 				if (ret == -FI_EAGAIN)
 					return;
-				rxm_cq_write_error(def_tx_entry->rxm_ep->util_ep.rx_cq,
-						   def_tx_entry->rxm_ep->util_ep.rx_cntr,
-						   def_tx_entry->rndv_read.rx_buf->
-							recv_entry->context, (int) ret);
+				rxm_rndv_read_chunk_error(
+					def_tx_entry->rndv_read.chunk, (int) ret);
 			}
 			break;
 		case RXM_DEFERRED_TX_RNDV_WRITE:
@@ -929,6 +1268,18 @@ void rxm_ep_progress_deferred_queue(struct rxm_ep *rxm_ep,
 				return;
 			}
 			break;
+		case RXM_DEFERRED_TX_CLOSE:
+			ret = fi_send(def_tx_entry->rxm_conn->msg_ep,
+				      &def_tx_entry->close_msg.tx_buf->pkt,
+				      sizeof(def_tx_entry->close_msg.tx_buf->pkt),
+				      def_tx_entry->close_msg.tx_buf->hdr.desc,
+				      0, def_tx_entry->close_msg.tx_buf);
+			if (ret) {
+				if (ret == -FI_EAGAIN)
+					return;
+				ofi_buf_free(def_tx_entry->close_msg.tx_buf);
+			}
+			break;
 		}
 
 		rxm_dequeue_deferred_tx(def_tx_entry);
@@ -1002,6 +1353,11 @@ static int rxm_ep_close(struct fid *fid)
 	 * connections.
 	 */
 	rxm_stop_listen(ep);
+	if (ep->evictions) {
+		FI_INFO(&rxm_prov, FI_LOG_EP_CTRL,
+			"conn cache: %" PRIu64 " evictions, %" PRIu64
+			" reconnects\n", ep->evictions, ep->reconnects);
+	}
 	rxm_freeall_conns(ep);
 	ret = rxm_listener_close(ep);
 	if (ret)
@@ -1203,6 +1559,37 @@ static void rxm_ep_init_proto(struct rxm_ep *ep)
 	}
 }
 
+/* Only the switch to rendezvous is tuned, within RXM_TUNE_SAR_SCALE times
+ * the configured SAR limit.  With dynamic receive buffers SAR is disabled,
+ * and eager sends larger than a bounce buffer are placed directly by the
+ * peer, the same as a configured eager_limit above buffer_size.
+ */
+static void rxm_ep_init_tune(struct rxm_ep *ep)
+{
+	struct rxm_domain *domain;
+
+	if (!rxm_auto_tune)
+		return;
+
+	domain = container_of(ep->util_ep.domain, struct rxm_domain,
+			      util_domain);
+
+	if (ep->sar_limit > ep->eager_limit) {
+		ep->tune.min = ep->eager_limit;
+		ep->tune.max = ep->sar_limit * RXM_TUNE_SAR_SCALE;
+	} else if (domain->dyn_rbuf && ep->enable_direct_send) {
+		ep->tune.eager = true;
+		ep->tune.min = rxm_buffer_size;
+		ep->tune.max = MAX(ep->eager_limit, rxm_buffer_size * 8 *
+				   RXM_TUNE_SAR_SCALE);
+	} else {
+		FI_INFO(&rxm_prov, FI_LOG_CORE,
+			"no protocol limit to tune, auto_tune disabled\n");
+		return;
+	}
+	ep->tune.enabled = true;
+}
+
 /* Direct send works with verbs, provided that msg_mr_local == rdm_mr_local.
  * However, it fails consistently on HFI, with the receiving side getting
  * corrupted data beyond the first iov.  Only enable if MR_LOCAL is not
@@ -1255,6 +1642,7 @@ static void rxm_ep_settings_init(struct rxm_ep *rxm_ep)
 
 	rxm_config_direct_send(rxm_ep);
 	rxm_ep_init_proto(rxm_ep);
+	rxm_ep_init_tune(rxm_ep);
 
  	FI_INFO(&rxm_prov, FI_LOG_CORE,
 		"Settings:\n"
@@ -1263,11 +1651,13 @@ static void rxm_ep_settings_init(struct rxm_ep *rxm_ep)
 	        "\t\t Buffered min: %zu\n"
 	        "\t\t Min multi recv size: %zu\n"
 	        "\t\t inject size: %zu\n"
-		"\t\t Protocol limits: Eager: %zu, SAR: %zu\n",
+		"\t\t Protocol limits: Eager: %zu, SAR: %zu\n"
+		"\t\t Protocol tuning: %d\n",
 		rxm_ep->msg_mr_local, rxm_ep->rdm_mr_local,
 		rxm_ep->comp_per_progress, rxm_ep->buffered_min,
 		rxm_ep->min_multi_recv_size, rxm_ep->inject_limit,
-		rxm_ep->eager_limit, rxm_ep->sar_limit);
+		rxm_ep->eager_limit, rxm_ep->sar_limit,
+		rxm_ep->tune.enabled);
 }
 
 static int rxm_ep_txrx_res_open(struct rxm_ep *rxm_ep)
@@ -1286,10 +1676,7 @@ static int rxm_ep_txrx_res_open(struct rxm_ep *rxm_ep)
 
 	return FI_SUCCESS;
 err:
-	ofi_bufpool_destroy(rxm_ep->rx_pool);
-	ofi_bufpool_destroy(rxm_ep->tx_pool);
-	rxm_ep->rx_pool = NULL;
-	rxm_ep->tx_pool = NULL;
+	rxm_ep_txrx_res_close(rxm_ep);
 	return ret;
 }
 
@@ -1380,13 +1767,23 @@ err:
 	return ret;
 }
 
+static int rxm_ep_ops_open(struct fid *fid, const char *name,
+			   uint64_t flags, void **ops, void *context)
+{
+	if (!strcasecmp(name, FI_PERSIST_OPS)) {
+		*ops = &rxm_ops_persist;
+		return 0;
+	}
+
+	return -FI_ENOSYS;
+}
 
 static struct fi_ops rxm_ep_fi_ops = {
 	.size = sizeof(struct fi_ops),
 	.close = rxm_ep_close,
 	.bind = ofi_ep_fid_bind,
 	.control = rxm_ep_ctrl,
-	.ops_open = fi_no_ops_open,
+	.ops_open = rxm_ep_ops_open,
 };
 
 static int rxm_listener_open(struct rxm_ep *rxm_ep)
@@ -1465,35 +1862,6 @@ err1:
 	return ret;
 }
 
-static ssize_t
-rxm_prepare_deferred_rndv_read(struct rxm_deferred_tx_entry **def_tx_entry,
-			       size_t index, struct iovec *iov,
-			       void *desc[RXM_IOV_LIMIT], size_t count,
-			       void *buf)
-{
-	uint8_t i;
-	struct rxm_rx_buf *rx_buf = buf;
-
-	*def_tx_entry = rxm_ep_alloc_deferred_tx_entry(rx_buf->ep, rx_buf->conn,
-						       RXM_DEFERRED_TX_RNDV_READ);
-	if (!*def_tx_entry)
-		return -FI_ENOMEM;
-
-	(*def_tx_entry)->rndv_read.rx_buf = rx_buf;
-	(*def_tx_entry)->rndv_read.rma_iov.addr =
-			rx_buf->remote_rndv_hdr->iov[index].addr;
-	(*def_tx_entry)->rndv_read.rma_iov.key =
-			rx_buf->remote_rndv_hdr->iov[index].key;
-
-	for (i = 0; i < count; i++) {
-		(*def_tx_entry)->rndv_read.rxm_iov.iov[i] = iov[i];
-		(*def_tx_entry)->rndv_read.rxm_iov.desc[i] = desc[i];
-	}
-	(*def_tx_entry)->rndv_read.rxm_iov.count = (uint8_t) count;
-
-	return 0;
-}
-
 static ssize_t
 rxm_prepare_deferred_rndv_write(struct rxm_deferred_tx_entry **def_tx_entry,
 			       size_t index, struct iovec *iov,
@@ -1529,7 +1897,6 @@ struct rxm_rndv_ops rxm_rndv_ops_read = {
 	.tx_mr_access = FI_REMOTE_READ,
 	.handle_rx = rxm_rndv_read,
 	.xfer = fi_readv,
-	.defer_xfer = rxm_prepare_deferred_rndv_read
 };
 
 struct rxm_rndv_ops rxm_rndv_ops_write = {
@@ -1625,6 +1992,7 @@ int rxm_endpoint(struct fid_domain *domain, struct fi_info *info,
 		(*ep_fid)->atomic = &rxm_ops_atomic;
 
 	dlist_init(&rxm_ep->loopback_list);
+	dlist_init(&rxm_ep->conn_lru);
 
 	return 0;
 err2:
@@ -55,10 +55,15 @@ size_t rxm_def_tx_size = 2048;
 
 size_t rxm_buffer_size = 16384;
 size_t rxm_packet_size;
+size_t rxm_rx_slab_size = 262144;
+size_t rxm_max_conns;
+size_t rxm_rndv_chunk_size = 4194304;
+size_t rxm_buf_arena_size;
 
 int rxm_passthru = 0; /* disable by default, need to analyze performance */
 int force_auto_progress;
 int rxm_use_write_rndv;
+int rxm_auto_tune;
 enum fi_wait_obj def_wait_obj = FI_WAIT_FD, def_tcp_wait_obj = FI_WAIT_UNSPEC;
 
 char *rxm_proto_state_str[] = {
@@ -417,6 +422,10 @@ static void rxm_init_infos(void)
 
 	rxm_packet_size = sizeof(struct rxm_pkt) + rxm_buffer_size;
 
+	fi_param_get_size_t(&rxm_prov, "rx_slab_size", &rxm_rx_slab_size);
+	if (rxm_rx_slab_size && rxm_rx_slab_size < 2 * rxm_packet_size)
+		rxm_rx_slab_size = 2 * rxm_packet_size;
+
 	fi_param_get_size_t(&rxm_prov, "tx_size", &tx_size);
 	fi_param_get_size_t(&rxm_prov, "rx_size", &rx_size);
 	if (tx_size)
@@ -630,6 +639,14 @@ RXM_INI
 			"typically used as the eager message size. "
 			"(default %zu)", rxm_buffer_size);
 
+	fi_param_define(&rxm_prov, "rx_slab_size", FI_PARAM_SIZE_T,
+			"Defines the size of the multi-recv buffers posted to "
+			"the message provider when it supports FI_MULTI_RECV. "
+			"Incoming packets are packed into these slabs instead "
+			"of a buffer_size bounce buffer each.  Set to 0 to "
+			"always post individual bounce buffers. "
+			"(default %zu)", rxm_rx_slab_size);
+
 	fi_param_define(&rxm_prov, "eager_limit", FI_PARAM_SIZE_T,
 			"Specifies the maximum size transfer that the eager "
 			"protocol will be used.  For transfers smaller than "
@@ -656,6 +673,22 @@ RXM_INI
 			"eager_limit to take effect.  (default %zu).",
 			rxm_buffer_size * 8);
 
+	fi_param_define(&rxm_prov, "rndv_chunk_size", FI_PARAM_SIZE_T,
+			"Defines the largest RMA read issued by the receiver of "
+			"a rendezvous transfer.  Larger messages are read, and "
+			"registered, in chunks of this size, with several reads "
+			"outstanding at a time.  Set to 0 to read each buffer "
+			"of the sender in a single operation. (default %zu)",
+			rxm_rndv_chunk_size);
+
+	fi_param_define(&rxm_prov, "buf_arena_size", FI_PARAM_SIZE_T,
+			"Reserves a range of this size per endpoint, backed "
+			"by transparent huge pages when available, and "
+			"registers it once with the message provider.  The "
+			"bounce buffer pools grow into the range without "
+			"registering memory.  Set to 0 to allocate and "
+			"register each pool region separately. (default 0)");
+
 	fi_param_define(&rxm_prov, "use_srx", FI_PARAM_BOOL,
 			"Set this environment variable to control the RxM "
 			"receive path. If this variable set to 1 (default: 0), "
@@ -663,6 +696,18 @@ RXM_INI
 			"memory consumption, but it may increase small message "
 			"latency as a side-effect.");
 
+	fi_param_define(&rxm_prov, "max_conns", FI_PARAM_SIZE_T,
+			"Defines the maximum number of connections an endpoint "
+			"keeps open.  Once reached, idle connections are closed "
+			"least recently used first and reopened on demand.  Set "
+			"to 0 for no limit. (default: 0)");
+
+	fi_param_define(&rxm_prov, "auto_tune", FI_PARAM_BOOL,
+			"Adjust the message size at which sends switch to the "
+			"rendezvous protocol at run time, based on measured "
+			"completion times.  The learned limits are reported "
+			"through FI_OPT_RXM_PROTO_LIMITS. (default: 0)");
+
 	fi_param_define(&rxm_prov, "tx_size", FI_PARAM_SIZE_T,
 			"Defines default tx context size (default: 2048).");
 
@@ -740,6 +785,11 @@ RXM_INI
 		rxm_cq_eq_fairness = 128;
 	fi_param_get_bool(&rxm_prov, "data_auto_progress", &force_auto_progress);
 	fi_param_get_bool(&rxm_prov, "use_rndv_write", &rxm_use_write_rndv);
+	fi_param_get_size_t(&rxm_prov, "max_conns", &rxm_max_conns);
+	fi_param_get_size_t(&rxm_prov, "rndv_chunk_size",
+			    &rxm_rndv_chunk_size);
+	fi_param_get_size_t(&rxm_prov, "buf_arena_size", &rxm_buf_arena_size);
+	fi_param_get_bool(&rxm_prov, "auto_tune", &rxm_auto_tune);
 
 	rxm_get_def_wait();
 
@@ -369,6 +369,7 @@ rxm_send_rndv(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 	if (ret)
 		goto err;
 
+	dlist_insert_tail(&tx_buf->rndv_entry, &rxm_conn->rndv_tx_list);
 	return FI_SUCCESS;
 
 err:
@@ -498,6 +499,7 @@ rxm_send_sar(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 		return ret;
 	}
 
+	rxm_tune_stamp(rxm_ep, first_tx_buf, data_len);
 	remain_len -= rxm_buffer_size;
 
 	for (i = 1; i < segs_cnt; i++) {
@@ -775,10 +777,150 @@ rxm_send_eager(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 		if (ret == -FI_EAGAIN)
 			rxm_ep_do_progress(&rxm_ep->util_ep);
 		rxm_free_tx_buf(rxm_ep, eager_buf);
+	} else {
+		rxm_tune_stamp(rxm_ep, eager_buf, data_len);
 	}
 	return ret;
 }
 
+static size_t rxm_tune_trial_limit(struct rxm_ep *ep)
+{
+	size_t limit;
+
+	limit = ep->tune.up ? ep->sar_limit + ep->sar_limit / 2 :
+			      ep->sar_limit - ep->sar_limit / 3;
+	return MIN(MAX(limit, ep->tune.min), ep->tune.max);
+}
+
+/* Called for sends near the limit, once they have been posted. */
+void rxm_tune_send(struct rxm_ep *ep, struct rxm_tx_buf *tx_buf, size_t len)
+{
+	struct rxm_tune *tune = &ep->tune;
+	struct rxm_tune_stat *stat;
+
+	tune->sends++;
+	switch (tune->phase) {
+	case RXM_TUNE_IDLE:
+		if (tune->sends < RXM_TUNE_IDLE_SENDS)
+			break;
+
+		tune->sends = 0;
+		tune->trial_limit = rxm_tune_trial_limit(ep);
+		if (tune->trial_limit == ep->sar_limit) {
+			tune->up = !tune->up;
+			break;
+		}
+		memset(tune->stat, 0, sizeof(tune->stat));
+		tune->epoch++;
+		tune->phase = RXM_TUNE_BASE;
+		break;
+	case RXM_TUNE_BASE:
+	case RXM_TUNE_TRIAL:
+	case RXM_TUNE_SETTLE:
+		tx_buf->tune_len = len;
+		tx_buf->tune_epoch = tune->epoch;
+		tx_buf->tune_trial = (tune->phase != RXM_TUNE_BASE);
+		stat = &tune->stat[tx_buf->tune_trial];
+		if (!stat->pending++)
+			stat->start = ofi_gettime_ns();
+
+		if (tune->sends == RXM_TUNE_EPOCH *
+				   (tune->phase == RXM_TUNE_BASE ? 2 : 1)) {
+			tune->sends = 0;
+			tune->phase++;
+		}
+		break;
+	case RXM_TUNE_WAIT:
+		/* Sends that complete in error are not sampled. */
+		if (tune->sends == RXM_TUNE_IDLE_SENDS) {
+			tune->sends = 0;
+			tune->phase = RXM_TUNE_IDLE;
+		}
+		break;
+	}
+}
+
+/* Keep the trial limit if the trial and settle epochs moved data at
+ * least 1/16th faster than the base epochs.  Otherwise, try the other
+ * direction next.
+ */
+void rxm_tune_sample(struct rxm_ep *ep, struct rxm_tx_buf *tx_buf)
+{
+	struct rxm_tune *tune = &ep->tune;
+	struct rxm_tune_stat *stat;
+	double base_rate, trial_rate;
+
+	if (tx_buf->tune_epoch != tune->epoch)
+		return;
+
+	stat = &tune->stat[tx_buf->tune_trial];
+	stat->bytes += tx_buf->tune_len;
+	stat->cnt++;
+	if (!--stat->pending)
+		stat->busy += ofi_gettime_ns() - stat->start;
+
+	if (tune->phase != RXM_TUNE_WAIT || tune->stat[0].pending ||
+	    tune->stat[1].pending)
+		return;
+
+	stat = &tune->stat[0];
+	base_rate = (double) stat->bytes / (stat->busy + 1);
+	stat = &tune->stat[1];
+	trial_rate = (double) stat->bytes / (stat->busy + 1);
+
+	if (trial_rate * 16 > base_rate * 17) {
+		FI_DBG(&rxm_prov, FI_LOG_EP_DATA,
+		       "rendezvous limit %zu -> %zu\n", ep->sar_limit,
+		       tune->trial_limit);
+		ep->sar_limit = tune->trial_limit;
+		if (tune->eager)
+			ep->eager_limit = tune->trial_limit;
+		tune->adjustments++;
+	} else {
+		tune->up = !tune->up;
+	}
+
+	tune->epoch++;
+	tune->sends = 0;
+	tune->phase = RXM_TUNE_IDLE;
+}
+
+static enum rxm_proto
+rxm_tune_proto(struct rxm_ep *ep, size_t data_len, size_t count, uint8_t op)
+{
+	size_t limit;
+
+	if (data_len <= ep->tune.min)
+		return RXM_PROTO_EAGER;
+
+	limit = (ep->tune.phase == RXM_TUNE_TRIAL) ?
+		ep->tune.trial_limit : ep->sar_limit;
+	if (data_len > limit)
+		return RXM_PROTO_RNDV;
+
+	if (!ep->tune.eager)
+		return RXM_PROTO_SAR;
+
+	/* otherwise the data is copied into a bounce buffer */
+	if (!rxm_use_msg_tsend(ep, count, op) &&
+	    !rxm_use_direct_send(ep, count, 0))
+		return RXM_PROTO_RNDV;
+
+	return RXM_PROTO_EAGER;
+}
+
+enum rxm_proto
+rxm_select_proto(struct rxm_ep *ep, size_t data_len, size_t count, uint8_t op)
+{
+	if (ep->tune.enabled)
+		return rxm_tune_proto(ep, data_len, count, op);
+	if (data_len <= ep->eager_limit)
+		return RXM_PROTO_EAGER;
+	if (data_len <= ep->sar_limit)
+		return RXM_PROTO_SAR;
+	return RXM_PROTO_RNDV;
+}
+
 ssize_t
 rxm_send_common(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 		const struct iovec *iov, void **desc, size_t count,
@@ -787,6 +929,7 @@ rxm_send_common(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 {
 	struct rxm_tx_buf *rndv_buf;
 	size_t data_len, total_len;
+	enum rxm_proto proto;
 	enum fi_hmem_iface iface;
 	uint64_t device;
 	ssize_t ret;
@@ -799,11 +942,14 @@ rxm_send_common(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 		(data_len > rxm_ep->rxm_info->tx_attr->inject_size)) ||
 	       (data_len <= rxm_ep->rxm_info->tx_attr->inject_size));
 
-	if (data_len <= rxm_ep->eager_limit) {
+	proto = rxm_select_proto(rxm_ep, data_len, count, op);
+	OFI_TRACE(rxm_proto, rxm_ep, op, data_len, proto);
+
+	if (proto == RXM_PROTO_EAGER) {
 		ret = rxm_send_eager(rxm_ep, rxm_conn, iov, desc, count,
 				     context, data, flags, tag, op,
 				     data_len, total_len);
-	} else if (data_len <= rxm_ep->sar_limit) {
+	} else if (proto == RXM_PROTO_SAR) {
 		ret = rxm_send_sar(rxm_ep, rxm_conn, iov, desc, (uint8_t) count,
 				   context, data, flags, tag, op, data_len,
 				   rxm_ep_sar_calc_segs_cnt(rxm_ep, data_len));
@@ -816,11 +962,94 @@ rxm_send_common(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 					 iface, device, &rndv_buf);
 		if (ret >= 0)
 			ret = rxm_send_rndv(rxm_ep, rxm_conn, rndv_buf, ret);
+		if (!ret)
+			rxm_tune_stamp(rxm_ep, rndv_buf, data_len);
 	}
 
 	return ret;
 }
 
+void rxm_persist_send_init(struct rxm_ep *ep, struct rxm_persist_req *req)
+{
+	size_t len = req->iov.iov_len;
+
+	req->proto = rxm_select_proto(ep, len, 1, ofi_op_tagged);
+	req->iface = rxm_mr_desc_to_hmem_iface_dev(&req->desc, 1,
+						   &req->device);
+
+	if (rxm_use_msg_tsend(ep, 1, ofi_op_tagged))
+		req->path = RXM_PERSIST_MSG_TSEND;
+	else if (rxm_use_direct_send(ep, 1, req->flags))
+		req->path = RXM_PERSIST_DIRECT;
+	else
+		req->path = RXM_PERSIST_COPY;
+
+	req->pkt.ctrl_hdr.version = RXM_CTRL_VERSION;
+	req->pkt.ctrl_hdr.type = rxm_ctrl_eager;
+	req->pkt.hdr.version = OFI_OP_VERSION;
+	req->pkt.hdr.size = len;
+	req->pkt.hdr.op = ofi_op_tagged;
+	req->pkt.hdr.tag = req->tag;
+}
+
+/* Eager sends copy the packet header formatted at init and only fill in
+ * the connection id.  Larger sends go through the regular path, which
+ * also handles protocol limits that move with FI_OFI_RXM_AUTO_TUNE.
+ */
+ssize_t rxm_persist_send(struct rxm_ep *ep, struct rxm_conn *conn,
+			 struct rxm_persist_req *req)
+{
+	struct rxm_tx_buf *tx_buf;
+	size_t len = req->iov.iov_len;
+	ssize_t ret;
+
+	if (ep->tune.enabled || req->proto != RXM_PROTO_EAGER)
+		return rxm_send_common(ep, conn, &req->iov, &req->desc, 1,
+				       req->persist.context, 0, req->flags,
+				       req->tag, ofi_op_tagged);
+
+	tx_buf = rxm_get_tx_buf(ep);
+	if (!tx_buf)
+		return -FI_EAGAIN;
+
+	tx_buf->hdr.state = RXM_TX;
+	tx_buf->app_context = req->persist.context;
+	tx_buf->flags = req->flags;
+	memcpy(&tx_buf->pkt, &req->pkt, sizeof(req->pkt));
+	tx_buf->pkt.ctrl_hdr.conn_id = conn->remote_index;
+
+	switch (req->path) {
+	case RXM_PERSIST_MSG_TSEND:
+		ret = rxm_msg_tsend(ep, conn, tx_buf, &req->iov, 1, 0,
+				    req->tag);
+		break;
+	case RXM_PERSIST_DIRECT:
+		ret = rxm_direct_send(ep, conn, tx_buf, &req->iov,
+				      &req->desc, 1);
+		break;
+	default:
+		if (req->iface == FI_HMEM_SYSTEM) {
+			memcpy(tx_buf->pkt.data, req->iov.iov_base, len);
+		} else {
+			ret = ofi_copy_from_hmem_iov(tx_buf->pkt.data, len,
+						     req->iface, req->device,
+						     &req->iov, 1, 0);
+			assert((size_t) ret == len);
+		}
+		ret = fi_send(conn->msg_ep, &tx_buf->pkt,
+			      sizeof(struct rxm_pkt) + len,
+			      tx_buf->hdr.desc, 0, tx_buf);
+		break;
+	}
+
+	if (ret) {
+		if (ret == -FI_EAGAIN)
+			rxm_ep_do_progress(&ep->util_ep);
+		rxm_free_tx_buf(ep, tx_buf);
+	}
+	return ret;
+}
+
 static ssize_t
 rxm_sendmsg(struct fid_ep *ep_fid, const struct fi_msg *msg, uint64_t flags)
 {
@@ -410,6 +410,160 @@ struct fi_ops_tagged rxm_tagged_ops = {
 	.injectdata = rxm_tinjectdata,
 };
 
+static struct rxm_persist_req *
+rxm_persist_alloc(struct fid_ep *ep_fid, void *buf, size_t len, void *desc,
+		  fi_addr_t addr, uint64_t tag, void *context)
+{
+	struct rxm_persist_req *req;
+	struct rxm_domain *domain;
+
+	req = calloc(1, sizeof(*req));
+	if (!req)
+		return NULL;
+
+	req->ep = container_of(ep_fid, struct rxm_ep, util_ep.ep_fid.fid);
+	domain = container_of(req->ep->util_ep.domain, struct rxm_domain,
+			      util_domain);
+	req->persist.ep = ep_fid;
+	req->persist.context = context;
+	req->iov.iov_base = buf;
+	req->iov.iov_len = len;
+	req->desc = desc;
+	req->addr = addr;
+	req->tag = tag;
+	req->thru = domain->passthru;
+	return req;
+}
+
+static int
+rxm_persist_tsend_init(struct fid_ep *ep_fid, const void *buf, size_t len,
+		       void *desc, fi_addr_t dest_addr, uint64_t tag,
+		       void *context, struct fi_persist_req **persist)
+{
+	struct rxm_persist_req *req;
+	struct util_peer_addr **peer;
+
+	req = rxm_persist_alloc(ep_fid, (void *) buf, len, desc, dest_addr,
+				tag, context);
+	if (!req)
+		return -FI_ENOMEM;
+
+	req->send = true;
+	req->flags = req->ep->util_ep.tx_op_flags;
+	if (!req->thru) {
+		if (!req->ep->util_ep.av) {
+			free(req);
+			return -FI_ENOAV;
+		}
+
+		ofi_ep_lock_acquire(&req->ep->util_ep);
+		peer = ofi_av_addr_context(req->ep->util_ep.av, dest_addr);
+		if (!peer || !*peer) {
+			ofi_ep_lock_release(&req->ep->util_ep);
+			free(req);
+			return -FI_EINVAL;
+		}
+		req->peer = *peer;
+		rxm_ref_peer(req->peer);
+		rxm_persist_send_init(req->ep, req);
+		ofi_ep_lock_release(&req->ep->util_ep);
+	}
+
+	*persist = &req->persist;
+	return 0;
+}
+
+static int
+rxm_persist_trecv_init(struct fid_ep *ep_fid, void *buf, size_t len,
+		       void *desc, fi_addr_t src_addr, uint64_t tag,
+		       uint64_t ignore, void *context,
+		       struct fi_persist_req **persist)
+{
+	struct rxm_persist_req *req;
+
+	req = rxm_persist_alloc(ep_fid, buf, len, desc, src_addr, tag,
+				context);
+	if (!req)
+		return -FI_ENOMEM;
+
+	req->ignore = ignore;
+	req->flags = req->ep->util_ep.rx_op_flags;
+	*persist = &req->persist;
+	return 0;
+}
+
+/* The connection found through the cached peer can be used as is, unless
+ * it is being set up, closed or has sends queued ahead of this one.
+ */
+static bool rxm_persist_conn_ready(struct rxm_conn *conn)
+{
+	return conn && conn->state == RXM_CM_CONNECTED &&
+	       !(conn->flags & RXM_CONN_CLOSING) &&
+	       dlist_empty(&conn->deferred_tx_queue);
+}
+
+static ssize_t rxm_persist_start(struct fi_persist_req *persist)
+{
+	struct rxm_persist_req *req;
+	struct rxm_conn *conn;
+	struct rxm_ep *ep;
+	ssize_t ret;
+
+	req = container_of(persist, struct rxm_persist_req, persist);
+	ep = req->ep;
+	if (req->thru) {
+		return req->send ?
+			fi_tsend(persist->ep, req->iov.iov_base,
+				 req->iov.iov_len, req->desc, req->addr,
+				 req->tag, persist->context) :
+			fi_trecv(persist->ep, req->iov.iov_base,
+				 req->iov.iov_len, req->desc, req->addr,
+				 req->tag, req->ignore, persist->context);
+	}
+
+	ofi_ep_lock_acquire(&ep->util_ep);
+	if (!req->send) {
+		ret = rxm_post_trecv(ep, &req->iov, &req->desc, 1, req->addr,
+				     req->tag, req->ignore, persist->context,
+				     req->flags);
+		goto unlock;
+	}
+
+	conn = ofi_idm_lookup(&ep->conn_idx_map, req->peer->index);
+	if (rxm_persist_conn_ready(conn)) {
+		if (rxm_max_conns)
+			rxm_touch_conn(conn);
+	} else {
+		ret = rxm_get_conn(ep, req->addr, &conn);
+		if (ret)
+			goto unlock;
+	}
+
+	ret = rxm_persist_send(ep, conn, req);
+unlock:
+	ofi_ep_lock_release(&ep->util_ep);
+	return ret;
+}
+
+static int rxm_persist_free(struct fi_persist_req *persist)
+{
+	struct rxm_persist_req *req;
+
+	req = container_of(persist, struct rxm_persist_req, persist);
+	if (req->peer)
+		util_put_peer(req->peer);
+	free(req);
+	return 0;
+}
+
+struct fi_ops_persist rxm_ops_persist = {
+	.size = sizeof(struct fi_ops_persist),
+	.tsend_init = rxm_persist_tsend_init,
+	.trecv_init = rxm_persist_trecv_init,
+	.start = rxm_persist_start,
+	.free = rxm_persist_free,
+};
+
 
 static ssize_t
 rxm_trecv_thru(struct fid_ep *ep_fid, void *buf, size_t len,
@@ -69,6 +69,8 @@
 struct smr_env {
 	size_t sar_threshold;
 	int disable_cma;
+	size_t cma_threads;
+	size_t cma_split_size;
 };
 
 extern struct smr_env smr_env;
@@ -86,6 +88,15 @@ struct smr_av {
 	size_t			used;
 };
 
+/* Entries of named AVs also hold the peer name, so that processes opening
+ * the AV with FI_READ can add the peers to their map at the same index.
+ * Other AVs only store the index.
+ */
+struct smr_av_addr {
+	int64_t			id;
+	char			name[SMR_NAME_MAX];
+};
+
 static inline int64_t smr_addr_lookup(struct util_av *av, fi_addr_t fiaddr)
 {
 	return *((int64_t *) ofi_av_get_addr(av, fiaddr));
@@ -371,7 +382,7 @@ static inline bool smr_ze_ipc_enabled(struct smr_region *smr,
 	       (peer_smr->flags & SMR_FLAG_IPC_SOCK);
 }
 
-static inline int smr_cma_loop(pid_t pid, struct iovec *local,
+static inline int smr_cma_copy(pid_t pid, struct iovec *local,
 			unsigned long local_cnt, struct iovec *remote,
 			unsigned long remote_cnt, unsigned long flags,
 			size_t total, bool write)
@@ -400,6 +411,24 @@ static inline int smr_cma_loop(pid_t pid, struct iovec *local,
 	}
 }
 
+int smr_copy_pool_cma(pid_t pid, struct iovec *local, unsigned long local_cnt,
+		      struct iovec *remote, unsigned long remote_cnt,
+		      unsigned long flags, size_t total, bool write);
+void smr_copy_pool_cleanup(void);
+
+static inline int smr_cma_loop(pid_t pid, struct iovec *local,
+			unsigned long local_cnt, struct iovec *remote,
+			unsigned long remote_cnt, unsigned long flags,
+			size_t total, bool write)
+{
+	if (smr_env.cma_threads && total >= smr_env.cma_split_size)
+		return smr_copy_pool_cma(pid, local, local_cnt, remote,
+					 remote_cnt, flags, total, write);
+
+	return smr_cma_copy(pid, local, local_cnt, remote, remote_cnt, flags,
+			    total, write);
+}
+
 int smr_progress_unexp_queue(struct smr_ep *ep, struct smr_rx_entry *entry,
 			     struct smr_queue *unexp_queue);
 
@@ -293,6 +293,10 @@ static ssize_t smr_atomic_writemsg(struct fid_ep *ep_fid,
 {
 	struct smr_ep *ep;
 
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_atomic(ep_fid, msg, NULL, NULL, 0, NULL,
+					  NULL, 0, flags, FI_OP_ATOMIC);
+
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
 
 	return smr_generic_atomic(ep, msg->msg_iov, msg->desc, msg->iov_count,
@@ -414,6 +418,11 @@ static ssize_t smr_atomic_readwritemsg(struct fid_ep *ep_fid,
 {
 	struct smr_ep *ep;
 
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_atomic(ep_fid, msg, resultv, result_desc,
+					  result_count, NULL, NULL, 0, flags,
+					  FI_OP_FETCH_ATOMIC);
+
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
 
 	return smr_generic_atomic(ep, msg->msg_iov, msg->desc, msg->iov_count,
@@ -483,6 +492,12 @@ static ssize_t smr_atomic_compwritemsg(struct fid_ep *ep_fid,
 {
 	struct smr_ep *ep;
 
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_atomic(ep_fid, msg, resultv, result_desc,
+					  result_count, comparev, compare_desc,
+					  compare_count, flags,
+					  FI_OP_COMPARE_ATOMIC);
+
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
 
 	return smr_generic_atomic(ep, msg->msg_iov, msg->desc, msg->iov_count,
@@ -50,6 +50,59 @@ static int smr_av_close(struct fid *fid)
 	return 0;
 }
 
+/* Adds the peers of a named AV to the map of a process that opened it
+ * with FI_READ, at the index they have in the map of the creator.
+ */
+static int smr_av_add_shared(struct util_av *util_av, void *addr,
+			     fi_addr_t fi_addr, void *arg)
+{
+	struct smr_av_addr *av_addr = addr;
+	struct smr_av *smr_av = arg;
+	int ret;
+
+	if (smr_av->smr_map->peers[av_addr->id].peer.name[0])
+		return 0;
+
+	ret = smr_map_add_id(&smr_prov, smr_av->smr_map, av_addr->name,
+			     av_addr->id);
+	if (ret) {
+		FI_WARN(&smr_prov, FI_LOG_AV, "unable to map peer %s\n",
+			av_addr->name);
+		return ret == -FI_EALREADY ? 0 : ret;
+	}
+
+	smr_av->smr_map->peers[av_addr->id].fiaddr = fi_addr;
+	smr_av->used++;
+	return 0;
+}
+
+static int smr_av_find(struct smr_av *smr_av, const char *name, int64_t *id)
+{
+	struct ofi_rbnode *node;
+
+	ofi_spin_lock(&smr_av->smr_map->lock);
+	node = ofi_rbmap_find(&smr_av->smr_map->rbmap, (void *) name);
+	if (node)
+		*id = (intptr_t) node->data;
+	ofi_spin_unlock(&smr_av->smr_map->lock);
+
+	return node ? 0 : -FI_ENOENT;
+}
+
+/* Read-only AVs resolve names inserted by the creator of the AV */
+static int smr_av_find_shared(struct smr_av *smr_av, const char *name,
+			      int64_t *id)
+{
+	int ret;
+
+	if (!smr_av_find(smr_av, name, id))
+		return 0;
+
+	ret = ofi_av_elements_iter(&smr_av->util_av, smr_av_add_shared,
+				   smr_av);
+	return ret ? ret : smr_av_find(smr_av, name, id);
+}
+
 /*
  * Input address: smr name (string)
  * output address: index (fi_addr_t), the output from util_av
@@ -62,8 +115,9 @@ static int smr_av_insert(struct fid_av *av_fid, const void *addr, size_t count,
 	struct smr_av *smr_av;
 	struct smr_ep *smr_ep;
 	struct dlist_entry *av_entry;
+	struct smr_av_addr av_addr;
 	fi_addr_t util_addr;
-	int64_t shm_id = -1;
+	int64_t shm_id;
 	int i, ret;
 	int succ_count = 0;
 
@@ -74,15 +128,12 @@ static int smr_av_insert(struct fid_av *av_fid, const void *addr, size_t count,
 		FI_INFO(&smr_prov, FI_LOG_AV, "%s\n", (const char *) addr);
 
 		util_addr = FI_ADDR_NOTAVAIL;
-		if (smr_av->used < SMR_MAX_PEERS) {
+		shm_id = -1;
+		if (util_av->flags & FI_READ) {
+			ret = smr_av_find_shared(smr_av, addr, &shm_id);
+		} else if (smr_av->used < SMR_MAX_PEERS) {
 			ret = smr_map_add(&smr_prov, smr_av->smr_map,
 					  addr, &shm_id);
-			if (!ret) {
-				ofi_mutex_lock(&util_av->lock);
-				ret = ofi_av_insert_addr(util_av, &shm_id,
-							 &util_addr);
-				ofi_mutex_unlock(&util_av->lock);
-			}
 		} else {
 			FI_WARN(&smr_prov, FI_LOG_AV,
 				"AV insert failed. The maximum number of AV "
@@ -90,6 +141,15 @@ static int smr_av_insert(struct fid_av *av_fid, const void *addr, size_t count,
 			ret = -FI_ENOMEM;
 		}
 
+		if (!ret) {
+			memset(&av_addr, 0, sizeof(av_addr));
+			av_addr.id = shm_id;
+			strncpy(av_addr.name, addr, SMR_NAME_MAX - 1);
+			ofi_mutex_lock(&util_av->lock);
+			ret = ofi_av_insert_addr(util_av, &av_addr, &util_addr);
+			ofi_mutex_unlock(&util_av->lock);
+		}
+
 		FI_INFO(&smr_prov, FI_LOG_AV, "fi_addr: %" PRIu64 "\n", util_addr);
 		if (fi_addr)
 			fi_addr[i] = util_addr;
@@ -97,16 +157,19 @@ static int smr_av_insert(struct fid_av *av_fid, const void *addr, size_t count,
 		if (ret) {
 			if (util_av->eq)
 				ofi_av_write_event(util_av, i, -ret, context);
-			if (shm_id >= 0)
+			if (shm_id >= 0 && !(util_av->flags & FI_READ))
 				smr_map_del(smr_av->smr_map, shm_id);
 			continue;
-		} else {
-			assert(shm_id >= 0 && shm_id < SMR_MAX_PEERS);
-			smr_av->smr_map->peers[shm_id].fiaddr = util_addr;
-			succ_count++;
-			smr_av->used++;
 		}
 
+		succ_count++;
+		if (util_av->flags & FI_READ)
+			continue;
+
+		assert(shm_id >= 0 && shm_id < SMR_MAX_PEERS);
+		smr_av->smr_map->peers[shm_id].fiaddr = util_addr;
+		smr_av->used++;
+
 		dlist_foreach(&util_av->ep_list, av_entry) {
 			util_ep = container_of(av_entry, struct util_ep, av_entry);
 			smr_ep = container_of(util_ep, struct smr_ep, util_ep);
@@ -134,6 +197,8 @@ static int smr_av_remove(struct fid_av *av_fid, fi_addr_t *fi_addr, size_t count
 
 	util_av = container_of(av_fid, struct util_av, av_fid);
 	smr_av = container_of(util_av, struct smr_av, util_av);
+	if (util_av->flags & FI_READ)
+		return -FI_EOPNOTSUPP;
 
 	ofi_mutex_lock(&util_av->lock);
 	for (i = 0; i < count; i++) {
@@ -222,11 +287,6 @@ int smr_av_open(struct fid_domain *domain, struct fi_av_attr *attr,
 		return -FI_EINVAL;
 	}
 
-	if (attr->name) {
-		FI_INFO(&smr_prov, FI_LOG_AV, "shared AV not supported\n");
-		return -FI_ENOSYS;
-	}
-
 	if (attr->type == FI_AV_UNSPEC)
 		attr->type = FI_AV_TABLE;
 
@@ -236,9 +296,10 @@ int smr_av_open(struct fid_domain *domain, struct fi_av_attr *attr,
 	if (!smr_av)
 		return -FI_ENOMEM;
 
-	util_attr.addrlen = sizeof(int64_t);
+	util_attr.addrlen = attr->name ? sizeof(struct smr_av_addr) :
+					 sizeof(int64_t);
 	util_attr.context_len = 0;
-	util_attr.flags = 0;
+	util_attr.flags = OFI_AV_SHARED;
 	if (attr->count > SMR_MAX_PEERS) {
 		FI_INFO(&smr_prov, FI_LOG_AV,
 			"count %d exceeds max peers\n", (int) attr->count);
@@ -259,8 +320,20 @@ int smr_av_open(struct fid_domain *domain, struct fi_av_attr *attr,
 	if (ret)
 		goto close;
 
+	if (smr_av->util_av.shared) {
+		attr->map_addr = smr_av->util_av.shared->map;
+		if (attr->flags & FI_READ) {
+			ret = ofi_av_elements_iter(&smr_av->util_av,
+						   smr_av_add_shared, smr_av);
+			if (ret)
+				goto free_map;
+		}
+	}
+
 	return 0;
 
+free_map:
+	smr_map_free(smr_av->smr_map);
 close:
 	ofi_av_close(&smr_av->util_av);
 out:
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2026 libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <dirent.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "smr.h"
+
+#define SMR_COPY_MAX_THREADS	16
+#define SMR_COPY_MIN_CHUNK	(1 << 20)
+
+struct smr_copy_job {
+	pid_t			pid;
+	bool			write;
+	ofi_atomic32_t		pending;
+	int			err;
+};
+
+struct smr_copy_chunk {
+	struct dlist_entry	entry;
+	struct smr_copy_job	*job;
+	struct iovec		local[SMR_IOV_LIMIT];
+	struct iovec		remote[SMR_IOV_LIMIT];
+	size_t			local_cnt;
+	size_t			remote_cnt;
+	size_t			len;
+	bool			queued;
+};
+
+static struct {
+	pthread_mutex_t		lock;
+	pthread_cond_t		cond;
+	struct dlist_entry	queue;
+	pthread_t		threads[SMR_COPY_MAX_THREADS];
+	int			nthreads;
+	bool			started;
+	bool			stop;
+	bool			bind;
+	cpu_set_t		cpus;
+} smr_copy_pool = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+	.queue = { &smr_copy_pool.queue, &smr_copy_pool.queue },
+};
+
+static void smr_copy_run(struct smr_copy_chunk *chunk)
+{
+	struct smr_copy_job *job = chunk->job;
+	int ret;
+
+	ret = smr_cma_copy(job->pid, chunk->local, chunk->local_cnt,
+			   chunk->remote, chunk->remote_cnt, 0, chunk->len,
+			   job->write);
+	if (ret)
+		job->err = ret;
+	ofi_atomic_dec32(&job->pending);
+}
+
+static void *smr_copy_thread(void *arg)
+{
+	struct smr_copy_chunk *chunk;
+
+	if (smr_copy_pool.bind)
+		pthread_setaffinity_np(pthread_self(),
+				       sizeof(smr_copy_pool.cpus),
+				       &smr_copy_pool.cpus);
+
+	pthread_mutex_lock(&smr_copy_pool.lock);
+	while (!smr_copy_pool.stop) {
+		if (dlist_empty(&smr_copy_pool.queue)) {
+			pthread_cond_wait(&smr_copy_pool.cond,
+					  &smr_copy_pool.lock);
+			continue;
+		}
+
+		dlist_pop_front(&smr_copy_pool.queue, struct smr_copy_chunk,
+				chunk, entry);
+		chunk->queued = false;
+		pthread_mutex_unlock(&smr_copy_pool.lock);
+		smr_copy_run(chunk);
+		pthread_mutex_lock(&smr_copy_pool.lock);
+	}
+	pthread_mutex_unlock(&smr_copy_pool.lock);
+
+	return NULL;
+}
+
+/* Find the CPUs of the NUMA node the caller runs on from sysfs */
+static int smr_copy_node_cpus(cpu_set_t *cpus)
+{
+	char path[64], list[1024], *str, *end;
+	struct dirent *dent;
+	long first, last;
+	int cpu, node = -1;
+	DIR *dir;
+	FILE *file;
+
+	cpu = sched_getcpu();
+	if (cpu < 0)
+		return -errno;
+
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+	dir = opendir(path);
+	if (!dir)
+		return -errno;
+
+	while ((dent = readdir(dir))) {
+		if (sscanf(dent->d_name, "node%d", &node) == 1)
+			break;
+	}
+	closedir(dir);
+	if (node < 0)
+		return -FI_ENODATA;
+
+	snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+		 node);
+	file = fopen(path, "r");
+	if (!file)
+		return -errno;
+
+	str = fgets(list, sizeof(list), file);
+	fclose(file);
+	if (!str)
+		return -FI_ENODATA;
+
+	CPU_ZERO(cpus);
+	while (*str && *str != '\n') {
+		first = strtol(str, &end, 10);
+		if (end == str)
+			return -FI_EINVAL;
+		last = first;
+		if (*end == '-')
+			last = strtol(end + 1, &end, 10);
+		for (; first <= last && first < CPU_SETSIZE; first++)
+			CPU_SET(first, cpus);
+		str = (*end == ',') ? end + 1 : end;
+	}
+
+	return CPU_COUNT(cpus) ? 0 : -FI_ENODATA;
+}
+
+/* Start the helpers on first use, on the NUMA node of the thread that
+ * needed them.  Helpers are bound to that node and their number leaves one
+ * of its CPUs for the caller, which copies a chunk itself.
+ */
+static void smr_copy_pool_start(void)
+{
+	long max_threads;
+	int i, ret;
+
+	smr_copy_pool.started = true;
+
+	ret = smr_copy_node_cpus(&smr_copy_pool.cpus);
+	if (ret) {
+		FI_INFO(&smr_prov, FI_LOG_EP_DATA,
+			"NUMA node of CMA copy threads unknown (%d)\n", ret);
+		max_threads = ofi_sysconf(_SC_NPROCESSORS_ONLN) - 1;
+	} else {
+		smr_copy_pool.bind = true;
+		max_threads = CPU_COUNT(&smr_copy_pool.cpus) - 1;
+	}
+
+	max_threads = MIN(max_threads, SMR_COPY_MAX_THREADS);
+	max_threads = MIN(max_threads, (long) smr_env.cma_threads);
+
+	for (i = 0; i < max_threads; i++) {
+		ret = pthread_create(&smr_copy_pool.threads[i], NULL,
+				     smr_copy_thread, NULL);
+		if (ret) {
+			FI_WARN(&smr_prov, FI_LOG_EP_DATA,
+				"unable to start CMA copy thread (%d)\n", ret);
+			break;
+		}
+	}
+	smr_copy_pool.nthreads = i;
+
+	FI_INFO(&smr_prov, FI_LOG_EP_DATA, "started %d CMA copy threads\n",
+		smr_copy_pool.nthreads);
+}
+
+static void smr_copy_slice(struct iovec *dst, size_t *dst_cnt,
+			   const struct iovec *src, size_t src_cnt,
+			   size_t offset, size_t len)
+{
+	memcpy(dst, src, sizeof(*src) * src_cnt);
+	*dst_cnt = src_cnt;
+	ofi_consume_iov(dst, dst_cnt, offset);
+	(void) ofi_truncate_iov(dst, dst_cnt, len);
+}
+
+/* Split a large CMA copy into chunks run by the copy threads.  The caller
+ * copies the first chunk and any others not yet picked up, then waits for
+ * the rest, so the copy is complete on return as with smr_cma_copy.
+ */
+int smr_copy_pool_cma(pid_t pid, struct iovec *local, unsigned long local_cnt,
+		      struct iovec *remote, unsigned long remote_cnt,
+		      unsigned long flags, size_t total, bool write)
+{
+	struct smr_copy_chunk chunks[SMR_COPY_MAX_THREADS + 1];
+	struct smr_copy_chunk *chunk;
+	struct smr_copy_job job;
+	size_t nchunks, chunk_len, offset, i;
+
+	pthread_mutex_lock(&smr_copy_pool.lock);
+	if (!smr_copy_pool.started)
+		smr_copy_pool_start();
+	pthread_mutex_unlock(&smr_copy_pool.lock);
+
+	nchunks = MIN(smr_copy_pool.nthreads + 1, total / SMR_COPY_MIN_CHUNK);
+	if (nchunks < 2 || local_cnt > SMR_IOV_LIMIT ||
+	    remote_cnt > SMR_IOV_LIMIT)
+		return smr_cma_copy(pid, local, local_cnt, remote, remote_cnt,
+				    flags, total, write);
+
+	chunk_len = ofi_get_aligned_size((total + nchunks - 1) / nchunks,
+					 SMR_COPY_MIN_CHUNK);
+	nchunks = (total + chunk_len - 1) / chunk_len;
+
+	job.pid = pid;
+	job.write = write;
+	job.err = 0;
+	ofi_atomic_initialize32(&job.pending, (int32_t) nchunks);
+
+	for (i = 0, offset = 0; i < nchunks; i++, offset += chunk_len) {
+		chunks[i].job = &job;
+		chunks[i].len = MIN(chunk_len, total - offset);
+		smr_copy_slice(chunks[i].local, &chunks[i].local_cnt, local,
+			       local_cnt, offset, chunks[i].len);
+		smr_copy_slice(chunks[i].remote, &chunks[i].remote_cnt, remote,
+			       remote_cnt, offset, chunks[i].len);
+	}
+
+	pthread_mutex_lock(&smr_copy_pool.lock);
+	for (i = 1; i < nchunks; i++) {
+		chunks[i].queued = true;
+		dlist_insert_tail(&chunks[i].entry, &smr_copy_pool.queue);
+	}
+	pthread_cond_broadcast(&smr_copy_pool.cond);
+	pthread_mutex_unlock(&smr_copy_pool.lock);
+
+	smr_copy_run(&chunks[0]);
+
+	while (ofi_atomic_get32(&job.pending)) {
+		chunk = NULL;
+		pthread_mutex_lock(&smr_copy_pool.lock);
+		for (i = 1; i < nchunks; i++) {
+			if (chunks[i].queued) {
+				chunk = &chunks[i];
+				chunk->queued = false;
+				dlist_remove(&chunk->entry);
+				break;
+			}
+		}
+		pthread_mutex_unlock(&smr_copy_pool.lock);
+
+		if (chunk)
+			smr_copy_run(chunk);
+		else
+			sched_yield();
+	}
+
+	return job.err;
+}
+
+void smr_copy_pool_cleanup(void)
+{
+	int i;
+
+	pthread_mutex_lock(&smr_copy_pool.lock);
+	smr_copy_pool.stop = true;
+	pthread_cond_broadcast(&smr_copy_pool.cond);
+	pthread_mutex_unlock(&smr_copy_pool.lock);
+
+	for (i = 0; i < smr_copy_pool.nthreads; i++)
+		pthread_join(smr_copy_pool.threads[i], NULL);
+
+	smr_copy_pool.nthreads = 0;
+	smr_copy_pool.started = false;
+	smr_copy_pool.stop = false;
+}
@@ -63,11 +63,24 @@ static int smr_domain_close(fid_t fid)
 	return 0;
 }
 
+static int smr_domain_ctrl(struct fid *fid, int command, void *arg)
+{
+	struct smr_domain *domain;
+
+	domain = container_of(fid, struct smr_domain, util_domain.domain_fid.fid);
+	switch (command) {
+	case FI_QUEUE_WORK:
+		return ofi_trigger_queue_work(&domain->util_domain, arg);
+	default:
+		return -FI_ENOSYS;
+	}
+}
+
 static struct fi_ops smr_domain_fi_ops = {
 	.size = sizeof(struct fi_ops),
 	.close = smr_domain_close,
 	.bind = fi_no_bind,
-	.control = fi_no_control,
+	.control = smr_domain_ctrl,
 	.ops_open = fi_no_ops_open,
 };
 
@@ -100,7 +113,6 @@ int smr_domain_open(struct fid_fabric *fabric, struct fi_info *info,
 		return ret;
 	}
 
-	smr_domain->util_domain.threading = FI_THREAD_SAFE;
 	smr_fabric = container_of(fabric, struct smr_fabric, util_fabric.fabric_fid);
 	ofi_mutex_lock(&smr_fabric->util_fabric.lock);
 	smr_domain->fast_rma = smr_fast_rma_enabled(info->domain_attr->mr_mode,
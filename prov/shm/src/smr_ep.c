@@ -42,6 +42,7 @@
 
 extern struct fi_ops_msg smr_msg_ops;
 extern struct fi_ops_tagged smr_tagged_ops;
+extern struct fi_ops_persist smr_persist_ops;
 extern struct fi_ops_rma smr_rma_ops;
 extern struct fi_ops_atomic smr_atomic_ops;
 DEFINE_LIST(sock_name_list);
@@ -232,6 +233,8 @@ out:
 
 int64_t smr_verify_peer(struct smr_ep *ep, fi_addr_t fi_addr)
 {
+	struct smr_av_addr *av_addr;
+	struct smr_peer *peer;
 	int64_t id;
 	int ret;
 
@@ -241,11 +244,21 @@ int64_t smr_verify_peer(struct smr_ep *ep, fi_addr_t fi_addr)
 	if (smr_peer_data(ep->region)[id].addr.id >= 0)
 		return id;
 
-	if (ep->region->map->peers[id].peer.id < 0) {
-		ret = smr_map_to_region(&smr_prov, &ep->region->map->peers[id]);
-		if (ret == -ENOENT)
-			return -1;
-
+	peer = &ep->region->map->peers[id];
+	if (peer->peer.id < 0) {
+		/* added to a shared AV after this process opened it */
+		if (!peer->peer.name[0] && ep->util_ep.av->shared) {
+			av_addr = ofi_av_get_addr(ep->util_ep.av, fi_addr);
+			ret = smr_map_add_id(&smr_prov, ep->region->map,
+					     av_addr->name, id);
+			if (ret || peer->peer.id < 0)
+				return -1;
+			peer->fiaddr = fi_addr;
+		} else {
+			ret = smr_map_to_region(&smr_prov, peer);
+			if (ret == -ENOENT)
+				return -1;
+		}
 	}
 
 	smr_send_name(ep, id);
@@ -1325,12 +1338,23 @@ static int smr_ep_ctrl(struct fid *fid, int command, void *arg)
 	return ret;
 }
 
+static int smr_ep_ops_open(struct fid *fid, const char *name,
+			   uint64_t flags, void **ops, void *context)
+{
+	if (!strcasecmp(name, FI_PERSIST_OPS)) {
+		*ops = &smr_persist_ops;
+		return 0;
+	}
+
+	return -FI_ENOSYS;
+}
+
 static struct fi_ops smr_ep_fi_ops = {
 	.size = sizeof(struct fi_ops),
 	.close = smr_ep_close,
 	.bind = smr_ep_bind,
 	.control = smr_ep_ctrl,
-	.ops_open = fi_no_ops_open,
+	.ops_open = smr_ep_ops_open,
 };
 
 static int smr_endpoint_name(struct smr_ep *ep, char *name, char *addr,
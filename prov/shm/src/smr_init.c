@@ -42,6 +42,8 @@ struct sigaction *old_action = NULL;
 struct smr_env smr_env = {
 	.sar_threshold = SIZE_MAX,
 	.disable_cma = false,
+	.cma_threads = 0,
+	.cma_split_size = 64 * 1024 * 1024,
 };
 
 static void smr_init_env(void)
@@ -50,6 +52,9 @@ static void smr_init_env(void)
 	fi_param_get_size_t(&smr_prov, "tx_size", &smr_info.tx_attr->size);
 	fi_param_get_size_t(&smr_prov, "rx_size", &smr_info.rx_attr->size);
 	fi_param_get_bool(&smr_prov, "disable_cma", &smr_env.disable_cma);
+	fi_param_get_size_t(&smr_prov, "cma_threads", &smr_env.cma_threads);
+	fi_param_get_size_t(&smr_prov, "cma_split_size",
+			    &smr_env.cma_split_size);
 }
 
 static void smr_resolve_addr(const char *node, const char *service,
@@ -174,6 +179,7 @@ static void smr_fini(void)
 #if HAVE_SHM_DL
 	ofi_hmem_cleanup();
 #endif
+	smr_copy_pool_cleanup();
 	smr_cleanup();
 	free(old_action);
 }
@@ -210,6 +216,13 @@ SHM_INI
 			 Default: 1024");
 	fi_param_define(&smr_prov, "disable_cma", FI_PARAM_BOOL,
 			"Manually disables CMA. Default: false");
+	fi_param_define(&smr_prov, "cma_threads", FI_PARAM_SIZE_T,
+			"Number of helper threads that split large CMA copies \
+			 with the receiving thread, capped by the CPUs of its \
+			 NUMA node. Default: 0 (disabled)");
+	fi_param_define(&smr_prov, "cma_split_size", FI_PARAM_SIZE_T,
+			"Minimum size of CMA copies split between helper \
+			 threads. Default: 67108864 (64 MiB)");
 
 	smr_init_env();
 
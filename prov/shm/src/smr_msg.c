@@ -116,6 +116,9 @@ ssize_t smr_recvmsg(struct fid_ep *ep_fid, const struct fi_msg *msg,
 {
 	struct smr_ep *ep;
 
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_msg(ep_fid, msg, flags, FI_OP_RECV);
+
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
 
 	return smr_generic_recv(ep, msg->msg_iov, msg->desc, msg->iov_count,
@@ -257,6 +260,9 @@ ssize_t smr_sendmsg(struct fid_ep *ep_fid, const struct fi_msg *msg,
 {
 	struct smr_ep *ep;
 
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_msg(ep_fid, msg, flags, FI_OP_SEND);
+
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
 
 	return smr_generic_sendmsg(ep, msg->msg_iov, msg->desc, msg->iov_count,
@@ -387,6 +393,9 @@ ssize_t smr_trecvmsg(struct fid_ep *ep_fid, const struct fi_msg_tagged *msg,
 {
 	struct smr_ep *ep;
 
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_tagged(ep_fid, msg, flags, FI_OP_TRECV);
+
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
 
 	return smr_generic_recv(ep, msg->msg_iov, msg->desc, msg->iov_count,
@@ -429,6 +438,9 @@ ssize_t smr_tsendmsg(struct fid_ep *ep_fid, const struct fi_msg_tagged *msg,
 {
 	struct smr_ep *ep;
 
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_tagged(ep_fid, msg, flags, FI_OP_TSEND);
+
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
 
 	return smr_generic_sendmsg(ep, msg->msg_iov, msg->desc, msg->iov_count,
@@ -479,3 +491,216 @@ struct fi_ops_tagged smr_tagged_ops = {
 	.senddata = smr_tsenddata,
 	.injectdata = smr_tinjectdata,
 };
+
+/* A persistent tagged send or receive.  Sends keep the peer id once it has
+ * been verified, along with the protocol and, for inline sends, the
+ * command header chosen for it.
+ */
+struct smr_persist_req {
+	struct fi_persist_req	persist;
+	struct smr_ep		*ep;
+	struct iovec		iov;
+	void			*desc;
+	fi_addr_t		addr;
+	uint64_t		tag;
+	uint64_t		ignore;
+	uint64_t		op_flags;
+	bool			send;
+
+	int64_t			id;
+	int			proto;
+	enum fi_hmem_iface	iface;
+	uint64_t		device;
+	struct smr_msg_hdr	hdr;
+};
+
+static struct smr_persist_req *
+smr_persist_alloc(struct fid_ep *ep_fid, void *buf, size_t len, void *desc,
+		  fi_addr_t addr, uint64_t tag, void *context)
+{
+	struct smr_persist_req *req;
+
+	req = calloc(1, sizeof(*req));
+	if (!req)
+		return NULL;
+
+	req->ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
+	req->persist.ep = ep_fid;
+	req->persist.context = context;
+	req->iov.iov_base = buf;
+	req->iov.iov_len = len;
+	req->desc = desc;
+	req->addr = addr;
+	req->tag = tag;
+	req->id = -1;
+	return req;
+}
+
+static int smr_persist_tsend_init(struct fid_ep *ep_fid, const void *buf,
+		size_t len, void *desc, fi_addr_t dest_addr, uint64_t tag,
+		void *context, struct fi_persist_req **persist)
+{
+	struct smr_persist_req *req;
+
+	req = smr_persist_alloc(ep_fid, (void *) buf, len, desc, dest_addr,
+				tag, context);
+	if (!req)
+		return -FI_ENOMEM;
+
+	req->send = true;
+	req->op_flags = smr_ep_tx_flags(req->ep);
+	req->iface = smr_get_mr_hmem_iface(req->ep->util_ep.domain,
+					   &req->desc, &req->device);
+	*persist = &req->persist;
+	return 0;
+}
+
+static int smr_persist_trecv_init(struct fid_ep *ep_fid, void *buf,
+		size_t len, void *desc, fi_addr_t src_addr, uint64_t tag,
+		uint64_t ignore, void *context, struct fi_persist_req **persist)
+{
+	struct smr_persist_req *req;
+
+	req = smr_persist_alloc(ep_fid, buf, len, desc, src_addr, tag,
+				context);
+	if (!req)
+		return -FI_ENOMEM;
+
+	req->ignore = ignore;
+	req->op_flags = smr_ep_rx_flags(req->ep);
+	*persist = &req->persist;
+	return 0;
+}
+
+/* The protocol depends on the peer's CMA support, so it is chosen once the
+ * peer has been verified, and again if the peer has to be verified anew.
+ */
+static int smr_persist_resolve(struct smr_persist_req *req)
+{
+	struct smr_ep *ep = req->ep;
+	struct smr_region *peer_smr;
+	struct smr_cmd cmd;
+	bool use_ipc;
+	int64_t id;
+
+	id = smr_verify_peer(ep, req->addr);
+	if (id < 0)
+		return -FI_EAGAIN;
+
+	peer_smr = smr_peer_region(ep->region, id);
+	use_ipc = ofi_hmem_is_ipc_enabled(req->iface) && req->desc &&
+		  (smr_get_mr_flags(&req->desc) & FI_HMEM_DEVICE_ONLY) &&
+		  !(req->op_flags & FI_INJECT);
+	req->proto = smr_select_proto(use_ipc, smr_cma_enabled(ep, peer_smr),
+				      req->iface, ofi_op_tagged,
+				      req->iov.iov_len, req->op_flags);
+
+	memset(&cmd.msg.hdr, 0, sizeof(cmd.msg.hdr));
+	smr_generic_format(&cmd, 0, ofi_op_tagged, req->tag, 0,
+			   req->op_flags);
+	cmd.msg.hdr.op_src = smr_src_inline;
+	cmd.msg.hdr.size = req->iov.iov_len;
+	req->hdr = cmd.msg.hdr;
+
+	req->id = id;
+	return 0;
+}
+
+static ssize_t smr_persist_tsend(struct smr_persist_req *req)
+{
+	struct smr_ep *ep = req->ep;
+	struct smr_region *peer_smr;
+	struct smr_cmd *cmd;
+	int64_t id, peer_id;
+	ssize_t ret = 0;
+
+	if (req->id < 0 || smr_peer_data(ep->region)[req->id].addr.id < 0) {
+		ret = smr_persist_resolve(req);
+		if (ret)
+			return ret;
+	}
+
+	id = req->id;
+	peer_id = smr_peer_data(ep->region)[id].addr.id;
+	peer_smr = smr_peer_region(ep->region, id);
+
+	pthread_spin_lock(&peer_smr->lock);
+	if (!peer_smr->cmd_cnt || smr_peer_data(ep->region)[id].sar_status) {
+		ret = -FI_EAGAIN;
+		goto unlock_region;
+	}
+
+	ofi_genlock_lock(&ep->util_ep.tx_cq->cq_lock);
+	if (ofi_cirque_isfull(ep->util_ep.tx_cq->cirq)) {
+		ret = -FI_EAGAIN;
+		goto unlock_cq;
+	}
+
+	if (req->proto == smr_src_inline) {
+		cmd = ofi_cirque_next(smr_cmd_queue(peer_smr));
+		cmd->msg.hdr = req->hdr;
+		cmd->msg.hdr.id = peer_id;
+		if (req->iface == FI_HMEM_SYSTEM)
+			memcpy(cmd->msg.data.msg, req->iov.iov_base,
+			       req->iov.iov_len);
+		else
+			ofi_copy_from_hmem_iov(cmd->msg.data.msg,
+					       SMR_MSG_DATA_LEN, req->iface,
+					       req->device, &req->iov, 1, 0);
+		ofi_cirque_commit(smr_cmd_queue(peer_smr));
+		peer_smr->cmd_cnt--;
+	} else {
+		ret = smr_proto_ops[req->proto](ep, peer_smr, id, peer_id,
+				ofi_op_tagged, req->tag, 0, req->op_flags,
+				req->iface, req->device, &req->iov, 1,
+				req->iov.iov_len, req->persist.context);
+		if (ret)
+			goto unlock_cq;
+	}
+
+	smr_signal(peer_smr);
+
+	if (req->proto != smr_src_inline && req->proto != smr_src_inject)
+		goto unlock_cq;
+
+	ret = smr_complete_tx(ep, req->persist.context, ofi_op_tagged,
+			      req->op_flags, 0);
+	if (ret) {
+		FI_WARN(&smr_prov, FI_LOG_EP_CTRL,
+			"unable to process tx completion\n");
+	}
+
+unlock_cq:
+	ofi_genlock_unlock(&ep->util_ep.tx_cq->cq_lock);
+unlock_region:
+	pthread_spin_unlock(&peer_smr->lock);
+	return ret;
+}
+
+static ssize_t smr_persist_start(struct fi_persist_req *persist)
+{
+	struct smr_persist_req *req;
+
+	req = container_of(persist, struct smr_persist_req, persist);
+	if (req->send)
+		return smr_persist_tsend(req);
+
+	return smr_generic_recv(req->ep, &req->iov, &req->desc, 1, req->addr,
+				persist->context, req->tag, req->ignore,
+				req->op_flags, &req->ep->trecv_queue,
+				&req->ep->unexp_tagged_queue);
+}
+
+static int smr_persist_free(struct fi_persist_req *persist)
+{
+	free(container_of(persist, struct smr_persist_req, persist));
+	return 0;
+}
+
+struct fi_ops_persist smr_persist_ops = {
+	.size = sizeof(struct fi_ops_persist),
+	.tsend_init = smr_persist_tsend_init,
+	.trecv_init = smr_persist_trecv_init,
+	.start = smr_persist_start,
+	.free = smr_persist_free,
+};
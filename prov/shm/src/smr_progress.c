@@ -987,6 +987,8 @@ static void smr_progress_cmd(struct smr_ep *ep)
 
 	while (!ofi_cirque_isempty(smr_cmd_queue(ep->region))) {
 		cmd = ofi_cirque_head(smr_cmd_queue(ep->region));
+		OFI_TRACE(smr_progress_cmd, ep, cmd->msg.hdr.op,
+			  cmd->msg.hdr.op_src, cmd->msg.hdr.size);
 
 		switch (cmd->msg.hdr.op) {
 		case ofi_op_msg:
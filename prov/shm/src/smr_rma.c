@@ -231,6 +231,9 @@ ssize_t smr_readmsg(struct fid_ep *ep_fid, const struct fi_msg_rma *msg,
 {
 	struct smr_ep *ep;
 
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_rma(ep_fid, msg, flags, FI_OP_READ);
+
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
 
 	return smr_generic_rma(ep, msg->msg_iov, msg->iov_count,
@@ -284,6 +287,9 @@ ssize_t smr_writemsg(struct fid_ep *ep_fid, const struct fi_msg_rma *msg,
 {
 	struct smr_ep *ep;
 
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_rma(ep_fid, msg, flags, FI_OP_WRITE);
+
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
 
 	return smr_generic_rma(ep, msg->msg_iov, msg->iov_count,
@@ -87,7 +87,10 @@
 #define SOCK_DOMAIN_MR_CNT (65535)
 
 #define SOCK_PE_POLL_TIMEOUT (100000)
-#define SOCK_PE_MAX_ENTRIES (128)
+#define SOCK_PE_ENTRY_CHUNK_CNT (128)
+/* bounded by the 16-bit pe_entry_id carried in sock_msg_hdr */
+#define SOCK_PE_MAX_ENTRIES (4096)
+#define SOCK_PE_DEF_CNT (1)
 #define SOCK_PE_WAITTIME (10)
 
 #define SOCK_EQ_DEF_SZ (1<<8)
@@ -130,7 +133,6 @@
 #define SOCK_USE_OP_FLAGS (1ULL << 61)
 #define SOCK_TRIGGERED_OP (1ULL << 62)
 #define SOCK_PE_COMM_BUFF_SZ (1024)
-#define SOCK_PE_OVERFLOW_COMM_BUFF_SZ (128)
 
 /* it must be adjusted if error data size in CQ/EQ
  * will be larger than SOCK_EP_MAX_CM_DATA_SZ */
@@ -236,7 +238,9 @@ struct sock_domain {
 
 	enum fi_progress	progress_mode;
 	struct ofi_mr_map	mr_map;
-	struct sock_pe		*pe;
+	struct sock_pe		**pe;
+	int			pe_cnt;
+	ofi_atomic32_t		pe_next;
 	struct dlist_entry	dom_list_entry;
 	struct fi_domain_attr	attr;
 	struct sock_conn_listener conn_listener;
@@ -547,6 +551,7 @@ struct sock_ep_attr {
 	struct sock_eq *eq;
 	struct sock_av *av;
 	struct sock_domain *domain;
+	struct sock_pe *pe;
 
 	struct sock_rx_ctx *rx_ctx;
 	struct sock_tx_ctx *tx_ctx;
@@ -647,6 +652,7 @@ struct sock_rx_ctx {
 	struct sock_av *av;
 	struct sock_eq *eq;
  	struct sock_domain *domain;
+	struct sock_pe *pe;
 
 	struct dlist_entry pe_entry;
 	struct dlist_entry cq_entry;
@@ -671,8 +677,14 @@ struct sock_tx_ctx {
 	} fid;
 	size_t fclass;
 
+	/* Producers serialize on rb_lock and publish committed ops through
+	 * rb_wcnt; the progress engine drains the ring without taking
+	 * rb_lock and hands space back through rb_rcnt.
+	 */
 	struct ofi_ringbuf rb;
 	ofi_mutex_t rb_lock;
+	ofi_atomic64_t rb_wcnt;
+	ofi_atomic64_t rb_rcnt;
 
 	uint16_t tx_id;
 	uint8_t enabled;
@@ -688,6 +700,7 @@ struct sock_tx_ctx {
 	struct sock_av *av;
 	struct sock_eq *eq;
  	struct sock_domain *domain;
+	struct sock_pe *pe;
 
 	struct dlist_entry pe_entry;
 	struct dlist_entry cq_entry;
@@ -825,9 +838,8 @@ struct sock_pe_entry {
 	uint8_t is_complete;
 	uint8_t is_error;
 	uint8_t mr_checked;
-	uint8_t is_pool_entry;
 	uint8_t completion_reported;
-	uint8_t reserved[3];
+	uint8_t reserved[4];
 
 	uint64_t done_len;
 	uint64_t total_len;
@@ -838,7 +850,6 @@ struct sock_pe_entry {
 	struct sock_conn *conn;
 	struct sock_comp *comp;
 
-	struct dlist_entry entry;
 	struct dlist_entry ctx_entry;
 	struct ofi_ringbuf comm_buf;
 	size_t cache_sz;
@@ -846,20 +857,16 @@ struct sock_pe_entry {
 
 struct sock_pe {
 	struct sock_domain *domain;
-	int num_free_entries;
-	struct sock_pe_entry pe_table[SOCK_PE_MAX_ENTRIES];
+	struct ofi_bufpool *entry_pool;
 	ofi_mutex_t lock;
 	ofi_mutex_t signal_lock;
 	pthread_mutex_t list_lock;
 	int wcnt, rcnt;
 	int signal_fds[2];
+	ofi_atomic32_t sleeping;
 	uint64_t waittime;
 
-	struct ofi_bufpool *pe_rx_pool;
 	struct ofi_bufpool *atomic_rx_pool;
-	struct dlist_entry free_list;
-	struct dlist_entry busy_list;
-	struct dlist_entry pool_list;
 
 	struct dlist_entry tx_list;
 	struct dlist_entry rx_list;
@@ -1011,6 +1018,7 @@ int sock_dom_check_list(struct sock_domain *domain);
 void sock_dom_remove_from_list(struct sock_domain *domain);
 struct sock_domain *sock_dom_list_head(void);
 int sock_dom_check_manual_progress(struct sock_fabric *fabric);
+struct sock_pe *sock_dom_select_pe(struct sock_domain *domain, int shared);
 int sock_query_atomic(struct fid_domain *domain,
 		      enum fi_datatype datatype, enum fi_op op,
 		      struct fi_atomic_attr *attr, uint64_t flags);
@@ -1095,6 +1103,9 @@ void sock_tx_ctx_start(struct sock_tx_ctx *tx_ctx);
 void sock_tx_ctx_write(struct sock_tx_ctx *tx_ctx, const void *buf, size_t len);
 void sock_tx_ctx_commit(struct sock_tx_ctx *tx_ctx);
 void sock_tx_ctx_abort(struct sock_tx_ctx *tx_ctx);
+size_t sock_tx_ctx_avail(struct sock_tx_ctx *tx_ctx);
+int sock_tx_ctx_empty(struct sock_tx_ctx *tx_ctx);
+void sock_tx_ctx_consume(struct sock_tx_ctx *tx_ctx);
 void sock_tx_ctx_write_op_send(struct sock_tx_ctx *tx_ctx,
 		struct sock_op *op, uint64_t flags, uint64_t context,
 		uint64_t dest_addr, uint64_t buf, struct sock_ep_attr *ep_attr,
@@ -141,7 +141,7 @@ ssize_t sock_ep_tx_atomic(struct fid_ep *ep,
 		      (result_count * sizeof(union sock_iov)));
 
 	sock_tx_ctx_start(tx_ctx);
-	if (ofi_rbavail(&tx_ctx->rb) < total_len) {
+	if (sock_tx_ctx_avail(tx_ctx) < total_len) {
 		ret = -FI_EAGAIN;
 		goto err;
 	}
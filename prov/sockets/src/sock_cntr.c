@@ -106,9 +106,9 @@ int sock_cntr_progress(struct sock_cntr *cntr)
 		fid_entry = container_of(entry, struct fid_list_entry, entry);
 		tx_ctx = container_of(fid_entry->fid, struct sock_tx_ctx, fid.ctx.fid);
 		if (tx_ctx->use_shared)
-			sock_pe_progress_tx_ctx(cntr->domain->pe, tx_ctx->stx_ctx);
+			sock_pe_progress_tx_ctx(tx_ctx->stx_ctx->pe, tx_ctx->stx_ctx);
 		else
-			sock_pe_progress_ep_tx(cntr->domain->pe, tx_ctx->ep_attr);
+			sock_pe_progress_ep_tx(tx_ctx->ep_attr->pe, tx_ctx->ep_attr);
 	}
 
 	for (entry = cntr->rx_list.next; entry != &cntr->rx_list;
@@ -116,9 +116,9 @@ int sock_cntr_progress(struct sock_cntr *cntr)
 		fid_entry = container_of(entry, struct fid_list_entry, entry);
 		rx_ctx = container_of(fid_entry->fid, struct sock_rx_ctx, ctx.fid);
 		if (rx_ctx->use_shared)
-			sock_pe_progress_rx_ctx(cntr->domain->pe, rx_ctx->srx_ctx);
+			sock_pe_progress_rx_ctx(rx_ctx->srx_ctx->pe, rx_ctx->srx_ctx);
 		else
-			sock_pe_progress_ep_rx(cntr->domain->pe, rx_ctx->ep_attr);
+			sock_pe_progress_ep_rx(rx_ctx->ep_attr->pe, rx_ctx->ep_attr);
 	}
 
 	ofi_mutex_unlock(&cntr->list_lock);
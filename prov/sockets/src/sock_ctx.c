@@ -108,6 +108,8 @@ static struct sock_tx_ctx *sock_tx_context_alloc(const struct fi_tx_attr *attr,
 	dlist_init(&tx_ctx->ep_list);
 
 	ofi_mutex_init(&tx_ctx->rb_lock);
+	ofi_atomic_initialize64(&tx_ctx->rb_wcnt, 0);
+	ofi_atomic_initialize64(&tx_ctx->rb_rcnt, 0);
 	ofi_mutex_init(&tx_ctx->lock);
 
 	switch (fclass) {
@@ -179,8 +181,9 @@ void sock_tx_ctx_write(struct sock_tx_ctx *tx_ctx, const void *buf, size_t len)
 void sock_tx_ctx_commit(struct sock_tx_ctx *tx_ctx)
 {
 	ofi_rbcommit(&tx_ctx->rb);
-	sock_pe_signal(tx_ctx->domain->pe);
+	ofi_atomic_set64(&tx_ctx->rb_wcnt, tx_ctx->rb.wcnt);
 	ofi_mutex_unlock(&tx_ctx->rb_lock);
+	sock_pe_signal(tx_ctx->pe);
 }
 
 void sock_tx_ctx_abort(struct sock_tx_ctx *tx_ctx)
@@ -189,6 +192,24 @@ void sock_tx_ctx_abort(struct sock_tx_ctx *tx_ctx)
 	ofi_mutex_unlock(&tx_ctx->rb_lock);
 }
 
+/* Called by producers with rb_lock held */
+size_t sock_tx_ctx_avail(struct sock_tx_ctx *tx_ctx)
+{
+	return tx_ctx->rb.size - (tx_ctx->rb.wcnt -
+		(size_t) ofi_atomic_get64(&tx_ctx->rb_rcnt));
+}
+
+/* Called by the progress engine, serialized by pe->lock */
+int sock_tx_ctx_empty(struct sock_tx_ctx *tx_ctx)
+{
+	return (size_t) ofi_atomic_get64(&tx_ctx->rb_wcnt) == tx_ctx->rb.rcnt;
+}
+
+void sock_tx_ctx_consume(struct sock_tx_ctx *tx_ctx)
+{
+	ofi_atomic_set64(&tx_ctx->rb_rcnt, tx_ctx->rb.rcnt);
+}
+
 void sock_tx_ctx_write_op_send(struct sock_tx_ctx *tx_ctx,
 		struct sock_op *op, uint64_t flags, uint64_t context,
 		uint64_t dest_addr, uint64_t buf, struct sock_ep_attr *ep_attr,
@@ -46,6 +46,47 @@
 
 extern struct fi_ops_mr sock_dom_mr_ops;
 
+static void sock_dom_fini_pe(struct sock_domain *dom)
+{
+	int i;
+
+	for (i = 0; i < dom->pe_cnt; i++)
+		sock_pe_finalize(dom->pe[i]);
+	free(dom->pe);
+}
+
+static int sock_dom_init_pe(struct sock_domain *dom)
+{
+	int cnt;
+
+	cnt = MAX(sock_pe_cnt, 1);
+	dom->pe = calloc(cnt, sizeof(*dom->pe));
+	if (!dom->pe)
+		return -FI_ENOMEM;
+
+	ofi_atomic_initialize32(&dom->pe_next, 0);
+	for (dom->pe_cnt = 0; dom->pe_cnt < cnt; dom->pe_cnt++) {
+		dom->pe[dom->pe_cnt] = sock_pe_init(dom);
+		if (!dom->pe[dom->pe_cnt]) {
+			sock_dom_fini_pe(dom);
+			return -FI_ENOMEM;
+		}
+	}
+	return 0;
+}
+
+/* Endpoints are spread round-robin across the domain's progress engines.
+ * Shared contexts, and every endpoint bound to one, stay on the first.
+ */
+struct sock_pe *sock_dom_select_pe(struct sock_domain *dom, int shared)
+{
+	if (shared || dom->pe_cnt == 1)
+		return dom->pe[0];
+
+	return dom->pe[(uint32_t) ofi_atomic_inc32(&dom->pe_next) %
+		       dom->pe_cnt];
+}
+
 
 static int sock_dom_close(struct fid *fid)
 {
@@ -57,7 +98,7 @@ static int sock_dom_close(struct fid *fid)
 	sock_conn_stop_listener_thread(&dom->conn_listener);
 	sock_ep_cm_stop_thread(&dom->cm_head);
 
-	sock_pe_finalize(dom->pe);
+	sock_dom_fini_pe(dom);
 	ofi_mutex_destroy(&dom->lock);
 	ofi_mr_map_close(&dom->mr_map);
 	sock_dom_remove_from_list(dom);
@@ -179,8 +220,7 @@ int sock_domain(struct fid_fabric *fabric, struct fi_info *info,
 	else
 		sock_domain->progress_mode = info->domain_attr->data_progress;
 
-	sock_domain->pe = sock_pe_init(sock_domain);
-	if (!sock_domain->pe) {
+	if (sock_dom_init_pe(sock_domain)) {
 		SOCK_LOG_ERROR("Failed to init PE\n");
 		goto err1;
 	}
@@ -209,7 +249,7 @@ int sock_domain(struct fid_fabric *fabric, struct fi_info *info,
 err3:
 	sock_conn_stop_listener_thread(&sock_domain->conn_listener);
 err2:
-	sock_pe_finalize(sock_domain->pe);
+	sock_dom_fini_pe(sock_domain);
 err1:
 	ofi_mutex_destroy(&sock_domain->lock);
 	free(sock_domain);
@@ -263,7 +263,7 @@ static int sock_ctx_enable(struct fid_ep *ep)
 	switch (ep->fid.fclass) {
 	case FI_CLASS_RX_CTX:
 		rx_ctx = container_of(ep, struct sock_rx_ctx, ctx.fid);
-		sock_pe_add_rx_ctx(rx_ctx->domain->pe, rx_ctx);
+		sock_pe_add_rx_ctx(rx_ctx->pe, rx_ctx);
 
 		if (!rx_ctx->ep_attr->conn_handle.do_listen &&
 		    sock_conn_listen(rx_ctx->ep_attr)) {
@@ -274,7 +274,7 @@ static int sock_ctx_enable(struct fid_ep *ep)
 
 	case FI_CLASS_TX_CTX:
 		tx_ctx = container_of(ep, struct sock_tx_ctx, fid.ctx.fid);
-		sock_pe_add_tx_ctx(tx_ctx->domain->pe, tx_ctx);
+		sock_pe_add_tx_ctx(tx_ctx->pe, tx_ctx);
 
 		if (!tx_ctx->ep_attr->conn_handle.do_listen &&
 		    sock_conn_listen(tx_ctx->ep_attr)) {
@@ -573,7 +573,7 @@ static ssize_t sock_tx_size_left(struct fid_ep *ep)
 		return -FI_EOPBADSTATE;
 
 	ofi_mutex_lock(&tx_ctx->rb_lock);
-	num_left = ofi_rbavail(&tx_ctx->rb)/SOCK_EP_TX_ENTRY_SZ;
+	num_left = sock_tx_ctx_avail(tx_ctx)/SOCK_EP_TX_ENTRY_SZ;
 	ofi_mutex_unlock(&tx_ctx->rb_lock);
 	return num_left;
 }
@@ -664,7 +664,7 @@ static int sock_ep_close(struct fid *fid)
 		ofi_mutex_unlock(&sock_ep->attr->av->list_lock);
 	}
 
-	pthread_mutex_lock(&sock_ep->attr->domain->pe->list_lock);
+	pthread_mutex_lock(&sock_ep->attr->pe->list_lock);
 	if (sock_ep->attr->tx_shared) {
 		ofi_mutex_lock(&sock_ep->attr->tx_ctx->lock);
 		dlist_remove(&sock_ep->attr->tx_ctx_entry);
@@ -676,7 +676,7 @@ static int sock_ep_close(struct fid *fid)
 		dlist_remove(&sock_ep->attr->rx_ctx_entry);
 		ofi_mutex_unlock(&sock_ep->attr->rx_ctx->lock);
 	}
-	pthread_mutex_unlock(&sock_ep->attr->domain->pe->list_lock);
+	pthread_mutex_unlock(&sock_ep->attr->pe->list_lock);
 
 	if (sock_ep->attr->conn_handle.do_listen) {
 		ofi_mutex_lock(&sock_ep->attr->domain->conn_listener.signal_lock);
@@ -725,10 +725,10 @@ static int sock_ep_close(struct fid *fid)
 	if (sock_ep->attr->dest_addr)
 		free(sock_ep->attr->dest_addr);
 
-	ofi_mutex_lock(&sock_ep->attr->domain->pe->lock);
+	ofi_mutex_lock(&sock_ep->attr->pe->lock);
 	ofi_idm_reset(&sock_ep->attr->av_idm, NULL);
 	sock_conn_map_destroy(sock_ep->attr);
-	ofi_mutex_unlock(&sock_ep->attr->domain->pe->lock);
+	ofi_mutex_unlock(&sock_ep->attr->pe->lock);
 
 	ofi_atomic_dec32(&sock_ep->attr->domain->ref);
 	ofi_mutex_destroy(&sock_ep->attr->lock);
@@ -737,6 +737,28 @@ static int sock_ep_close(struct fid *fid)
 	return 0;
 }
 
+/* Responses are matched against the PE table that issued the request, so an
+ * endpoint sharing a context must be driven by the shared context's engine.
+ */
+static void sock_ep_set_pe(struct sock_ep_attr *attr, struct sock_pe *pe)
+{
+	size_t i;
+
+	attr->pe = pe;
+	for (i = 0; i < attr->ep_attr.tx_ctx_cnt; i++) {
+		if (!attr->tx_array[i])
+			continue;
+		attr->tx_array[i]->pe = pe;
+		if (attr->tx_array[i]->rx_ctrl_ctx)
+			attr->tx_array[i]->rx_ctrl_ctx->pe = pe;
+	}
+
+	for (i = 0; i < attr->ep_attr.rx_ctx_cnt; i++) {
+		if (attr->rx_array[i])
+			attr->rx_array[i]->pe = pe;
+	}
+}
+
 static int sock_ep_bind(struct fid *fid, struct fid *bfid, uint64_t flags)
 {
 	int ret;
@@ -884,6 +906,7 @@ static int sock_ep_bind(struct fid *fid, struct fid *bfid, uint64_t flags)
 
 		ep->attr->tx_ctx->use_shared = 1;
 		ep->attr->tx_ctx->stx_ctx = tx_ctx;
+		sock_ep_set_pe(ep->attr, tx_ctx->pe);
 		break;
 
 	case FI_CLASS_SRX_CTX:
@@ -894,6 +917,7 @@ static int sock_ep_bind(struct fid *fid, struct fid *bfid, uint64_t flags)
 
 		ep->attr->rx_ctx->use_shared = 1;
 		ep->attr->rx_ctx->srx_ctx = rx_ctx;
+		sock_ep_set_pe(ep->attr, rx_ctx->pe);
 		break;
 
 	default:
@@ -988,11 +1012,11 @@ int sock_ep_enable(struct fid_ep *ep)
 			tx_ctx->enabled = 1;
 			if (tx_ctx->use_shared) {
 				if (tx_ctx->stx_ctx) {
-					sock_pe_add_tx_ctx(tx_ctx->domain->pe, tx_ctx->stx_ctx);
+					sock_pe_add_tx_ctx(tx_ctx->stx_ctx->pe, tx_ctx->stx_ctx);
 					tx_ctx->stx_ctx->enabled = 1;
 				}
 			} else {
-				sock_pe_add_tx_ctx(tx_ctx->domain->pe, tx_ctx);
+				sock_pe_add_tx_ctx(tx_ctx->pe, tx_ctx);
 			}
 		}
 	}
@@ -1003,11 +1027,11 @@ int sock_ep_enable(struct fid_ep *ep)
 			rx_ctx->enabled = 1;
 			if (rx_ctx->use_shared) {
 				if (rx_ctx->srx_ctx) {
-					sock_pe_add_rx_ctx(rx_ctx->domain->pe, rx_ctx->srx_ctx);
+					sock_pe_add_rx_ctx(rx_ctx->srx_ctx->pe, rx_ctx->srx_ctx);
 					rx_ctx->srx_ctx->enabled = 1;
 				}
 			} else {
-				sock_pe_add_rx_ctx(rx_ctx->domain->pe, rx_ctx);
+				sock_pe_add_rx_ctx(rx_ctx->pe, rx_ctx);
 			}
 		}
 	}
@@ -1140,8 +1164,11 @@ static int sock_ep_tx_ctx(struct fid_ep *ep, int index, struct fi_tx_attr *attr,
 	tx_ctx->tx_id = (uint16_t) index;
 	tx_ctx->ep_attr = sock_ep->attr;
 	tx_ctx->domain = sock_ep->attr->domain;
-	if (tx_ctx->rx_ctrl_ctx && tx_ctx->rx_ctrl_ctx->is_ctrl_ctx)
+	tx_ctx->pe = sock_ep->attr->pe;
+	if (tx_ctx->rx_ctrl_ctx && tx_ctx->rx_ctrl_ctx->is_ctrl_ctx) {
 		tx_ctx->rx_ctrl_ctx->domain = sock_ep->attr->domain;
+		tx_ctx->rx_ctrl_ctx->pe = sock_ep->attr->pe;
+	}
 	tx_ctx->av = sock_ep->attr->av;
 	dlist_insert_tail(&sock_ep->attr->tx_ctx_entry, &tx_ctx->ep_list);
 
@@ -1186,6 +1213,7 @@ static int sock_ep_rx_ctx(struct fid_ep *ep, int index, struct fi_rx_attr *attr,
 	rx_ctx->rx_id = (uint16_t) index;
 	rx_ctx->ep_attr = sock_ep->attr;
 	rx_ctx->domain = sock_ep->attr->domain;
+	rx_ctx->pe = sock_ep->attr->pe;
 	rx_ctx->av = sock_ep->attr->av;
 	dlist_insert_tail(&sock_ep->attr->rx_ctx_entry, &rx_ctx->ep_list);
 
@@ -1249,8 +1277,11 @@ int sock_stx_ctx(struct fid_domain *domain,
 		return -FI_ENOMEM;
 
 	tx_ctx->domain = dom;
-	if (tx_ctx->rx_ctrl_ctx && tx_ctx->rx_ctrl_ctx->is_ctrl_ctx)
+	tx_ctx->pe = sock_dom_select_pe(dom, 1);
+	if (tx_ctx->rx_ctrl_ctx && tx_ctx->rx_ctrl_ctx->is_ctrl_ctx) {
 		tx_ctx->rx_ctrl_ctx->domain = dom;
+		tx_ctx->rx_ctrl_ctx->pe = tx_ctx->pe;
+	}
 
 	tx_ctx->fid.stx.fid.ops = &sock_ctx_ops;
 	tx_ctx->fid.stx.ops = &sock_ep_ops;
@@ -1298,6 +1329,7 @@ int sock_srx_ctx(struct fid_domain *domain,
 		return -FI_ENOMEM;
 
 	rx_ctx->domain = dom;
+	rx_ctx->pe = sock_dom_select_pe(dom, 1);
 	rx_ctx->ctx.fid.fclass = FI_CLASS_SRX_CTX;
 
 	rx_ctx->ctx.fid.ops = &sock_ctx_ops;
@@ -1709,6 +1741,12 @@ int sock_alloc_endpoint(struct fid_domain *domain, struct fi_info *info,
 	if (sock_ep->attr->ep_attr.rx_ctx_cnt == FI_SHARED_CONTEXT)
 		sock_ep->attr->rx_shared = 1;
 
+	/* All contexts of an endpoint, and with them its connections, are
+	 * driven by a single progress engine. */
+	sock_ep->attr->pe = sock_dom_select_pe(sock_dom,
+					       sock_ep->attr->tx_shared ||
+					       sock_ep->attr->rx_shared);
+
 	if (sock_ep->attr->fclass != FI_CLASS_SEP) {
 		sock_ep->attr->ep_attr.tx_ctx_cnt = 1;
 		sock_ep->attr->ep_attr.rx_ctx_cnt = 1;
@@ -1738,8 +1776,11 @@ int sock_alloc_endpoint(struct fid_domain *domain, struct fi_info *info,
 		}
 		tx_ctx->ep_attr = sock_ep->attr;
 		tx_ctx->domain = sock_dom;
-		if (tx_ctx->rx_ctrl_ctx && tx_ctx->rx_ctrl_ctx->is_ctrl_ctx)
+		tx_ctx->pe = sock_ep->attr->pe;
+		if (tx_ctx->rx_ctrl_ctx && tx_ctx->rx_ctrl_ctx->is_ctrl_ctx) {
 			tx_ctx->rx_ctrl_ctx->domain = sock_dom;
+			tx_ctx->rx_ctrl_ctx->pe = sock_ep->attr->pe;
+		}
 		tx_ctx->tx_id = 0;
 		dlist_insert_tail(&sock_ep->attr->tx_ctx_entry, &tx_ctx->ep_list);
 		sock_ep->attr->tx_array[0] = tx_ctx;
@@ -1754,6 +1795,7 @@ int sock_alloc_endpoint(struct fid_domain *domain, struct fi_info *info,
 		}
 		rx_ctx->ep_attr = sock_ep->attr;
 		rx_ctx->domain = sock_dom;
+		rx_ctx->pe = sock_ep->attr->pe;
 		rx_ctx->rx_id = 0;
 		dlist_insert_tail(&sock_ep->attr->rx_ctx_entry, &rx_ctx->ep_list);
 		sock_ep->attr->rx_array[0] = rx_ctx;
@@ -1792,7 +1834,7 @@ void sock_ep_remove_conn(struct sock_ep_attr *attr, struct sock_conn *conn)
 {
 	if (attr->cmap.used <= 0 || conn->sock_fd == -1)
 		return;
-	sock_pe_poll_del(attr->domain->pe, conn->sock_fd);
+	sock_pe_poll_del(attr->pe, conn->sock_fd);
 	sock_conn_release_entry(&attr->cmap, conn);
 }
 
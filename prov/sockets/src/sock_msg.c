@@ -257,7 +257,7 @@ ssize_t sock_ep_sendmsg(struct fid_ep *ep, const struct fi_msg *msg,
 		total_len += sizeof(uint64_t);
 
 	sock_tx_ctx_start(tx_ctx);
-	if (ofi_rbavail(&tx_ctx->rb) < total_len) {
+	if (sock_tx_ctx_avail(tx_ctx) < total_len) {
 		ret = -FI_EAGAIN;
 		goto err;
 	}
@@ -602,7 +602,7 @@ ssize_t sock_ep_tsendmsg(struct fid_ep *ep,
 		total_len += sizeof(uint64_t);
 
 	sock_tx_ctx_start(tx_ctx);
-	if (ofi_rbavail(&tx_ctx->rb) < total_len) {
+	if (sock_tx_ctx_avail(tx_ctx) < total_len) {
 		ret = -FI_EAGAIN;
 		goto err;
 	}
@@ -63,7 +63,7 @@
 #define SOCK_LOG_DBG(...) _SOCK_LOG_DBG(FI_LOG_EP_DATA, __VA_ARGS__)
 #define SOCK_LOG_ERROR(...) _SOCK_LOG_ERROR(FI_LOG_EP_DATA, __VA_ARGS__)
 
-#define PE_INDEX(_pe, _e) (_e - &_pe->pe_table[0])
+#define PE_INDEX(_pe, _e) ofi_buf_index(_e)
 #define SOCK_GET_RX_ID(_addr, _bits) (((_bits) == 0) ? 0 : \
 		(((uint64_t)_addr) >> (64 - _bits)))
 
@@ -165,17 +165,9 @@ static void sock_pe_release_entry(struct sock_pe *pe,
 		ofi_buf_free(pe_entry->pe.rx.atomic_src);
 	}
 
-	if (pe_entry->is_pool_entry) {
-		ofi_rbfree(&pe_entry->comm_buf);
-		dlist_remove(&pe_entry->entry);
-		ofi_buf_free(pe_entry);
-		return;
-	}
-
 	if (pe_entry->type == SOCK_PE_TX)
 		ofi_rbreset(&pe_entry->comm_buf);
 
-	pe->num_free_entries++;
 	pe_entry->conn = NULL;
 
 	memset(&pe_entry->pe.rx, 0, sizeof(pe_entry->pe.rx));
@@ -195,41 +187,33 @@ static void sock_pe_release_entry(struct sock_pe *pe,
 	pe_entry->mr_checked = 0;
 	pe_entry->completion_reported = 0;
 
-	dlist_remove(&pe_entry->entry);
-	dlist_insert_head(&pe_entry->entry, &pe->free_list);
+	ofi_ibuf_free(pe_entry);
 	SOCK_LOG_DBG("progress entry %p released\n", pe_entry);
 }
 
 static struct sock_pe_entry *sock_pe_acquire_entry(struct sock_pe *pe)
 {
-	struct dlist_entry *entry;
 	struct sock_pe_entry *pe_entry;
 
-	if (dlist_empty(&pe->free_list)) {
-		pe_entry = ofi_buf_alloc(pe->pe_rx_pool);
-		SOCK_LOG_DBG("Getting rx pool entry\n");
-		if (pe_entry) {
-			memset(pe_entry, 0, sizeof(*pe_entry));
-			pe_entry->is_pool_entry = 1;
-			if (ofi_rbinit(&pe_entry->comm_buf, SOCK_PE_OVERFLOW_COMM_BUFF_SZ))
-				SOCK_LOG_ERROR("failed to init comm-cache\n");
-			pe_entry->cache_sz = SOCK_PE_OVERFLOW_COMM_BUFF_SZ;
-			dlist_insert_tail(&pe_entry->entry, &pe->pool_list);
-		}
-	} else {
-		pe->num_free_entries--;
-		entry = pe->free_list.next;
-		pe_entry = container_of(entry, struct sock_pe_entry, entry);
-
-		assert(ofi_rbempty(&pe_entry->comm_buf));
-		dlist_remove(&pe_entry->entry);
-		dlist_insert_tail(&pe_entry->entry, &pe->busy_list);
-		SOCK_LOG_DBG("progress entry %p acquired : %lu\n", pe_entry,
-			     PE_INDEX(pe, pe_entry));
+	pe_entry = ofi_ibuf_alloc(pe->entry_pool);
+	if (!pe_entry) {
+		SOCK_LOG_DBG("PE table exhausted\n");
+		return NULL;
 	}
+
+	assert(ofi_rbempty(&pe_entry->comm_buf));
+	SOCK_LOG_DBG("progress entry %p acquired : %zu\n", pe_entry,
+		     PE_INDEX(pe, pe_entry));
 	return pe_entry;
 }
 
+static inline struct sock_pe_entry *
+sock_pe_get_entry(struct sock_pe *pe, uint16_t index)
+{
+	assert(index < pe->entry_pool->entry_cnt);
+	return ofi_bufpool_get_ibuf(pe->entry_pool, index);
+}
+
 static void sock_pe_report_send_cq_completion(struct sock_pe_entry *pe_entry)
 {
 	ssize_t ret = 0;
@@ -579,8 +563,7 @@ static int sock_pe_handle_ack(struct sock_pe *pe,
 		return 0;
 
 	response = &pe_entry->response;
-	assert(response->pe_entry_id <= SOCK_PE_MAX_ENTRIES);
-	waiting_entry = &pe->pe_table[response->pe_entry_id];
+	waiting_entry = sock_pe_get_entry(pe, response->pe_entry_id);
 	SOCK_LOG_DBG("Received ack for PE entry %p (index: %d)\n",
 		      waiting_entry, response->pe_entry_id);
 
@@ -601,8 +584,7 @@ static int sock_pe_handle_error(struct sock_pe *pe,
 		return 0;
 
 	response = &pe_entry->response;
-	assert(response->pe_entry_id <= SOCK_PE_MAX_ENTRIES);
-	waiting_entry = &pe->pe_table[response->pe_entry_id];
+	waiting_entry = sock_pe_get_entry(pe, response->pe_entry_id);
 	SOCK_LOG_ERROR("Received error for PE entry %p (index: %d)\n",
 		      waiting_entry, response->pe_entry_id);
 
@@ -637,12 +619,11 @@ static int sock_pe_handle_read_complete(struct sock_pe *pe,
 		return 0;
 
 	response = &pe_entry->response;
-	assert(response->pe_entry_id <= SOCK_PE_MAX_ENTRIES);
-	waiting_entry = &pe->pe_table[response->pe_entry_id];
+	waiting_entry = sock_pe_get_entry(pe, response->pe_entry_id);
 	SOCK_LOG_DBG("Received read complete for PE entry %p (index: %d)\n",
 		      waiting_entry, response->pe_entry_id);
 
-	waiting_entry = &pe->pe_table[response->pe_entry_id];
+	waiting_entry = sock_pe_get_entry(pe, response->pe_entry_id);
 	assert(waiting_entry->type == SOCK_PE_TX);
 
 	len = sizeof(struct sock_msg_response);
@@ -671,8 +652,7 @@ static int sock_pe_handle_write_complete(struct sock_pe *pe,
 		return 0;
 
 	response = &pe_entry->response;
-	assert(response->pe_entry_id <= SOCK_PE_MAX_ENTRIES);
-	waiting_entry = &pe->pe_table[response->pe_entry_id];
+	waiting_entry = sock_pe_get_entry(pe, response->pe_entry_id);
 	SOCK_LOG_DBG("Received ack for PE entry %p (index: %d)\n",
 		      waiting_entry, response->pe_entry_id);
 
@@ -695,12 +675,11 @@ static int sock_pe_handle_atomic_complete(struct sock_pe *pe,
 		return 0;
 
 	response = &pe_entry->response;
-	assert(response->pe_entry_id <= SOCK_PE_MAX_ENTRIES);
-	waiting_entry = &pe->pe_table[response->pe_entry_id];
+	waiting_entry = sock_pe_get_entry(pe, response->pe_entry_id);
 	SOCK_LOG_DBG("Received atomic complete for PE entry %p (index: %d)\n",
 		      waiting_entry, response->pe_entry_id);
 
-	waiting_entry = &pe->pe_table[response->pe_entry_id];
+	waiting_entry = sock_pe_get_entry(pe, response->pe_entry_id);
 	assert(waiting_entry->type == SOCK_PE_TX);
 
 	len = sizeof(struct sock_msg_response);
@@ -2116,6 +2095,8 @@ static int sock_pe_new_tx_entry(struct sock_pe *pe, struct sock_tx_ctx *tx_ctx)
 	struct sock_ep_attr *ep_attr;
 
 	pe_entry = sock_pe_acquire_entry(pe);
+	if (!pe_entry)
+		return 0;
 	memset(&pe_entry->pe.tx, 0, sizeof(pe_entry->pe.tx));
 	memset(&pe_entry->msg_hdr, 0, sizeof(pe_entry->msg_hdr));
 
@@ -2258,6 +2239,7 @@ static int sock_pe_new_tx_entry(struct sock_pe *pe, struct sock_tx_ctx *tx_ctx)
 		SOCK_LOG_ERROR("Invalid operation type\n");
 		return -FI_EINVAL;
 	}
+	sock_tx_ctx_consume(tx_ctx);
 	SOCK_LOG_DBG("Inserting TX-entry to PE entry %p, conn: %p\n",
 		      pe_entry, pe_entry->conn);
 
@@ -2281,11 +2263,9 @@ static int sock_pe_new_tx_entry(struct sock_pe *pe, struct sock_tx_ctx *tx_ctx)
 	return sock_pe_progress_tx_entry(pe, tx_ctx, pe_entry);
 }
 
-void sock_pe_signal(struct sock_pe *pe)
+static void sock_pe_signal_fd(struct sock_pe *pe)
 {
 	char c = 0;
-	if (pe->domain->progress_mode != FI_PROGRESS_AUTO)
-		return;
 
 	ofi_mutex_lock(&pe->signal_lock);
 	if (pe->wcnt == pe->rcnt) {
@@ -2297,6 +2277,19 @@ void sock_pe_signal(struct sock_pe *pe)
 	ofi_mutex_unlock(&pe->signal_lock);
 }
 
+/* The progress thread publishes 'sleeping' before its final check for
+ * work, so a thread that is running or spinning picks up new work on its
+ * own and the fd only needs to be written when it may be blocked.
+ */
+void sock_pe_signal(struct sock_pe *pe)
+{
+	if (pe->domain->progress_mode != FI_PROGRESS_AUTO)
+		return;
+
+	if (ofi_atomic_get32(&pe->sleeping))
+		sock_pe_signal_fd(pe);
+}
+
 void sock_pe_poll_add(struct sock_pe *pe, int fd)
 {
         ofi_mutex_lock(&pe->signal_lock);
@@ -2352,16 +2345,16 @@ out:
 
 void sock_pe_remove_tx_ctx(struct sock_tx_ctx *tx_ctx)
 {
-	pthread_mutex_lock(&tx_ctx->domain->pe->list_lock);
+	pthread_mutex_lock(&tx_ctx->pe->list_lock);
 	dlist_remove(&tx_ctx->pe_entry);
-	pthread_mutex_unlock(&tx_ctx->domain->pe->list_lock);
+	pthread_mutex_unlock(&tx_ctx->pe->list_lock);
 }
 
 void sock_pe_remove_rx_ctx(struct sock_rx_ctx *rx_ctx)
 {
-	pthread_mutex_lock(&rx_ctx->domain->pe->list_lock);
+	pthread_mutex_lock(&rx_ctx->pe->list_lock);
 	dlist_remove(&rx_ctx->pe_entry);
-	pthread_mutex_unlock(&rx_ctx->domain->pe->list_lock);
+	pthread_mutex_unlock(&rx_ctx->pe->list_lock);
 }
 
 static int sock_pe_progress_rx_ep(struct sock_pe *pe,
@@ -2539,13 +2532,11 @@ int sock_pe_progress_tx_ctx(struct sock_pe *pe, struct sock_tx_ctx *tx_ctx)
 		}
 	}
 
-	ofi_mutex_lock(&tx_ctx->rb_lock);
-	if (!ofi_rbempty(&tx_ctx->rb) && !dlist_empty(&pe->free_list)) {
+	if (!sock_tx_ctx_empty(tx_ctx)) {
 		ret = sock_pe_new_tx_entry(pe, tx_ctx);
+		if (ret < 0)
+			goto out;
 	}
-	ofi_mutex_unlock(&tx_ctx->rb_lock);
-	if (ret < 0)
-		goto out;
 
 	sock_pe_progress_rx_ctrl_ctx(pe, tx_ctx->rx_ctrl_ctx, tx_ctx);
 out:
@@ -2572,7 +2563,7 @@ static int sock_pe_wait_ok(struct sock_pe *pe)
 		     entry != &pe->tx_list; entry = entry->next) {
 			tx_ctx = container_of(entry, struct sock_tx_ctx,
 						pe_entry);
-			if (!ofi_rbempty(&tx_ctx->rb) ||
+			if (!sock_tx_ctx_empty(tx_ctx) ||
 			    !dlist_empty(&tx_ctx->pe_entry_list)) {
 				return 0;
 			}
@@ -2642,9 +2633,13 @@ static void *sock_pe_progress_thread(void *data)
 		pthread_mutex_lock(&pe->list_lock);
 		if (pe->domain->progress_mode == FI_PROGRESS_AUTO &&
 		    sock_pe_wait_ok(pe)) {
-			pthread_mutex_unlock(&pe->list_lock);
-			sock_pe_wait(pe);
-			pthread_mutex_lock(&pe->list_lock);
+			ofi_atomic_set32(&pe->sleeping, 1);
+			if (sock_pe_wait_ok(pe) && pe->do_progress) {
+				pthread_mutex_unlock(&pe->list_lock);
+				sock_pe_wait(pe);
+				pthread_mutex_lock(&pe->list_lock);
+			}
+			ofi_atomic_set32(&pe->sleeping, 0);
 		}
 
 		if (!dlist_empty(&pe->tx_list)) {
@@ -2681,26 +2676,55 @@ static void *sock_pe_progress_thread(void *data)
 	return NULL;
 }
 
-static void sock_pe_init_table(struct sock_pe *pe)
+static void sock_pe_entry_init(struct ofi_bufpool_region *region, void *buf)
 {
-	int i;
+	struct sock_pe_entry *pe_entry = buf;
 
-	memset(&pe->pe_table, 0,
-	       sizeof(struct sock_pe_entry) * SOCK_PE_MAX_ENTRIES);
+	pe_entry->cache_sz = SOCK_PE_COMM_BUFF_SZ;
+	if (ofi_rbinit(&pe_entry->comm_buf, SOCK_PE_COMM_BUFF_SZ))
+		SOCK_LOG_ERROR("failed to init comm-cache\n");
+}
+
+static void sock_pe_entry_region_free(struct ofi_bufpool_region *region)
+{
+	struct sock_pe_entry *pe_entry;
+	size_t i;
+
+	for (i = 0; i < region->pool->attr.chunk_cnt; i++) {
+		pe_entry = (struct sock_pe_entry *) (region->mem_region +
+					i * region->pool->entry_size);
+		ofi_rbfree(&pe_entry->comm_buf);
+	}
+}
 
-	dlist_init(&pe->free_list);
-	dlist_init(&pe->busy_list);
-	dlist_init(&pe->pool_list);
+/* The PE table starts at one chunk and grows on demand.  Entries are
+ * indexed so that a response can locate its request by pe_entry_id.
+ */
+static int sock_pe_init_table(struct sock_pe *pe)
+{
+	struct ofi_bufpool_attr attr = {
+		.size		= sizeof(struct sock_pe_entry),
+		.alignment	= 16,
+		.max_cnt	= SOCK_PE_MAX_ENTRIES,
+		.chunk_cnt	= SOCK_PE_ENTRY_CHUNK_CNT,
+		.init_fn	= sock_pe_entry_init,
+		.free_fn	= sock_pe_entry_region_free,
+		.flags		= OFI_BUFPOOL_INDEXED | OFI_BUFPOOL_NO_TRACK,
+	};
+	int ret;
+
+	ret = ofi_bufpool_create_attr(&attr, &pe->entry_pool);
+	if (ret)
+		return ret;
 
-	for (i = 0; i < SOCK_PE_MAX_ENTRIES; i++) {
-		dlist_insert_head(&pe->pe_table[i].entry, &pe->free_list);
-		pe->pe_table[i].cache_sz = SOCK_PE_COMM_BUFF_SZ;
-		if (ofi_rbinit(&pe->pe_table[i].comm_buf, SOCK_PE_COMM_BUFF_SZ))
-			SOCK_LOG_ERROR("failed to init comm-cache\n");
+	ret = ofi_bufpool_grow(pe->entry_pool);
+	if (ret) {
+		ofi_bufpool_destroy(pe->entry_pool);
+		return ret;
 	}
 
-	pe->num_free_entries = SOCK_PE_MAX_ENTRIES;
 	SOCK_LOG_DBG("PE table init: OK\n");
+	return 0;
 }
 
 struct sock_pe *sock_pe_init(struct sock_domain *domain)
@@ -2712,19 +2736,17 @@ struct sock_pe *sock_pe_init(struct sock_domain *domain)
 	if (!pe)
 		return NULL;
 
-	sock_pe_init_table(pe);
 	dlist_init(&pe->tx_list);
 	dlist_init(&pe->rx_list);
 	ofi_mutex_init(&pe->lock);
 	ofi_mutex_init(&pe->signal_lock);
 	pthread_mutex_init(&pe->list_lock, NULL);
+	ofi_atomic_initialize32(&pe->sleeping, 0);
 	pe->domain = domain;
 
-
-	ret = ofi_bufpool_create(&pe->pe_rx_pool,
-				 sizeof(struct sock_pe_entry), 16, 0, 1024, 0);
+	ret = sock_pe_init_table(pe);
 	if (ret) {
-		SOCK_LOG_ERROR("failed to create buffer pool\n");
+		SOCK_LOG_ERROR("failed to create PE table\n");
 		goto err1;
 	}
 
@@ -2768,46 +2790,25 @@ err4:
 err3:
 	ofi_bufpool_destroy(pe->atomic_rx_pool);
 err2:
-	ofi_bufpool_destroy(pe->pe_rx_pool);
+	ofi_bufpool_destroy(pe->entry_pool);
 err1:
 	ofi_mutex_destroy(&pe->lock);
 	free(pe);
 	return NULL;
 }
 
-static void sock_pe_free_util_pool(struct sock_pe *pe)
-{
-	struct dlist_entry *entry;
-	struct sock_pe_entry *pe_entry;
-
-	while (!dlist_empty(&pe->pool_list)) {
-		entry = pe->pool_list.next;
-		pe_entry = container_of(entry, struct sock_pe_entry, entry);
-		ofi_rbfree(&pe_entry->comm_buf);
-		dlist_remove(&pe_entry->entry);
-		ofi_buf_free(pe_entry);
-	}
-
-	ofi_bufpool_destroy(pe->pe_rx_pool);
-	ofi_bufpool_destroy(pe->atomic_rx_pool);
-}
-
 void sock_pe_finalize(struct sock_pe *pe)
 {
-	int i;
 	if (pe->domain->progress_mode == FI_PROGRESS_AUTO) {
 		pe->do_progress = 0;
-		sock_pe_signal(pe);
+		sock_pe_signal_fd(pe);
 		pthread_join(pe->progress_thread, NULL);
 		ofi_close_socket(pe->signal_fds[0]);
 		ofi_close_socket(pe->signal_fds[1]);
 	}
 
-	for (i = 0; i < SOCK_PE_MAX_ENTRIES; i++) {
-		ofi_rbfree(&pe->pe_table[i].comm_buf);
-	}
-
-	sock_pe_free_util_pool(pe);
+	ofi_bufpool_destroy(pe->entry_pool);
+	ofi_bufpool_destroy(pe->atomic_rx_pool);
 	ofi_mutex_destroy(&pe->lock);
 	ofi_mutex_destroy(&pe->signal_lock);
 	pthread_mutex_destroy(&pe->list_lock);
@@ -33,7 +33,7 @@
 #include "tcpx.h"
 
 
-#define TCPX_DOMAIN_CAPS (FI_LOCAL_COMM | FI_REMOTE_COMM)
+#define TCPX_DOMAIN_CAPS (FI_LOCAL_COMM | FI_REMOTE_COMM | FI_SHARED_AV)
 #define TCPX_EP_CAPS	 (FI_MSG | FI_RMA | FI_RMA_PMEM)
 #define TCPX_EP_SRX_CAPS (TCPX_EP_CAPS | FI_TAGGED)
 #define TCPX_TX_CAPS	 (FI_SEND | FI_WRITE | FI_READ)
@@ -15,5 +15,27 @@ AC_DEFUN([FI_UDP_CONFIGURE],[
 	                       [udp_h_happy=0])
 	      ])
 
+	# AF_XDP receive path, needs BPF links (Linux 5.9)
+	udp_xdp_happy=0
+	AS_IF([test $udp_h_happy -eq 1 && test x"$linux" = x"1"],
+	      [AC_MSG_CHECKING([for AF_XDP support])
+	       AC_COMPILE_IFELSE(
+		   [AC_LANG_PROGRAM([[#include <sys/socket.h>
+				      #include <linux/bpf.h>
+				      #include <linux/if_link.h>
+				      #include <linux/if_xdp.h>]],
+				    [[union bpf_attr attr;
+				      struct xdp_mmap_offsets off;
+				      attr.link_create.target_ifindex = 0;
+				      attr.link_create.attach_type = BPF_XDP;
+				      (void) off;
+				      return AF_XDP + XDP_FLAGS_SKB_MODE;]])],
+		   [udp_xdp_happy=1
+		    AC_MSG_RESULT([yes])],
+		   [AC_MSG_RESULT([no])])
+	      ])
+	AC_DEFINE_UNQUOTED([HAVE_UDP_XDP], [$udp_xdp_happy],
+			   [Define to 1 if the udp provider can use AF_XDP])
+
 	AS_IF([test $udp_h_happy -eq 1], [$1], [$2])
 ])
@@ -68,6 +68,13 @@ extern struct fi_provider udpx_prov;
 extern struct util_prov udpx_util_prov;
 extern struct fi_info udpx_info;
 
+struct udpx_env {
+	int	xdp;
+	int	xdp_queue;
+};
+
+extern struct udpx_env udpx_env;
+
 
 int udpx_fabric(struct fi_fabric_attr *attr, struct fid_fabric **fabric,
 		void *context);
@@ -91,6 +98,7 @@ struct udpx_ep_entry {
 OFI_DECLARE_CIRQUE(struct udpx_ep_entry, udpx_rx_cirq);
 
 struct udpx_ep;
+struct udpx_xdp;
 typedef void (*udpx_rx_comp_func)(struct udpx_ep *ep, void *context,
 		uint64_t flags, size_t len, void *buf, void *addr);
 typedef void (*udpx_tx_comp_func)(struct udpx_ep *ep, void *context);
@@ -103,10 +111,32 @@ struct udpx_ep {
 	SOCKET			sock;
 	int			is_bound;
 	ofi_atomic32_t		ref;
+	struct udpx_xdp		*xdp;	/* protected by rx_cq lock */
 };
 
 int udpx_endpoint(struct fid_domain *domain, struct fi_info *info,
 		  struct fid_ep **ep, void *context);
+void udpx_rx_trunc(struct udpx_ep *ep, void *context, size_t len,
+		   size_t olen);
+
+#if HAVE_UDP_XDP
+int udpx_xdp_open(struct udpx_ep *ep);
+void udpx_xdp_close(struct udpx_ep *ep);
+void udpx_xdp_progress(struct udpx_ep *ep);
+#else
+static inline int udpx_xdp_open(struct udpx_ep *ep)
+{
+	return -FI_ENOSYS;
+}
+
+static inline void udpx_xdp_close(struct udpx_ep *ep)
+{
+}
+
+static inline void udpx_xdp_progress(struct udpx_ep *ep)
+{
+}
+#endif
 
 
 int udpx_cq_open(struct fid_domain *domain, struct fi_cq_attr *attr,
@@ -34,6 +34,7 @@
 #include <string.h>
 
 #include "udpx.h"
+#include <ofi_iov.h>
 
 
 static int udpx_setname(fid_t fid, void *addr, size_t addrlen)
@@ -270,12 +271,31 @@ static void udpx_rx_src_comp_signal(struct udpx_ep *ep, void *context,
 	ep->util_ep.rx_cq->wait->signal(ep->util_ep.rx_cq->wait);
 }
 
+/* Called with the rx CQ lock held */
+void udpx_rx_trunc(struct udpx_ep *ep, void *context, size_t len,
+		   size_t olen)
+{
+	struct fi_cq_err_entry err_entry = {
+		.op_context	= context,
+		.flags		= FI_RECV,
+		.len		= len,
+		.olen		= olen,
+		.err		= FI_ETRUNC,
+		.prov_errno	= -FI_ETRUNC,
+	};
+
+	(void) ofi_cq_insert_error(ep->util_ep.rx_cq, &err_entry);
+	if (ep->util_ep.rx_cq->wait)
+		ep->util_ep.rx_cq->wait->signal(ep->util_ep.rx_cq->wait);
+}
+
 static void udpx_ep_progress(struct util_ep *util_ep)
 {
 	struct udpx_ep *ep;
 	struct udpx_ep_entry *entry;
 	struct msghdr hdr;
 	struct sockaddr_in6 addr;
+	size_t len;
 	ssize_t ret;
 
 	ep = container_of(util_ep, struct udpx_ep, util_ep);
@@ -286,6 +306,9 @@ static void udpx_ep_progress(struct util_ep *util_ep)
 	hdr.msg_flags = 0;
 
 	ofi_genlock_lock(&ep->util_ep.rx_cq->cq_lock);
+	if (ep->xdp)
+		udpx_xdp_progress(ep);
+
 	if (ofi_cirque_isempty(ep->rxq))
 		goto out;
 
@@ -293,9 +316,16 @@ static void udpx_ep_progress(struct util_ep *util_ep)
 	hdr.msg_iov = entry->iov;
 	hdr.msg_iovlen = entry->iov_count;
 
-	ret = ofi_recvmsg_udp(ep->sock, &hdr, 0);
+	/* Where supported, MSG_TRUNC returns the full datagram length */
+	ret = ofi_recvmsg_udp(ep->sock, &hdr, MSG_TRUNC);
 	if (ret >= 0) {
-		ep->rx_comp(ep, entry->context, 0, ret, NULL, &addr);
+		if (hdr.msg_flags & MSG_TRUNC) {
+			len = MIN((size_t) ret, ofi_total_iov_len(entry->iov,
+							entry->iov_count));
+			udpx_rx_trunc(ep, entry->context, len, ret - len);
+		} else {
+			ep->rx_comp(ep, entry->context, 0, ret, NULL, &addr);
+		}
 		ofi_cirque_discard(ep->rxq);
 	}
 out:
@@ -568,6 +598,7 @@ static int udpx_ep_close(struct fid *fid)
 				&ep->util_ep.ep_fid.fid);
 	}
 
+	udpx_xdp_close(ep);
 	udpx_rx_cirq_free(ep->rxq);
 	ofi_close_socket(ep->sock);
 	ofi_endpoint_close(&ep->util_ep);
@@ -694,6 +725,7 @@ static void udpx_bind_src_addr(struct udpx_ep *ep)
 static int udpx_ep_ctrl(struct fid *fid, int command, void *arg)
 {
 	struct udpx_ep *ep;
+	int ret;
 
 	ep = container_of(fid, struct udpx_ep, util_ep.ep_fid.fid);
 	switch (command) {
@@ -706,6 +738,15 @@ static int udpx_ep_ctrl(struct fid *fid, int command, void *arg)
 
 		if (!ep->is_bound)
 			udpx_bind_src_addr(ep);
+
+		if (udpx_env.xdp && ep->is_bound &&
+		    ofi_recv_allowed(ep->util_ep.caps)) {
+			ret = udpx_xdp_open(ep);
+			if (ret)
+				FI_WARN(&udpx_prov, FI_LOG_EP_CTRL,
+					"AF_XDP unavailable (%d), receiving "
+					"through the socket\n", ret);
+		}
 		break;
 	default:
 		return -FI_ENOSYS;
@@ -38,6 +38,11 @@
 #include <sys/types.h>
 
 
+struct udpx_env udpx_env = {
+	.xdp = 0,
+	.xdp_queue = 0,
+};
+
 static int udpx_getinfo(uint32_t version, const char *node, const char *service,
 			uint64_t flags, const struct fi_info *hints,
 			struct fi_info **info)
@@ -64,6 +69,14 @@ UDP_INI
 {
 	fi_param_define(&udpx_prov, "iface", FI_PARAM_STRING,
 			"Specify interface name");
+	fi_param_define(&udpx_prov, "xdp", FI_PARAM_BOOL,
+			"Receive through an AF_XDP socket when supported "
+			"(default: false)");
+	fi_param_define(&udpx_prov, "xdp_queue", FI_PARAM_INT,
+			"NIC receive queue of the AF_XDP socket (default: 0)");
+
+	fi_param_get_bool(&udpx_prov, "xdp", &udpx_env.xdp);
+	fi_param_get_int(&udpx_prov, "xdp_queue", &udpx_env.xdp_queue);
 
 	return &udpx_prov;
 }
@@ -0,0 +1,583 @@
+/*
+ * Copyright (c) 2026 libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "udpx.h"
+
+#if HAVE_UDP_XDP
+
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <netinet/udp.h>
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+
+#include <ofi_iov.h>
+
+#define UDPX_XDP_FRAME_SIZE	4096
+#define UDPX_XDP_RING_SIZE	2048
+#define UDPX_XDP_COMP_SIZE	64
+#define UDPX_XDP_BATCH		64
+#define UDPX_XDP_MAX_INSNS	32
+
+struct udpx_xdp_ring {
+	void		*map;
+	size_t		map_len;
+	uint32_t	*producer;
+	uint32_t	*consumer;
+	void		*desc;
+	uint32_t	mask;
+};
+
+struct udpx_xdp {
+	int			fd;
+	int			map_fd;
+	int			prog_fd;
+	int			link_fd;
+	void			*umem;
+	size_t			umem_len;
+	struct udpx_xdp_ring	fill;
+	struct udpx_xdp_ring	comp;
+	struct udpx_xdp_ring	rx;
+};
+
+static int udpx_bpf(int cmd, union bpf_attr *attr)
+{
+	int ret;
+
+	ret = (int) syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+	return ret < 0 ? -errno : ret;
+}
+
+#define UDPX_BPF_INSN(c, d, s, o, i)				\
+	((struct bpf_insn) {					\
+		.code = (c), .dst_reg = (d), .src_reg = (s),	\
+		.off = (o), .imm = (i) })
+#define UDPX_BPF_MOV_REG(d, s)	UDPX_BPF_INSN(BPF_ALU64 | BPF_MOV | BPF_X, d, s, 0, 0)
+#define UDPX_BPF_MOV_IMM(d, i)	UDPX_BPF_INSN(BPF_ALU64 | BPF_MOV | BPF_K, d, 0, 0, i)
+#define UDPX_BPF_ADD_IMM(d, i)	UDPX_BPF_INSN(BPF_ALU64 | BPF_ADD | BPF_K, d, 0, 0, i)
+#define UDPX_BPF_AND_IMM(d, i)	UDPX_BPF_INSN(BPF_ALU64 | BPF_AND | BPF_K, d, 0, 0, i)
+#define UDPX_BPF_LDX(sz, d, s, o) UDPX_BPF_INSN(BPF_LDX | BPF_MEM | sz, d, s, o, 0)
+#define UDPX_BPF_JGT_REG(d, s)	UDPX_BPF_INSN(BPF_JMP | BPF_JGT | BPF_X, d, s, 0, 0)
+#define UDPX_BPF_JNE_IMM(d, i)	UDPX_BPF_INSN(BPF_JMP | BPF_JNE | BPF_K, d, 0, 0, i)
+#define UDPX_BPF_JNE32_IMM(d, i) UDPX_BPF_INSN(BPF_JMP32 | BPF_JNE | BPF_K, d, 0, 0, i)
+#define UDPX_BPF_CALL(f)	UDPX_BPF_INSN(BPF_JMP | BPF_CALL, 0, 0, 0, f)
+#define UDPX_BPF_EXIT()		UDPX_BPF_INSN(BPF_JMP | BPF_EXIT, 0, 0, 0, 0)
+
+/* Offsets into an untagged Ethernet frame carrying IPv4 without options */
+#define UDPX_XDP_ETH_TYPE	12
+#define UDPX_XDP_IP_VHL		14
+#define UDPX_XDP_IP_FRAG	20
+#define UDPX_XDP_IP_PROTO	23
+#define UDPX_XDP_IP_DADDR	30
+#define UDPX_XDP_UDP_DPORT	36
+#define UDPX_XDP_HDR_LEN	42
+
+/* The program redirects UDP datagrams sent to the endpoint address to the
+ * socket bound to the receive queue, and passes everything else to the
+ * kernel: other traffic, IP fragments and headers with options.  If no
+ * socket is bound to the queue a datagram is passed as well, and reaches
+ * the endpoint through its regular socket.
+ */
+static int udpx_xdp_load_prog(struct udpx_xdp *xdp,
+			      const struct sockaddr_in *sin)
+{
+	struct bpf_insn insns[UDPX_XDP_MAX_INSNS];
+	int pass_jmp[UDPX_XDP_MAX_INSNS];
+	union bpf_attr attr;
+	int n = 0, njmp = 0, i;
+
+	insns[n++] = UDPX_BPF_MOV_REG(BPF_REG_6, BPF_REG_1);
+	insns[n++] = UDPX_BPF_LDX(BPF_W, BPF_REG_2, BPF_REG_1,
+				  offsetof(struct xdp_md, data));
+	insns[n++] = UDPX_BPF_LDX(BPF_W, BPF_REG_3, BPF_REG_1,
+				  offsetof(struct xdp_md, data_end));
+	insns[n++] = UDPX_BPF_MOV_REG(BPF_REG_4, BPF_REG_2);
+	insns[n++] = UDPX_BPF_ADD_IMM(BPF_REG_4, UDPX_XDP_HDR_LEN);
+	pass_jmp[njmp++] = n;
+	insns[n++] = UDPX_BPF_JGT_REG(BPF_REG_4, BPF_REG_3);
+
+	insns[n++] = UDPX_BPF_LDX(BPF_H, BPF_REG_5, BPF_REG_2,
+				  UDPX_XDP_ETH_TYPE);
+	pass_jmp[njmp++] = n;
+	insns[n++] = UDPX_BPF_JNE_IMM(BPF_REG_5, htons(ETH_P_IP));
+	insns[n++] = UDPX_BPF_LDX(BPF_B, BPF_REG_5, BPF_REG_2,
+				  UDPX_XDP_IP_VHL);
+	pass_jmp[njmp++] = n;
+	insns[n++] = UDPX_BPF_JNE_IMM(BPF_REG_5, 0x45);
+	insns[n++] = UDPX_BPF_LDX(BPF_B, BPF_REG_5, BPF_REG_2,
+				  UDPX_XDP_IP_PROTO);
+	pass_jmp[njmp++] = n;
+	insns[n++] = UDPX_BPF_JNE_IMM(BPF_REG_5, IPPROTO_UDP);
+	insns[n++] = UDPX_BPF_LDX(BPF_H, BPF_REG_5, BPF_REG_2,
+				  UDPX_XDP_IP_FRAG);
+	insns[n++] = UDPX_BPF_AND_IMM(BPF_REG_5, htons(IP_MF | IP_OFFMASK));
+	pass_jmp[njmp++] = n;
+	insns[n++] = UDPX_BPF_JNE_IMM(BPF_REG_5, 0);
+	insns[n++] = UDPX_BPF_LDX(BPF_H, BPF_REG_5, BPF_REG_2,
+				  UDPX_XDP_UDP_DPORT);
+	pass_jmp[njmp++] = n;
+	insns[n++] = UDPX_BPF_JNE_IMM(BPF_REG_5, sin->sin_port);
+	if (sin->sin_addr.s_addr != htonl(INADDR_ANY)) {
+		insns[n++] = UDPX_BPF_LDX(BPF_W, BPF_REG_5, BPF_REG_2,
+					  UDPX_XDP_IP_DADDR);
+		pass_jmp[njmp++] = n;
+		insns[n++] = UDPX_BPF_JNE32_IMM(BPF_REG_5,
+						sin->sin_addr.s_addr);
+	}
+
+	/* bpf_redirect_map(map, ctx->rx_queue_index, XDP_PASS) */
+	insns[n++] = UDPX_BPF_INSN(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1,
+				   BPF_PSEUDO_MAP_FD, 0, xdp->map_fd);
+	insns[n++] = UDPX_BPF_INSN(0, 0, 0, 0, 0);
+	insns[n++] = UDPX_BPF_LDX(BPF_W, BPF_REG_2, BPF_REG_6,
+				  offsetof(struct xdp_md, rx_queue_index));
+	insns[n++] = UDPX_BPF_MOV_IMM(BPF_REG_3, XDP_PASS);
+	insns[n++] = UDPX_BPF_CALL(BPF_FUNC_redirect_map);
+	insns[n++] = UDPX_BPF_EXIT();
+
+	for (i = 0; i < njmp; i++)
+		insns[pass_jmp[i]].off = n - pass_jmp[i] - 1;
+	insns[n++] = UDPX_BPF_MOV_IMM(BPF_REG_0, XDP_PASS);
+	insns[n++] = UDPX_BPF_EXIT();
+	assert(n <= UDPX_XDP_MAX_INSNS);
+
+	memset(&attr, 0, sizeof(attr));
+	attr.prog_type = BPF_PROG_TYPE_XDP;
+	attr.insns = (uintptr_t) insns;
+	attr.insn_cnt = n;
+	attr.license = (uintptr_t) "Dual BSD/GPL";
+	xdp->prog_fd = udpx_bpf(BPF_PROG_LOAD, &attr);
+	return xdp->prog_fd < 0 ? xdp->prog_fd : 0;
+}
+
+static int udpx_xdp_map_ring(struct udpx_xdp *xdp, struct udpx_xdp_ring *ring,
+			     const struct xdp_ring_offset *off, uint32_t size,
+			     size_t desc_size, off_t pgoff)
+{
+	ring->map_len = off->desc + size * desc_size;
+	ring->map = mmap(NULL, ring->map_len, PROT_READ | PROT_WRITE,
+			 MAP_SHARED | MAP_POPULATE, xdp->fd, pgoff);
+	if (ring->map == MAP_FAILED) {
+		ring->map = NULL;
+		return -errno;
+	}
+
+	ring->producer = (uint32_t *) ((char *) ring->map + off->producer);
+	ring->consumer = (uint32_t *) ((char *) ring->map + off->consumer);
+	ring->desc = (char *) ring->map + off->desc;
+	ring->mask = size - 1;
+	return 0;
+}
+
+static void udpx_xdp_unmap_ring(struct udpx_xdp_ring *ring)
+{
+	if (ring->map)
+		munmap(ring->map, ring->map_len);
+}
+
+static int udpx_xdp_setopt(int fd, int optname, const void *val,
+			   socklen_t len)
+{
+	return setsockopt(fd, SOL_XDP, optname, val, len) ? -errno : 0;
+}
+
+/* Create the AF_XDP socket and its UMEM.  Every frame is handed to the
+ * kernel through the fill ring up front, and returned to it as soon as
+ * the datagram it holds has been copied to a posted receive.
+ */
+static int udpx_xdp_open_sock(struct udpx_xdp *xdp, int ifindex,
+			      uint32_t queue)
+{
+	struct xdp_umem_reg reg = {0};
+	struct xdp_mmap_offsets off;
+	struct sockaddr_xdp sxdp = {0};
+	socklen_t optlen = sizeof(off);
+	uint32_t size, i;
+	uint64_t *fill;
+	int ret;
+
+	xdp->fd = socket(AF_XDP, SOCK_RAW, 0);
+	if (xdp->fd < 0)
+		return -errno;
+
+	xdp->umem_len = (size_t) UDPX_XDP_RING_SIZE * UDPX_XDP_FRAME_SIZE;
+	xdp->umem = mmap(NULL, xdp->umem_len, PROT_READ | PROT_WRITE,
+			 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (xdp->umem == MAP_FAILED) {
+		xdp->umem = NULL;
+		return -errno;
+	}
+
+	reg.addr = (uintptr_t) xdp->umem;
+	reg.len = xdp->umem_len;
+	reg.chunk_size = UDPX_XDP_FRAME_SIZE;
+	ret = udpx_xdp_setopt(xdp->fd, XDP_UMEM_REG, &reg, sizeof(reg));
+	if (ret)
+		return ret;
+
+	size = UDPX_XDP_RING_SIZE;
+	ret = udpx_xdp_setopt(xdp->fd, XDP_UMEM_FILL_RING, &size, sizeof(size));
+	if (ret)
+		return ret;
+	ret = udpx_xdp_setopt(xdp->fd, XDP_RX_RING, &size, sizeof(size));
+	if (ret)
+		return ret;
+	size = UDPX_XDP_COMP_SIZE;
+	ret = udpx_xdp_setopt(xdp->fd, XDP_UMEM_COMPLETION_RING, &size,
+			      sizeof(size));
+	if (ret)
+		return ret;
+
+	if (getsockopt(xdp->fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen))
+		return -errno;
+
+	ret = udpx_xdp_map_ring(xdp, &xdp->fill, &off.fr, UDPX_XDP_RING_SIZE,
+				sizeof(uint64_t), XDP_UMEM_PGOFF_FILL_RING);
+	if (ret)
+		return ret;
+	ret = udpx_xdp_map_ring(xdp, &xdp->comp, &off.cr, UDPX_XDP_COMP_SIZE,
+				sizeof(uint64_t),
+				XDP_UMEM_PGOFF_COMPLETION_RING);
+	if (ret)
+		return ret;
+	ret = udpx_xdp_map_ring(xdp, &xdp->rx, &off.rx, UDPX_XDP_RING_SIZE,
+				sizeof(struct xdp_desc), XDP_PGOFF_RX_RING);
+	if (ret)
+		return ret;
+
+	fill = xdp->fill.desc;
+	for (i = 0; i < UDPX_XDP_RING_SIZE; i++)
+		fill[i] = (uint64_t) i * UDPX_XDP_FRAME_SIZE;
+	__atomic_store_n(xdp->fill.producer, UDPX_XDP_RING_SIZE,
+			 __ATOMIC_RELEASE);
+
+	sxdp.sxdp_family = AF_XDP;
+	sxdp.sxdp_ifindex = ifindex;
+	sxdp.sxdp_queue_id = queue;
+	if (bind(xdp->fd, (struct sockaddr *) &sxdp, sizeof(sxdp)))
+		return -errno;
+
+	return 0;
+}
+
+static int udpx_xdp_attach(struct udpx_xdp *xdp, int ifindex)
+{
+	union bpf_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.link_create.prog_fd = xdp->prog_fd;
+	attr.link_create.target_ifindex = ifindex;
+	attr.link_create.attach_type = BPF_XDP;
+	attr.link_create.flags = XDP_FLAGS_DRV_MODE;
+	xdp->link_fd = udpx_bpf(BPF_LINK_CREATE, &attr);
+	if (xdp->link_fd >= 0)
+		return 0;
+
+	FI_INFO(&udpx_prov, FI_LOG_EP_CTRL,
+		"native XDP unavailable (%d), using generic mode\n",
+		xdp->link_fd);
+	attr.link_create.flags = XDP_FLAGS_SKB_MODE;
+	xdp->link_fd = udpx_bpf(BPF_LINK_CREATE, &attr);
+	return xdp->link_fd < 0 ? xdp->link_fd : 0;
+}
+
+/* The interface holding the bound address, or FI_UDP_IFACE for endpoints
+ * bound to any address.
+ */
+static int udpx_xdp_ifindex(const struct sockaddr_in *sin)
+{
+	struct ifaddrs *ifaddrs, *ifa;
+	char *iface = NULL;
+	int ifindex = 0;
+
+	if (sin->sin_addr.s_addr == htonl(INADDR_ANY)) {
+		fi_param_get_str(&udpx_prov, "iface", &iface);
+		return iface ? (int) if_nametoindex(iface) : 0;
+	}
+
+	if (getifaddrs(&ifaddrs))
+		return 0;
+
+	for (ifa = ifaddrs; ifa; ifa = ifa->ifa_next) {
+		if (ifa->ifa_addr && ifa->ifa_addr->sa_family == AF_INET &&
+		    ((struct sockaddr_in *) ifa->ifa_addr)->sin_addr.s_addr ==
+		    sin->sin_addr.s_addr) {
+			ifindex = (int) if_nametoindex(ifa->ifa_name);
+			break;
+		}
+	}
+	freeifaddrs(ifaddrs);
+	return ifindex;
+}
+
+void udpx_xdp_close(struct udpx_ep *ep)
+{
+	struct udpx_xdp *xdp = ep->xdp;
+	struct util_wait_fd *wait;
+
+	if (!xdp)
+		return;
+
+	if (xdp->fd >= 0 && ep->util_ep.rx_cq && ep->util_ep.rx_cq->wait) {
+		wait = container_of(ep->util_ep.rx_cq->wait,
+				    struct util_wait_fd, util_wait);
+		ofi_epoll_del(wait->epoll_fd, xdp->fd);
+	}
+
+	if (xdp->link_fd >= 0)
+		close(xdp->link_fd);
+	udpx_xdp_unmap_ring(&xdp->rx);
+	udpx_xdp_unmap_ring(&xdp->comp);
+	udpx_xdp_unmap_ring(&xdp->fill);
+	if (xdp->fd >= 0)
+		close(xdp->fd);
+	if (xdp->umem)
+		munmap(xdp->umem, xdp->umem_len);
+	if (xdp->prog_fd >= 0)
+		close(xdp->prog_fd);
+	if (xdp->map_fd >= 0)
+		close(xdp->map_fd);
+	free(xdp);
+	ep->xdp = NULL;
+}
+
+int udpx_xdp_open(struct udpx_ep *ep)
+{
+	struct udpx_xdp *xdp;
+	struct sockaddr_in sin;
+	socklen_t len = sizeof(sin);
+	struct util_wait_fd *wait;
+	union bpf_attr attr;
+	int ifindex, ret;
+
+	if (ofi_getsockname(ep->sock, (struct sockaddr *) &sin, &len))
+		return -ofi_sockerr();
+	if (sin.sin_family != AF_INET)
+		return -FI_ENOSYS;
+
+	ifindex = udpx_xdp_ifindex(&sin);
+	if (!ifindex)
+		return -FI_ENODEV;
+
+	xdp = calloc(1, sizeof(*xdp));
+	if (!xdp)
+		return -FI_ENOMEM;
+
+	xdp->fd = xdp->map_fd = xdp->prog_fd = xdp->link_fd = -1;
+	ep->xdp = xdp;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.map_type = BPF_MAP_TYPE_XSKMAP;
+	attr.key_size = sizeof(uint32_t);
+	attr.value_size = sizeof(int);
+	attr.max_entries = udpx_env.xdp_queue + 1;
+	xdp->map_fd = udpx_bpf(BPF_MAP_CREATE, &attr);
+	if (xdp->map_fd < 0) {
+		ret = xdp->map_fd;
+		goto err;
+	}
+
+	ret = udpx_xdp_load_prog(xdp, &sin);
+	if (ret)
+		goto err;
+
+	ret = udpx_xdp_open_sock(xdp, ifindex, udpx_env.xdp_queue);
+	if (ret)
+		goto err;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.map_fd = xdp->map_fd;
+	attr.key = (uintptr_t) &udpx_env.xdp_queue;
+	attr.value = (uintptr_t) &xdp->fd;
+	attr.flags = BPF_ANY;
+	ret = udpx_bpf(BPF_MAP_UPDATE_ELEM, &attr);
+	if (ret)
+		goto err;
+
+	ret = udpx_xdp_attach(xdp, ifindex);
+	if (ret)
+		goto err;
+
+	if (ep->util_ep.rx_cq && ep->util_ep.rx_cq->wait) {
+		wait = container_of(ep->util_ep.rx_cq->wait,
+				    struct util_wait_fd, util_wait);
+		ret = ofi_epoll_add(wait->epoll_fd, xdp->fd, OFI_EPOLL_IN,
+				    &ep->util_ep.ep_fid.fid);
+		if (ret)
+			goto err;
+	}
+
+	FI_INFO(&udpx_prov, FI_LOG_EP_CTRL,
+		"receiving through AF_XDP on ifindex %d queue %d\n",
+		ifindex, udpx_env.xdp_queue);
+	return 0;
+err:
+	udpx_xdp_close(ep);
+	return ret;
+}
+
+/* Ones' complement sum of big-endian 16-bit words */
+static uint32_t udpx_xdp_csum_add(uint32_t sum, const uint8_t *buf,
+				  size_t len)
+{
+	for (; len > 1; buf += 2, len -= 2)
+		sum += ((uint32_t) buf[0] << 8) | buf[1];
+	if (len)
+		sum += (uint32_t) buf[0] << 8;
+	return sum;
+}
+
+static bool udpx_xdp_csum_ok(uint32_t sum)
+{
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return sum == 0xffff;
+}
+
+/* Frames redirected to the socket skip the kernel's checksum validation,
+ * and AF_XDP does not report whether the NIC validated them, so check
+ * both checksums here.  A zero UDP checksum means the sender did not
+ * compute one.  Virtual interfaces such as veth may deliver local traffic
+ * with checksums left to offload, which fail this check.
+ */
+static bool udpx_xdp_csum_valid(struct iphdr *ip, struct udphdr *udp,
+				size_t udp_len)
+{
+	uint32_t sum;
+
+	if (!udpx_xdp_csum_ok(udpx_xdp_csum_add(0, (uint8_t *) ip,
+						 ip->ihl * 4)))
+		return false;
+
+	if (!udp->check)
+		return true;
+
+	sum = udpx_xdp_csum_add(0, (uint8_t *) &ip->saddr,
+				sizeof(ip->saddr) + sizeof(ip->daddr));
+	sum += IPPROTO_UDP + udp_len;
+	return udpx_xdp_csum_ok(udpx_xdp_csum_add(sum, (uint8_t *) udp,
+						   udp_len));
+}
+
+static bool udpx_xdp_parse(uint8_t *frame, uint32_t len,
+			   struct sockaddr_in *sin, void **data,
+			   size_t *data_len)
+{
+	struct ethhdr *eth = (struct ethhdr *) frame;
+	struct iphdr *ip;
+	struct udphdr *udp;
+	size_t ip_len, udp_len;
+
+	if (len < UDPX_XDP_HDR_LEN || eth->h_proto != htons(ETH_P_IP))
+		return false;
+
+	ip = (struct iphdr *) (eth + 1);
+	ip_len = ip->ihl * 4;
+	if (ip->protocol != IPPROTO_UDP ||
+	    sizeof(*eth) + ip_len + sizeof(*udp) > len)
+		return false;
+
+	udp = (struct udphdr *) ((uint8_t *) ip + ip_len);
+	udp_len = ntohs(udp->len);
+	if (udp_len < sizeof(*udp) ||
+	    (uint8_t *) udp + udp_len > frame + len)
+		return false;
+
+	if (!udpx_xdp_csum_valid(ip, udp, udp_len)) {
+		FI_WARN_ONCE(&udpx_prov, FI_LOG_EP_DATA,
+			     "dropping datagrams with bad checksums\n");
+		return false;
+	}
+
+	sin->sin_family = AF_INET;
+	sin->sin_port = udp->source;
+	sin->sin_addr.s_addr = ip->saddr;
+	*data = udp + 1;
+	*data_len = udp_len - sizeof(*udp);
+	return true;
+}
+
+/* Called with the rx CQ lock held.  Completes posted receives from the
+ * datagrams waiting in the rx ring, then returns their frames to the fill
+ * ring with a single producer update.
+ */
+void udpx_xdp_progress(struct udpx_ep *ep)
+{
+	struct udpx_xdp *xdp = ep->xdp;
+	struct udpx_ep_entry *entry;
+	struct xdp_desc *desc;
+	struct sockaddr_in6 addr;
+	uint32_t cons, avail, fill_prod, i;
+	uint64_t *fill;
+	size_t data_len, len;
+	void *data;
+
+	cons = *xdp->rx.consumer;
+	avail = __atomic_load_n(xdp->rx.producer, __ATOMIC_ACQUIRE) - cons;
+	if (!avail)
+		return;
+
+	avail = MIN(avail, UDPX_XDP_BATCH);
+	fill = xdp->fill.desc;
+	fill_prod = *xdp->fill.producer;
+	memset(&addr, 0, sizeof(addr));
+
+	for (i = 0; i < avail && !ofi_cirque_isempty(ep->rxq); i++) {
+		desc = (struct xdp_desc *) xdp->rx.desc +
+		       ((cons + i) & xdp->rx.mask);
+		fill[(fill_prod + i) & xdp->fill.mask] =
+			desc->addr & ~((uint64_t) UDPX_XDP_FRAME_SIZE - 1);
+
+		if (!udpx_xdp_parse((uint8_t *) xdp->umem + desc->addr,
+				    desc->len, (struct sockaddr_in *) &addr,
+				    &data, &data_len))
+			continue;
+
+		entry = ofi_cirque_head(ep->rxq);
+		len = ofi_copy_to_iov(entry->iov, entry->iov_count, 0,
+				      data, data_len);
+		if (len < data_len)
+			udpx_rx_trunc(ep, entry->context, len, data_len - len);
+		else
+			ep->rx_comp(ep, entry->context, 0, len, NULL, &addr);
+		ofi_cirque_discard(ep->rxq);
+	}
+
+	__atomic_store_n(xdp->fill.producer, fill_prod + i, __ATOMIC_RELEASE);
+	__atomic_store_n(xdp->rx.consumer, cons + i, __ATOMIC_RELEASE);
+}
+
+#endif /* HAVE_UDP_XDP */
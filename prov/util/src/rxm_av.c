@@ -227,11 +227,9 @@ static int rxm_av_remove(struct fid_av *av_fid, fi_addr_t *fi_addr,
 		if (!av_entry)
 			continue;
 
-		if (!ofi_atomic_dec32(&av_entry->use_cnt)) {
+		if (ofi_atomic_get32(&av_entry->use_cnt) == 1)
 			rxm_put_peer_addr(av, fi_addr[i]);
-			HASH_DELETE(hh, av->util_av.hash, av_entry);
-			ofi_ibuf_free(av_entry);
-		}
+		ofi_av_remove_addr(&av->util_av, fi_addr[i]);
 	}
 
 	ofi_mutex_unlock(&av->util_av.lock);
@@ -49,12 +49,20 @@
 #endif
 
 #include <ofi_util.h>
+#include <fasthash.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 
 enum {
 	UTIL_NO_ENTRY = -1,
 };
 
+#define UTIL_AV_SHM_MAGIC	0x4f46492d41563031ULL	/* "OFI-AV01" */
+#define UTIL_AV_SHM_REMOVED	UINT64_MAX
+
 static int fi_get_src_sockaddr(const struct sockaddr *dest_addr, size_t dest_addrlen,
 			       struct sockaddr **src_addr, size_t *src_addrlen)
 {
@@ -240,10 +248,19 @@ int ofi_get_addr(uint32_t *addr_format, uint64_t flags,
 	}
 }
 
+static inline void *
+util_av_shm_entry(struct util_av_shared *shared, size_t index)
+{
+	return shared->entries + index * shared->hdr->entry_size;
+}
+
 void *ofi_av_get_addr(struct util_av *av, fi_addr_t fi_addr)
 {
 	struct util_av_entry *entry;
 
+	if (av->shared)
+		return util_av_shm_entry(av->shared, fi_addr);
+
 	entry = ofi_bufpool_get_ibuf(av->av_entry_pool, fi_addr);
 	return entry->data;
 }
@@ -283,14 +300,367 @@ int ofi_verify_av_insert(struct util_av *av, uint64_t flags, void *context)
 	return 0;
 }
 
+/* Slots of the private AV index are probed in aligned groups of
+ * UTIL_AV_GROUP_SIZE, comparing the control bytes of a whole group with
+ * the fingerprint of the address at once.  Addresses are only compared
+ * for matching fingerprints, and a probe ends at the first group with an
+ * empty slot.  Empty and deleted control bytes have the high bit set.
+ */
+#define UTIL_AV_GROUP_SIZE	16
+#define UTIL_AV_CTRL_EMPTY	0x80
+#define UTIL_AV_CTRL_DELETED	0xfe
+
+static inline uint8_t util_av_ctrl_tag(uint64_t hash)
+{
+	return (uint8_t) (hash >> 57);
+}
+
+static inline uint32_t util_av_group_match(const uint8_t *ctrl, uint8_t val)
+{
+#ifdef __SSE2__
+	__m128i group = _mm_load_si128((const __m128i *) ctrl);
+
+	return (uint32_t) _mm_movemask_epi8(
+			_mm_cmpeq_epi8(group, _mm_set1_epi8((char) val)));
+#else
+	uint32_t mask = 0;
+	int i;
+
+	for (i = 0; i < UTIL_AV_GROUP_SIZE; i++)
+		mask |= (uint32_t) (ctrl[i] == val) << i;
+	return mask;
+#endif
+}
+
+/* Slots that are empty or deleted */
+static inline uint32_t util_av_group_free(const uint8_t *ctrl)
+{
+#ifdef __SSE2__
+	return (uint32_t) _mm_movemask_epi8(
+			_mm_load_si128((const __m128i *) ctrl));
+#else
+	uint32_t mask = 0;
+	int i;
+
+	for (i = 0; i < UTIL_AV_GROUP_SIZE; i++)
+		mask |= (uint32_t) (ctrl[i] >> 7) << i;
+	return mask;
+#endif
+}
+
+static inline int util_av_group_first(uint32_t mask)
+{
+#ifdef __GNUC__
+	return __builtin_ctz(mask);
+#else
+	return ofi_lsb(mask) - 1;
+#endif
+}
+
+static inline uint64_t util_av_hash(struct util_av *av, const void *addr)
+{
+	return fasthash64(addr, av->addrlen, 0);
+}
+
+static struct util_av_index *util_av_index_alloc(size_t size)
+{
+	struct util_av_index *index;
+	size_t hdr_size;
+
+	hdr_size = ofi_get_aligned_size(sizeof(*index), UTIL_AV_GROUP_SIZE);
+	if (ofi_memalign((void **) &index, UTIL_AV_GROUP_SIZE, hdr_size +
+			 size * (sizeof(*index->ctrl) + sizeof(*index->slots))))
+		return NULL;
+
+	index->retired = NULL;
+	index->size = size;
+	index->cnt = 0;
+	index->deleted = 0;
+	index->ctrl = (uint8_t *) index + hdr_size;
+	index->slots = (struct util_av_entry **) (index->ctrl + size);
+	memset(index->ctrl, UTIL_AV_CTRL_EMPTY, size);
+	memset(index->slots, 0, size * sizeof(*index->slots));
+	return index;
+}
+
+static void util_av_index_free(struct util_av_index *index)
+{
+	struct util_av_index *retired;
+
+	while (index) {
+		retired = index->retired;
+		ofi_freealign(index);
+		index = retired;
+	}
+}
+
+/* Updates of the index, and of entries that are or were in it, are made
+ * under the AV lock between util_av_write_begin() and util_av_write_end().
+ * Lookups without the lock check the sequence around the probe and retry
+ * if it changed; see ofi_av_lookup_fi_addr().
+ */
+static inline void util_av_write_begin(struct util_av *av)
+{
+	ofi_atomic_store_u64(&av->index_seq, av->index_seq + 1);
+	ofi_atomic_fence_release();
+}
+
+static inline void util_av_write_end(struct util_av *av)
+{
+	ofi_atomic_store_u64(&av->index_seq, av->index_seq + 1);
+}
+
+/* Without the AV lock, the probe may see a slot or an entry being
+ * updated.  Entries stay allocated in the entry pool and replaced tables
+ * stay on the retired list, so the probe only reads valid memory, and the
+ * caller discards its result if the sequence changed.
+ */
+static struct util_av_entry *
+util_av_index_find(struct util_av *av, const void *addr, uint64_t hash)
+{
+	struct util_av_index *index = ofi_atomic_load_ptr(&av->index);
+	struct util_av_entry *entry;
+	size_t mask, group, n;
+	uint32_t match;
+	uint8_t *ctrl;
+
+	mask = index->size / UTIL_AV_GROUP_SIZE - 1;
+	group = hash & mask;
+	for (n = 0; n <= mask; n++, group = (group + 1) & mask) {
+		ctrl = &index->ctrl[group * UTIL_AV_GROUP_SIZE];
+		for (match = util_av_group_match(ctrl, util_av_ctrl_tag(hash));
+		     match; match &= match - 1) {
+			entry = index->slots[group * UTIL_AV_GROUP_SIZE +
+					     util_av_group_first(match)];
+			if (entry && entry->hash == hash &&
+			    !memcmp(entry->data, addr, av->addrlen))
+				return entry;
+		}
+
+		if (util_av_group_match(ctrl, UTIL_AV_CTRL_EMPTY))
+			break;
+	}
+	return NULL;
+}
+
+static void util_av_index_add(struct util_av_index *index,
+			      struct util_av_entry *entry)
+{
+	size_t mask, group, i;
+	uint32_t free_slots;
+
+	mask = index->size / UTIL_AV_GROUP_SIZE - 1;
+	for (group = entry->hash & mask; ; group = (group + 1) & mask) {
+		free_slots = util_av_group_free(
+				&index->ctrl[group * UTIL_AV_GROUP_SIZE]);
+		if (free_slots)
+			break;
+	}
+
+	i = group * UTIL_AV_GROUP_SIZE + util_av_group_first(free_slots);
+	if (index->ctrl[i] == UTIL_AV_CTRL_DELETED)
+		index->deleted--;
+	index->slots[i] = entry;
+	index->ctrl[i] = util_av_ctrl_tag(entry->hash);
+	index->cnt++;
+}
+
+static void util_av_index_del(struct util_av_index *index,
+			      struct util_av_entry *entry)
+{
+	size_t mask, group, i;
+	uint32_t match;
+	uint8_t *ctrl;
+
+	mask = index->size / UTIL_AV_GROUP_SIZE - 1;
+	for (group = entry->hash & mask; ; group = (group + 1) & mask) {
+		ctrl = &index->ctrl[group * UTIL_AV_GROUP_SIZE];
+		for (match = util_av_group_match(ctrl,
+					util_av_ctrl_tag(entry->hash));
+		     match; match &= match - 1) {
+			i = group * UTIL_AV_GROUP_SIZE +
+			    util_av_group_first(match);
+			if (index->slots[i] == entry)
+				goto found;
+		}
+		assert(!util_av_group_match(ctrl, UTIL_AV_CTRL_EMPTY));
+	}
+
+found:
+	/* Probes already end at a group with an empty slot */
+	if (util_av_group_match(ctrl, UTIL_AV_CTRL_EMPTY)) {
+		index->ctrl[i] = UTIL_AV_CTRL_EMPTY;
+	} else {
+		index->ctrl[i] = UTIL_AV_CTRL_DELETED;
+		index->deleted++;
+	}
+	index->slots[i] = NULL;
+	index->cnt--;
+}
+
+/* Size the index to hold count more addresses without growing.  The
+ * index is kept at most 7/8 full, counting deleted slots.  Replacing the
+ * index always doubles its size, which bounds the retired tables to the
+ * size of the current one.
+ */
+int ofi_av_reserve(struct util_av *av, size_t count)
+{
+	struct util_av_index *index = av->index, *new_index;
+	size_t size, i;
+
+	assert(ofi_mutex_held(&av->lock));
+	if (av->shared)
+		return 0;
+
+	count += index->cnt;
+	if (count + index->deleted <= index->size / 8 * 7)
+		return 0;
+
+	for (size = index->size * 2; count > size / 8 * 7; size *= 2)
+		;
+
+	new_index = util_av_index_alloc(size);
+	if (!new_index)
+		return -FI_ENOMEM;
+
+	for (i = 0; i < index->size; i++) {
+		if (!(index->ctrl[i] & UTIL_AV_CTRL_EMPTY))
+			util_av_index_add(new_index, index->slots[i]);
+	}
+
+	FI_DBG(av->prov, FI_LOG_AV, "AV index size %zu\n", size);
+	new_index->retired = index;
+	ofi_atomic_store_ptr(&av->index, new_index);
+	return 0;
+}
+
+size_t ofi_av_count(struct util_av *av)
+{
+	if (av->shared)
+		return ofi_atomic_load_u64(&av->shared->hdr->used);
+
+	return av->index->cnt;
+}
+
+/* Returns the hash slot referencing addr, or NULL.  Slots are only
+ * written by the process that created the AV, so lookups from other
+ * processes must tolerate entries being added or removed concurrently.
+ */
+static uint64_t *util_av_shm_find(struct util_av *av, const void *addr)
+{
+	struct util_av_shared *shared = av->shared;
+	uint64_t mask = shared->hdr->hash_size - 1;
+	uint64_t i, n, val;
+
+	i = fasthash64(addr, av->addrlen, 0) & mask;
+	for (n = 0; n <= mask; n++, i = (i + 1) & mask) {
+		val = ofi_atomic_load_u64(&shared->hash[i]);
+		if (!val)
+			break;
+
+		if (val != UTIL_AV_SHM_REMOVED &&
+		    !memcmp(util_av_shm_entry(shared, val - 1), addr,
+			    av->addrlen))
+			return &shared->hash[i];
+	}
+	return NULL;
+}
+
+/* AVs opened with FI_READ resolve addresses already in the AV */
+static int util_av_shm_insert(struct util_av *av, const void *addr,
+			      fi_addr_t *fi_addr)
+{
+	struct util_av_shared *shared = av->shared;
+	struct util_av_shm_hdr *hdr = shared->hdr;
+	uint64_t mask = hdr->hash_size - 1;
+	uint64_t *slot, index, i;
+
+	slot = util_av_shm_find(av, addr);
+	if (slot) {
+		index = *slot - 1;
+		if (!(av->flags & FI_READ) && ++shared->use_cnt[index] > 1) {
+			ofi_straddr_log(av->prov, FI_LOG_WARN, FI_LOG_AV,
+					"addr already in AV\n", addr);
+		}
+		goto out;
+	}
+
+	if (av->flags & FI_READ) {
+		ofi_straddr_log(av->prov, FI_LOG_WARN, FI_LOG_AV,
+				"addr not in read-only AV\n", addr);
+		index = FI_ADDR_NOTAVAIL;
+		goto out;
+	}
+
+	if (hdr->used < hdr->count) {
+		index = hdr->used;
+	} else {
+		for (index = 0; index < hdr->count; index++) {
+			if (shared->map[index] == FI_ADDR_NOTAVAIL)
+				break;
+		}
+		if (index == hdr->count) {
+			index = FI_ADDR_NOTAVAIL;
+			goto out;
+		}
+	}
+
+	memcpy(util_av_shm_entry(shared, index), addr, av->addrlen);
+	shared->use_cnt[index] = 1;
+
+	i = fasthash64(addr, av->addrlen, 0) & mask;
+	while (shared->hash[i] && shared->hash[i] != UTIL_AV_SHM_REMOVED)
+		i = (i + 1) & mask;
+
+	ofi_atomic_store_u64(&shared->hash[i], index + 1);
+	ofi_atomic_store_u64(&shared->map[index], index);
+	if (index == hdr->used)
+		ofi_atomic_store_u64(&hdr->used, index + 1);
+	FI_INFO(av->prov, FI_LOG_AV, "fi_addr: %" PRIu64 "\n", index);
+out:
+	if (fi_addr)
+		*fi_addr = index;
+	if (index != FI_ADDR_NOTAVAIL)
+		return 0;
+	return (av->flags & FI_READ) ? -FI_ENOENT : -FI_ENOMEM;
+}
+
+static int util_av_shm_remove(struct util_av *av, fi_addr_t fi_addr)
+{
+	struct util_av_shared *shared = av->shared;
+	uint64_t *slot;
+
+	if (av->flags & FI_READ)
+		return -FI_EOPNOTSUPP;
+
+	if (fi_addr >= shared->hdr->count ||
+	    shared->map[fi_addr] == FI_ADDR_NOTAVAIL)
+		return -FI_ENOENT;
+
+	if (--shared->use_cnt[fi_addr])
+		return FI_SUCCESS;
+
+	slot = util_av_shm_find(av, util_av_shm_entry(shared, fi_addr));
+	assert(slot);
+	ofi_atomic_store_u64(slot, UTIL_AV_SHM_REMOVED);
+	ofi_atomic_store_u64(&shared->map[fi_addr], FI_ADDR_NOTAVAIL);
+	FI_DBG(av->prov, FI_LOG_AV, "av_remove fi_addr: %" PRIu64 "\n", fi_addr);
+	return 0;
+}
+
 int ofi_av_insert_addr(struct util_av *av, const void *addr, fi_addr_t *fi_addr)
 {
-	struct util_av_entry *entry = NULL;
+	struct util_av_entry *entry;
+	uint64_t hash;
 
 	assert(ofi_mutex_held(&av->lock));
 	ofi_straddr_log(av->prov, FI_LOG_INFO, FI_LOG_AV,
 			"inserting addr\n", addr);
-	HASH_FIND(hh, av->hash, addr, av->addrlen, entry);
+	if (av->shared)
+		return util_av_shm_insert(av, addr, fi_addr);
+
+	hash = util_av_hash(av, addr);
+	entry = util_av_index_find(av, addr, hash);
 	if (entry) {
 		if (fi_addr)
 			*fi_addr = ofi_buf_index(entry);
@@ -299,7 +669,8 @@ int ofi_av_insert_addr(struct util_av *av, const void *addr, fi_addr_t *fi_addr)
 					"addr already in AV\n", addr);
 		}
 	} else {
-		entry = ofi_ibuf_alloc(av->av_entry_pool);
+		entry = ofi_av_reserve(av, 1) ? NULL :
+			ofi_ibuf_alloc(av->av_entry_pool);
 		if (!entry) {
 			if (fi_addr)
 				*fi_addr = FI_ADDR_NOTAVAIL;
@@ -308,9 +679,12 @@ int ofi_av_insert_addr(struct util_av *av, const void *addr, fi_addr_t *fi_addr)
 
 		if (fi_addr)
 			*fi_addr = ofi_buf_index(entry);
+		util_av_write_begin(av);
 		memcpy(entry->data, addr, av->addrlen);
 		ofi_atomic_initialize32(&entry->use_cnt, 1);
-		HASH_ADD(hh, av->hash, data, av->addrlen, entry);
+		entry->hash = hash;
+		util_av_index_add(av->index, entry);
+		util_av_write_end(av);
 		FI_INFO(av->prov, FI_LOG_AV, "fi_addr: %" PRIu64 "\n",
 			ofi_buf_index(entry));
 	}
@@ -322,6 +696,9 @@ int ofi_av_remove_addr(struct util_av *av, fi_addr_t fi_addr)
 	struct util_av_entry *av_entry;
 
 	assert(ofi_mutex_held(&av->lock));
+	if (av->shared)
+		return util_av_shm_remove(av, fi_addr);
+
 	av_entry = ofi_bufpool_get_ibuf(av->av_entry_pool, fi_addr);
 	if (!av_entry)
 		return -FI_ENOENT;
@@ -329,7 +706,9 @@ int ofi_av_remove_addr(struct util_av *av, fi_addr_t fi_addr)
 	if (ofi_atomic_dec32(&av_entry->use_cnt))
 		return FI_SUCCESS;
 
-	HASH_DELETE(hh, av->hash, av_entry);
+	util_av_write_begin(av);
+	util_av_index_del(av->index, av_entry);
+	util_av_write_end(av);
 	FI_DBG(av->prov, FI_LOG_AV, "av_remove fi_addr: %" PRIu64 "\n", fi_addr);
 	ofi_ibuf_free(av_entry);
 	return 0;
@@ -337,19 +716,45 @@ int ofi_av_remove_addr(struct util_av *av, fi_addr_t fi_addr)
 
 fi_addr_t ofi_av_lookup_fi_addr_unsafe(struct util_av *av, const void *addr)
 {
-	struct util_av_entry *entry = NULL;
+	struct util_av_entry *entry;
+	uint64_t *slot;
 
-	HASH_FIND(hh, av->hash, addr, av->addrlen, entry);
+	if (av->shared) {
+		slot = util_av_shm_find(av, addr);
+		return slot ? ofi_atomic_load_u64(slot) - 1 : FI_ADDR_NOTAVAIL;
+	}
+
+	entry = util_av_index_find(av, addr, util_av_hash(av, addr));
 	return entry ? ofi_buf_index(entry) : FI_ADDR_NOTAVAIL;
 }
 
+/* Lookups do not take the AV lock unless they overlap with an update.
+ * Holding the lock across the probe keeps the cache misses of one lookup
+ * from overlapping with those of the next, which matters for large AVs.
+ */
 fi_addr_t ofi_av_lookup_fi_addr(struct util_av *av, const void *addr)
 {
+	struct util_av_entry *entry;
 	fi_addr_t fi_addr;
+	uint64_t hash, seq;
+
+	if (av->shared)
+		return ofi_av_lookup_fi_addr_unsafe(av, addr);
+
+	hash = util_av_hash(av, addr);
+	seq = ofi_atomic_load_u64(&av->index_seq);
+	if (!(seq & 1)) {
+		entry = util_av_index_find(av, addr, hash);
+		fi_addr = entry ? ofi_buf_index(entry) : FI_ADDR_NOTAVAIL;
+		ofi_atomic_fence_acquire();
+		if (ofi_atomic_load_u64(&av->index_seq) == seq)
+			return fi_addr;
+	}
+
 	ofi_mutex_lock(&av->lock);
-	fi_addr = ofi_av_lookup_fi_addr_unsafe(av, addr);
+	entry = util_av_index_find(av, addr, hash);
 	ofi_mutex_unlock(&av->lock);
-	return fi_addr;
+	return entry ? ofi_buf_index(entry) : FI_ADDR_NOTAVAIL;
 }
 
 static void *
@@ -388,9 +793,134 @@ int ofi_av_bind(struct fid *av_fid, struct fid *eq_fid, uint64_t flags)
 	return 0;
 }
 
+int ofi_av_elements_iter(struct util_av *av, ofi_av_apply_func apply,
+			 void *arg)
+{
+	struct util_av_index *index;
+	fi_addr_t i, used;
+	int ret;
+
+	if (av->shared) {
+		used = ofi_atomic_load_u64(&av->shared->hdr->used);
+		for (i = 0; i < used; i++) {
+			if (ofi_atomic_load_u64(&av->shared->map[i]) != i)
+				continue;
+
+			ret = apply(av, util_av_shm_entry(av->shared, i),
+				    i, arg);
+			if (ret)
+				return ret;
+		}
+		return 0;
+	}
+
+	index = av->index;
+	for (i = 0; i < index->size; i++) {
+		if (index->ctrl[i] & UTIL_AV_CTRL_EMPTY)
+			continue;
+
+		ret = apply(av, index->slots[i]->data,
+			    ofi_buf_index(index->slots[i]), arg);
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+static void util_av_shm_close(struct util_av_shared *shared, bool owner)
+{
+	/* Only the creator removes the segment */
+	if (!owner) {
+		free((void *) shared->shm.name);
+		shared->shm.name = NULL;
+	}
+	ofi_shm_unmap(&shared->shm);
+	free(shared->use_cnt);
+	free(shared);
+}
+
+static int util_av_shm_open(struct util_av *av, const struct fi_av_attr *attr,
+			    size_t entry_size, size_t count)
+{
+	struct util_av_shared *shared;
+	struct util_av_shm_hdr *hdr;
+	size_t hash_size, size;
+	bool owner = !(attr->flags & FI_READ);
+	void *base;
+	int ret;
+
+	shared = calloc(1, sizeof(*shared));
+	if (!shared)
+		return -FI_ENOMEM;
+
+	hash_size = roundup_power_of_two(count * 2);
+	size = sizeof(*hdr) + count * sizeof(*shared->map) +
+	       hash_size * sizeof(*shared->hash) + count * entry_size;
+
+	/* A second writer would overwrite the AV of the first, so only one
+	 * process may create it.  Other processes map it read-only.
+	 */
+	ret = ofi_shm_map_flags(&shared->shm, attr->name, size,
+				owner ? OFI_SHM_CREATE | OFI_SHM_EXCL :
+					OFI_SHM_RDONLY, &base);
+	if (ret) {
+		FI_WARN(av->prov, FI_LOG_AV, "unable to map shared AV %s\n",
+			attr->name);
+		free(shared);
+		return ret;
+	}
+
+	hdr = base;
+	shared->hdr = hdr;
+	shared->map = (fi_addr_t *) (hdr + 1);
+	shared->hash = (uint64_t *) (shared->map + count);
+	shared->entries = (char *) (shared->hash + hash_size);
+
+	if (owner) {
+		shared->use_cnt = calloc(count, sizeof(*shared->use_cnt));
+		if (!shared->use_cnt) {
+			ret = -FI_ENOMEM;
+			goto close;
+		}
+
+		ofi_atomic_store_u64(&hdr->magic, 0);
+		hdr->count = count;
+		hdr->addrlen = av->addrlen;
+		hdr->entry_size = entry_size;
+		hdr->hash_size = hash_size;
+		hdr->used = 0;
+		memset(shared->map, 0xff, count * sizeof(*shared->map));
+		memset(shared->hash, 0, hash_size * sizeof(*shared->hash));
+		ofi_atomic_store_u64(&hdr->magic, UTIL_AV_SHM_MAGIC);
+	} else if (ofi_atomic_load_u64(&hdr->magic) != UTIL_AV_SHM_MAGIC ||
+		   hdr->count != count || hdr->addrlen != av->addrlen ||
+		   hdr->entry_size != entry_size) {
+		FI_WARN(av->prov, FI_LOG_AV, "shared AV %s does not exist or "
+			"was created with different attributes\n", attr->name);
+		ret = -FI_EINVAL;
+		goto close;
+	}
+
+	FI_INFO(av->prov, FI_LOG_AV, "%s shared AV %s\n",
+		owner ? "created" : "opened", attr->name);
+	av->shared = shared;
+	return 0;
+
+close:
+	util_av_shm_close(shared, owner);
+	return ret;
+}
+
 static void util_av_close(struct util_av *av)
 {
-	HASH_CLEAR(hh, av->hash);
+	if (av->shared) {
+		util_av_shm_close(av->shared, !(av->flags & FI_READ));
+		av->shared = NULL;
+		return;
+	}
+
+	util_av_index_free(av->index);
+	av->index = NULL;
 	ofi_bufpool_destroy(av->av_entry_pool);
 }
 
@@ -437,6 +967,9 @@ int ofi_av_close(struct util_av *av)
 
 size_t ofi_av_size(struct util_av *av)
 {
+	if (av->shared)
+		return av->shared->hdr->count;
+
 	return av->av_entry_pool->entry_cnt ?
 	       av->av_entry_pool->entry_cnt :
 	       av->av_entry_pool->attr.chunk_cnt;
@@ -445,7 +978,7 @@ size_t ofi_av_size(struct util_av *av)
 static int util_verify_av_util_attr(struct util_domain *domain,
 				    const struct util_av_attr *util_attr)
 {
-	if (util_attr->flags & ~(OFI_AV_DYN_ADDRLEN)) {
+	if (util_attr->flags & ~(OFI_AV_DYN_ADDRLEN | OFI_AV_SHARED)) {
 		FI_WARN(domain->prov, FI_LOG_AV, "invalid internal flags\n");
 		return -FI_EINVAL;
 	}
@@ -475,9 +1008,6 @@ static int util_av_init(struct util_av *av, const struct fi_av_attr *attr,
 		.flags		= OFI_BUFPOOL_NO_TRACK | OFI_BUFPOOL_INDEXED,
 	};
 
-	/* TODO: Handle FI_READ */
-	/* TODO: Handle mmap - shared AV */
-
 	ret = util_verify_av_util_attr(av->domain, util_attr);
 	if (ret)
 		return ret;
@@ -489,14 +1019,32 @@ static int util_av_init(struct util_av *av, const struct fi_av_attr *attr,
 	av->addrlen = util_attr->addrlen;
 	av->context_offset = offset + av->addrlen;
 	av->flags = util_attr->flags | attr->flags;
-	av->hash = NULL;
+	av->index = NULL;
+	av->index_seq = 0;
+
+	if (attr->name) {
+		return util_av_shm_open(av, attr,
+			ofi_get_aligned_size(pool_attr.size -
+					     sizeof(struct util_av_entry), 8),
+			orig_size);
+	}
 
 	pool_attr.chunk_cnt = orig_size;
-	return ofi_bufpool_create_attr(&pool_attr, &av->av_entry_pool);
+	av->index = util_av_index_alloc(MAX(roundup_power_of_two(orig_size +
+					    orig_size / 7), UTIL_AV_GROUP_SIZE));
+	if (!av->index)
+		return -FI_ENOMEM;
+
+	ret = ofi_bufpool_create_attr(&pool_attr, &av->av_entry_pool);
+	if (ret) {
+		util_av_index_free(av->index);
+		av->index = NULL;
+	}
+	return ret;
 }
 
 static int util_verify_av_attr(struct util_domain *domain,
-			       const struct fi_av_attr *attr)
+			       const struct fi_av_attr *attr, int util_flags)
 {
 	switch (attr->type) {
 	case FI_AV_MAP:
@@ -512,11 +1060,17 @@ static int util_verify_av_attr(struct util_domain *domain,
 		return -FI_EINVAL;
 	}
 
-	if (attr->name) {
+	if (attr->name && !(util_flags & OFI_AV_SHARED)) {
 		FI_WARN(domain->prov, FI_LOG_AV, "Shared AV is unsupported\n");
 		return -FI_ENOSYS;
 	}
 
+	if ((attr->flags & FI_READ) && !attr->name) {
+		FI_WARN(domain->prov, FI_LOG_AV,
+			"read-only AV must be named\n");
+		return -FI_EINVAL;
+	}
+
 	if (attr->flags & ~(FI_EVENT | FI_READ | FI_SYMMETRIC)) {
 		FI_WARN(domain->prov, FI_LOG_AV, "invalid flags\n");
 		return -FI_EINVAL;
@@ -525,12 +1079,13 @@ static int util_verify_av_attr(struct util_domain *domain,
 	return 0;
 }
 
-int ofi_av_init_lightweight(struct util_domain *domain, const struct fi_av_attr *attr,
-			    struct util_av *av, void *context)
+static int util_av_init_common(struct util_domain *domain,
+			       const struct fi_av_attr *attr, int util_flags,
+			       struct util_av *av, void *context)
 {
 	int ret;
 
-	ret = util_verify_av_attr(domain, attr);
+	ret = util_verify_av_attr(domain, attr, util_flags);
 	if (ret)
 		return ret;
 
@@ -551,17 +1106,24 @@ int ofi_av_init_lightweight(struct util_domain *domain, const struct fi_av_attr
 	return 0;
 }
 
+int ofi_av_init_lightweight(struct util_domain *domain, const struct fi_av_attr *attr,
+			    struct util_av *av, void *context)
+{
+	return util_av_init_common(domain, attr, 0, av, context);
+}
+
 int ofi_av_init(struct util_domain *domain, const struct fi_av_attr *attr,
 		const struct util_av_attr *util_attr,
 		struct util_av *av, void *context)
 {
-	int ret = ofi_av_init_lightweight(domain, attr, av, context);
+	int ret = util_av_init_common(domain, attr, util_attr->flags,
+				      av, context);
 	if (ret)
 		return ret;
 
 	ret = util_av_init(av, attr, util_attr);
 	if (ret)
-		return ret;
+		ofi_av_close_lightweight(av);
 	return ret;
 }
 
@@ -652,6 +1214,13 @@ int ofi_ip_av_insertv(struct util_av *av, const void *addr, size_t addrlen,
 	assert(av->addrlen == addrlen);
 
 	FI_DBG(av->prov, FI_LOG_AV, "inserting %zu addresses\n", count);
+	/* Size the index for the batch up front, rather than growing it
+	 * repeatedly.  The inserts grow it themselves if this fails.
+	 */
+	ofi_mutex_lock(&av->lock);
+	(void) ofi_av_reserve(av, count);
+	ofi_mutex_unlock(&av->lock);
+
 	if (flags & FI_SYNC_ERR) {
 		sync_err = context;
 		memset(sync_err, 0, sizeof(*sync_err) * count);
@@ -912,6 +1481,11 @@ int ofi_ip_av_remove(struct fid_av *av_fid, fi_addr_t *fi_addr,
 		return -FI_EINVAL;
 	}
 
+	if (av->flags & FI_READ) {
+		FI_WARN(av->prov, FI_LOG_AV, "AV is read-only\n");
+		return -FI_EOPNOTSUPP;
+	}
+
 	/*
 	 * It's more efficient to remove addresses from high to low index.
 	 * We assume that addresses are removed in the same order that they were
@@ -1000,6 +1574,7 @@ int ofi_ip_av_create(struct fid_domain *domain_fid, struct fi_av_attr *attr,
 		util_attr.addrlen = sizeof(struct sockaddr_in6);
 		util_attr.flags = OFI_AV_DYN_ADDRLEN;
 	}
+	util_attr.flags |= OFI_AV_SHARED;
 
 	if (attr->type == FI_AV_UNSPEC)
 		attr->type = FI_AV_MAP;
@@ -1014,6 +1589,9 @@ int ofi_ip_av_create(struct fid_domain *domain_fid, struct fi_av_attr *attr,
 		return ret;
 	}
 
+	if (util_av->shared)
+		attr->map_addr = util_av->shared->map;
+
 	*av = &util_av->av_fid;
 	(*av)->fid.ops = &ip_av_fi_ops;
 	(*av)->ops = &ip_av_ops;
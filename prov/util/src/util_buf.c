@@ -38,6 +38,7 @@
 #include <ofi_mem.h>
 #include <ofi.h>
 #include <ofi_osd.h>
+#include <ofi_trace.h>
 
 
 enum {
@@ -52,6 +53,11 @@ static int ofi_bufpool_region_alloc(struct ofi_bufpool_region *buf_region)
 	size_t alloc_size;
 	struct ofi_bufpool *pool = buf_region->pool;
 
+	if (pool->attr.mem_alloc_fn && !pool->attr.mem_alloc_fn(buf_region)) {
+		buf_region->flags = OFI_BUFPOOL_EXTERNAL_MEM;
+		return 0;
+	}
+
 	if (pool->attr.flags & OFI_BUFPOOL_HUGEPAGES) {
 		page_size = ofi_get_hugepage_size();
 		if (page_size > 0 && pool->alloc_size >= (size_t) page_size) {
@@ -104,7 +110,10 @@ static void ofi_bufpool_region_free(struct ofi_bufpool_region *buf_region)
 	int ret;
 	struct ofi_bufpool *pool = buf_region->pool;
 
-	if (buf_region->flags & (OFI_BUFPOOL_HUGEPAGES | OFI_BUFPOOL_NONSHARED)) {
+	if (buf_region->flags & OFI_BUFPOOL_EXTERNAL_MEM) {
+		pool->attr.mem_free_fn(buf_region);
+	} else if (buf_region->flags &
+		   (OFI_BUFPOOL_HUGEPAGES | OFI_BUFPOOL_NONSHARED)) {
 		ret = ofi_unmap_anon_pages(buf_region->alloc_region, pool->alloc_size);
 		if (ret) {
 			FI_DBG(&core_prov, FI_LOG_CORE,
@@ -197,6 +206,7 @@ int ofi_bufpool_grow(struct ofi_bufpool *pool)
 		dlist_insert_tail(&buf_region->entry, &pool->free_list.regions);
 
 	pool->entry_cnt += pool->attr.chunk_cnt;
+	OFI_TRACE(bufpool_grow, pool, pool->entry_size, pool->entry_cnt);
 	return 0;
 
 err3:
@@ -209,6 +219,50 @@ err1:
 	return ret;
 }
 
+/* Release all regions but the first if no buffer is in use.  Idle is
+ * detected by walking the free list, so this is meant to be called
+ * periodically rather than on the data path.  Returns the number of
+ * regions released.
+ */
+size_t ofi_bufpool_trim(struct ofi_bufpool *pool)
+{
+	struct ofi_bufpool_region *buf_region;
+	struct ofi_bufpool_hdr *buf_hdr;
+	struct slist_entry *entry;
+	size_t i, cnt = 0;
+
+	assert(!(pool->attr.flags & OFI_BUFPOOL_INDEXED));
+	if (pool->region_cnt <= 1)
+		return 0;
+
+	for (entry = pool->free_list.entries.head; entry; entry = entry->next)
+		cnt++;
+	if (cnt != pool->entry_cnt)
+		return 0;
+
+	for (i = 1; i < pool->region_cnt; i++) {
+		buf_region = pool->region_table[i];
+		if (pool->attr.free_fn)
+			pool->attr.free_fn(buf_region);
+
+		ofi_bufpool_region_free(buf_region);
+		free(buf_region);
+	}
+	cnt = pool->region_cnt - 1;
+
+	buf_region = pool->region_table[0];
+	slist_init(&pool->free_list.entries);
+	for (i = 0; i < pool->attr.chunk_cnt; i++) {
+		buf_hdr = ofi_buf_hdr(buf_region->mem_region +
+				      i * pool->entry_size);
+		slist_insert_tail(&buf_hdr->entry.slist,
+				  &pool->free_list.entries);
+	}
+	pool->region_cnt = 1;
+	pool->entry_cnt = pool->attr.chunk_cnt;
+	return cnt;
+}
+
 int ofi_bufpool_create_attr(struct ofi_bufpool_attr *attr,
 			      struct ofi_bufpool **buf_pool)
 {
@@ -76,7 +76,7 @@ static uint64_t ofi_cntr_read(struct fid_cntr *cntr_fid)
 	assert(cntr->cntr_fid.fid.fclass == FI_CLASS_CNTR);
 	cntr->progress(cntr);
 
-	return ofi_atomic_get64(&cntr->cnt);
+	return ofi_cntr_value(cntr);
 }
 
 static uint64_t ofi_cntr_readerr(struct fid_cntr *cntr_fid)
@@ -96,12 +96,57 @@ static int ofi_cntr_add(struct fid_cntr *cntr_fid, uint64_t value)
 	assert(cntr->cntr_fid.fid.fclass == FI_CLASS_CNTR);
 
 	ofi_atomic_add64(&cntr->cnt, value);
+	if (!dlist_empty(&cntr->trigger_list))
+		ofi_trigger_check(cntr);
 	if (cntr->wait)
 		cntr->wait->signal(cntr->wait);
 
 	return FI_SUCCESS;
 }
 
+/*
+ * Spread threads across shards by hashing the thread id.  Threads that
+ * collide share a cache line, which is no worse than the unsharded case.
+ */
+static inline struct util_cntr_shard *
+ofi_cntr_shard(struct util_cntr *cntr)
+{
+	uint64_t id = (uint64_t) (uintptr_t) pthread_self();
+
+	return &cntr->shards[((id * 0x9E3779B97F4A7C15ULL) >> 58) &
+			     cntr->shard_mask];
+}
+
+static int ofi_cntr_shard_add(struct fid_cntr *cntr_fid, uint64_t value)
+{
+	struct util_cntr *cntr = container_of(cntr_fid, struct util_cntr, cntr_fid);
+	uint64_t threshold;
+
+	assert(cntr->cntr_fid.fid.fclass == FI_CLASS_CNTR);
+
+	ofi_atomic_add64(&ofi_cntr_shard(cntr)->cnt, value);
+	if (!dlist_empty(&cntr->trigger_list))
+		ofi_trigger_check(cntr);
+	if (!cntr->wait)
+		return FI_SUCCESS;
+
+	/*
+	 * An application wait set may be waited on without fi_cntr_wait,
+	 * so only an internal wait object can skip the signal.  Once the
+	 * lowest waiter threshold is reached, clear it and wake everyone;
+	 * waiters that are not done yet register their threshold again.
+	 */
+	if (cntr->internal_wait) {
+		threshold = ofi_atomic_get64(&cntr->wait_threshold);
+		if (threshold == UINT64_MAX || ofi_cntr_value(cntr) < threshold)
+			return FI_SUCCESS;
+		ofi_atomic_set64(&cntr->wait_threshold, (int64_t) UINT64_MAX);
+	}
+	cntr->wait->signal(cntr->wait);
+
+	return FI_SUCCESS;
+}
+
 static int ofi_cntr_adderr(struct fid_cntr *cntr_fid, uint64_t value)
 {
 	struct util_cntr *cntr = container_of(cntr_fid, struct util_cntr, cntr_fid);
@@ -118,10 +163,17 @@ static int ofi_cntr_adderr(struct fid_cntr *cntr_fid, uint64_t value)
 static int ofi_cntr_set(struct fid_cntr *cntr_fid, uint64_t value)
 {
 	struct util_cntr *cntr = container_of(cntr_fid, struct util_cntr, cntr_fid);
+	size_t i;
 
 	assert(cntr->cntr_fid.fid.fclass == FI_CLASS_CNTR);
 
+	if (cntr->shards) {
+		for (i = 0; i <= cntr->shard_mask; i++)
+			ofi_atomic_set64(&cntr->shards[i].cnt, 0);
+	}
 	ofi_atomic_set64(&cntr->cnt, value);
+	if (!dlist_empty(&cntr->trigger_list))
+		ofi_trigger_check(cntr);
 	if (cntr->wait)
 		cntr->wait->signal(cntr->wait);
 
@@ -152,8 +204,9 @@ static int ofi_cntr_wait(struct fid_cntr *cntr_fid, uint64_t threshold, int time
 	endtime = ofi_timeout_time(timeout);
 
 	do {
+		ofi_cntr_wait_threshold(cntr, threshold);
 		cntr->progress(cntr);
-		if (threshold <= (uint64_t)ofi_atomic_get64(&cntr->cnt))
+		if (threshold <= ofi_cntr_value(cntr))
 			return FI_SUCCESS;
 
 		if (errcnt != (uint64_t)ofi_atomic_get64(&cntr->err))
@@ -172,8 +225,18 @@ static int ofi_cntr_wait(struct fid_cntr *cntr_fid, uint64_t threshold, int time
 		 * and then instead of waiting for a longer period. This does
 		 * have the overhead of threads waking up unnecessarily.
 		 */
-		timeout_quantum = (timeout < 0 ? OFI_TIMEOUT_QUANTUM_MS :
-				   MIN(OFI_TIMEOUT_QUANTUM_MS, timeout));
+		timeout_quantum = OFI_TIMEOUT_QUANTUM_MS;
+
+		/*
+		 * Pending triggered work is only driven by cntr->progress, and
+		 * may be what will update this counter.  Wake up often enough
+		 * to keep driving it.
+		 */
+		if (ofi_trigger_pending(cntr->domain))
+			timeout_quantum = OFI_TRIGGER_WAIT_MS;
+
+		if (timeout >= 0)
+			timeout_quantum = MIN(timeout_quantum, timeout);
 
 		ret = fi_wait(&cntr->wait->wait_fid, timeout_quantum);
 	} while (!ret || (ret == -FI_ETIMEDOUT &&
@@ -193,6 +256,28 @@ static struct fi_ops_cntr util_cntr_ops = {
 	.wait = ofi_cntr_wait
 };
 
+static struct fi_ops_cntr util_cntr_shard_ops = {
+	.size = sizeof(struct fi_ops_cntr),
+	.read = ofi_cntr_read,
+	.readerr = ofi_cntr_readerr,
+	.add = ofi_cntr_shard_add,
+	.adderr = ofi_cntr_adderr,
+	.set = ofi_cntr_set,
+	.seterr = ofi_cntr_seterr,
+	.wait = ofi_cntr_wait
+};
+
+static struct fi_ops_cntr util_cntr_shard_no_wait_ops = {
+	.size = sizeof(struct fi_ops_cntr),
+	.read = ofi_cntr_read,
+	.readerr = ofi_cntr_readerr,
+	.add = ofi_cntr_shard_add,
+	.adderr = ofi_cntr_adderr,
+	.set = ofi_cntr_set,
+	.seterr = ofi_cntr_seterr,
+	.wait = fi_no_cntr_wait,
+};
+
 static struct fi_ops_cntr util_cntr_no_wait_ops = {
 	.size = sizeof(struct fi_ops_cntr),
 	.read = ofi_cntr_read,
@@ -209,6 +294,7 @@ int ofi_cntr_cleanup(struct util_cntr *cntr)
 	if (ofi_atomic_get32(&cntr->ref))
 		return -FI_EBUSY;
 
+	ofi_trigger_cleanup_cntr(cntr);
 	if (cntr->wait) {
 		fi_poll_del(&cntr->wait->pollset->poll_fid,
 			    &cntr->cntr_fid.fid, 0);
@@ -218,6 +304,8 @@ int ofi_cntr_cleanup(struct util_cntr *cntr)
 
 	ofi_atomic_dec32(&cntr->domain->ref);
 	ofi_mutex_destroy(&cntr->ep_list_lock);
+	if (cntr->shards)
+		ofi_freealign(cntr->shards);
 	return 0;
 }
 
@@ -247,6 +335,25 @@ void ofi_cntr_progress(struct util_cntr *cntr)
 		ep->progress(ep);
 	}
 	ofi_mutex_unlock(&cntr->ep_list_lock);
+	ofi_trigger_progress(cntr->domain);
+}
+
+static int ofi_cntr_init_shards(struct util_cntr *cntr)
+{
+	size_t i, count;
+	int ret;
+
+	count = roundup_power_of_two(MIN(ofi_cntr_shards, OFI_CNTR_MAX_SHARDS));
+	ret = ofi_memalign((void **) &cntr->shards, OFI_CNTR_SHARD_SIZE,
+			   count * sizeof(*cntr->shards));
+	if (ret)
+		return -FI_ENOMEM;
+
+	for (i = 0; i < count; i++)
+		ofi_atomic_initialize64(&cntr->shards[i].cnt, 0);
+	cntr->shard_mask = count - 1;
+	ofi_atomic_initialize64(&cntr->wait_threshold, (int64_t) UINT64_MAX);
+	return 0;
 }
 
 static struct fi_ops util_cntr_fi_ops = {
@@ -276,16 +383,27 @@ int ofi_cntr_init(const struct fi_provider *prov, struct fid_domain *domain,
 	ofi_atomic_initialize64(&cntr->cnt, 0);
 	ofi_atomic_initialize64(&cntr->err, 0);
 	dlist_init(&cntr->ep_list);
+	dlist_init(&cntr->trigger_list);
 
 	cntr->cntr_fid.fid.fclass = FI_CLASS_CNTR;
 	cntr->cntr_fid.fid.context = context;
 	cntr->cntr_fid.fid.ops = &util_cntr_fi_ops;
 	cntr->cntr_fid.ops = &util_cntr_ops;
+	cntr->shards = NULL;
+
+	if (ofi_cntr_shards) {
+		ret = ofi_cntr_init_shards(cntr);
+		if (ret)
+			return ret;
+		cntr->cntr_fid.ops = &util_cntr_shard_ops;
+	}
 
 	switch (attr->wait_obj) {
 	case FI_WAIT_NONE:
 		wait = NULL;
-		cntr->cntr_fid.ops = &util_cntr_no_wait_ops;
+		cntr->cntr_fid.ops = cntr->shards ?
+				     &util_cntr_shard_no_wait_ops :
+				     &util_cntr_no_wait_ops;
 		break;
 	case FI_WAIT_UNSPEC:
 	case FI_WAIT_FD:
@@ -297,14 +415,17 @@ int ofi_cntr_init(const struct fi_provider *prov, struct fid_domain *domain,
 		cntr->internal_wait = 1;
 		ret = fi_wait_open(&cntr->domain->fabric->fabric_fid,
 				   &wait_attr, &wait);
-		if (ret)
+		if (ret) {
+			ofi_freealign(cntr->shards);
 			return ret;
+		}
 		break;
 	case FI_WAIT_SET:
 		wait = attr->wait_set;
 		break;
 	default:
 		assert(0);
+		ofi_freealign(cntr->shards);
 		return -FI_EINVAL;
 	}
 
@@ -1207,8 +1207,8 @@ static int util_av_create_base_set(struct util_av *av)
 	assert(ofi_mutex_held(&av->lock));
 
 	attr.stride = 1;
-	if (HASH_COUNT(av->hash)) {
-		attr.end_addr = HASH_COUNT(av->hash) - 1;
+	if (ofi_av_count(av)) {
+		attr.end_addr = ofi_av_count(av) - 1;
 	} else {
 		/* set start > end to skip insertions */
 		attr.start_addr = 1;
@@ -64,6 +64,10 @@ int ofi_cq_write_overflow(struct util_cq *cq, void *context, uint64_t flags,
 	FI_DBG(cq->domain->prov, FI_LOG_CQ, "writing to CQ overflow list\n");
 	assert(ofi_cirque_freecnt(cq->cirq) <= 1);
 
+	if (ofi_trigger_issued(cq->domain, context) &&
+	    ofi_trigger_complete(cq->domain, &context, 0))
+		return 0;
+
 	entry = calloc(1, sizeof(*entry));
 	if (!entry)
 		return -FI_ENOMEM;
@@ -93,6 +97,9 @@ int ofi_cq_insert_error(struct util_cq *cq,
 		return -FI_ENOMEM;
 
 	entry->comp = *err_entry;
+	if (ofi_trigger_issued(cq->domain, entry->comp.op_context))
+		(void) ofi_trigger_complete(cq->domain, &entry->comp.op_context,
+					    entry->comp.err);
 	ofi_cq_insert_aux(cq, entry);
 	return 0;
 }
@@ -570,6 +577,7 @@ void ofi_cq_progress(struct util_cq *cq)
 
 	}
 	ofi_mutex_unlock(&cq->ep_list_lock);
+	ofi_trigger_progress(cq->domain);
 }
 
 int ofi_cq_init(const struct fi_provider *prov, struct fid_domain *domain,
@@ -81,6 +81,9 @@ int ofi_domain_close(struct util_domain *domain)
 	if (domain->mr_map.rbtree)
 		ofi_mr_map_close(&domain->mr_map);
 
+	ofi_trigger_cleanup_domain(domain);
+	ofi_mutex_destroy(&domain->trigger_lock);
+
 	ofi_mutex_lock(&domain->fabric->lock);
 	dlist_remove(&domain->list_entry);
 	ofi_mutex_unlock(&domain->fabric->lock);
@@ -102,7 +105,7 @@ static int
 util_domain_init(struct util_domain *domain, const struct fi_info *info,
 		 enum ofi_lock_type lock_type)
 {
-	int ret;
+	int i, ret;
 
 	ofi_atomic_initialize32(&domain->ref, 0);
 	ret = ofi_genlock_init(&domain->lock, lock_type);
@@ -121,6 +124,14 @@ util_domain_init(struct util_domain *domain, const struct fi_info *info,
 		ofi_genlock_destroy(&domain->lock);
 		return -FI_ENOMEM;
 	}
+
+	ofi_mutex_init(&domain->trigger_lock);
+	dlist_init(&domain->trigger_list);
+	ofi_atomic_initialize32(&domain->trigger_cnt, 0);
+	for (i = 0; i < OFI_TRIGGER_HASH_SIZE; i++) {
+		dlist_init(&domain->trigger_issued[i]);
+		ofi_atomic_initialize32(&domain->trigger_issued_cnt[i], 0);
+	}
 	return 0;
 }
 
@@ -248,13 +248,8 @@ int ofi_endpoint_init(struct fid_domain *domain, const struct util_prov *util_pr
 	if (util_domain->eq)
 		ofi_ep_bind_eq(ep, util_domain->eq);
 	ofi_mutex_init(&ep->lock);
-	if (ep->domain->threading != FI_THREAD_SAFE) {
-		ep->lock_acquire = ofi_mutex_lock_noop;
-		ep->lock_release = ofi_mutex_unlock_noop;
-	} else {
-		ep->lock_acquire = ofi_mutex_lock_op;
-		ep->lock_release = ofi_mutex_unlock_op;
-	}
+	ep->lock_type = (ep->domain->threading != FI_THREAD_SAFE) ?
+			OFI_LOCK_NOOP : OFI_LOCK_MUTEX;
 	if (ep->caps & FI_COLLECTIVE) {
 		ep->coll_cid_mask = calloc(1, sizeof(*ep->coll_cid_mask));
 		if (!ep->coll_cid_mask)
@@ -269,6 +264,8 @@ int ofi_endpoint_init(struct fid_domain *domain, const struct util_prov *util_pr
 
 int ofi_endpoint_close(struct util_ep *util_ep)
 {
+	ofi_trigger_cleanup_ep(util_ep);
+
 	if (util_ep->tx_cq) {
 		fid_list_remove(&util_ep->tx_cq->ep_list,
 				&util_ep->tx_cq->ep_list_lock,
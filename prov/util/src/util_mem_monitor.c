@@ -39,6 +39,7 @@
 #include <ofi_mr.h>
 #include <ofi_hmem.h>
 #include <ofi_enosys.h>
+#include <ofi_trace.h>
 #include <rdma/fi_ext.h>
 
 
@@ -467,6 +468,59 @@ void ofi_monitor_unsubscribe(struct ofi_mem_monitor *monitor,
 #include <sys/ioctl.h>
 #include <linux/userfaultfd.h>
 
+static int ofi_uffd_range_cmp(const void *a, const void *b)
+{
+	const struct ofi_uffd_range *ra = a, *rb = b;
+
+	return (ra->start > rb->start) - (ra->start < rb->start);
+}
+
+/* Convert a batch of events into ranges sorted by address, merging
+ * adjacent and overlapping ranges.  Returns the number of ranges.
+ */
+static size_t ofi_uffd_coalesce(struct uffd_msg *msg, size_t cnt,
+				struct ofi_uffd_range *range)
+{
+	size_t i, n = 0;
+
+	for (i = 0; i < cnt; i++) {
+		switch (msg[i].event) {
+		case UFFD_EVENT_REMOVE:
+			ofi_monitor_unsubscribe(&uffd.monitor,
+				(void *) (uintptr_t) msg[i].arg.remove.start,
+				(size_t) (msg[i].arg.remove.end -
+					  msg[i].arg.remove.start), NULL);
+			/* fall through */
+		case UFFD_EVENT_UNMAP:
+			range[n].start = (uintptr_t) msg[i].arg.remove.start;
+			range[n++].end = (uintptr_t) msg[i].arg.remove.end;
+			break;
+		case UFFD_EVENT_REMAP:
+			range[n].start = (uintptr_t) msg[i].arg.remap.from;
+			range[n++].end = (uintptr_t) (msg[i].arg.remap.from +
+						      msg[i].arg.remap.len);
+			break;
+		default:
+			FI_WARN(&core_prov, FI_LOG_MR,
+				"Unhandled uffd event %d\n", msg[i].event);
+			break;
+		}
+	}
+
+	if (n < 2)
+		return n;
+
+	qsort(range, n, sizeof(*range), ofi_uffd_range_cmp);
+	for (cnt = 0, i = 1; i < n; i++) {
+		if (range[i].start <= range[cnt].end) {
+			range[cnt].end = MAX(range[cnt].end, range[i].end);
+		} else {
+			range[++cnt] = range[i];
+		}
+	}
+	return cnt + 1;
+}
+
 /* The userfault fd monitor requires for events that could
  * trigger it to be handled outside of the monitor functions
  * itself. When a fault occurs on a monitored region, the
@@ -478,50 +532,48 @@ void ofi_monitor_unsubscribe(struct ofi_mem_monitor *monitor,
  */
 static void *ofi_uffd_handler(void *arg)
 {
-	struct uffd_msg msg;
-	struct pollfd fds;
+	struct uffd_msg msg[OFI_UFFD_BATCH];
+	struct ofi_uffd_range range[OFI_UFFD_BATCH];
+	struct pollfd fds[2];
+	ssize_t len;
+	size_t cnt, i;
 	int ret;
 
-	fds.fd = uffd.fd;
-	fds.events = POLLIN;
+	fds[0].fd = uffd.fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = fd_signal_get(&uffd.stop);
+	fds[1].events = POLLIN;
 	for (;;) {
-		ret = poll(&fds, 1, -1);
-		if (ret != 1)
+		ret = poll(fds, 2, -1);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0 || fds[1].revents)
 			break;
 
+		/* Hold mm_lock from the read until the caches are notified.
+		 * A thread unmapping memory is released once its event is
+		 * read, so a search it makes afterwards must not see the
+		 * region.
+		 */
 		pthread_rwlock_rdlock(&mm_list_rwlock);
 		pthread_mutex_lock(&mm_lock);
-		ret = read(uffd.fd, &msg, sizeof(msg));
-		if (ret != sizeof(msg)) {
+		len = read(uffd.fd, msg, sizeof(msg));
+		if (len < (ssize_t) sizeof(*msg)) {
 			pthread_mutex_unlock(&mm_lock);
 			pthread_rwlock_unlock(&mm_list_rwlock);
-			if (errno != EAGAIN)
-				break;
-			continue;
+			if (len < 0 && errno == EAGAIN)
+				continue;
+			break;
 		}
 
-		switch (msg.event) {
-		case UFFD_EVENT_REMOVE:
-			ofi_monitor_unsubscribe(&uffd.monitor,
-				(void *) (uintptr_t) msg.arg.remove.start,
-				(size_t) (msg.arg.remove.end -
-					  msg.arg.remove.start), NULL);
-			/* fall through */
-		case UFFD_EVENT_UNMAP:
-			ofi_monitor_notify(&uffd.monitor,
-				(void *) (uintptr_t) msg.arg.remove.start,
-				(size_t) (msg.arg.remove.end -
-					  msg.arg.remove.start));
-			break;
-		case UFFD_EVENT_REMAP:
+		cnt = ofi_uffd_coalesce(msg, len / sizeof(*msg), range);
+		OFI_TRACE(uffd_read, len / sizeof(*msg), cnt);
+		for (i = 0; i < cnt; i++) {
+			OFI_TRACE(uffd_invalidate, range[i].start,
+				  range[i].end - range[i].start);
 			ofi_monitor_notify(&uffd.monitor,
-				(void *) (uintptr_t) msg.arg.remap.from,
-				(size_t) msg.arg.remap.len);
-			break;
-		default:
-			FI_WARN(&core_prov, FI_LOG_MR,
-				"Unhandled uffd event %d\n", msg.event);
-			break;
+					   (void *) range[i].start,
+					   range[i].end - range[i].start);
 		}
 		pthread_mutex_unlock(&mm_lock);
 		pthread_rwlock_unlock(&mm_list_rwlock);
@@ -639,15 +691,24 @@ static int ofi_uffd_start(struct ofi_mem_monitor *monitor)
 		goto closefd;
 	}
 
+	ret = fd_signal_init(&uffd.stop);
+	if (ret) {
+		FI_WARN(&core_prov, FI_LOG_MR,
+			"failed to create stop signal %s\n", fi_strerror(-ret));
+		goto closefd;
+	}
+
 	ret = pthread_create(&uffd.thread, NULL, ofi_uffd_handler, &uffd);
 	if (ret) {
 		FI_WARN(&core_prov, FI_LOG_MR,
 			"failed to create handler thread %s\n", strerror(ret));
 		ret = -ret;
-		goto closefd;
+		goto freesignal;
 	}
 	return 0;
 
+freesignal:
+	fd_signal_free(&uffd.stop);
 closefd:
 	close(uffd.fd);
 	return ret;
@@ -655,8 +716,9 @@ closefd:
 
 static void ofi_uffd_stop(struct ofi_mem_monitor *monitor)
 {
-	pthread_cancel(uffd.thread);
+	fd_signal_set(&uffd.stop);
 	pthread_join(uffd.thread, NULL);
+	fd_signal_free(&uffd.stop);
 	close(uffd.fd);
 }
 
@@ -121,6 +121,8 @@ static void util_mr_uncache_entry_storage(struct ofi_mr_cache *cache,
 	 * notification events, but is harmless to correct operation.
 	 */
 
+	OFI_TRACE(mr_cache_evict, cache, entry->info.iov.iov_base,
+		  entry->info.iov.iov_len, entry->use_cnt);
 	ofi_rbmap_delete(&cache->tree, entry->node);
 	entry->node = NULL;
 
@@ -367,6 +369,8 @@ int ofi_mr_cache_search(struct ofi_mr_cache *cache, const struct fi_mr_attr *att
 		}
 		pthread_mutex_unlock(&mm_lock);
 
+		OFI_TRACE(mr_cache_miss, cache, info.iov.iov_base,
+			  info.iov.iov_len);
 		ret = util_mr_cache_create(cache, &info, entry);
 		if (ret && ret != -FI_EAGAIN) {
 			if (ofi_mr_cache_flush(cache, true))
@@ -377,6 +381,7 @@ int ofi_mr_cache_search(struct ofi_mr_cache *cache, const struct fi_mr_attr *att
 	return ret;
 
 hit:
+	OFI_TRACE(mr_cache_hit, cache, info.iov.iov_base, info.iov.iov_len);
 	cache->hit_cnt++;
 	if ((*entry)->use_cnt++ == 0)
 		dlist_remove_init(&(*entry)->list_entry);
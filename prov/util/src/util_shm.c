@@ -465,6 +465,21 @@ void smr_exchange_all_peers(struct smr_region *region)
 		smr_map_to_endpoint(region, i);
 }
 
+static int smr_map_init_peer(const struct fi_provider *prov,
+			     struct smr_map *map, const char *name, int64_t id)
+{
+	int ret;
+
+	strncpy(map->peers[id].peer.name, name, SMR_NAME_MAX);
+	map->peers[id].peer.name[SMR_NAME_MAX - 1] = '\0';
+
+	ret = smr_map_to_region(prov, &map->peers[id]);
+	if (!ret)
+		map->peers[id].peer.id = id;
+
+	return ret == -ENOENT ? 0 : ret;
+}
+
 int smr_map_add(const struct fi_provider *prov, struct smr_map *map,
 		const char *name, int64_t *id)
 {
@@ -481,7 +496,7 @@ int smr_map_add(const struct fi_provider *prov, struct smr_map *map,
 		return 0;
 	}
 
-	while (map->peers[map->cur_id].peer.id != -1 &&
+	while (map->peers[map->cur_id].peer.name[0] &&
 	       tries < SMR_MAX_PEERS) {
 		if (++map->cur_id == SMR_MAX_PEERS)
 			map->cur_id = 0;
@@ -491,22 +506,37 @@ int smr_map_add(const struct fi_provider *prov, struct smr_map *map,
 	assert(map->cur_id < SMR_MAX_PEERS && tries < SMR_MAX_PEERS);
 	*id = map->cur_id;
 	node->data = (void *) (intptr_t) *id;
-	strncpy(map->peers[*id].peer.name, name, SMR_NAME_MAX);
-	map->peers[*id].peer.name[SMR_NAME_MAX - 1] = '\0';
+	ret = smr_map_init_peer(prov, map, name, *id);
+
+	ofi_spin_unlock(&map->lock);
+	return ret;
+}
 
-	ret = smr_map_to_region(prov, &map->peers[*id]);
+/* Adds a peer at the index it has in the map of another process, used
+ * when opening a shared AV.
+ */
+int smr_map_add_id(const struct fi_provider *prov, struct smr_map *map,
+		   const char *name, int64_t id)
+{
+	struct ofi_rbnode *node;
+	int ret;
+
+	assert(id >= 0 && id < SMR_MAX_PEERS);
+	ofi_spin_lock(&map->lock);
+	ret = ofi_rbmap_insert(&map->rbmap, (void *) name,
+			       (void *) (intptr_t) id, &node);
 	if (!ret)
-		map->peers[*id].peer.id = *id;
+		ret = smr_map_init_peer(prov, map, name, id);
 
 	ofi_spin_unlock(&map->lock);
-	return ret == -ENOENT ? 0 : ret;
+	return ret;
 }
 
 void smr_map_del(struct smr_map *map, int64_t id)
 {
 	struct dlist_entry *entry;
 
-	if (id >= SMR_MAX_PEERS || id < 0 || map->peers[id].peer.id < 0)
+	if (id >= SMR_MAX_PEERS || id < 0 || !map->peers[id].peer.name[0])
 		return;
 
 	pthread_mutex_lock(&ep_list_lock);
@@ -515,14 +545,14 @@ void smr_map_del(struct smr_map *map, int64_t id)
 	pthread_mutex_unlock(&ep_list_lock);
 
 	ofi_spin_lock(&map->lock);
-	if (!entry)
+	if (!entry && map->peers[id].peer.id >= 0)
 		munmap(map->peers[id].region, map->peers[id].region->total_size);
 
 	(void) ofi_rbmap_find_delete(&map->rbmap,
 				     (void *) map->peers[id].peer.name);
 
 	map->peers[id].fiaddr = FI_ADDR_UNSPEC;
-	map->peers[id].peer.id = -1;
+	smr_peer_addr_init(&map->peers[id].peer);
 
 	ofi_spin_unlock(&map->lock);
 }
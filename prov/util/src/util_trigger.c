@@ -0,0 +1,772 @@
+/*
+ * Copyright (c) 2026 libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <ofi_util.h>
+
+/*
+ * A trigger moves through three states.  It is QUEUED on both the domain
+ * list and its counter's threshold ordered list until the counter reaches
+ * the threshold.  The counter update marks it READY (removing it from the
+ * counter list), and the next call to ofi_trigger_progress() marks it
+ * ISSUED and posts the operation with the trigger as the op context.  An
+ * issued trigger is linked by cntr_entry into the domain's issued hash, so
+ * the provider's completion for that context is found by
+ * ofi_trigger_complete() without scanning pending work.  Completions for
+ * other contexts usually hash to an empty bucket and skip the lock.
+ */
+enum util_trigger_state {
+	UTIL_TRIGGER_QUEUED,
+	UTIL_TRIGGER_READY,
+	UTIL_TRIGGER_ISSUED,
+};
+
+struct util_trigger {
+	struct dlist_entry	entry;
+	struct dlist_entry	cntr_entry;
+	enum util_trigger_state	state;
+
+	uint64_t		threshold;
+	struct util_cntr	*cntr;
+	struct fid_cntr		*completion_cntr;
+	struct util_ep		*ep;
+	void			*context;
+	bool			report;
+
+	enum fi_op_type		op_type;
+	union {
+		struct fi_op_msg		msg;
+		struct fi_op_tagged		tagged;
+		struct fi_op_rma		rma;
+		struct fi_op_atomic		atomic;
+		struct fi_op_fetch_atomic	fetch_atomic;
+		struct fi_op_compare_atomic	compare_atomic;
+		struct fi_op_cntr		cntr;
+	} op;
+
+	union {
+		struct iovec		iov[OFI_TRIGGER_IOV_LIMIT];
+		struct fi_ioc		ioc[OFI_TRIGGER_IOV_LIMIT];
+	} msg_iov;
+	void			*desc[OFI_TRIGGER_IOV_LIMIT];
+	union {
+		struct fi_rma_iov	iov[OFI_TRIGGER_IOV_LIMIT];
+		struct fi_rma_ioc	ioc[OFI_TRIGGER_IOV_LIMIT];
+	} rma_iov;
+	struct fi_ioc		fetch_iov[OFI_TRIGGER_IOV_LIMIT];
+	void			*fetch_desc[OFI_TRIGGER_IOV_LIMIT];
+	struct fi_ioc		compare_iov[OFI_TRIGGER_IOV_LIMIT];
+	void			*compare_desc[OFI_TRIGGER_IOV_LIMIT];
+};
+
+#define UTIL_TRIGGER_PROGRESS_MAX 8
+
+static int util_trigger_copy_desc(void **dst, void **src, size_t count)
+{
+	if (count > OFI_TRIGGER_IOV_LIMIT)
+		return -FI_EINVAL;
+
+	if (src)
+		memcpy(dst, src, count * sizeof(*dst));
+	else
+		memset(dst, 0, count * sizeof(*dst));
+	return 0;
+}
+
+static void util_trigger_set_ep(struct util_trigger *trigger,
+				struct fid_ep *ep_fid, uint64_t op_flags,
+				bool rx)
+{
+	trigger->ep = container_of(ep_fid, struct util_ep, ep_fid);
+	trigger->report = ((rx ? trigger->ep->rx_msg_flags :
+			    trigger->ep->tx_msg_flags) | op_flags) &
+			  FI_COMPLETION;
+}
+
+static int util_trigger_copy_msg(struct util_trigger *trigger,
+				 const struct fi_op_msg *op, bool rx)
+{
+	if (op->msg.iov_count > OFI_TRIGGER_IOV_LIMIT)
+		return -FI_EINVAL;
+
+	trigger->op.msg = *op;
+	memcpy(trigger->msg_iov.iov, op->msg.msg_iov,
+	       op->msg.iov_count * sizeof(*op->msg.msg_iov));
+	trigger->op.msg.msg.msg_iov = trigger->msg_iov.iov;
+	trigger->op.msg.msg.desc = trigger->desc;
+	trigger->context = op->msg.context;
+	trigger->op.msg.msg.context = trigger;
+	util_trigger_set_ep(trigger, op->ep, op->flags, rx);
+	return util_trigger_copy_desc(trigger->desc, op->msg.desc,
+				      op->msg.iov_count);
+}
+
+static int util_trigger_copy_tagged(struct util_trigger *trigger,
+				    const struct fi_op_tagged *op, bool rx)
+{
+	if (op->msg.iov_count > OFI_TRIGGER_IOV_LIMIT)
+		return -FI_EINVAL;
+
+	trigger->op.tagged = *op;
+	memcpy(trigger->msg_iov.iov, op->msg.msg_iov,
+	       op->msg.iov_count * sizeof(*op->msg.msg_iov));
+	trigger->op.tagged.msg.msg_iov = trigger->msg_iov.iov;
+	trigger->op.tagged.msg.desc = trigger->desc;
+	trigger->context = op->msg.context;
+	trigger->op.tagged.msg.context = trigger;
+	util_trigger_set_ep(trigger, op->ep, op->flags, rx);
+	return util_trigger_copy_desc(trigger->desc, op->msg.desc,
+				      op->msg.iov_count);
+}
+
+static int util_trigger_copy_rma(struct util_trigger *trigger,
+				 const struct fi_op_rma *op)
+{
+	if (op->msg.iov_count > OFI_TRIGGER_IOV_LIMIT ||
+	    op->msg.rma_iov_count > OFI_TRIGGER_IOV_LIMIT)
+		return -FI_EINVAL;
+
+	trigger->op.rma = *op;
+	memcpy(trigger->msg_iov.iov, op->msg.msg_iov,
+	       op->msg.iov_count * sizeof(*op->msg.msg_iov));
+	memcpy(trigger->rma_iov.iov, op->msg.rma_iov,
+	       op->msg.rma_iov_count * sizeof(*op->msg.rma_iov));
+	trigger->op.rma.msg.msg_iov = trigger->msg_iov.iov;
+	trigger->op.rma.msg.rma_iov = trigger->rma_iov.iov;
+	trigger->op.rma.msg.desc = trigger->desc;
+	trigger->context = op->msg.context;
+	trigger->op.rma.msg.context = trigger;
+	util_trigger_set_ep(trigger, op->ep, op->flags, false);
+	return util_trigger_copy_desc(trigger->desc, op->msg.desc,
+				      op->msg.iov_count);
+}
+
+static int util_trigger_copy_atomic_msg(struct util_trigger *trigger,
+					struct fi_msg_atomic *dst,
+					const struct fi_msg_atomic *src)
+{
+	if (src->iov_count > OFI_TRIGGER_IOV_LIMIT ||
+	    src->rma_iov_count > OFI_TRIGGER_IOV_LIMIT)
+		return -FI_EINVAL;
+
+	memcpy(trigger->msg_iov.ioc, src->msg_iov,
+	       src->iov_count * sizeof(*src->msg_iov));
+	memcpy(trigger->rma_iov.ioc, src->rma_iov,
+	       src->rma_iov_count * sizeof(*src->rma_iov));
+	dst->msg_iov = trigger->msg_iov.ioc;
+	dst->rma_iov = trigger->rma_iov.ioc;
+	dst->desc = trigger->desc;
+	trigger->context = src->context;
+	dst->context = trigger;
+	return util_trigger_copy_desc(trigger->desc, src->desc,
+				      src->iov_count);
+}
+
+static int util_trigger_copy_ioc(struct fi_ioc *dst_iov, void **dst_desc,
+				 const struct fi_ioc *src_iov, void **src_desc,
+				 size_t count)
+{
+	if (count > OFI_TRIGGER_IOV_LIMIT)
+		return -FI_EINVAL;
+
+	memcpy(dst_iov, src_iov, count * sizeof(*src_iov));
+	return util_trigger_copy_desc(dst_desc, src_desc, count);
+}
+
+static int util_trigger_copy_op(struct util_trigger *trigger,
+				const struct fi_deferred_work *work)
+{
+	struct fi_op_fetch_atomic *fetch;
+	struct fi_op_compare_atomic *compare;
+	int ret;
+
+	switch (work->op_type) {
+	case FI_OP_RECV:
+		return util_trigger_copy_msg(trigger, work->op.msg, true);
+	case FI_OP_SEND:
+		return util_trigger_copy_msg(trigger, work->op.msg, false);
+	case FI_OP_TRECV:
+		return util_trigger_copy_tagged(trigger, work->op.tagged, true);
+	case FI_OP_TSEND:
+		return util_trigger_copy_tagged(trigger, work->op.tagged, false);
+	case FI_OP_READ:
+	case FI_OP_WRITE:
+		return util_trigger_copy_rma(trigger, work->op.rma);
+	case FI_OP_ATOMIC:
+		trigger->op.atomic = *work->op.atomic;
+		util_trigger_set_ep(trigger, work->op.atomic->ep,
+				    work->op.atomic->flags, false);
+		return util_trigger_copy_atomic_msg(trigger,
+						    &trigger->op.atomic.msg,
+						    &work->op.atomic->msg);
+	case FI_OP_FETCH_ATOMIC:
+		trigger->op.fetch_atomic = *work->op.fetch_atomic;
+		fetch = &trigger->op.fetch_atomic;
+		util_trigger_set_ep(trigger, fetch->ep, fetch->flags, false);
+		ret = util_trigger_copy_atomic_msg(trigger, &fetch->msg,
+						   &work->op.fetch_atomic->msg);
+		if (ret)
+			return ret;
+
+		fetch->fetch.msg_iov = trigger->fetch_iov;
+		fetch->fetch.desc = trigger->fetch_desc;
+		return util_trigger_copy_ioc(trigger->fetch_iov,
+				trigger->fetch_desc,
+				work->op.fetch_atomic->fetch.msg_iov,
+				work->op.fetch_atomic->fetch.desc,
+				work->op.fetch_atomic->fetch.iov_count);
+	case FI_OP_COMPARE_ATOMIC:
+		trigger->op.compare_atomic = *work->op.compare_atomic;
+		compare = &trigger->op.compare_atomic;
+		util_trigger_set_ep(trigger, compare->ep, compare->flags, false);
+		ret = util_trigger_copy_atomic_msg(trigger, &compare->msg,
+					&work->op.compare_atomic->msg);
+		if (ret)
+			return ret;
+
+		compare->fetch.msg_iov = trigger->fetch_iov;
+		compare->fetch.desc = trigger->fetch_desc;
+		ret = util_trigger_copy_ioc(trigger->fetch_iov,
+				trigger->fetch_desc,
+				work->op.compare_atomic->fetch.msg_iov,
+				work->op.compare_atomic->fetch.desc,
+				work->op.compare_atomic->fetch.iov_count);
+		if (ret)
+			return ret;
+
+		compare->compare.msg_iov = trigger->compare_iov;
+		compare->compare.desc = trigger->compare_desc;
+		return util_trigger_copy_ioc(trigger->compare_iov,
+				trigger->compare_desc,
+				work->op.compare_atomic->compare.msg_iov,
+				work->op.compare_atomic->compare.desc,
+				work->op.compare_atomic->compare.iov_count);
+	case FI_OP_CNTR_SET:
+	case FI_OP_CNTR_ADD:
+		trigger->op.cntr = *work->op.cntr;
+		return 0;
+	default:
+		return -FI_ENOSYS;
+	}
+}
+
+/* Caller holds domain->trigger_lock */
+static void util_trigger_check(struct util_cntr *cntr)
+{
+	struct util_trigger *trigger;
+	uint64_t value;
+
+	value = ofi_cntr_value(cntr);
+	while (!dlist_empty(&cntr->trigger_list)) {
+		trigger = container_of(cntr->trigger_list.next,
+				       struct util_trigger, cntr_entry);
+		if (trigger->threshold > value)
+			break;
+
+		dlist_remove(&trigger->cntr_entry);
+		trigger->state = UTIL_TRIGGER_READY;
+	}
+}
+
+static void util_trigger_insert(struct util_domain *domain,
+				struct util_trigger *trigger)
+{
+	struct util_trigger *prev;
+	struct dlist_entry *item;
+
+	ofi_mutex_lock(&domain->trigger_lock);
+	trigger->state = UTIL_TRIGGER_QUEUED;
+	dlist_insert_tail(&trigger->entry, &domain->trigger_list);
+	ofi_atomic_inc32(&domain->trigger_cnt);
+
+	/* Keep insertion order among equal thresholds */
+	dlist_foreach_reverse(&trigger->cntr->trigger_list, item) {
+		prev = container_of(item, struct util_trigger, cntr_entry);
+		if (prev->threshold <= trigger->threshold)
+			break;
+	}
+	dlist_insert_after(&trigger->cntr_entry, item);
+	util_trigger_check(trigger->cntr);
+	ofi_mutex_unlock(&domain->trigger_lock);
+}
+
+/* Caller holds domain->trigger_lock */
+static void util_trigger_set_issued(struct util_domain *domain,
+				    struct util_trigger *trigger)
+{
+	size_t i = ofi_trigger_hash(trigger);
+
+	trigger->state = UTIL_TRIGGER_ISSUED;
+	dlist_insert_tail(&trigger->cntr_entry, &domain->trigger_issued[i]);
+	ofi_atomic_inc32(&domain->trigger_issued_cnt[i]);
+}
+
+/* Caller holds domain->trigger_lock */
+static void util_trigger_clear_issued(struct util_domain *domain,
+				      struct util_trigger *trigger)
+{
+	dlist_remove(&trigger->cntr_entry);
+	ofi_atomic_dec32(&domain->trigger_issued_cnt[ofi_trigger_hash(trigger)]);
+}
+
+static void util_trigger_free(struct util_domain *domain,
+			      struct util_trigger *trigger)
+{
+	dlist_remove(&trigger->entry);
+	if (trigger->state == UTIL_TRIGGER_QUEUED)
+		dlist_remove(&trigger->cntr_entry);
+	else if (trigger->state == UTIL_TRIGGER_ISSUED)
+		util_trigger_clear_issued(domain, trigger);
+	ofi_atomic_dec32(&domain->trigger_cnt);
+	free(trigger);
+}
+
+static int util_trigger_alloc(struct util_domain *domain,
+			      const struct fi_deferred_work *work,
+			      struct util_trigger **trigger)
+{
+	struct util_cntr *cntr;
+	int ret;
+
+	if (!work->triggering_cntr)
+		return -FI_EINVAL;
+
+	cntr = container_of(work->triggering_cntr, struct util_cntr,
+			    cntr_fid);
+	if (cntr->domain != domain)
+		return -FI_EINVAL;
+
+	*trigger = calloc(1, sizeof(**trigger));
+	if (!*trigger)
+		return -FI_ENOMEM;
+
+	(*trigger)->threshold = work->threshold;
+	(*trigger)->cntr = cntr;
+	(*trigger)->completion_cntr = work->completion_cntr;
+	(*trigger)->op_type = work->op_type;
+	ret = util_trigger_copy_op(*trigger, work);
+	if (ret) {
+		free(*trigger);
+		return ret;
+	}
+	return 0;
+}
+
+int ofi_trigger_queue_work(struct util_domain *domain,
+			   struct fi_deferred_work *work)
+{
+	struct util_trigger *trigger;
+	int ret;
+
+	ret = util_trigger_alloc(domain, work, &trigger);
+	if (ret) {
+		FI_WARN(domain->prov, FI_LOG_DOMAIN,
+			"unable to queue deferred work: %s\n",
+			fi_strerror(-ret));
+		return ret;
+	}
+
+	util_trigger_insert(domain, trigger);
+	ofi_trigger_progress(domain);
+	return 0;
+}
+
+static ssize_t util_trigger_queue(struct fid_ep *ep_fid, void *context,
+				  struct fi_deferred_work *work)
+{
+	struct fi_triggered_context *trig_ctx = context;
+	struct util_ep *ep;
+
+	ep = container_of(ep_fid, struct util_ep, ep_fid);
+	if (!trig_ctx || trig_ctx->event_type != FI_TRIGGER_THRESHOLD)
+		return -FI_EINVAL;
+
+	work->triggering_cntr = trig_ctx->trigger.threshold.cntr;
+	work->threshold = trig_ctx->trigger.threshold.threshold;
+	work->completion_cntr = NULL;
+	return ofi_trigger_queue_work(ep->domain, work);
+}
+
+ssize_t ofi_trigger_msg(struct fid_ep *ep, const struct fi_msg *msg,
+			uint64_t flags, enum fi_op_type op_type)
+{
+	struct fi_deferred_work work = { .op_type = op_type };
+	struct fi_op_msg op = {
+		.ep = ep,
+		.msg = *msg,
+		.flags = flags & ~FI_TRIGGER,
+	};
+
+	work.op.msg = &op;
+	return util_trigger_queue(ep, msg->context, &work);
+}
+
+ssize_t ofi_trigger_tagged(struct fid_ep *ep, const struct fi_msg_tagged *msg,
+			   uint64_t flags, enum fi_op_type op_type)
+{
+	struct fi_deferred_work work = { .op_type = op_type };
+	struct fi_op_tagged op = {
+		.ep = ep,
+		.msg = *msg,
+		.flags = flags & ~FI_TRIGGER,
+	};
+
+	work.op.tagged = &op;
+	return util_trigger_queue(ep, msg->context, &work);
+}
+
+ssize_t ofi_trigger_rma(struct fid_ep *ep, const struct fi_msg_rma *msg,
+			uint64_t flags, enum fi_op_type op_type)
+{
+	struct fi_deferred_work work = { .op_type = op_type };
+	struct fi_op_rma op = {
+		.ep = ep,
+		.msg = *msg,
+		.flags = flags & ~FI_TRIGGER,
+	};
+
+	work.op.rma = &op;
+	return util_trigger_queue(ep, msg->context, &work);
+}
+
+ssize_t ofi_trigger_atomic(struct fid_ep *ep, const struct fi_msg_atomic *msg,
+			   struct fi_ioc *resultv, void **result_desc,
+			   size_t result_count, const struct fi_ioc *comparev,
+			   void **compare_desc, size_t compare_count,
+			   uint64_t flags, enum fi_op_type op_type)
+{
+	struct fi_deferred_work work = { .op_type = op_type };
+	struct fi_op_compare_atomic op = {
+		.ep = ep,
+		.msg = *msg,
+		.fetch = {
+			.msg_iov = resultv,
+			.desc = result_desc,
+			.iov_count = result_count,
+		},
+		.compare = {
+			.msg_iov = comparev,
+			.desc = compare_desc,
+			.iov_count = compare_count,
+		},
+		.flags = flags & ~FI_TRIGGER,
+	};
+	struct fi_op_fetch_atomic fetch_op = {
+		.ep = ep,
+		.msg = *msg,
+		.fetch = op.fetch,
+		.flags = op.flags,
+	};
+	struct fi_op_atomic atomic_op = {
+		.ep = ep,
+		.msg = *msg,
+		.flags = op.flags,
+	};
+
+	switch (op_type) {
+	case FI_OP_ATOMIC:
+		work.op.atomic = &atomic_op;
+		break;
+	case FI_OP_FETCH_ATOMIC:
+		work.op.fetch_atomic = &fetch_op;
+		break;
+	default:
+		assert(op_type == FI_OP_COMPARE_ATOMIC);
+		work.op.compare_atomic = &op;
+		break;
+	}
+	return util_trigger_queue(ep, msg->context, &work);
+}
+
+void ofi_trigger_check(struct util_cntr *cntr)
+{
+	ofi_mutex_lock(&cntr->domain->trigger_lock);
+	util_trigger_check(cntr);
+	ofi_mutex_unlock(&cntr->domain->trigger_lock);
+}
+
+static ssize_t util_trigger_issue(struct util_trigger *trigger)
+{
+	struct fi_op_fetch_atomic *fetch;
+	struct fi_op_compare_atomic *compare;
+	uint64_t flags;
+
+	switch (trigger->op_type) {
+	case FI_OP_RECV:
+		flags = trigger->op.msg.flags | FI_COMPLETION;
+		return fi_recvmsg(trigger->op.msg.ep, &trigger->op.msg.msg,
+				  flags);
+	case FI_OP_SEND:
+		flags = trigger->op.msg.flags | FI_COMPLETION;
+		return fi_sendmsg(trigger->op.msg.ep, &trigger->op.msg.msg,
+				  flags);
+	case FI_OP_TRECV:
+		flags = trigger->op.tagged.flags | FI_COMPLETION;
+		return fi_trecvmsg(trigger->op.tagged.ep,
+				   &trigger->op.tagged.msg, flags);
+	case FI_OP_TSEND:
+		flags = trigger->op.tagged.flags | FI_COMPLETION;
+		return fi_tsendmsg(trigger->op.tagged.ep,
+				   &trigger->op.tagged.msg, flags);
+	case FI_OP_READ:
+		flags = trigger->op.rma.flags | FI_COMPLETION;
+		return fi_readmsg(trigger->op.rma.ep, &trigger->op.rma.msg,
+				  flags);
+	case FI_OP_WRITE:
+		flags = trigger->op.rma.flags | FI_COMPLETION;
+		return fi_writemsg(trigger->op.rma.ep, &trigger->op.rma.msg,
+				   flags);
+	case FI_OP_ATOMIC:
+		flags = trigger->op.atomic.flags | FI_COMPLETION;
+		return fi_atomicmsg(trigger->op.atomic.ep,
+				    &trigger->op.atomic.msg, flags);
+	case FI_OP_FETCH_ATOMIC:
+		fetch = &trigger->op.fetch_atomic;
+		return fi_fetch_atomicmsg(fetch->ep, &fetch->msg,
+					  fetch->fetch.msg_iov,
+					  fetch->fetch.desc,
+					  fetch->fetch.iov_count,
+					  fetch->flags | FI_COMPLETION);
+	case FI_OP_COMPARE_ATOMIC:
+		compare = &trigger->op.compare_atomic;
+		return fi_compare_atomicmsg(compare->ep, &compare->msg,
+					    compare->compare.msg_iov,
+					    compare->compare.desc,
+					    compare->compare.iov_count,
+					    compare->fetch.msg_iov,
+					    compare->fetch.desc,
+					    compare->fetch.iov_count,
+					    compare->flags | FI_COMPLETION);
+	case FI_OP_CNTR_SET:
+		return fi_cntr_set(trigger->op.cntr.cntr,
+				   trigger->op.cntr.value);
+	case FI_OP_CNTR_ADD:
+		return fi_cntr_add(trigger->op.cntr.cntr,
+				   trigger->op.cntr.value);
+	default:
+		assert(0);
+		return -FI_ENOSYS;
+	}
+}
+
+static void util_trigger_progress_cntr(struct util_cntr *cntr)
+{
+	struct util_ep *ep;
+	struct fid_list_entry *fid_entry;
+	struct dlist_entry *item;
+
+	ofi_mutex_lock(&cntr->ep_list_lock);
+	dlist_foreach(&cntr->ep_list, item) {
+		fid_entry = container_of(item, struct fid_list_entry, entry);
+		ep = container_of(fid_entry->fid, struct util_ep, ep_fid.fid);
+		if (ep->progress)
+			ep->progress(ep);
+	}
+	ofi_mutex_unlock(&cntr->ep_list_lock);
+}
+
+static void util_trigger_add_target(void **targets, size_t *count,
+				    void *target)
+{
+	size_t i;
+
+	for (i = 0; i < *count; i++) {
+		if (targets[i] == target)
+			return;
+	}
+
+	if (*count < UTIL_TRIGGER_PROGRESS_MAX)
+		targets[(*count)++] = target;
+}
+
+static void util_trigger_run(struct util_domain *domain,
+			     struct util_trigger *trigger)
+{
+	struct fid_cntr *cntr = trigger->completion_cntr;
+	bool async = trigger->ep != NULL;
+	ssize_t ret;
+
+	/* Data ops may complete, and release the trigger, before returning */
+	ret = util_trigger_issue(trigger);
+	if (!ret && async)
+		return;
+
+	ofi_mutex_lock(&domain->trigger_lock);
+	if (ret == -FI_EAGAIN) {
+		util_trigger_clear_issued(domain, trigger);
+		trigger->state = UTIL_TRIGGER_READY;
+		ofi_mutex_unlock(&domain->trigger_lock);
+		return;
+	}
+	util_trigger_free(domain, trigger);
+	ofi_mutex_unlock(&domain->trigger_lock);
+
+	if (ret) {
+		FI_WARN(domain->prov, FI_LOG_DOMAIN,
+			"triggered op failed: %s\n", fi_strerror((int) -ret));
+		if (cntr)
+			fi_cntr_adderr(cntr, 1);
+	} else if (cntr) {
+		fi_cntr_add(cntr, 1);
+	}
+}
+
+/*
+ * Issue ready work and drive progress on behalf of pending work.  Queued
+ * work may be waiting on a counter that is only updated by progressing the
+ * endpoints bound to it, and issued work needs its endpoint progressed to
+ * complete.  The application is not required to drive either directly.
+ * Work made ready while this runs is picked up by the next call.
+ */
+void ofi_trigger_progress(struct util_domain *domain)
+{
+	struct util_trigger *ready[UTIL_TRIGGER_PROGRESS_MAX];
+	void *cntrs[UTIL_TRIGGER_PROGRESS_MAX];
+	void *eps[UTIL_TRIGGER_PROGRESS_MAX];
+	struct util_trigger *trigger;
+	struct dlist_entry *item;
+	size_t ready_cnt = 0, cntr_cnt = 0, ep_cnt = 0, i;
+
+	if (!ofi_trigger_pending(domain))
+		return;
+
+	ofi_mutex_lock(&domain->trigger_lock);
+	dlist_foreach(&domain->trigger_list, item) {
+		trigger = container_of(item, struct util_trigger, entry);
+		switch (trigger->state) {
+		case UTIL_TRIGGER_QUEUED:
+			util_trigger_add_target(cntrs, &cntr_cnt, trigger->cntr);
+			break;
+		case UTIL_TRIGGER_READY:
+			if (ready_cnt == UTIL_TRIGGER_PROGRESS_MAX)
+				break;
+			util_trigger_set_issued(domain, trigger);
+			ready[ready_cnt++] = trigger;
+			break;
+		case UTIL_TRIGGER_ISSUED:
+			if (trigger->ep && trigger->ep->progress)
+				util_trigger_add_target(eps, &ep_cnt,
+							trigger->ep);
+			break;
+		}
+	}
+	ofi_mutex_unlock(&domain->trigger_lock);
+
+	for (i = 0; i < ready_cnt; i++)
+		util_trigger_run(domain, ready[i]);
+	for (i = 0; i < cntr_cnt; i++)
+		util_trigger_progress_cntr(cntrs[i]);
+	for (i = 0; i < ep_cnt; i++)
+		((struct util_ep *) eps[i])->progress(eps[i]);
+}
+
+/*
+ * Called from the util CQ write paths when ofi_trigger_issued().  Only
+ * the context pointer is compared, never dereferenced, so application
+ * contexts are safe to pass through.  Returns true if the completion must
+ * not be reported to the application.
+ */
+bool ofi_trigger_complete(struct util_domain *domain, void **context,
+			  uint64_t err)
+{
+	struct util_trigger *trigger;
+	struct dlist_entry *item;
+	struct fid_cntr *cntr;
+	bool suppress;
+
+	ofi_mutex_lock(&domain->trigger_lock);
+	dlist_foreach(&domain->trigger_issued[ofi_trigger_hash(*context)],
+		      item) {
+		trigger = container_of(item, struct util_trigger, cntr_entry);
+		if (trigger == *context)
+			goto found;
+	}
+	ofi_mutex_unlock(&domain->trigger_lock);
+	return false;
+
+found:
+	*context = trigger->context;
+	suppress = !err && !trigger->report;
+	cntr = trigger->completion_cntr;
+	util_trigger_free(domain, trigger);
+	ofi_mutex_unlock(&domain->trigger_lock);
+
+	if (cntr) {
+		if (err)
+			fi_cntr_adderr(cntr, 1);
+		else
+			fi_cntr_add(cntr, 1);
+	}
+	return suppress;
+}
+
+void ofi_trigger_cleanup_cntr(struct util_cntr *cntr)
+{
+	struct util_trigger *trigger;
+
+	ofi_mutex_lock(&cntr->domain->trigger_lock);
+	while (!dlist_empty(&cntr->trigger_list)) {
+		trigger = container_of(cntr->trigger_list.next,
+				       struct util_trigger, cntr_entry);
+		util_trigger_free(cntr->domain, trigger);
+	}
+	ofi_mutex_unlock(&cntr->domain->trigger_lock);
+}
+
+void ofi_trigger_cleanup_ep(struct util_ep *ep)
+{
+	struct util_trigger *trigger;
+	struct dlist_entry *item, *tmp;
+
+	ofi_mutex_lock(&ep->domain->trigger_lock);
+	dlist_foreach_safe(&ep->domain->trigger_list, item, tmp) {
+		trigger = container_of(item, struct util_trigger, entry);
+		if (trigger->ep == ep)
+			util_trigger_free(ep->domain, trigger);
+	}
+	ofi_mutex_unlock(&ep->domain->trigger_lock);
+}
+
+void ofi_trigger_cleanup_domain(struct util_domain *domain)
+{
+	struct util_trigger *trigger;
+
+	ofi_mutex_lock(&domain->trigger_lock);
+	while (!dlist_empty(&domain->trigger_list)) {
+		trigger = container_of(domain->trigger_list.next,
+				       struct util_trigger, entry);
+		util_trigger_free(domain, trigger);
+	}
+	ofi_mutex_unlock(&domain->trigger_lock);
+}
@@ -593,9 +593,11 @@ static int util_wait_yield_run(struct fid_wait *wait_fid, int timeout)
 {
 	struct util_wait_yield *wait;
 	struct ofi_wait_fid_entry *fid_entry;
+	uint64_t endtime;
 	int ret = 0;
 
 	wait = container_of(wait_fid, struct util_wait_yield, util_wait.wait_fid);
+	endtime = ofi_timeout_time(timeout);
 	while (!wait->signal) {
 		ofi_mutex_lock(&wait->util_wait.lock);
 		dlist_foreach_container(&wait->util_wait.fid_list,
@@ -608,6 +610,8 @@ static int util_wait_yield_run(struct fid_wait *wait_fid, int timeout)
 			}
 		}
 		ofi_mutex_unlock(&wait->util_wait.lock);
+		if (ofi_adjust_timeout(endtime, &timeout))
+			return -FI_ETIMEDOUT;
 		sched_yield();
 	}
 
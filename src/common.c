@@ -84,6 +84,7 @@ struct ofi_common_locks common_locks = {
 };
 
 size_t ofi_universe_size = 1024;
+size_t ofi_cntr_shards = 0;
 int ofi_poll_fairness = 0;
 
 
@@ -96,29 +97,17 @@ int ofi_genlock_init(struct ofi_genlock *lock,
 	switch (lock->lock_type) {
 	case OFI_LOCK_SPINLOCK:
 		ret = ofi_spin_init(&lock->base.spinlock);
-		lock->lock = (ofi_genlock_lockop_t) ofi_spin_lock_op;
-		lock->unlock = (ofi_genlock_lockop_t) ofi_spin_unlock_op;
-		lock->held = (ofi_genlock_lockheld_t) ofi_spin_held_op;
 		break;
 	case OFI_LOCK_MUTEX:
 		ret = ofi_mutex_init(&lock->base.mutex);
-		lock->lock = (ofi_genlock_lockop_t) ofi_mutex_lock_op;
-		lock->unlock = (ofi_genlock_lockop_t) ofi_mutex_unlock_op;
-		lock->held = (ofi_genlock_lockheld_t) ofi_mutex_held_op;
 		break;
 	case OFI_LOCK_NOOP:
 		/* Use mutex for debug no-op support */
 		ret = ofi_mutex_init(&lock->base.mutex);
-		lock->lock = (ofi_genlock_lockop_t) ofi_mutex_lock_noop;
-		lock->unlock = (ofi_genlock_lockop_t) ofi_mutex_unlock_noop;
-		lock->held = (ofi_genlock_lockheld_t) ofi_mutex_held_op;
 		break;
 	case OFI_LOCK_NONE:
 		ret = 0;
 		lock->base.nolock = NULL;
-		lock->lock = (ofi_genlock_lockop_t) ofi_nolock_lock_op;
-		lock->unlock = (ofi_genlock_lockop_t) ofi_nolock_unlock_op;
-		lock->held = (ofi_genlock_lockheld_t) ofi_nolock_held_op;
 		break;
 	default:
 		ret = -FI_EINVAL;
@@ -1260,6 +1249,12 @@ ssize_t ofi_bsock_sendv(struct ofi_bsock *bsock, const struct iovec *iov,
 	return ret;
 }
 
+/* Reads shorter than this are staged through rq. */
+static inline size_t ofi_bsock_prefetch_limit(struct ofi_bsock *bsock)
+{
+	return MIN(bsock->rq.size >> 1, bsock->rx_prefetch);
+}
+
 ssize_t ofi_bsock_recv(struct ofi_bsock *bsock, void *buf, size_t len)
 {
 	size_t bytes;
@@ -1267,6 +1262,7 @@ ssize_t ofi_bsock_recv(struct ofi_bsock *bsock, void *buf, size_t len)
 
 	bytes = ofi_byteq_read(&bsock->rq, buf, len);
 	if (bytes) {
+		bsock->rx_bounce_bytes += bytes;
 		if (bytes == len)
 			return len;
 		buf = (char *) buf + bytes;
@@ -1274,19 +1270,23 @@ ssize_t ofi_bsock_recv(struct ofi_bsock *bsock, void *buf, size_t len)
 	}
 
 	assert(!ofi_bsock_readable(bsock));
-	if (len < (bsock->rq.size >> 1)) {
-		ret = ofi_byteq_recv(&bsock->rq, bsock->sock);
+	if (len < ofi_bsock_prefetch_limit(bsock)) {
+		ret = ofi_byteq_recv(&bsock->rq, bsock->sock,
+				     bsock->rx_prefetch);
 		if (ret <= 0)
 			goto out;
 
 		assert(ofi_bsock_readable(bsock));
-		bytes += ofi_byteq_read(&bsock->rq, buf, len);
-		return bytes;
+		ret = ofi_byteq_read(&bsock->rq, buf, len);
+		bsock->rx_bounce_bytes += ret;
+		return bytes + ret;
 	}
 
 	ret = ofi_recv_socket(bsock->sock, buf, len, MSG_NOSIGNAL);
-	if (ret > 0)
+	if (ret > 0) {
+		bsock->rx_direct_bytes += ret;
 		return bytes + ret;
+	}
 
 out:
 	if (bytes)
@@ -1306,6 +1306,7 @@ ssize_t ofi_bsock_recvv(struct ofi_bsock *bsock, struct iovec *iov, size_t cnt)
 	len = ofi_total_iov_len(iov, cnt);
 	if (ofi_byteq_readable(&bsock->rq)) {
 		bytes = ofi_byteq_readv(&bsock->rq, iov, cnt, 0);
+		bsock->rx_bounce_bytes += bytes;
 		if (bytes == len)
 			return len;
 
@@ -1315,14 +1316,16 @@ ssize_t ofi_bsock_recvv(struct ofi_bsock *bsock, struct iovec *iov, size_t cnt)
 	}
 
 	assert(!ofi_bsock_readable(bsock));
-	if (len < (bsock->rq.size >> 1)) {
-		ret = ofi_byteq_recv(&bsock->rq, bsock->sock);
+	if (len < ofi_bsock_prefetch_limit(bsock)) {
+		ret = ofi_byteq_recv(&bsock->rq, bsock->sock,
+				     bsock->rx_prefetch);
 		if (ret <= 0)
 			goto out;
 
 		assert(ofi_bsock_readable(bsock));
-		bytes += ofi_byteq_readv(&bsock->rq, iov, cnt, bytes);
-		return bytes;
+		ret = ofi_byteq_readv(&bsock->rq, iov, cnt, bytes);
+		bsock->rx_bounce_bytes += ret;
+		return bytes + ret;
 	}
 
 	/* It's too difficult to adjust the iov without copying it, so return
@@ -1340,8 +1343,10 @@ ssize_t ofi_bsock_recvv(struct ofi_bsock *bsock, struct iovec *iov, size_t cnt)
 	msg.msg_iovlen = cnt;
 
 	ret = ofi_recvmsg_tcp(bsock->sock, &msg, MSG_NOSIGNAL);
-	if (ret > 0)
+	if (ret > 0) {
+		bsock->rx_direct_bytes += ret;
 		return ret;
+	}
 out:
 	if (bytes)
 		return bytes;
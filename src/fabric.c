@@ -827,6 +827,15 @@ void fi_ini(void)
 			"(default: provider specific)");
 	fi_param_get_size_t(NULL, "universe_size", &ofi_universe_size);
 
+	fi_param_define(NULL, "cntr_shards", FI_PARAM_SIZE_T,
+			"Number of shards that counter increments are spread "
+			"across, rounded up to a power of two.  Reduces "
+			"contention when many threads complete operations on "
+			"the same counter, at the cost of slower reads.  Used "
+			"by providers built on the util counter (default: 0, "
+			"disabled)");
+	fi_param_get_size_t(NULL, "cntr_shards", &ofi_cntr_shards);
+
 	fi_param_define(NULL, "poll_fairness", FI_PARAM_INT,
 			"This counter value controls calling poll() on a list "
 			"of sockets and file descriptors and is most relevant "
@@ -882,6 +891,8 @@ FI_DESTRUCTOR(fi_fini(void))
 	if (!ofi_init)
 		goto unlock;
 
+	/* Buffered log messages may reference provider memory */
+	fi_log_fini();
 	while (prov_head) {
 		prov = prov_head;
 		prov_head = prov->next;
@@ -893,7 +904,6 @@ FI_DESTRUCTOR(fi_fini(void))
 	ofi_hmem_cleanup();
 	ofi_hook_fini();
 	ofi_mem_fini();
-	fi_log_fini();
 	fi_param_fini();
 	ofi_osd_fini();
 
@@ -39,14 +39,141 @@
 #include <assert.h>
 #include <ofi_indexer.h>
 
+/*
+ * Index tree - shared storage for the indexer and index map
+ *
+ * Interior nodes hold OFI_IDX_CHUNK_SIZE child pointers; leaves hold
+ * OFI_IDX_CHUNK_SIZE entries of the caller's type.  The root pointer is
+ * tagged with the tree height.  The tree grows upward by installing a new
+ * root whose first slot is the old root, and downward by installing
+ * missing children.  Both steps are a single compare-and-swap, so any
+ * number of writers may extend the tree concurrently.  The loser of a
+ * race frees its node and uses the winner's.
+ *
+ * Nodes are only released by ofi_idx_tree_free(), so a reader that has
+ * loaded a node pointer can keep using it without further synchronization.
+ */
+
+static void **ofi_idx_tree_node(uintptr_t tagged)
+{
+	return (void **) (tagged & ~OFI_IDX_HEIGHT_MASK);
+}
+
+static int ofi_idx_tree_height(uintptr_t tagged)
+{
+	return (int) (tagged & OFI_IDX_HEIGHT_MASK);
+}
+
+static uintptr_t ofi_idx_tree_tag(void *node, int height)
+{
+	assert(!((uintptr_t) node & OFI_IDX_HEIGHT_MASK));
+	return (uintptr_t) node | height;
+}
+
+static uintptr_t ofi_idx_tree_grow(void **root, int index, size_t leaf_size)
+{
+	uintptr_t tagged, new_root;
+	void **node;
+	int height;
+
+	for (;;) {
+		tagged = (uintptr_t) ofi_atomic_load_ptr(root);
+		height = ofi_idx_tree_height(tagged);
+		if (tagged && !((unsigned int) index >>
+				(height * OFI_IDX_OFFSET_BITS)))
+			return tagged;
+
+		if (!tagged) {
+			node = calloc(OFI_IDX_CHUNK_SIZE, leaf_size);
+			if (!node)
+				return 0;
+		} else {
+			node = calloc(OFI_IDX_CHUNK_SIZE, sizeof(void *));
+			if (!node)
+				return 0;
+			node[0] = ofi_idx_tree_node(tagged);
+		}
+
+		new_root = ofi_idx_tree_tag(node, height + 1);
+		if (!ofi_atomic_cas_ptr(root, (void *) tagged, (void *) new_root))
+			free(node);
+	}
+}
+
+void *ofi_idx_tree_leaf(void **root, int index, size_t leaf_size)
+{
+	uintptr_t tagged;
+	void **node, **slot, *child;
+	int level;
+
+	if (index < 0 || index >= OFI_IDX_MAX_INDEX)
+		goto nomem;
+
+	tagged = ofi_idx_tree_grow(root, index, leaf_size);
+	if (!tagged)
+		goto nomem;
+
+	node = ofi_idx_tree_node(tagged);
+	for (level = ofi_idx_tree_height(tagged) - 1; level > 0; level--) {
+		slot = &node[ofi_idx_offset(index >>
+					    (level * OFI_IDX_OFFSET_BITS))];
+		child = ofi_atomic_load_ptr(slot);
+		if (!child) {
+			child = calloc(OFI_IDX_CHUNK_SIZE, level > 1 ?
+				       sizeof(void *) : leaf_size);
+			if (!child)
+				goto nomem;
+			if (!ofi_atomic_cas_ptr(slot, NULL, child)) {
+				free(child);
+				child = ofi_atomic_load_ptr(slot);
+			}
+		}
+		node = child;
+	}
+	return node;
+
+nomem:
+	errno = ENOMEM;
+	return NULL;
+}
+
+static void ofi_idx_node_free(void **node, int level,
+			      void (*callback)(void *leaf, void *arg),
+			      void *arg)
+{
+	int i;
+
+	if (level) {
+		for (i = 0; i < OFI_IDX_CHUNK_SIZE; i++) {
+			if (node[i])
+				ofi_idx_node_free(node[i], level - 1,
+						  callback, arg);
+		}
+	} else if (callback) {
+		callback(node, arg);
+	}
+	free(node);
+}
+
+void ofi_idx_tree_free(void **root, void (*callback)(void *leaf, void *arg),
+		       void *arg)
+{
+	uintptr_t tagged = (uintptr_t) *root;
+
+	if (!tagged)
+		return;
+
+	*root = NULL;
+	ofi_idx_node_free(ofi_idx_tree_node(tagged),
+			  ofi_idx_tree_height(tagged) - 1, callback, arg);
+}
+
 /*
  * Indexer - to find a structure given an index
  *
- * We store pointers using a double lookup and return an index to the
- * user which is then used to retrieve the pointer.  The upper bits of
- * the index are itself an index into an array of memory allocations.
- * The lower bits specify the offset into the allocated memory where
- * the pointer is stored.
+ * We store pointers in the leaves of an index tree and return an index
+ * to the user which is then used to retrieve the pointer.  Leaves are
+ * added in index order, so the number of leaves bounds the valid indices.
  *
  * This allows us to adjust the number of pointers stored by the index
  * list without taking a lock during data lookups.
@@ -57,15 +184,15 @@ static int ofi_idx_grow(struct indexer *idx)
 	struct ofi_idx_entry *chunk;
 	int i, start_index;
 
-	if (idx->size >= OFI_IDX_MAX_CHUNKS)
+	start_index = idx->size * OFI_IDX_CHUNK_SIZE;
+	if (start_index >= OFI_IDX_MAX_INDEX)
 		goto nomem;
 
-	idx->chunk[idx->size] = calloc(OFI_IDX_CHUNK_SIZE, sizeof(struct ofi_idx_entry));
-	if (!idx->chunk[idx->size])
+	chunk = ofi_idx_tree_leaf(&idx->root, start_index,
+				  sizeof(struct ofi_idx_entry));
+	if (!chunk)
 		goto nomem;
 
-	chunk = idx->chunk[idx->size];
-	start_index = idx->size * OFI_IDX_CHUNK_SIZE;
 	chunk[OFI_IDX_CHUNK_SIZE - 1].next = idx->free_list;
 
 	for (i = OFI_IDX_CHUNK_SIZE - 2; i >= 0; i--)
@@ -113,28 +240,32 @@ void *ofi_idx_remove(struct indexer *idx, int index)
 	return item;
 }
 
+static struct ofi_idx_entry *ofi_idx_get_entry(struct indexer *idx, int index)
+{
+	return ofi_idx_chunk(idx, index) + ofi_idx_offset(index);
+}
+
 void *ofi_idx_remove_ordered(struct indexer *idx, int index)
 {
-	struct ofi_idx_entry *chunk;
+	struct ofi_idx_entry *entry, *temp;
 	void *item;
-	int temp_index;
-	int offset = ofi_idx_offset(index);
 
-	chunk = ofi_idx_chunk(idx, index);
-	item = chunk[offset].item;
-	chunk[offset].item = NULL;
+	entry = ofi_idx_get_entry(idx, index);
+	item = entry->item;
+	entry->item = NULL;
 	if (ofi_idx_free_list_empty(idx) || index < idx->free_list) {
-		chunk[offset].next = idx->free_list;
+		entry->next = idx->free_list;
 		idx->free_list = index;
 		return item;
 	}
-	temp_index = idx->free_list;
-	while (chunk[ofi_idx_offset(temp_index)].next < index) {
-		temp_index = chunk[ofi_idx_offset(temp_index)].next;
-	}
-	chunk[offset].next = chunk[ofi_idx_offset(temp_index)].next;
-	chunk[ofi_idx_offset(temp_index)].next = index;
 
+	/* Free list entries may live in any chunk */
+	temp = ofi_idx_get_entry(idx, idx->free_list);
+	while (temp->next && temp->next < index)
+		temp = ofi_idx_get_entry(idx, temp->next);
+
+	entry->next = temp->next;
+	temp->next = index;
 	return item;
 }
 
@@ -148,46 +279,20 @@ void ofi_idx_replace(struct indexer *idx, int index, void *item)
 
 void ofi_idx_reset(struct indexer *idx)
 {
-	while (idx->size) {
-		free(idx->chunk[idx->size - 1]);
-		idx->chunk[idx->size - 1] = NULL;
-		idx->size--;
-	}
+	ofi_idx_tree_free(&idx->root, NULL, NULL);
+	idx->size = 0;
 	idx->free_list = 0;
 }
 
-static int ofi_idm_grow(struct index_map *idm, int index)
-{
-	assert(!ofi_idm_chunk(idm, index));
-	idm->chunk[ofi_idx_chunk_id(index)] = calloc(OFI_IDX_CHUNK_SIZE,
-						     sizeof(void *));
-	if (!idm->chunk[ofi_idx_chunk_id(index)])
-		goto nomem;
-
-	return index;
-
-nomem:
-	errno = ENOMEM;
-	return -1;
-}
-
 int ofi_idm_set(struct index_map *idm, int index, void *item)
 {
 	void **chunk;
 
-	if (index > OFI_IDX_MAX_INDEX) {
-		errno = ENOMEM;
+	chunk = ofi_idx_tree_leaf(&idm->root, index, sizeof(void *));
+	if (!chunk)
 		return -1;
-	}
 
-	if (!ofi_idm_chunk(idm, index)) {
-		if (ofi_idm_grow(idm, index) < 0)
-			return -1;
-	}
-
-	chunk = ofi_idm_chunk(idm, index);
-	chunk[ofi_idx_offset(index)] = item;
-	idm->count[ofi_idx_chunk_id(index)]++;
+	ofi_atomic_store_ptr(&chunk[ofi_idx_offset(index)], item);
 	return index;
 }
 
@@ -197,38 +302,28 @@ void *ofi_idm_clear(struct index_map *idm, int index)
 	void *item;
 
 	chunk = ofi_idm_chunk(idm, index);
-	item = chunk[ofi_idx_offset(index)];
-	chunk[ofi_idx_offset(index)] = NULL;
-	if (--idm->count[ofi_idx_chunk_id(index)] == 0) {
-		free(chunk);
-		idm->chunk[ofi_idx_chunk_id(index)] = NULL;
-	}
+	if (!chunk)
+		return NULL;
+
+	item = ofi_atomic_load_ptr(&chunk[ofi_idx_offset(index)]);
+	ofi_atomic_store_ptr(&chunk[ofi_idx_offset(index)], NULL);
 	return item;
 }
 
-void ofi_idm_reset(struct index_map *idm, void (*callback)(void *item))
+static void ofi_idm_reset_chunk(void *leaf, void *arg)
 {
-	void **chunk;
-	void *item;
-	int c, i;
-
-	for (c = 0; c < OFI_IDX_MAX_CHUNKS; c++) {
-		if (!idm->chunk[c]) {
-			assert(idm->count[c] == 0);
-			continue;
-		}
+	void (*callback)(void *item) = *(void (**)(void *)) arg;
+	void **chunk = leaf;
+	int i;
 
-		chunk = idm->chunk[c];
-		for (i = 0; idm->count[c] && i < OFI_IDX_CHUNK_SIZE; i++) {
-			item = chunk[i];
-			if (item) {
-				if (callback)
-					callback(item);
-				idm->count[c]--;
-			}
-		}
-		free(chunk);
-		idm->chunk[c] = NULL;
+	for (i = 0; i < OFI_IDX_CHUNK_SIZE; i++) {
+		if (chunk[i])
+			callback(chunk[i]);
 	}
 }
 
+void ofi_idm_reset(struct index_map *idm, void (*callback)(void *item))
+{
+	ofi_idx_tree_free(&idm->root, callback ? ofi_idm_reset_chunk : NULL,
+			  &callback);
+}
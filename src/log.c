@@ -33,6 +33,7 @@
  *
  */
 
+#include <ctype.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -103,6 +104,737 @@ static int fi_convert_log_str(const char *value)
 	return 0;
 }
 
+/*
+ * Asynchronous logging
+ *
+ * With FI_LOG_ASYNC enabled, fi_log() does not format messages.  It copies
+ * the call site, a timestamp and the raw arguments of each message into a
+ * ring owned by the calling thread.  A background thread formats the
+ * messages of all rings in timestamp order and writes them to stderr.
+ * Messages are dropped while a ring is full, and the number dropped is
+ * reported by the background thread.  Messages left in the rings are
+ * written when the library is finalized.
+ *
+ * String arguments are copied, other arguments are copied by value, so
+ * the format string, function name and provider must outlive the message.
+ * Messages with conversions that cannot be copied, such as %n or %m, are
+ * formatted by the calling thread and copied as a string.
+ */
+#ifndef _WIN32
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <x86intrin.h>
+#define ofi_log_tsc() __rdtsc()
+#else
+#define ofi_log_tsc() ofi_gettime_ns()
+#endif
+
+#define OFI_LOG_ASYNC_MAX_ARGS	128
+#define OFI_LOG_ASYNC_INTERVAL	10000	/* usec between ring drains */
+
+enum {
+	OFI_LOG_ARG_NONE,
+	OFI_LOG_ARG_INT,
+	OFI_LOG_ARG_UINT,
+	OFI_LOG_ARG_CHAR,
+	OFI_LOG_ARG_DOUBLE,
+	OFI_LOG_ARG_STR,
+	OFI_LOG_ARG_PTR,
+	OFI_LOG_ARG_INVALID,
+};
+
+/* A conversion specification of a format string */
+struct ofi_log_spec {
+	const char	*start;
+	size_t		len;
+	size_t		mod_off;	/* offset of the length modifier */
+	int		stars;
+	int		prec_star;
+	int		prec;		/* -1 if no precision is given */
+	int		type;
+	char		mod[3];
+};
+
+/* Records are 8 byte aligned.  A record without provider pads the ring
+ * up to its end.  A record without format holds a formatted message.
+ */
+struct ofi_log_rec {
+	uint32_t			size;
+	int				line;
+	uint64_t			tsc;
+	const struct fi_provider	*prov;
+	const char			*func;
+	const char			*fmt;
+	const char			*prefix;
+	uint32_t			level;
+	uint32_t			subsys;
+	uint64_t			args[];
+};
+
+/* Single producer, the owning thread, and single consumer ring */
+struct ofi_log_ring {
+	struct dlist_entry	entry;
+	char			*buf;
+	size_t			size;
+	uint64_t		head;
+	uint64_t		tail;
+	uint64_t		dropped;
+	uint64_t		reported;
+	ofi_atomic32_t		exited;
+	int			tid;
+};
+
+static struct {
+	int			enabled;
+	ofi_atomic32_t		running;
+	size_t			ring_size;
+	pthread_t		thread;
+	pthread_key_t		key;
+	pthread_mutex_t		lock;
+	struct dlist_entry	rings;
+	int			ring_cnt;
+	uint64_t		tsc_start;
+	uint64_t		ns_start;
+	uint64_t		realtime_start;
+	double			ns_per_tick;
+} log_async = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static const char *ofi_log_parse_spec(const char *fmt,
+				      struct ofi_log_spec *spec)
+{
+	const char *p = fmt + 1;
+	int i = 0;
+
+	spec->start = fmt;
+	spec->stars = 0;
+	spec->prec_star = 0;
+	spec->prec = -1;
+
+	while (*p && strchr("-+ #0'I", *p))
+		p++;
+	if (*p == '*') {
+		spec->stars++;
+		p++;
+	} else {
+		while (isdigit((unsigned char) *p))
+			p++;
+	}
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			spec->stars++;
+			spec->prec_star = 1;
+			p++;
+		} else {
+			spec->prec = atoi(p);
+			while (isdigit((unsigned char) *p))
+				p++;
+		}
+	}
+
+	spec->mod_off = p - fmt;
+	while (*p && strchr("hlqjztL", *p) && i < 2)
+		spec->mod[i++] = *p++;
+	spec->mod[i] = '\0';
+
+	switch (*p) {
+	case '%':
+		spec->type = i ? OFI_LOG_ARG_INVALID : OFI_LOG_ARG_NONE;
+		break;
+	case 'd':
+	case 'i':
+		spec->type = OFI_LOG_ARG_INT;
+		break;
+	case 'o':
+	case 'u':
+	case 'x':
+	case 'X':
+		spec->type = OFI_LOG_ARG_UINT;
+		break;
+	case 'c':
+		spec->type = i ? OFI_LOG_ARG_INVALID : OFI_LOG_ARG_CHAR;
+		break;
+	case 'e':
+	case 'E':
+	case 'f':
+	case 'F':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		spec->type = strchr(spec->mod, 'L') ? OFI_LOG_ARG_INVALID :
+			     OFI_LOG_ARG_DOUBLE;
+		break;
+	case 's':
+		spec->type = i ? OFI_LOG_ARG_INVALID : OFI_LOG_ARG_STR;
+		break;
+	case 'p':
+		spec->type = i ? OFI_LOG_ARG_INVALID : OFI_LOG_ARG_PTR;
+		break;
+	default:
+		spec->type = OFI_LOG_ARG_INVALID;
+		break;
+	}
+
+	if (*p)
+		p++;
+	spec->len = p - fmt;
+	return p;
+}
+
+static int64_t ofi_log_int_arg(const char *mod, va_list *vargs)
+{
+	if (!strcmp(mod, "hh"))
+		return (signed char) va_arg(*vargs, int);
+	if (!strcmp(mod, "h"))
+		return (short) va_arg(*vargs, int);
+	if (!strcmp(mod, "l"))
+		return va_arg(*vargs, long);
+	if (!strcmp(mod, "ll") || !strcmp(mod, "q"))
+		return va_arg(*vargs, long long);
+	if (!strcmp(mod, "j"))
+		return va_arg(*vargs, intmax_t);
+	if (!strcmp(mod, "z"))
+		return (ssize_t) va_arg(*vargs, size_t);
+	if (!strcmp(mod, "t"))
+		return va_arg(*vargs, ptrdiff_t);
+	return va_arg(*vargs, int);
+}
+
+static uint64_t ofi_log_uint_arg(const char *mod, va_list *vargs)
+{
+	if (!strcmp(mod, "hh"))
+		return (unsigned char) va_arg(*vargs, unsigned int);
+	if (!strcmp(mod, "h"))
+		return (unsigned short) va_arg(*vargs, unsigned int);
+	if (!strcmp(mod, "l"))
+		return va_arg(*vargs, unsigned long);
+	if (!strcmp(mod, "ll") || !strcmp(mod, "q"))
+		return va_arg(*vargs, unsigned long long);
+	if (!strcmp(mod, "j"))
+		return va_arg(*vargs, uintmax_t);
+	if (!strcmp(mod, "z"))
+		return va_arg(*vargs, size_t);
+	if (!strcmp(mod, "t"))
+		return (uint64_t) va_arg(*vargs, ptrdiff_t);
+	return va_arg(*vargs, unsigned int);
+}
+
+/* Strings are stored as their length, followed by the characters */
+static size_t ofi_log_copy_str(uint64_t *args, size_t max, const char *str,
+			       size_t len)
+{
+	size_t words = 1 + (len + sizeof(*args)) / sizeof(*args);
+
+	if (words > max)
+		return 0;
+
+	args[0] = len;
+	memcpy(&args[1], str, len);
+	((char *) &args[1])[len] = '\0';
+	return words;
+}
+
+/* Returns the number of words written to args, or 0 if the arguments
+ * cannot be copied.
+ */
+static size_t ofi_log_encode(uint64_t *args, size_t max, const char *fmt,
+			     va_list *vargs)
+{
+	struct ofi_log_spec spec;
+	const char *str;
+	size_t n = 0, words;
+	int i, star;
+	union {
+		double		d;
+		uint64_t	u;
+	} val;
+
+	while ((fmt = strchr(fmt, '%'))) {
+		fmt = ofi_log_parse_spec(fmt, &spec);
+		if (spec.type == OFI_LOG_ARG_NONE)
+			continue;
+		if (spec.type == OFI_LOG_ARG_INVALID ||
+		    n + spec.stars + 1 > max)
+			return 0;
+
+		for (i = 0; i < spec.stars; i++) {
+			star = va_arg(*vargs, int);
+			args[n++] = (int64_t) star;
+			if (spec.prec_star && i == spec.stars - 1)
+				spec.prec = star;
+		}
+
+		switch (spec.type) {
+		case OFI_LOG_ARG_INT:
+			args[n++] = (uint64_t) ofi_log_int_arg(spec.mod, vargs);
+			break;
+		case OFI_LOG_ARG_UINT:
+			args[n++] = ofi_log_uint_arg(spec.mod, vargs);
+			break;
+		case OFI_LOG_ARG_CHAR:
+			args[n++] = (uint64_t) va_arg(*vargs, int);
+			break;
+		case OFI_LOG_ARG_DOUBLE:
+			val.d = va_arg(*vargs, double);
+			args[n++] = val.u;
+			break;
+		case OFI_LOG_ARG_PTR:
+			args[n++] = (uintptr_t) va_arg(*vargs, void *);
+			break;
+		case OFI_LOG_ARG_STR:
+			str = va_arg(*vargs, const char *);
+			if (!str)
+				str = "(null)";
+			words = ofi_log_copy_str(&args[n], max - n, str,
+				spec.prec >= 0 ? strnlen(str, spec.prec) :
+						 strlen(str));
+			if (!words)
+				return 0;
+			n += words;
+			break;
+		}
+	}
+	return n;
+}
+
+#define OFI_LOG_SNPRINTF(buf, len, spec, stars, arg)			\
+	((spec.stars == 2) ?						\
+		snprintf(buf, len, spec_str, (int) stars[0],		\
+			 (int) stars[1], arg) :				\
+	 (spec.stars == 1) ?						\
+		snprintf(buf, len, spec_str, (int) stars[0], arg) :	\
+		snprintf(buf, len, spec_str, arg))
+
+static void ofi_log_decode(char *buf, size_t len, const char *fmt,
+			   const uint64_t *args)
+{
+	struct ofi_log_spec spec;
+	char spec_str[64];
+	const uint64_t *stars;
+	const char *next;
+	size_t off = 0;
+	int ret;
+	union {
+		double		d;
+		uint64_t	u;
+	} val;
+
+	while (off < len - 1) {
+		next = strchr(fmt, '%');
+		if (!next) {
+			ofi_strncatf(buf + off, len - off, "%s", fmt);
+			return;
+		}
+
+		ret = snprintf(buf + off, len - off, "%.*s",
+			       (int) (next - fmt), fmt);
+		off += ret;
+		if (off >= len - 1)
+			return;
+
+		fmt = ofi_log_parse_spec(next, &spec);
+		if (spec.type == OFI_LOG_ARG_NONE) {
+			buf[off++] = '%';
+			buf[off] = '\0';
+			continue;
+		}
+		if (spec.mod_off + 4 > sizeof(spec_str))
+			return;
+
+		/* integers are passed as long long */
+		memcpy(spec_str, spec.start, spec.mod_off);
+		snprintf(spec_str + spec.mod_off, sizeof(spec_str) - spec.mod_off,
+			 "%s%c", (spec.type == OFI_LOG_ARG_INT ||
+				  spec.type == OFI_LOG_ARG_UINT) ? "ll" : "",
+			 spec.start[spec.len - 1]);
+
+		stars = args;
+		args += spec.stars;
+		switch (spec.type) {
+		case OFI_LOG_ARG_INT:
+			ret = OFI_LOG_SNPRINTF(buf + off, len - off, spec, stars,
+					       (long long) *args);
+			args++;
+			break;
+		case OFI_LOG_ARG_UINT:
+			ret = OFI_LOG_SNPRINTF(buf + off, len - off, spec, stars,
+					       (unsigned long long) *args);
+			args++;
+			break;
+		case OFI_LOG_ARG_CHAR:
+			ret = OFI_LOG_SNPRINTF(buf + off, len - off, spec, stars,
+					       (int) *args);
+			args++;
+			break;
+		case OFI_LOG_ARG_DOUBLE:
+			val.u = *args++;
+			ret = OFI_LOG_SNPRINTF(buf + off, len - off, spec, stars,
+					       val.d);
+			break;
+		case OFI_LOG_ARG_PTR:
+			ret = OFI_LOG_SNPRINTF(buf + off, len - off, spec, stars,
+					       (void *) (uintptr_t) *args);
+			args++;
+			break;
+		case OFI_LOG_ARG_STR:
+			ret = OFI_LOG_SNPRINTF(buf + off, len - off, spec, stars,
+					       (const char *) &args[1]);
+			args += 1 + (args[0] + sizeof(*args)) / sizeof(*args);
+			break;
+		default:
+			return;
+		}
+		if (ret < 0)
+			return;
+		off += ret;
+	}
+}
+
+static void ofi_log_ring_free(void *arg)
+{
+	struct ofi_log_ring *ring = arg;
+
+	/* freed by the log thread once drained */
+	ofi_atomic_set32(&ring->exited, 1);
+}
+
+static struct ofi_log_ring *ofi_log_ring_get(void)
+{
+	struct ofi_log_ring *ring;
+
+	ring = pthread_getspecific(log_async.key);
+	if (ring)
+		return ring;
+
+	ring = calloc(1, sizeof(*ring));
+	if (!ring)
+		return NULL;
+
+	ofi_atomic_initialize32(&ring->exited, 0);
+	ring->size = log_async.ring_size;
+	ring->buf = malloc(ring->size);
+	if (!ring->buf) {
+		free(ring);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&log_async.lock);
+	ring->tid = ++log_async.ring_cnt;
+	dlist_insert_tail(&ring->entry, &log_async.rings);
+	pthread_mutex_unlock(&log_async.lock);
+	pthread_setspecific(log_async.key, ring);
+	return ring;
+}
+
+static void ofi_log_async(const struct fi_provider *prov,
+			  enum fi_log_level level, enum fi_log_subsys subsys,
+			  const char *func, int line, const char *fmt,
+			  va_list vargs)
+{
+	uint64_t args[OFI_LOG_ASYNC_MAX_ARGS];
+	struct ofi_log_ring *ring;
+	struct ofi_log_rec *rec;
+	size_t words, size, off;
+	uint64_t tsc, head, tail;
+	va_list copy;
+
+	tsc = ofi_log_tsc();
+	ring = ofi_log_ring_get();
+	if (!ring)
+		return;
+
+	va_copy(copy, vargs);
+	words = ofi_log_encode(args, OFI_LOG_ASYNC_MAX_ARGS, fmt, &copy);
+	va_end(copy);
+	if (!words) {
+		vsnprintf((char *) &args[1], sizeof(args) - sizeof(args[0]),
+			  fmt, vargs);
+		args[0] = strlen((char *) &args[1]);
+		words = 1 + (args[0] + sizeof(args[0])) / sizeof(args[0]);
+		fmt = NULL;
+	}
+
+	size = sizeof(*rec) + words * sizeof(args[0]);
+	head = ring->head;
+	tail = ofi_atomic_load_u64(&ring->tail);
+	off = head & (ring->size - 1);
+
+	/* records do not wrap around the end of the ring */
+	if (ring->size - off < size) {
+		if (ring->size - (head - tail) < ring->size - off + size)
+			goto drop;
+
+		/* a tail too short for a header is skipped by the reader */
+		if (ring->size - off >= sizeof(*rec)) {
+			rec = (struct ofi_log_rec *) (ring->buf + off);
+			rec->size = ring->size - off;
+			rec->prov = NULL;
+		}
+		head += ring->size - off;
+		off = 0;
+	} else if (ring->size - (head - tail) < size) {
+		goto drop;
+	}
+
+	rec = (struct ofi_log_rec *) (ring->buf + off);
+	rec->size = size;
+	rec->line = line;
+	rec->tsc = tsc;
+	rec->prov = prov;
+	rec->func = func;
+	rec->fmt = fmt;
+	rec->prefix = log_prefix;
+	rec->level = level;
+	rec->subsys = subsys;
+	memcpy(rec->args, args, words * sizeof(args[0]));
+	ofi_atomic_store_u64(&ring->head, head + size);
+	return;
+
+drop:
+	ofi_atomic_store_u64(&ring->dropped, ring->dropped + 1);
+}
+
+static uint64_t ofi_log_realtime_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static uint64_t ofi_log_tsc_to_ns(uint64_t tsc)
+{
+	return log_async.realtime_start + (uint64_t)
+	       ((double) (tsc - log_async.tsc_start) * log_async.ns_per_tick);
+}
+
+static void ofi_log_write_rec(struct ofi_log_rec *rec)
+{
+	char msg[1024];
+	uint64_t ns;
+
+	if (rec->fmt) {
+		msg[0] = '\0';
+		ofi_log_decode(msg, sizeof(msg), rec->fmt, rec->args);
+	} else {
+		snprintf(msg, sizeof(msg), "%s", (char *) &rec->args[1]);
+	}
+
+	ns = ofi_log_tsc_to_ns(rec->tsc);
+	fprintf(stderr, "%s:%d:%lu.%06lu:%s:%s:%s:%s():%d<%s> %s",
+		PACKAGE, pid, (unsigned long) (ns / 1000000000),
+		(unsigned long) (ns % 1000000000 / 1000), rec->prefix,
+		rec->prov->name, log_subsys[rec->subsys], rec->func,
+		rec->line, log_levels[rec->level], msg);
+}
+
+/* Returns the next record of the ring, skipping padding */
+static struct ofi_log_rec *ofi_log_ring_peek(struct ofi_log_ring *ring)
+{
+	struct ofi_log_rec *rec;
+	uint64_t head;
+	size_t off;
+
+	head = ofi_atomic_load_u64(&ring->head);
+	while (ring->tail != head) {
+		off = ring->tail & (ring->size - 1);
+		if (ring->size - off < sizeof(*rec)) {
+			ofi_atomic_store_u64(&ring->tail,
+					     ring->tail + ring->size - off);
+			continue;
+		}
+		rec = (struct ofi_log_rec *) (ring->buf + off);
+		if (rec->prov)
+			return rec;
+		ofi_atomic_store_u64(&ring->tail, ring->tail + rec->size);
+	}
+	return NULL;
+}
+
+static void ofi_log_update_clock(void)
+{
+	uint64_t ticks;
+
+	ticks = ofi_log_tsc() - log_async.tsc_start;
+	if (ticks)
+		log_async.ns_per_tick = (double) (ofi_gettime_ns() -
+				       log_async.ns_start) / ticks;
+}
+
+/* Writes the messages in all rings, merged in timestamp order */
+static void ofi_log_drain(void)
+{
+	struct ofi_log_ring *ring, *next_ring;
+	struct ofi_log_rec *rec, *next_rec;
+	struct dlist_entry *tmp;
+	uint64_t dropped, ns;
+
+	ofi_log_update_clock();
+	pthread_mutex_lock(&log_async.lock);
+	for (;;) {
+		next_ring = NULL;
+		next_rec = NULL;
+		dlist_foreach_container(&log_async.rings, struct ofi_log_ring,
+					ring, entry) {
+			rec = ofi_log_ring_peek(ring);
+			if (rec && (!next_rec || rec->tsc < next_rec->tsc)) {
+				next_ring = ring;
+				next_rec = rec;
+			}
+		}
+		if (!next_rec)
+			break;
+
+		ofi_log_write_rec(next_rec);
+		ofi_atomic_store_u64(&next_ring->tail,
+				     next_ring->tail + next_rec->size);
+	}
+
+	dlist_foreach_container_safe(&log_async.rings, struct ofi_log_ring,
+				     ring, entry, tmp) {
+		dropped = ofi_atomic_load_u64(&ring->dropped);
+		if (dropped != ring->reported) {
+			ns = ofi_log_tsc_to_ns(ofi_log_tsc());
+			fprintf(stderr, "%s:%d:%lu.%06lu::core:core:%s():%d<warn> "
+				"%" PRIu64 " log messages dropped by thread %d\n",
+				PACKAGE, pid, (unsigned long) (ns / 1000000000),
+				(unsigned long) (ns % 1000000000 / 1000),
+				__func__, __LINE__, dropped - ring->reported,
+				ring->tid);
+			ring->reported = dropped;
+		}
+
+		if (ofi_atomic_get32(&ring->exited) &&
+		    !ofi_log_ring_peek(ring)) {
+			dlist_remove(&ring->entry);
+			free(ring->buf);
+			free(ring);
+		}
+	}
+	pthread_mutex_unlock(&log_async.lock);
+	fflush(stderr);
+}
+
+static void *ofi_log_thread(void *arg)
+{
+	while (ofi_atomic_get32(&log_async.running)) {
+		usleep(OFI_LOG_ASYNC_INTERVAL);
+		ofi_log_drain();
+	}
+	return NULL;
+}
+
+/* The log thread does not exist in the child.  Messages inherited from
+ * the parent are discarded, as the parent writes them.
+ */
+static void ofi_log_async_atfork_child(void)
+{
+	struct ofi_log_ring *ring;
+
+	pid = getpid();
+	pthread_mutex_init(&log_async.lock, NULL);
+	dlist_foreach_container(&log_async.rings, struct ofi_log_ring,
+				ring, entry) {
+		ring->tail = ring->head;
+		ring->reported = ring->dropped;
+	}
+
+	if (pthread_create(&log_async.thread, NULL, ofi_log_thread, NULL))
+		log_async.enabled = 0;
+}
+
+static void ofi_log_async_init(void)
+{
+	size_t size = 1 << 20;
+	int enable = 0;
+
+	fi_param_define(NULL, "log_async", FI_PARAM_BOOL,
+			"Copy log messages to per thread buffers, and format "
+			"and write them from a background thread (default: no)");
+	fi_param_define(NULL, "log_async_size", FI_PARAM_SIZE_T,
+			"Size in bytes of the per thread buffers used by "
+			"asynchronous logging (default: %zu)", size);
+	fi_param_get_bool(NULL, "log_async", &enable);
+	if (!enable)
+		return;
+
+	fi_param_get_size_t(NULL, "log_async_size", &size);
+	log_async.ring_size = roundup_power_of_two(MAX(size, 4096));
+	dlist_init(&log_async.rings);
+	log_async.tsc_start = ofi_log_tsc();
+	log_async.ns_start = ofi_gettime_ns();
+	log_async.realtime_start = ofi_log_realtime_ns();
+	log_async.ns_per_tick = 1.0;
+	ofi_atomic_initialize32(&log_async.running, 1);
+
+	if (pthread_key_create(&log_async.key, ofi_log_ring_free))
+		goto err;
+
+	if (pthread_create(&log_async.thread, NULL, ofi_log_thread, NULL)) {
+		pthread_key_delete(log_async.key);
+		goto err;
+	}
+
+	pthread_atfork(NULL, NULL, ofi_log_async_atfork_child);
+	log_async.enabled = 1;
+	return;
+err:
+	fprintf(stderr, "%s:%d::%s:core:core:%s():%d<warn> unable to start "
+		"asynchronous logging\n", PACKAGE, pid, log_prefix,
+		__func__, __LINE__);
+}
+
+/* Messages may reference memory of providers, so this must be called
+ * before providers are unloaded.
+ */
+static void ofi_log_async_fini(void)
+{
+	struct ofi_log_ring *ring;
+	struct dlist_entry *tmp;
+
+	if (!log_async.enabled)
+		return;
+
+	log_async.enabled = 0;
+	ofi_atomic_set32(&log_async.running, 0);
+	pthread_join(log_async.thread, NULL);
+	ofi_log_drain();
+
+	dlist_foreach_container_safe(&log_async.rings, struct ofi_log_ring,
+				     ring, entry, tmp) {
+		dlist_remove(&ring->entry);
+		free(ring->buf);
+		free(ring);
+	}
+	pthread_key_delete(log_async.key);
+}
+
+#else /* _WIN32 */
+
+static struct {
+	int	enabled;
+} log_async;
+
+static void ofi_log_async(const struct fi_provider *prov,
+			  enum fi_log_level level, enum fi_log_subsys subsys,
+			  const char *func, int line, const char *fmt,
+			  va_list vargs)
+{
+}
+
+static void ofi_log_async_init(void)
+{
+}
+
+static void ofi_log_async_fini(void)
+{
+}
+
+#endif /* _WIN32 */
+
 void fi_log_init(void)
 {
 	struct fi_filter subsys_filter;
@@ -136,6 +868,7 @@ void fi_log_init(void)
 	}
 	ofi_free_filter(&subsys_filter);
 	pid = getpid();
+	ofi_log_async_init();
 }
 
 static int ofi_log_enabled(const struct fi_provider *prov,
@@ -313,6 +1046,7 @@ void ofi_tostr_log_subsys(char *buf, size_t len, enum fi_log_subsys subsys)
 
 void fi_log_fini(void)
 {
+	ofi_log_async_fini();
 	ofi_free_filter(&prov_log_filter);
 }
 
@@ -357,6 +1091,14 @@ void DEFAULT_SYMVER_PRE(fi_log)(const struct fi_provider *prov, enum fi_log_leve
 	int size = 0;
 	va_list vargs;
 
+	/* Loggers imported through fi_open take precedence */
+	if (log_async.enabled && log_fid.ops->log == ofi_log) {
+		va_start(vargs, fmt);
+		ofi_log_async(prov, level, subsys, func, line, fmt, vargs);
+		va_end(vargs);
+		return;
+	}
+
 	va_start(vargs, fmt);
 	vsnprintf(msg + size, sizeof(msg) - size, fmt, vargs);
 	va_end(vargs);
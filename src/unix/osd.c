@@ -140,12 +140,14 @@ int ofi_unmap_anon_pages(void *memptr, size_t size)
 	return FI_SUCCESS;
 }
 
-int ofi_shm_map(struct util_shm *shm, const char *name, size_t size,
-		int readonly, void **mapped)
+int ofi_shm_map_flags(struct util_shm *shm, const char *name, size_t size,
+		      int flags, void **mapped)
 {
 	char *fname = 0;
 	int i, ret = FI_SUCCESS;
-	int flags = O_RDWR | (readonly ? 0 : O_CREAT);
+	int oflags = (flags & OFI_SHM_RDONLY) ? O_RDONLY : O_RDWR;
+	int prot = PROT_READ | ((flags & OFI_SHM_RDONLY) ? 0 : PROT_WRITE);
+	bool created = false;
 	struct stat mapstat;
 	int fname_size = 0;
 
@@ -168,11 +170,34 @@ int ofi_shm_map(struct util_shm *shm, const char *name, size_t size,
 	FI_DBG(&core_prov, FI_LOG_CORE,
 		"Creating shm segment :%s (size: %lu)\n", fname, size);
 
-	shm->shared_fd = shm_open(fname, flags, S_IRUSR | S_IWUSR);
+	/* Create exclusively first, so that a failure below only removes
+	 * a segment created by this call.
+	 */
+	shm->shared_fd = -1;
+	if (flags & OFI_SHM_CREATE) {
+		shm->shared_fd = shm_open(fname, oflags | O_CREAT | O_EXCL,
+					  S_IRUSR | S_IWUSR);
+		if (shm->shared_fd >= 0) {
+			created = true;
+		} else if (errno != EEXIST) {
+			FI_WARN(&core_prov, FI_LOG_CORE, "shm_open failed\n");
+			ret = -FI_EINVAL;
+			goto failed;
+		} else if (flags & OFI_SHM_EXCL) {
+			FI_WARN(&core_prov, FI_LOG_CORE,
+				"shm segment %s already exists\n", fname);
+			ret = -FI_EBUSY;
+			goto failed;
+		}
+	}
+
 	if (shm->shared_fd < 0) {
-		FI_WARN(&core_prov, FI_LOG_CORE, "shm_open failed\n");
-		ret = -FI_EINVAL;
-		goto failed;
+		shm->shared_fd = shm_open(fname, oflags, S_IRUSR | S_IWUSR);
+		if (shm->shared_fd < 0) {
+			FI_WARN(&core_prov, FI_LOG_CORE, "shm_open failed\n");
+			ret = -FI_EINVAL;
+			goto failed;
+		}
 	}
 
 	if (fstat(shm->shared_fd, &mapstat)) {
@@ -182,7 +207,7 @@ int ofi_shm_map(struct util_shm *shm, const char *name, size_t size,
 		goto failed;
 	}
 
-	if (mapstat.st_size == 0) {
+	if (mapstat.st_size == 0 && !(flags & OFI_SHM_RDONLY)) {
 		if (ftruncate(shm->shared_fd, size)) {
 			FI_WARN(&core_prov, FI_LOG_CORE,
 				"ftruncate failed: %s\n", strerror(errno));
@@ -195,8 +220,7 @@ int ofi_shm_map(struct util_shm *shm, const char *name, size_t size,
 		goto failed;
 	}
 
-	shm->ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
-				MAP_SHARED, shm->shared_fd, 0);
+	shm->ptr = mmap(NULL, size, prot, MAP_SHARED, shm->shared_fd, 0);
 	if (shm->ptr == MAP_FAILED) {
 		FI_WARN(&core_prov, FI_LOG_CORE,
 			"mmap failed: %s\n", strerror(errno));
@@ -209,16 +233,23 @@ int ofi_shm_map(struct util_shm *shm, const char *name, size_t size,
 	return ret;
 
 failed:
-	if (shm->shared_fd >= 0) {
+	if (shm->shared_fd >= 0)
 		close(shm->shared_fd);
+	if (created)
 		shm_unlink(fname);
-	}
 	if (fname)
 		free(fname);
 	memset(shm, 0, sizeof(*shm));
 	return ret;
 }
 
+int ofi_shm_map(struct util_shm *shm, const char *name, size_t size,
+		int readonly, void **mapped)
+{
+	return ofi_shm_map_flags(shm, name, size,
+				 readonly ? 0 : OFI_SHM_CREATE, mapped);
+}
+
 int ofi_shm_unmap(struct util_shm* shm)
 {
 	if (shm->ptr && shm->ptr != MAP_FAILED) {
@@ -231,14 +231,15 @@ BOOL WINAPI DllMain(HINSTANCE instance, DWORD reason, LPVOID reserved)
 	return TRUE;
 }
 
-int ofi_shm_map(struct util_shm *shm, const char *name, size_t size,
-	int readonly, void **mapped)
+int ofi_shm_map_flags(struct util_shm *shm, const char *name, size_t size,
+		      int flags, void **mapped)
 {
 	int ret = FI_SUCCESS;
 	char *fname = 0;
 	size_t len = lstrlenA(name) + sizeof(ofi_shm_prefix);
 	LARGE_INTEGER large = {.QuadPart = size};
-	DWORD access = FILE_MAP_READ | (readonly ? 0 : FILE_MAP_WRITE);
+	DWORD access = FILE_MAP_READ |
+		       ((flags & OFI_SHM_RDONLY) ? 0 : FILE_MAP_WRITE);
 
 	ZeroMemory(shm, sizeof(*shm));
 
@@ -252,7 +253,7 @@ int ofi_shm_map(struct util_shm *shm, const char *name, size_t size,
 	lstrcpyA(fname, ofi_shm_prefix);
 	lstrcatA(fname, name);
 
-	if (!readonly) {
+	if (flags & OFI_SHM_CREATE) {
 		shm->shared_fd = CreateFileMappingA(INVALID_HANDLE_VALUE, 0,
 			PAGE_READWRITE, large.HighPart, large.LowPart,
 			shm->name);
@@ -261,7 +262,14 @@ int ofi_shm_map(struct util_shm *shm, const char *name, size_t size,
 			ret = -FI_EINVAL;
 			goto fn_nofilemap;
 		}
-	} else { /* readonly */
+		if ((flags & OFI_SHM_EXCL) &&
+		    GetLastError() == ERROR_ALREADY_EXISTS) {
+			FI_WARN(&core_prov, FI_LOG_CORE,
+				"shm segment %s already exists\n", shm->name);
+			ret = -FI_EBUSY;
+			goto fn_nomap;
+		}
+	} else {
 		shm->shared_fd = OpenFileMappingA(access, FALSE, shm->name);
 		if (!shm->shared_fd) {
 			FI_WARN(&core_prov, FI_LOG_CORE, "OpenFileMapping failed\n");
@@ -293,6 +301,14 @@ fn_nomem:
 	return ret;
 }
 
+int ofi_shm_map(struct util_shm *shm, const char *name, size_t size,
+	int readonly, void **mapped)
+{
+	return ofi_shm_map_flags(shm, name, size,
+				 readonly ? OFI_SHM_RDONLY : OFI_SHM_CREATE,
+				 mapped);
+}
+
 int ofi_shm_unmap(struct util_shm *shm)
 {
 	if (shm->name)
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2026 libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under the BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Reverse lookup benchmark for util AVs.
+ *
+ * Fills the AV of a util-based provider with IPv4 addresses, then has
+ * each thread resolve random addresses with ofi_av_lookup_fi_addr(), the
+ * call providers make per received packet for FI_SOURCE.  With -u the
+ * lookups use the function callers make while holding the AV lock.
+ * With -w, another thread inserts and removes other addresses meanwhile,
+ * reusing entries and growing the index.  Every lookup is checked against
+ * the fi_addr returned by the insert.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <rdma/fabric.h>
+#include <rdma/fi_domain.h>
+#include <ofi_util.h>
+
+static struct util_av *av;
+static struct sockaddr_in *addrs;
+static fi_addr_t *fi_addrs;
+static int num_addr = 1 << 20;
+static int iterations = 1 << 22;
+static int unlocked;
+static int churn;
+static volatile int done;
+
+struct lookup_thread {
+	pthread_t thread;
+	unsigned int seed;
+	uint64_t errors;
+};
+
+static double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *lookup_thread(void *arg)
+{
+	struct lookup_thread *lt = arg;
+	fi_addr_t fi_addr;
+	int i, n;
+
+	for (i = 0; i < iterations; i++) {
+		n = rand_r(&lt->seed) % num_addr;
+		fi_addr = unlocked ?
+			  ofi_av_lookup_fi_addr_unsafe(av, &addrs[n]) :
+			  ofi_av_lookup_fi_addr(av, &addrs[n]);
+		if (fi_addr != fi_addrs[n])
+			lt->errors++;
+	}
+	return NULL;
+}
+
+static void *churn_thread(void *arg)
+{
+	struct fid_av *av_fid = arg;
+	struct sockaddr_in *extra;
+	fi_addr_t *extra_fi_addrs;
+	int i, n = num_addr / 4 + 1, ret;
+
+	extra = calloc(n, sizeof(*extra));
+	extra_fi_addrs = calloc(n, sizeof(*extra_fi_addrs));
+	if (!extra || !extra_fi_addrs)
+		exit(EXIT_FAILURE);
+
+	for (i = 0; i < n; i++) {
+		extra[i].sin_family = AF_INET;
+		extra[i].sin_addr.s_addr = htonl(0x0b000000 + i);
+		extra[i].sin_port = htons(4096);
+	}
+
+	while (!done) {
+		for (i = 0; i < n && !done; i++) {
+			ret = fi_av_insert(av_fid, &extra[i], 1,
+					   &extra_fi_addrs[i], 0, NULL);
+			if (ret != 1)
+				exit(EXIT_FAILURE);
+		}
+		ret = fi_av_remove(av_fid, extra_fi_addrs, i, 0);
+		if (ret)
+			exit(EXIT_FAILURE);
+	}
+
+	free(extra_fi_addrs);
+	free(extra);
+	return NULL;
+}
+
+static void usage(const char *argv0)
+{
+	printf("Usage: %s [OPTIONS]\n", argv0);
+	printf("  -p <provider>    util-based provider (default udp)\n");
+	printf("  -t <threads>     number of lookup threads (default 1)\n");
+	printf("  -n <addresses>   number of addresses inserted "
+	       "(default %d)\n", num_addr);
+	printf("  -i <iterations>  lookups per thread (default %d)\n",
+	       iterations);
+	printf("  -u               look up as a caller holding the AV lock\n");
+	printf("  -w               insert and remove other addresses "
+	       "concurrently\n");
+}
+
+int main(int argc, char **argv)
+{
+	struct fi_info *hints, *info;
+	struct fid_fabric *fabric;
+	struct fid_domain *domain;
+	struct fid_av *av_fid;
+	struct fi_av_attr av_attr = { 0 };
+	struct lookup_thread *threads;
+	pthread_t churner;
+	uint64_t errors = 0;
+	double start, elapsed;
+	int op, i, num_threads = 1, ret;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return EXIT_FAILURE;
+
+	hints->ep_attr->type = FI_EP_DGRAM;
+	hints->addr_format = FI_SOCKADDR_IN;
+	hints->fabric_attr->prov_name = strdup("udp");
+
+	while ((op = getopt(argc, argv, "p:t:n:i:uwh")) != -1) {
+		switch (op) {
+		case 'p':
+			free(hints->fabric_attr->prov_name);
+			hints->fabric_attr->prov_name = strdup(optarg);
+			break;
+		case 't':
+			num_threads = atoi(optarg);
+			break;
+		case 'n':
+			num_addr = atoi(optarg);
+			break;
+		case 'i':
+			iterations = atoi(optarg);
+			break;
+		case 'u':
+			unlocked = 1;
+			break;
+		case 'w':
+			churn = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (num_threads <= 0 || num_addr <= 0 || iterations <= 0 ||
+	    (unlocked && churn)) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	ret = fi_getinfo(FI_VERSION(FI_MAJOR_VERSION, FI_MINOR_VERSION),
+			 NULL, NULL, 0, hints, &info);
+	if (ret) {
+		printf("fi_getinfo: %s\n", fi_strerror(-ret));
+		return EXIT_FAILURE;
+	}
+
+	ret = fi_fabric(info->fabric_attr, &fabric, NULL);
+	if (!ret)
+		ret = fi_domain(fabric, info, &domain, NULL);
+	av_attr.type = FI_AV_TABLE;
+	av_attr.count = num_addr;
+	if (!ret)
+		ret = fi_av_open(domain, &av_attr, &av_fid, NULL);
+	if (ret) {
+		printf("open: %s\n", fi_strerror(-ret));
+		return EXIT_FAILURE;
+	}
+	/* Providers using ofi_ip_av_create embed the util AV */
+	av = container_of(av_fid, struct util_av, av_fid);
+
+	addrs = calloc(num_addr, sizeof(*addrs));
+	fi_addrs = calloc(num_addr, sizeof(*fi_addrs));
+	threads = calloc(num_threads, sizeof(*threads));
+	if (!addrs || !fi_addrs || !threads)
+		return EXIT_FAILURE;
+
+	for (i = 0; i < num_addr; i++) {
+		addrs[i].sin_family = AF_INET;
+		addrs[i].sin_addr.s_addr = htonl(0x0a000000 + (i >> 4));
+		addrs[i].sin_port = htons(4096 + (i & 15));
+	}
+
+	start = bench_now();
+	ret = fi_av_insert(av_fid, addrs, num_addr, fi_addrs, 0, NULL);
+	if (ret != num_addr) {
+		printf("fi_av_insert: %d\n", ret);
+		return EXIT_FAILURE;
+	}
+	printf("insert: %d addresses in %.3f s\n", num_addr,
+	       bench_now() - start);
+
+	if (churn) {
+		ret = pthread_create(&churner, NULL, churn_thread, av_fid);
+		if (ret) {
+			errno = ret;
+			perror("pthread_create");
+			return EXIT_FAILURE;
+		}
+	}
+
+	start = bench_now();
+	for (i = 0; i < num_threads; i++) {
+		threads[i].seed = i + 1;
+		ret = pthread_create(&threads[i].thread, NULL, lookup_thread,
+				     &threads[i]);
+		if (ret) {
+			errno = ret;
+			perror("pthread_create");
+			return EXIT_FAILURE;
+		}
+	}
+
+	for (i = 0; i < num_threads; i++) {
+		pthread_join(threads[i].thread, NULL);
+		errors += threads[i].errors;
+	}
+	elapsed = bench_now() - start;
+	if (churn) {
+		done = 1;
+		pthread_join(churner, NULL);
+	}
+
+	printf("threads: %d mode: %s lookups: %llu errors: %llu\n",
+	       num_threads, unlocked ? "unsafe" : churn ? "churn" : "lookup",
+	       (unsigned long long) num_threads * iterations,
+	       (unsigned long long) errors);
+	printf("elapsed: %.3f s  rate: %.2f Mlookups/s  %.1f ns/lookup "
+	       "per thread\n", elapsed,
+	       (double) num_threads * iterations / elapsed / 1e6,
+	       elapsed * 1e9 / iterations);
+
+	fi_close(&av_fid->fid);
+	fi_close(&domain->fid);
+	fi_close(&fabric->fid);
+	fi_freeinfo(info);
+	fi_freeinfo(hints);
+	free(threads);
+	free(fi_addrs);
+	free(addrs);
+	return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2026 libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under the BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Concurrent lookup benchmark for the index map.
+ *
+ * Reader threads look up random indices in a sparse set, without a lock.
+ * By default the set is written before they start.  With -w, a writer
+ * thread writes the set while they run, adding nodes to the map, then
+ * keeps clearing and setting the indices.  Readers verify that every
+ * non-NULL item they observe is the one stored for that index.  Once all
+ * indices are cleared, every lookup must miss.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <ofi_indexer.h>
+
+static struct index_map idm;
+static int num_index = 1 << 16;
+static int stride = 257;
+static int iterations = 1 << 22;
+static int churn;
+static volatile int done;
+
+struct reader {
+	pthread_t thread;
+	unsigned int seed;
+	uint64_t lookups;
+	uint64_t hits;
+	uint64_t errors;
+};
+
+static int bench_index(int i)
+{
+	return (int) (((uint64_t) i * stride) % OFI_IDX_MAX_INDEX);
+}
+
+static void *bench_item(int index)
+{
+	return (void *) ((uintptr_t) index * 2 + 1);
+}
+
+static double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench_set(int i)
+{
+	if (ofi_idm_set(&idm, bench_index(i), bench_item(bench_index(i))) < 0) {
+		perror("ofi_idm_set");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void *writer_thread(void *arg)
+{
+	int i, pass;
+
+	for (i = 0; i < num_index && !done; i++)
+		bench_set(i);
+
+	for (pass = 0; !done; pass++) {
+		for (i = pass & 1; i < num_index && !done; i += 2)
+			(void) ofi_idm_clear(&idm, bench_index(i));
+		for (i = pass & 1; i < num_index && !done; i += 2)
+			bench_set(i);
+	}
+	return NULL;
+}
+
+static void *reader_thread(void *arg)
+{
+	struct reader *reader = arg;
+	void *item;
+	int i, index;
+
+	for (i = 0; i < iterations; i++) {
+		index = bench_index(rand_r(&reader->seed) % num_index);
+		item = ofi_idm_lookup(&idm, index);
+		reader->lookups++;
+		if (!item)
+			continue;
+		reader->hits++;
+		if (item != bench_item(index))
+			reader->errors++;
+	}
+	return NULL;
+}
+
+static void usage(const char *argv0)
+{
+	printf("Usage: %s [OPTIONS]\n", argv0);
+	printf("  -t <threads>     number of reader threads (default 4)\n");
+	printf("  -n <indices>     number of indices written (default %d)\n",
+	       num_index);
+	printf("  -s <stride>      distance between written indices "
+	       "(default %d)\n", stride);
+	printf("  -i <iterations>  lookups per reader (default %d)\n",
+	       iterations);
+	printf("  -w               set and clear indices while readers run\n");
+}
+
+int main(int argc, char **argv)
+{
+	struct reader *readers;
+	pthread_t writer;
+	uint64_t lookups = 0, hits = 0, errors = 0;
+	double start, elapsed;
+	int op, i, num_readers = 4, ret;
+
+	while ((op = getopt(argc, argv, "t:n:s:i:wh")) != -1) {
+		switch (op) {
+		case 't':
+			num_readers = atoi(optarg);
+			break;
+		case 'n':
+			num_index = atoi(optarg);
+			break;
+		case 's':
+			stride = atoi(optarg);
+			break;
+		case 'i':
+			iterations = atoi(optarg);
+			break;
+		case 'w':
+			churn = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (num_readers <= 0 || num_index <= 0 || stride <= 0) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	readers = calloc(num_readers, sizeof(*readers));
+	if (!readers)
+		return EXIT_FAILURE;
+
+	if (!churn) {
+		for (i = 0; i < num_index; i++)
+			bench_set(i);
+	}
+
+	start = bench_now();
+	if (churn) {
+		ret = pthread_create(&writer, NULL, writer_thread, NULL);
+		if (ret) {
+			errno = ret;
+			perror("pthread_create");
+			return EXIT_FAILURE;
+		}
+	}
+
+	for (i = 0; i < num_readers; i++) {
+		readers[i].seed = i + 1;
+		ret = pthread_create(&readers[i].thread, NULL, reader_thread,
+				     &readers[i]);
+		if (ret) {
+			errno = ret;
+			perror("pthread_create");
+			return EXIT_FAILURE;
+		}
+	}
+
+	for (i = 0; i < num_readers; i++) {
+		pthread_join(readers[i].thread, NULL);
+		lookups += readers[i].lookups;
+		hits += readers[i].hits;
+		errors += readers[i].errors;
+	}
+	elapsed = bench_now() - start;
+	if (churn) {
+		done = 1;
+		pthread_join(writer, NULL);
+	}
+
+	for (i = 0; i < num_index; i++)
+		(void) ofi_idm_clear(&idm, bench_index(i));
+	for (i = 0; i < num_index; i++) {
+		if (ofi_idm_lookup(&idm, bench_index(i))) {
+			printf("index %d found after clearing all indices\n",
+			       bench_index(i));
+			errors++;
+			break;
+		}
+	}
+
+	printf("readers: %d mode: %s lookups: %llu hits: %llu errors: %llu\n",
+	       num_readers, churn ? "churn" : "lookup",
+	       (unsigned long long) lookups,
+	       (unsigned long long) hits, (unsigned long long) errors);
+	printf("elapsed: %.3f s  rate: %.2f Mlookups/s\n", elapsed,
+	       lookups / elapsed / 1e6);
+
+	ofi_idm_reset(&idm, NULL);
+	free(readers);
+	return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}